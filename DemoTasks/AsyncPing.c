@@ -0,0 +1,411 @@
+/*
+ * FreeRTOS V202411.00
+ * Copyright (C) 2020 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * https://www.FreeRTOS.org
+ * https://github.com/FreeRTOS
+ *
+ */
+
+/*
+ * See AsyncPing.h.
+ *
+ * Each ping that is waiting for a reply occupies a slot in a small table.  A
+ * slot is reserved before the ping is sent, so the send time can be recorded
+ * without holding a critical section across FreeRTOS_SendPingRequest(), and
+ * is given the ping's identifier once FreeRTOS_SendPingRequest() returns.  A
+ * reply that arrives before the identifier has been recorded is remembered
+ * so the sender can match it up itself.
+ */
+
+/* Standard includes. */
+#include <stdint.h>
+#include <string.h>
+
+/* FreeRTOS includes. */
+#include "FreeRTOS.h"
+#include "task.h"
+
+/* FreeRTOS+UDP includes. */
+#include "FreeRTOS_IP.h"
+#include "FreeRTOS_Sockets.h"
+
+/* Demo app includes. */
+#include "AsyncPing.h"
+#include "DemoTimestamp.h"
+
+#if ( ipconfigSUPPORT_OUTGOING_PINGS == 1 )
+
+/* The states of a slot in the outstanding ping table. */
+    #define pingSLOT_FREE        0
+    #define pingSLOT_RESERVED    1 /* The ping is being sent, its identifier is not yet known. */
+    #define pingSLOT_SENT        2 /* The ping is waiting for its reply. */
+
+/* A ping that is waiting for its reply. */
+    typedef struct xPING_SLOT
+    {
+        BaseType_t xState;              /* One of the pingSLOT_ states. */
+        uint16_t usIdentifier;          /* The identifier returned by FreeRTOS_SendPingRequest(). */
+        DemoTimestamp_t xSent;          /* The time at which the ping was sent. */
+        AsyncPingCallback_t pxCallback; /* Called when the reply arrives. */
+        void * pvContext;               /* Passed to pxCallback. */
+    } PingSlot_t;
+
+/* A reply received for a ping that was not in the table. */
+    typedef struct xPING_EARLY_REPLY
+    {
+        BaseType_t xValid;          /* pdTRUE if the other members hold a reply. */
+        uint16_t usIdentifier;      /* The identifier in the reply. */
+        ePingReplyStatus_t eStatus; /* The status passed to vApplicationPingReplyHook(). */
+        DemoTimestamp_t xReceived;  /* The time at which the reply was received. */
+    } PingEarlyReply_t;
+
+/* The state of a run of pings started by xAsyncPingRun(). */
+    typedef struct xPING_RUN
+    {
+        TaskHandle_t xTask;        /* The task waiting for the replies. */
+        uint32_t ulReceived;       /* Successful replies. */
+        uint32_t ulFailed;         /* Replies with a bad checksum or bad data. */
+        uint32_t ulMinUs;          /* The shortest round trip time. */
+        uint32_t ulMaxUs;          /* The longest round trip time. */
+        uint32_t ulLastUs;         /* The round trip time of the most recent reply. */
+        uint64_t ullTotalUs;       /* The sum of the round trip times. */
+        uint64_t ullTotalJitterUs; /* The sum of the differences between consecutive round trip times. */
+    } PingRun_t;
+
+/*
+ * The callback used by xAsyncPingRun() to accumulate the round trip times.
+ */
+    static void prvRunCallback( uint16_t usIdentifier,
+                                BaseType_t xSuccess,
+                                uint32_t ulRoundTripUs,
+                                void * pvContext );
+
+/*-----------------------------------------------------------*/
+
+    static PingSlot_t xSlots[ pingMAX_OUTSTANDING ];
+    static PingEarlyReply_t xEarlyReply = { 0 };
+
+/* The number of callbacks that vApplicationPingReplyHook() has removed from
+ * the table but not yet finished calling. */
+    static UBaseType_t uxCallbacksRunning = 0;
+
+/*-----------------------------------------------------------*/
+
+    uint16_t usAsyncPingSend( uint32_t ulIPAddress,
+                              size_t xBytes,
+                              TickType_t xBlockTime,
+                              AsyncPingCallback_t pxCallback,
+                              void * pvContext )
+    {
+        PingSlot_t * pxSlot = NULL;
+        UBaseType_t uxSlot;
+        BaseType_t xIdentifier, xAnsweredEarly = pdFALSE;
+        DemoTimestamp_t xSent, xReceived = 0;
+        ePingReplyStatus_t eStatus = eSuccess;
+
+        configASSERT( pxCallback );
+
+        taskENTER_CRITICAL();
+        {
+            for( uxSlot = 0; uxSlot < pingMAX_OUTSTANDING; uxSlot++ )
+            {
+                if( xSlots[ uxSlot ].xState == pingSLOT_FREE )
+                {
+                    pxSlot = &( xSlots[ uxSlot ] );
+                    pxSlot->xState = pingSLOT_RESERVED;
+                    pxSlot->pxCallback = pxCallback;
+                    pxSlot->pvContext = pvContext;
+                    break;
+                }
+            }
+        }
+        taskEXIT_CRITICAL();
+
+        if( pxSlot == NULL )
+        {
+            return 0;
+        }
+
+        /* The reply hook ignores reserved slots, so the send time can be set
+         * outside of the critical section. */
+        xSent = demoGET_TIMESTAMP();
+        pxSlot->xSent = xSent;
+        xIdentifier = FreeRTOS_SendPingRequest( ulIPAddress, xBytes, xBlockTime );
+
+        taskENTER_CRITICAL();
+        {
+            if( xIdentifier == pdFAIL )
+            {
+                pxSlot->xState = pingSLOT_FREE;
+            }
+            else if( ( xEarlyReply.xValid != pdFALSE ) && ( xEarlyReply.usIdentifier == ( uint16_t ) xIdentifier ) )
+            {
+                /* The reply arrived before the identifier was known. */
+                xAnsweredEarly = pdTRUE;
+                eStatus = xEarlyReply.eStatus;
+                xReceived = xEarlyReply.xReceived;
+                xEarlyReply.xValid = pdFALSE;
+                pxSlot->xState = pingSLOT_FREE;
+            }
+            else
+            {
+                pxSlot->usIdentifier = ( uint16_t ) xIdentifier;
+                pxSlot->xState = pingSLOT_SENT;
+            }
+        }
+        taskEXIT_CRITICAL();
+
+        if( xAnsweredEarly != pdFALSE )
+        {
+            pxCallback( ( uint16_t ) xIdentifier, ( eStatus == eSuccess ) ? pdTRUE : pdFALSE, demoTIMESTAMP_TO_US( xReceived - xSent ), pvContext );
+        }
+
+        return ( xIdentifier == pdFAIL ) ? 0 : ( uint16_t ) xIdentifier;
+    }
+/*-----------------------------------------------------------*/
+
+    UBaseType_t uxAsyncPingCancel( void * pvContext )
+    {
+        UBaseType_t uxSlot, uxCancelled = 0, uxRunning;
+
+        taskENTER_CRITICAL();
+        {
+            for( uxSlot = 0; uxSlot < pingMAX_OUTSTANDING; uxSlot++ )
+            {
+                if( ( xSlots[ uxSlot ].xState == pingSLOT_SENT ) && ( xSlots[ uxSlot ].pvContext == pvContext ) )
+                {
+                    xSlots[ uxSlot ].xState = pingSLOT_FREE;
+                    uxCancelled++;
+                }
+            }
+        }
+        taskEXIT_CRITICAL();
+
+        /* A reply that was being processed when the table was searched has
+         * already left the table, so wait for its callback to complete. */
+        for( ; ; )
+        {
+            taskENTER_CRITICAL();
+            {
+                uxRunning = uxCallbacksRunning;
+            }
+            taskEXIT_CRITICAL();
+
+            if( uxRunning == 0 )
+            {
+                break;
+            }
+
+            vTaskDelay( 1 );
+        }
+
+        return uxCancelled;
+    }
+/*-----------------------------------------------------------*/
+
+    BaseType_t xAsyncPingRun( uint32_t ulIPAddress,
+                              size_t xBytes,
+                              uint32_t ulCount,
+                              TickType_t xInterval,
+                              TickType_t xTimeout,
+                              AsyncPingSummary_t * pxSummary )
+    {
+        PingRun_t xRun;
+        TickType_t xNextSend, xRemaining = xTimeout;
+        TimeOut_t xTimeOut;
+        uint32_t ul, ulReplies;
+
+        configASSERT( pxSummary );
+
+        if( ( ulCount == 0 ) || ( ulCount > pingMAX_COUNT ) || ( xInterval < pdMS_TO_TICKS( pingMIN_INTERVAL_MS ) ) )
+        {
+            return pdFAIL;
+        }
+
+        memset( &xRun, 0x00, sizeof( xRun ) );
+        memset( pxSummary, 0x00, sizeof( AsyncPingSummary_t ) );
+        xRun.xTask = xTaskGetCurrentTaskHandle();
+
+        /* Discard any notification left over from before the run. */
+        ( void ) ulTaskNotifyTake( pdTRUE, 0 );
+
+        xNextSend = xTaskGetTickCount();
+
+        for( ul = 0; ul < ulCount; ul++ )
+        {
+            if( ul > 0 )
+            {
+                ( void ) xTaskDelayUntil( &xNextSend, xInterval );
+            }
+
+            if( usAsyncPingSend( ulIPAddress, xBytes, xInterval, prvRunCallback, &xRun ) != 0 )
+            {
+                pxSummary->ulSent++;
+            }
+            else
+            {
+                pxSummary->ulNotSent++;
+            }
+        }
+
+        /* Wait for the replies that are still outstanding.  The callback
+         * notifies this task each time a reply arrives. */
+        vTaskSetTimeOutState( &xTimeOut );
+
+        for( ; ; )
+        {
+            taskENTER_CRITICAL();
+            {
+                ulReplies = xRun.ulReceived + xRun.ulFailed;
+            }
+            taskEXIT_CRITICAL();
+
+            if( ( ulReplies >= pxSummary->ulSent ) || ( xTaskCheckForTimeOut( &xTimeOut, &xRemaining ) != pdFALSE ) )
+            {
+                break;
+            }
+
+            ( void ) ulTaskNotifyTake( pdTRUE, xRemaining );
+        }
+
+        /* Once the outstanding pings are cancelled xRun is no longer
+         * referenced by the table, so can go out of scope. */
+        pxSummary->ulLost = ( uint32_t ) uxAsyncPingCancel( &xRun );
+        pxSummary->ulReceived = xRun.ulReceived;
+        pxSummary->ulFailed = xRun.ulFailed;
+
+        if( xRun.ulReceived > 0 )
+        {
+            pxSummary->ulMinUs = xRun.ulMinUs;
+            pxSummary->ulMaxUs = xRun.ulMaxUs;
+            pxSummary->ulAverageUs = ( uint32_t ) ( xRun.ullTotalUs / xRun.ulReceived );
+        }
+
+        if( xRun.ulReceived > 1 )
+        {
+            pxSummary->ulJitterUs = ( uint32_t ) ( xRun.ullTotalJitterUs / ( xRun.ulReceived - 1 ) );
+        }
+
+        return pdPASS;
+    }
+/*-----------------------------------------------------------*/
+
+    static void prvRunCallback( uint16_t usIdentifier,
+                                BaseType_t xSuccess,
+                                uint32_t ulRoundTripUs,
+                                void * pvContext )
+    {
+        PingRun_t * pxRun = ( PingRun_t * ) pvContext;
+
+        ( void ) usIdentifier;
+
+        /* A reply can be passed to the callback by the sending task as well as
+         * by the IP task. */
+        taskENTER_CRITICAL();
+        {
+            if( xSuccess != pdFALSE )
+            {
+                if( pxRun->ulReceived == 0 )
+                {
+                    pxRun->ulMinUs = ulRoundTripUs;
+                    pxRun->ulMaxUs = ulRoundTripUs;
+                }
+                else
+                {
+                    if( ulRoundTripUs < pxRun->ulMinUs )
+                    {
+                        pxRun->ulMinUs = ulRoundTripUs;
+                    }
+
+                    if( ulRoundTripUs > pxRun->ulMaxUs )
+                    {
+                        pxRun->ulMaxUs = ulRoundTripUs;
+                    }
+
+                    pxRun->ullTotalJitterUs += ( ulRoundTripUs > pxRun->ulLastUs ) ? ( ulRoundTripUs - pxRun->ulLastUs ) : ( pxRun->ulLastUs - ulRoundTripUs );
+                }
+
+                pxRun->ullTotalUs += ulRoundTripUs;
+                pxRun->ulLastUs = ulRoundTripUs;
+                pxRun->ulReceived++;
+            }
+            else
+            {
+                pxRun->ulFailed++;
+            }
+        }
+        taskEXIT_CRITICAL();
+
+        xTaskNotifyGive( pxRun->xTask );
+    }
+/*-----------------------------------------------------------*/
+
+/*
+ * Called by the IP stack when a ping reply is received.
+ */
+    void vApplicationPingReplyHook( ePingReplyStatus_t eStatus,
+                                    uint16_t usIdentifier )
+    {
+        DemoTimestamp_t xReceived = demoGET_TIMESTAMP(), xSent = 0;
+        AsyncPingCallback_t pxCallback = NULL;
+        void * pvContext = NULL;
+        UBaseType_t uxSlot;
+
+        taskENTER_CRITICAL();
+        {
+            for( uxSlot = 0; uxSlot < pingMAX_OUTSTANDING; uxSlot++ )
+            {
+                if( ( xSlots[ uxSlot ].xState == pingSLOT_SENT ) && ( xSlots[ uxSlot ].usIdentifier == usIdentifier ) )
+                {
+                    xSent = xSlots[ uxSlot ].xSent;
+                    pxCallback = xSlots[ uxSlot ].pxCallback;
+                    pvContext = xSlots[ uxSlot ].pvContext;
+                    xSlots[ uxSlot ].xState = pingSLOT_FREE;
+                    uxCallbacksRunning++;
+                    break;
+                }
+            }
+
+            if( pxCallback == NULL )
+            {
+                /* The sender may not have recorded the identifier yet. */
+                xEarlyReply.xValid = pdTRUE;
+                xEarlyReply.usIdentifier = usIdentifier;
+                xEarlyReply.eStatus = eStatus;
+                xEarlyReply.xReceived = xReceived;
+            }
+        }
+        taskEXIT_CRITICAL();
+
+        if( pxCallback != NULL )
+        {
+            pxCallback( usIdentifier, ( eStatus == eSuccess ) ? pdTRUE : pdFALSE, demoTIMESTAMP_TO_US( xReceived - xSent ), pvContext );
+
+            taskENTER_CRITICAL();
+            {
+                uxCallbacksRunning--;
+            }
+            taskEXIT_CRITICAL();
+        }
+    }
+/*-----------------------------------------------------------*/
+
+#endif /* ipconfigSUPPORT_OUTGOING_PINGS == 1 */
@@ -35,6 +35,7 @@
 /* FreeRTOS includes. */
 #include "FreeRTOS.h"
 #include "task.h"
+#include "semphr.h"
 
 /* Standard includes. */
 #include <stdint.h>
@@ -49,10 +50,64 @@
 #include "FreeRTOS_UDP_IP.h"
 #include "FreeRTOS_Sockets.h"
 
+/* Demo app includes. */
+#include "CLIDispatch.h"
+#include "UDPCommandInterpreter.h"
+#include "LockProfiler.h"
+#include "TraceRing.h"
+#include "StateRecorder.h"
+#include "TwoEchoClients.h"
+#include "UDPServer.h"
+#include "AsyncPing.h"
+#include "DNSCache.h"
+#include "StackAuditor.h"
+#include "Workload.h"
+#include "PeriodicTask.h"
+#include "DemoLock.h"
+#include "DeferredOutput.h"
+#include "CoreStats.h"
+#include "CLIWriter.h"
+
 #ifndef  configINCLUDE_TRACE_RELATED_CLI_COMMANDS
     #define configINCLUDE_TRACE_RELATED_CLI_COMMANDS    0
 #endif
 
+/* The task-stats and run-time-stats commands take a snapshot of the state of
+ * every task using uxTaskGetSystemState(), then return as many rows of the
+ * table as fit in the write buffer per call.  This sets the maximum number of
+ * tasks the snapshot can hold. */
+#ifndef cliMAX_TASKS_IN_SNAPSHOT
+    #define cliMAX_TASKS_IN_SNAPSHOT    64
+#endif
+
+/* The longest interval that can be sampled by "run-time-stats delta <ms>". */
+#define cliMAX_RUN_TIME_DELTA_MS    60000UL
+
+/* The most IP stack debug counters the ip-debug-stats command can copy into
+ * its snapshot. */
+#ifndef cliMAX_DEBUG_STATS
+    #define cliMAX_DEBUG_STATS    32
+#endif
+
+/* How long the ping command waits for replies after the last ping is sent. */
+#define cliPING_REPLY_TIMEOUT_MS    2000UL
+
+/* The number of samples shown on each row of the task-timeline output.  Rows
+ * start at a multiple of this, so if it is a multiple of
+ * staterecSAMPLES_PER_STAMP the time shown for each row is the time the
+ * recorder took its first sample. */
+#define cliTIMELINE_SAMPLES_PER_ROW    64
+
+/* How long the lock-mode and lock-compare commands wait for a lock to be free
+ * so its mode can be changed. */
+#define cliLOCK_MODE_TIMEOUT_MS    10000UL
+
+/* The default and longest total time lock-compare runs the workload for,
+ * which is split equally between the lock modes.  lock-compare is a heavy
+ * command, so the limit also bounds how long it occupies a worker. */
+#define cliLOCK_COMPARE_DEFAULT_SECONDS    30UL
+#define cliLOCK_COMPARE_MAX_SECONDS        300UL
+
 
 /*
  * Implements the run-time-stats command.
@@ -68,6 +123,29 @@ static portBASE_TYPE prvRunTimeStatsCommand( int8_t * pcWriteBuffer,
                                              size_t xWriteBufferLen,
                                              const int8_t * pcCommandString );
 
+/*
+ * Implements "run-time-stats cores", which shows the share of each core's
+ * time used by each task.
+ */
+static portBASE_TYPE prvRunTimeStatsPerCore( CLIWriter_t * pxWriter,
+                                             const int8_t * pcCommandString );
+
+/*
+ * Implements the core-affinity command.
+ */
+static portBASE_TYPE prvCoreAffinityCommand( int8_t * pcWriteBuffer,
+                                             size_t xWriteBufferLen,
+                                             const int8_t * pcCommandString );
+
+/*
+ * Take a snapshot of the state of every task into pxTaskStatusArray, which
+ * has room for uxArraySize tasks.  Returns the number of tasks in the
+ * snapshot, or 0 if there are more tasks than will fit in the array.
+ */
+static UBaseType_t prvTakeTaskSnapshot( TaskStatus_t * pxTaskStatusArray,
+                                        UBaseType_t uxArraySize,
+                                        configRUN_TIME_COUNTER_TYPE * pulTotalRunTime );
+
 /*
  * Implements the echo-three-parameters command.
  */
@@ -90,7 +168,9 @@ static portBASE_TYPE prvDisplayIPConfig( int8_t * pcWriteBuffer,
                                          const int8_t * pcCommandString );
 
 /*
- * Defines a command that prints out the gathered demo debug stats.
+ * Defines a command that prints out the gathered demo debug stats, from a
+ * snapshot taken when the command starts, optionally with the change in each
+ * value since the previous snapshot.
  */
 static portBASE_TYPE prvDisplayIPDebugStats( int8_t * pcWriteBuffer,
                                              size_t xWriteBufferLen,
@@ -103,6 +183,114 @@ static portBASE_TYPE prvPingCommand( int8_t * pcWriteBuffer,
                                      size_t xWriteBufferLen,
                                      const int8_t * pcCommandString );
 
+/*
+ * Defines a command that prints out the counters maintained by the UDP command
+ * interpreter task.
+ */
+static portBASE_TYPE prvDisplayCLIStats( int8_t * pcWriteBuffer,
+                                         size_t xWriteBufferLen,
+                                         const int8_t * pcCommandString );
+
+/*
+ * Defines a command that prints out the statistics gathered for each lock
+ * registered with the lock profiler.
+ */
+static portBASE_TYPE prvDisplayLockStats( int8_t * pcWriteBuffer,
+                                          size_t xWriteBufferLen,
+                                          const int8_t * pcCommandString );
+
+/*
+ * Defines a command that returns the events waiting in the trace rings.
+ */
+static portBASE_TYPE prvTraceDumpCommand( int8_t * pcWriteBuffer,
+                                          size_t xWriteBufferLen,
+                                          const int8_t * pcCommandString );
+
+/*
+ * Implements the task-timeline command.
+ */
+static portBASE_TYPE prvTaskTimelineCommand( int8_t * pcWriteBuffer,
+                                             size_t xWriteBufferLen,
+                                             const int8_t * pcCommandString );
+
+/*
+ * Implements the echo-bench command.
+ */
+static portBASE_TYPE prvEchoBenchCommand( int8_t * pcWriteBuffer,
+                                          size_t xWriteBufferLen,
+                                          const int8_t * pcCommandString );
+
+/*
+ * Defines a command that prints out the counters of each UDP server and its
+ * workers.
+ */
+static portBASE_TYPE prvDisplayServerStats( int8_t * pcWriteBuffer,
+                                            size_t xWriteBufferLen,
+                                            const int8_t * pcCommandString );
+
+/*
+ * Defines a command that shows, flushes or pre-loads the DNS cache.
+ */
+static portBASE_TYPE prvDNSCacheCommand( int8_t * pcWriteBuffer,
+                                         size_t xWriteBufferLen,
+                                         const int8_t * pcCommandString );
+
+/*
+ * Defines a command that prints out the stack use seen by the stack auditor
+ * and the stack depth it recommends for each task.
+ */
+static portBASE_TYPE prvStackStatsCommand( int8_t * pcWriteBuffer,
+                                           size_t xWriteBufferLen,
+                                           const int8_t * pcCommandString );
+
+/*
+ * Defines a command that loads, changes, starts and stops the workload, and
+ * shows the response times it measured.
+ */
+static portBASE_TYPE prvWorkloadCommand( int8_t * pcWriteBuffer,
+                                         size_t xWriteBufferLen,
+                                         const int8_t * pcCommandString );
+
+/*
+ * Defines a command that prints out the start latency and response time
+ * histograms of each periodic task.
+ */
+static portBASE_TYPE prvPeriodicStatsCommand( int8_t * pcWriteBuffer,
+                                              size_t xWriteBufferLen,
+                                              const int8_t * pcCommandString );
+
+/*
+ * Defines a command that shows or changes the protocol used by every DemoLock.
+ */
+static portBASE_TYPE prvLockModeCommand( int8_t * pcWriteBuffer,
+                                         size_t xWriteBufferLen,
+                                         const int8_t * pcCommandString );
+
+/*
+ * Defines a command that runs the workload with each lock protocol in turn and
+ * compares the time the highest priority worker that uses locks was blocked.
+ */
+static portBASE_TYPE prvLockCompareCommand( int8_t * pcWriteBuffer,
+                                            size_t xWriteBufferLen,
+                                            const int8_t * pcCommandString );
+
+/*
+ * Defines a command that shows or changes whether tasks write their output
+ * directly or through the deferred output task.
+ */
+static portBASE_TYPE prvOutputModeCommand( int8_t * pcWriteBuffer,
+                                           size_t xWriteBufferLen,
+                                           const int8_t * pcCommandString );
+
+/*
+ * Convert the comma separated list of lock numbers in the xLength characters
+ * at pcList to a lock mask.  "-" is an empty list.  Returns pdFALSE if the list
+ * is not valid.
+ */
+static BaseType_t prvParseLockList( const char * pcList,
+                                    portBASE_TYPE xLength,
+                                    uint32_t * pulMask );
+
 /*
  * Implements the "trace start" and "trace stop" commands;
  */
@@ -121,25 +309,175 @@ static const CLI_Command_Definition_t xIPConfig =
     0
 };
 
+/* Structure that defines the "cli-stats" command line command. */
+static const CLI_Command_Definition_t xCLIStats =
+{
+    ( const int8_t * const ) "cli-stats",
+    ( const int8_t * const ) "cli-stats:\r\n Displays receive and session counters for the command interpreter\r\n\r\n",
+    prvDisplayCLIStats, /* The function to run. */
+    0                   /* No parameters are expected. */
+};
+
+/* Structure that defines the "lock-stats" command line command. */
+static const CLI_Command_Definition_t xLockStats =
+{
+    ( const int8_t * const ) "lock-stats",
+    ( const int8_t * const ) "lock-stats [reset]:\r\n Displays the wait and hold times of each profiled lock, times are in microseconds.\r\n"
+                             " 'reset' clears the statistics\r\n\r\n",
+    prvDisplayLockStats, /* The function to run. */
+    -1                   /* Zero or one parameters are expected, the command implementation checks them. */
+};
+
+/* Structure that defines the "trace-dump" command line command. */
+static const CLI_Command_Definition_t xTraceDump =
+{
+    ( const int8_t * const ) "trace-dump",
+    ( const int8_t * const ) "trace-dump:\r\n Returns, and removes, the events waiting in the trace rings\r\n\r\n",
+    prvTraceDumpCommand, /* The function to run. */
+    0                    /* No parameters are expected. */
+};
+
+/* Structure that defines the "task-timeline" command line command. */
+static const CLI_Command_Definition_t xTaskTimeline =
+{
+    ( const int8_t * const ) "task-timeline",
+    ( const int8_t * const ) "task-timeline [start [ticks] | stop]:\r\n Displays the recorded task state timeline, B=blocked r=ready R=running S=suspended.\r\n"
+                             " 'start' starts recording a sample every <ticks> ticks (default 1), 'stop' stops recording\r\n\r\n",
+    prvTaskTimelineCommand, /* The function to run. */
+    -1                      /* Zero, one or two parameters are expected, the command implementation checks them. */
+};
+
+/* Structure that defines the "echo-bench" command line command. */
+static const CLI_Command_Definition_t xEchoBench =
+{
+    ( const int8_t * const ) "echo-bench",
+    ( const int8_t * const ) "echo-bench [<bytes> <seconds> [window]]:\r\n Runs the echo clients as a benchmark, first using the standard interface then\r\n"
+                             " the zero copy interface, with up to [window] requests in flight (default 1).\r\n"
+                             " Without parameters shows the results of the last run\r\n\r\n",
+    prvEchoBenchCommand, /* The function to run. */
+    -1                   /* Zero, two or three parameters are expected, the command implementation checks them. */
+};
+
+/* Structure that defines the "server-stats" command line command. */
+static const CLI_Command_Definition_t xServerStats =
+{
+    ( const int8_t * const ) "server-stats",
+    ( const int8_t * const ) "server-stats:\r\n Displays the datagrams received by each UDP server and handled by each of its workers\r\n\r\n",
+    prvDisplayServerStats, /* The function to run. */
+    0                      /* No parameters are expected. */
+};
+
+/* Structure that defines the "dns-cache" command line command. */
+static const CLI_Command_Definition_t xDNSCache =
+{
+    ( const int8_t * const ) "dns-cache",
+    ( const int8_t * const ) "dns-cache [show | flush | warm <name> [name...]]:\r\n Shows the resolved host names held by the DNS cache, empties the cache,\r\n"
+                             " or resolves the named hosts and adds them to the cache\r\n\r\n",
+    prvDNSCacheCommand, /* The function to run. */
+    -1                  /* The number of parameters depends on the sub-command. */
+};
+
+/* Structure that defines the "stack-stats" command line command. */
+static const CLI_Command_Definition_t xStackStats =
+{
+    ( const int8_t * const ) "stack-stats",
+    ( const int8_t * const ) "stack-stats:\r\n Shows the least free stack seen for each task since the demo started, and\r\n"
+                             " the stack depth recommended for tasks whose created depth is known\r\n\r\n",
+    prvStackStatsCommand, /* The function to run. */
+    0                     /* No parameters are expected. */
+};
+
+/* Structure that defines the "workload" command line command. */
+static const CLI_Command_Definition_t xWorkload =
+{
+    ( const int8_t * const ) "workload",
+    ( const int8_t * const ) "workload [show | list | load <scenario> | start | stop |\r\n"
+                             "          set <task> <priority> [<period> <burst> <locks> <hold> [offset [output]]]]:\r\n"
+                             " Runs a set of periodic tasks and shows each task's response times and missed\r\n"
+                             " deadlines.  Times are in ms.  <locks> is a comma separated list of lock\r\n"
+                             " numbers, or - for none.  [output] is the number of characters each job writes\r\n"
+                             " while holding its locks, see output-mode.  A priority of 0 removes the task\r\n\r\n",
+    prvWorkloadCommand, /* The function to run. */
+    -1                  /* The number of parameters depends on the sub-command. */
+};
+
+/* Structure that defines the "periodic-stats" command line command. */
+static const CLI_Command_Definition_t xPeriodicStats =
+{
+    ( const int8_t * const ) "periodic-stats",
+    ( const int8_t * const ) "periodic-stats [reset]:\r\n Displays the start latency and response time of each periodic task's jobs,\r\n"
+                             " including the workload workers, and how many missed their deadline.  Times\r\n"
+                             " are in microseconds.  'reset' clears the statistics\r\n\r\n",
+    prvPeriodicStatsCommand, /* The function to run. */
+    -1                       /* Zero or one parameters are expected, the command implementation checks them. */
+};
+
+/* Structure that defines the "lock-mode" command line command. */
+static const CLI_Command_Definition_t xLockMode =
+{
+    ( const int8_t * const ) "lock-mode",
+    ( const int8_t * const ) "lock-mode [mutex | semaphore | ceiling]:\r\n Shows the protocol used by each lock, or changes the protocol used by every\r\n"
+                             " lock to priority inheritance, none, or the immediate priority ceiling\r\n\r\n",
+    prvLockModeCommand, /* The function to run. */
+    -1                  /* Zero or one parameters are expected, the command implementation checks them. */
+};
+
+/* Structure that defines the "lock-compare" command line command. */
+static const CLI_Command_Definition_t xLockCompare =
+{
+    ( const int8_t * const ) "lock-compare",
+    ( const int8_t * const ) "lock-compare [seconds]:\r\n Runs the workload with each lock protocol in turn, splitting the given total\r\n"
+                             " time between them, then compares how long the highest priority task that\r\n"
+                             " uses locks was blocked\r\n\r\n",
+    prvLockCompareCommand, /* The function to run. */
+    -1                     /* Zero or one parameters are expected, the command implementation checks them. */
+};
+
+/* Structure that defines the "output-mode" command line command. */
+static const CLI_Command_Definition_t xOutputMode =
+{
+    ( const int8_t * const ) "output-mode",
+    ( const int8_t * const ) "output-mode [direct | deferred]:\r\n Shows or changes whether tasks write slow output while holding their lock, or\r\n"
+                             " only queue it for the output task.  Also shows the output task's statistics\r\n\r\n",
+    prvOutputModeCommand, /* The function to run. */
+    -1                    /* Zero or one parameters are expected, the command implementation checks them. */
+};
+
 #if configINCLUDE_DEMO_DEBUG_STATS != 0
     /* Structure that defines the "ip-debug-stats" command line command. */
     static const CLI_Command_Definition_t xIPDebugStats =
     {
         ( const int8_t * const ) "ip-debug-stats", /* The command string to type. */
-        ( const int8_t * const ) "ip-debug-stats:\r\n Shows some IP stack stats useful for debug - an example only.\r\n\r\n",
+        ( const int8_t * const ) "ip-debug-stats [delta]:\r\n Shows some IP stack stats useful for debug - an example only.  All the values\r\n"
+                                 " are copied at the same time.  'delta' also shows the change in each value since\r\n"
+                                 " the previous ip-debug-stats command\r\n\r\n",
         prvDisplayIPDebugStats,                    /* The function to run. */
-        0                                          /* No parameters are expected. */
+        -1                                         /* Zero or one parameters are expected, the command implementation checks them. */
     };
 #endif /* configINCLUDE_DEMO_DEBUG_STATS */
 
 /* Structure that defines the "run-time-stats" command line command.   This
- * generates a table that shows how much run time each task has */
+ * generates a table that shows how much run time each task has used, either
+ * since boot or, with the delta parameter, over a recent interval. */
 static const CLI_Command_Definition_t xRunTimeStats =
 {
     ( const int8_t * const ) "run-time-stats", /* The command string to type. */
-    ( const int8_t * const ) "run-time-stats:\r\n Displays a table showing how much processing time each FreeRTOS task has used\r\n\r\n",
+    ( const int8_t * const ) "run-time-stats [delta [ms] | cores [reset]]:\r\n Displays a table showing how much processing time each FreeRTOS task has used.\r\n"
+                             " 'delta' shows the time used since the previous run-time-stats command,\r\n"
+                             " 'delta <ms>' samples for <ms> milliseconds then shows the time used in that interval,\r\n"
+                             " 'cores' shows the share of each core's ticks each task was running for\r\n\r\n",
     prvRunTimeStatsCommand,                    /* The function to run. */
-    0                                          /* No parameters are expected. */
+    -1                                         /* Zero, one or two parameters are expected, the command implementation checks them. */
+};
+
+/* Structure that defines the "core-affinity" command line command. */
+static const CLI_Command_Definition_t xCoreAffinity =
+{
+    ( const int8_t * const ) "core-affinity",
+    ( const int8_t * const ) "core-affinity [<task> <mask>]:\r\n Lists the cores each task can run on, or sets the core mask of the named task,\r\n"
+                             " for example 'core-affinity H 0x2'.  Masks can only be set on SMP builds\r\n\r\n",
+    prvCoreAffinityCommand, /* The function to run. */
+    -1                      /* Zero or two parameters are expected, the command implementation checks them. */
 };
 
 /* Structure that defines the "task-stats" command line command.  This generates
@@ -182,9 +520,11 @@ static const CLI_Command_Definition_t xParameterEcho =
     static const CLI_Command_Definition_t xPing =
     {
         ( const int8_t * const ) "ping",
-        ( const int8_t * const ) "ping <ipaddress> <optional:bytes to send>:\r\n for example, ping 192.168.0.3 8, or ping www.example.com\r\n\r\n",
+        ( const int8_t * const ) "ping <ipaddress> [bytes [count [interval ms]]]:\r\n Sends <count> pings (default 4) of <bytes> bytes (default 8), <interval ms> apart\r\n"
+                                 " (default 1000), then shows the min/avg/max round trip time and the jitter.\r\n"
+                                 " For example, ping 192.168.0.3 8, or ping www.example.com\r\n\r\n",
         prvPingCommand, /* The function to run. */
-        -1              /* Ping can take either one or two parameter, so the number of parameters has to be determined by the ping command implementation. */
+        -1              /* Ping can take from one to four parameters, so the number of parameters has to be determined by the ping command implementation. */
     };
 
 #endif /* ipconfigSUPPORT_OUTGOING_PINGS */
@@ -206,138 +546,676 @@ static const CLI_Command_Definition_t xParameterEcho =
 
 void vRegisterCLICommands( void )
 {
-    /* Register all the command line commands defined immediately above. */
-    FreeRTOS_CLIRegisterCommand( &xTaskStats );
-    FreeRTOS_CLIRegisterCommand( &xRunTimeStats );
-    FreeRTOS_CLIRegisterCommand( &xThreeParameterEcho );
-    FreeRTOS_CLIRegisterCommand( &xParameterEcho );
-    FreeRTOS_CLIRegisterCommand( &xIPConfig );
+    /* Register all the command line commands defined immediately above.  Each
+     * command is also added to the dispatch index used by the UDP command
+     * interpreter.  Commands that can block for a long time are registered as
+     * heavy, so the UDP command interpreter executes them in a worker task. */
+    xCLIDispatchRegisterCommand( &xTaskStats );
+    xCLIDispatchRegisterCommandWithCost( &xRunTimeStats, cliCOST_HEAVY );
+    xCLIDispatchRegisterCommand( &xThreeParameterEcho );
+    xCLIDispatchRegisterCommand( &xParameterEcho );
+    xCLIDispatchRegisterCommand( &xIPConfig );
+    xCLIDispatchRegisterCommand( &xCLIStats );
+    xCLIDispatchRegisterCommand( &xLockStats );
+    xCLIDispatchRegisterCommand( &xTraceDump );
+    xCLIDispatchRegisterCommand( &xTaskTimeline );
+    xCLIDispatchRegisterCommand( &xEchoBench );
+    xCLIDispatchRegisterCommand( &xServerStats );
+    xCLIDispatchRegisterCommandWithCost( &xDNSCache, cliCOST_HEAVY );
+    xCLIDispatchRegisterCommand( &xStackStats );
+    xCLIDispatchRegisterCommand( &xWorkload );
+    xCLIDispatchRegisterCommand( &xPeriodicStats );
+    xCLIDispatchRegisterCommandWithCost( &xLockMode, cliCOST_HEAVY );
+    xCLIDispatchRegisterCommandWithCost( &xLockCompare, cliCOST_HEAVY );
+    xCLIDispatchRegisterCommand( &xOutputMode );
+    xCLIDispatchRegisterCommand( &xCoreAffinity );
+
+    #if configINCLUDE_DEMO_DEBUG_STATS != 0
+    {
+        xCLIDispatchRegisterCommand( &xIPDebugStats );
+    }
+    #endif /* configINCLUDE_DEMO_DEBUG_STATS */
 
     #if ipconfigSUPPORT_OUTGOING_PINGS == 1
     {
-        FreeRTOS_CLIRegisterCommand( &xPing );
+        xCLIDispatchRegisterCommandWithCost( &xPing, cliCOST_HEAVY );
     }
     #endif /* ipconfigSUPPORT_OUTGOING_PINGS */
 
     #if configINCLUDE_TRACE_RELATED_CLI_COMMANDS == 1
-        FreeRTOS_CLIRegisterCommand( &xStartStopTrace );
+        xCLIDispatchRegisterCommand( &xStartStopTrace );
     #endif
 }
 /*-----------------------------------------------------------*/
 
+static UBaseType_t prvTakeTaskSnapshot( TaskStatus_t * pxTaskStatusArray,
+                                        UBaseType_t uxArraySize,
+                                        configRUN_TIME_COUNTER_TYPE * pulTotalRunTime )
+{
+    /* uxTaskGetSystemState() only suspends the scheduler for as long as it
+     * takes to copy the task states into the array.  The (slower) formatting is
+     * then done with the scheduler running. */
+    return uxTaskGetSystemState( pxTaskStatusArray, uxArraySize, pulTotalRunTime );
+}
+/*-----------------------------------------------------------*/
+
 static portBASE_TYPE prvTaskStatsCommand( int8_t * pcWriteBuffer,
                                           size_t xWriteBufferLen,
                                           const int8_t * pcCommandString )
 {
     const int8_t * const pcHeader = ( int8_t * ) "Task          State  Priority  Stack	#\r\n************************************************\r\n";
+    static TaskStatus_t xSnapshot[ cliMAX_TASKS_IN_SNAPSHOT ];
+    static UBaseType_t uxTasksInSnapshot = 0;
+    static portBASE_TYPE xIndex = -1;
+    TaskStatus_t * pxTask;
+    char cState;
+    portBASE_TYPE xReturn;
+    CLIWriter_t xWriter;
+    size_t xRowStart;
 
     /* Remove compile time warnings about unused parameters, and check the
-     * write buffer is not NULL.  NOTE - for simplicity, this example assumes the
-     * write buffer length is adequate, so does not check for buffer overflows. */
+     * write buffer is not NULL. */
     ( void ) pcCommandString;
-    ( void ) xWriteBufferLen;
     configASSERT( pcWriteBuffer );
+    vCLIWriterInit( &xWriter, pcWriteBuffer, xWriteBufferLen );
 
-    /* Generate a table of task stats. */
-    strcpy( ( char * ) pcWriteBuffer, ( char * ) pcHeader );
-    vTaskList( pcWriteBuffer + strlen( ( char * ) pcHeader ) );
+    if( xIndex < 0 )
+    {
+        /* The first time the function is called after the command has been
+         * entered the state of every task is captured, then just the header is
+         * returned.  Each subsequent call returns as many rows of the table as
+         * fit in the write buffer. */
+        uxTasksInSnapshot = prvTakeTaskSnapshot( xSnapshot, cliMAX_TASKS_IN_SNAPSHOT, NULL );
 
-    /* There is no more data to return after this single string, so return
-     * pdFALSE. */
-    return pdFALSE;
+        if( uxTasksInSnapshot == 0 )
+        {
+            ( void ) xCLIWriterPrintf( &xWriter, "More than %u tasks, increase cliMAX_TASKS_IN_SNAPSHOT\r\n", ( unsigned ) cliMAX_TASKS_IN_SNAPSHOT );
+            xReturn = pdFALSE;
+        }
+        else
+        {
+            ( void ) xCLIWriterAppendString( &xWriter, ( const char * ) pcHeader );
+            xIndex = 0;
+            xReturn = pdTRUE;
+        }
+    }
+    else
+    {
+        while( xIndex < ( portBASE_TYPE ) uxTasksInSnapshot )
+        {
+            pxTask = &( xSnapshot[ xIndex ] );
+
+            /* Use the same state letters as vTaskList(). */
+            switch( pxTask->eCurrentState )
+            {
+                case eRunning:   cState = 'X'; break;
+                case eReady:     cState = 'R'; break;
+                case eBlocked:   cState = 'B'; break;
+                case eSuspended: cState = 'S'; break;
+                case eDeleted:   cState = 'D'; break;
+                default:         cState = '?'; break;
+            }
+
+            xRowStart = xCLIWriterGetMark( &xWriter );
+            ( void ) xCLIWriterPrintf( &xWriter, "%-*s\t%c\t%u\t%u\t%u\r\n",
+                                       ( int ) configMAX_TASK_NAME_LEN,
+                                       pxTask->pcTaskName,
+                                       cState,
+                                       ( unsigned ) pxTask->uxCurrentPriority,
+                                       ( unsigned ) pxTask->usStackHighWaterMark,
+                                       ( unsigned ) pxTask->xTaskNumber );
+
+            if( xCLIWriterCommitRow( &xWriter, xRowStart ) == pdFALSE )
+            {
+                /* The row did not fit, so is returned by the next call. */
+                break;
+            }
+
+            xIndex++;
+        }
+
+        if( xIndex < ( portBASE_TYPE ) uxTasksInSnapshot )
+        {
+            /* There are more rows to return after these ones. */
+            xReturn = pdTRUE;
+        }
+        else
+        {
+            /* That was the last row.  Reset the index for the next time the
+             * command is executed. */
+            xIndex = -1;
+            xReturn = pdFALSE;
+        }
+    }
+
+    return xReturn;
 }
 /*-----------------------------------------------------------*/
 
+#if ( configGENERATE_RUN_TIME_STATS == 1 )
+
+/* The run-time-stats command alternates between two snapshots so the
+ * previous snapshot is always available to calculate how much run time each
+ * task used since it was taken. */
+    typedef struct xRUN_TIME_SNAPSHOT
+    {
+        TaskStatus_t xTasks[ cliMAX_TASKS_IN_SNAPSHOT ];
+        UBaseType_t uxTasks;                         /* The number of valid entries in xTasks[], 0 if the snapshot is not valid. */
+        configRUN_TIME_COUNTER_TYPE ulTotalRunTime;  /* The total run time when the snapshot was taken. */
+        TickType_t xTimeTaken;                       /* The tick count when the snapshot was taken. */
+    } RunTimeSnapshot_t;
+
+    static RunTimeSnapshot_t xRunTimeSnapshots[ 2 ];
+
+/*
+ * Return the run time counter value that the task with handle xTask had when
+ * pxSnapshot was taken, or 0 if the task did not exist then.
+ */
+    static configRUN_TIME_COUNTER_TYPE prvGetPreviousRunTime( const RunTimeSnapshot_t * pxSnapshot,
+                                                              TaskHandle_t xTask )
+    {
+        UBaseType_t uxTask;
+
+        for( uxTask = 0; uxTask < pxSnapshot->uxTasks; uxTask++ )
+        {
+            if( pxSnapshot->xTasks[ uxTask ].xHandle == xTask )
+            {
+                return pxSnapshot->xTasks[ uxTask ].ulRunTimeCounter;
+            }
+        }
+
+        return 0;
+    }
+    /*-----------------------------------------------------------*/
+
+#endif /* configGENERATE_RUN_TIME_STATS */
+
 static portBASE_TYPE prvRunTimeStatsCommand( int8_t * pcWriteBuffer,
                                              size_t xWriteBufferLen,
                                              const int8_t * pcCommandString )
 {
     const int8_t * const pcHeader = ( int8_t * ) "Task            Abs Time      % Time\r\n****************************************\r\n";
+    portBASE_TYPE xReturn = pdFALSE;
+    const char * pcFirstParameter;
+    portBASE_TYPE xFirstParameterLength;
+
+    #if ( configGENERATE_RUN_TIME_STATS == 1 )
+        static portBASE_TYPE xIndex = -1, xCurrent = 0, xDelta = pdFALSE;
+        static configRUN_TIME_COUNTER_TYPE ulIntervalRunTime = 0, ulIdleRunTime = 0;
+        RunTimeSnapshot_t * pxCurrent, * pxPrevious;
+        configRUN_TIME_COUNTER_TYPE ulRunTime, ulPercentage;
+        TaskStatus_t * pxTask;
+        int8_t * pcParameter;
+        portBASE_TYPE xParameterStringLength;
+        uint32_t ulSampleMs = 0;
+        size_t xRowStart;
+    #endif
+    CLIWriter_t xWriter;
 
-    /* Remove compile time warnings about unused parameters, and check the
-     * write buffer is not NULL.  NOTE - for simplicity, this example assumes the
-     * write buffer length is adequate, so does not check for buffer overflows. */
-    ( void ) pcCommandString;
-    ( void ) xWriteBufferLen;
+    /* Check the write buffer is not NULL. */
     configASSERT( pcWriteBuffer );
+    vCLIWriterInit( &xWriter, pcWriteBuffer, xWriteBufferLen );
 
-    /* Generate a table of task stats. */
-    strcpy( ( char * ) pcWriteBuffer, ( char * ) pcHeader );
+    /* The command string is the same each time the function is called for one
+     * command, so every call for "run-time-stats cores" is passed on. */
+    pcFirstParameter = ( const char * ) FreeRTOS_CLIGetParameter( pcCommandString, 1, &xFirstParameterLength );
 
-    #if ( ( configGENERATE_RUN_TIME_STATS == 1 ) && ( configUSE_STATS_FORMATTING_FUNCTIONS > 0 ) && ( configSUPPORT_DYNAMIC_ALLOCATION == 1 ) )
-        vTaskGetRunTimeStats( pcWriteBuffer + strlen( ( char * ) pcHeader ) );
-    #endif
+    if( ( pcFirstParameter != NULL ) && ( xFirstParameterLength == ( portBASE_TYPE ) strlen( "cores" ) ) && ( strncmp( pcFirstParameter, "cores", strlen( "cores" ) ) == 0 ) )
+    {
+        return prvRunTimeStatsPerCore( &xWriter, pcCommandString );
+    }
 
-    /* There is no more data to return after this single string, so return
-     * pdFALSE. */
-    return pdFALSE;
+    #if ( configGENERATE_RUN_TIME_STATS == 1 )
+    {
+        if( xIndex < 0 )
+        {
+            /* As per the task-stats command, the first call captures the state
+             * of every task and returns the header, then each subsequent call
+             * returns as many rows of the table as fit.  First see if the command is to
+             * show the run time used over an interval rather than since boot. */
+            xDelta = pdFALSE;
+            pcParameter = ( int8_t * ) FreeRTOS_CLIGetParameter( pcCommandString, 1, &xParameterStringLength );
+
+            if( pcParameter != NULL )
+            {
+                if( ( xParameterStringLength == ( portBASE_TYPE ) strlen( "delta" ) ) && ( strncmp( ( const char * ) pcParameter, "delta", strlen( "delta" ) ) == 0 ) )
+                {
+                    xDelta = pdTRUE;
+                }
+                else
+                {
+                    ( void ) xCLIWriterAppendString( &xWriter, "Valid parameters are 'delta', 'delta <ms>' and 'cores'.\r\n" );
+                    return pdFALSE;
+                }
+
+                pcParameter = ( int8_t * ) FreeRTOS_CLIGetParameter( pcCommandString, 2, &xParameterStringLength );
+
+                if( pcParameter != NULL )
+                {
+                    ulSampleMs = ( uint32_t ) atol( ( const char * ) pcParameter );
+
+                    if( ( ulSampleMs == 0 ) || ( ulSampleMs > cliMAX_RUN_TIME_DELTA_MS ) )
+                    {
+                        ( void ) xCLIWriterPrintf( &xWriter, "The interval must be between 1 and %u ms.\r\n", ( unsigned ) cliMAX_RUN_TIME_DELTA_MS );
+                        return pdFALSE;
+                    }
+                }
+            }
+
+            if( ulSampleMs > 0 )
+            {
+                /* Take the snapshot from which the interval is measured, then
+                 * wait for the interval to pass. */
+                pxPrevious = &( xRunTimeSnapshots[ xCurrent ] );
+                pxPrevious->uxTasks = prvTakeTaskSnapshot( pxPrevious->xTasks, cliMAX_TASKS_IN_SNAPSHOT, &( pxPrevious->ulTotalRunTime ) );
+                pxPrevious->xTimeTaken = xTaskGetTickCount();
+                xCurrent ^= 1;
+                vTaskDelay( pdMS_TO_TICKS( ulSampleMs ) );
+            }
+
+            /* The snapshot taken now becomes the previous snapshot the next
+             * time the command is executed. */
+            pxPrevious = &( xRunTimeSnapshots[ xCurrent ^ 1 ] );
+            pxCurrent = &( xRunTimeSnapshots[ xCurrent ] );
+            pxCurrent->uxTasks = prvTakeTaskSnapshot( pxCurrent->xTasks, cliMAX_TASKS_IN_SNAPSHOT, &( pxCurrent->ulTotalRunTime ) );
+            pxCurrent->xTimeTaken = xTaskGetTickCount();
+
+            if( pxCurrent->uxTasks == 0 )
+            {
+                ( void ) xCLIWriterPrintf( &xWriter, "More than %u tasks, increase cliMAX_TASKS_IN_SNAPSHOT\r\n", ( unsigned ) cliMAX_TASKS_IN_SNAPSHOT );
+            }
+            else if( ( xDelta != pdFALSE ) && ( pxPrevious->uxTasks == 0 ) )
+            {
+                ( void ) xCLIWriterAppendString( &xWriter, "No previous sample, a delta is available the next time the command is executed.\r\n" );
+                xCurrent ^= 1;
+            }
+            else
+            {
+                if( xDelta != pdFALSE )
+                {
+                    ulIntervalRunTime = pxCurrent->ulTotalRunTime - pxPrevious->ulTotalRunTime;
+                    ( void ) xCLIWriterPrintf( &xWriter, "Run time used in the last %u ms\r\n",
+                                               ( unsigned ) pdTICKS_TO_MS( pxCurrent->xTimeTaken - pxPrevious->xTimeTaken ) );
+                }
+                else
+                {
+                    ulIntervalRunTime = pxCurrent->ulTotalRunTime;
+                }
+
+                ( void ) xCLIWriterAppendString( &xWriter, ( const char * ) pcHeader );
+
+                /* The percentage calculations below divide by the total run
+                 * time divided by 100. */
+                ulIntervalRunTime /= 100UL;
+                ulIdleRunTime = 0;
+                xIndex = 0;
+                xReturn = pdTRUE;
+            }
+        }
+        else
+        {
+            pxCurrent = &( xRunTimeSnapshots[ xCurrent ] );
+            pxPrevious = &( xRunTimeSnapshots[ xCurrent ^ 1 ] );
+
+            while( xIndex < ( portBASE_TYPE ) pxCurrent->uxTasks )
+            {
+                pxTask = &( pxCurrent->xTasks[ xIndex ] );
+                ulRunTime = pxTask->ulRunTimeCounter;
+
+                if( xDelta != pdFALSE )
+                {
+                    ulRunTime -= prvGetPreviousRunTime( pxPrevious, pxTask->xHandle );
+                }
+
+                if( ulIntervalRunTime > 0 )
+                {
+                    ulPercentage = ulRunTime / ulIntervalRunTime;
+                }
+                else
+                {
+                    ulPercentage = 0;
+                }
+
+                /* Use the same layout as vTaskGetRunTimeStats(). */
+                xRowStart = xCLIWriterGetMark( &xWriter );
+
+                if( ulPercentage > 0 )
+                {
+                    ( void ) xCLIWriterPrintf( &xWriter, "%-*s\t%llu\t\t%u%%\r\n",
+                                               ( int ) configMAX_TASK_NAME_LEN,
+                                               pxTask->pcTaskName,
+                                               ( unsigned long long ) ulRunTime,
+                                               ( unsigned ) ulPercentage );
+                }
+                else
+                {
+                    ( void ) xCLIWriterPrintf( &xWriter, "%-*s\t%llu\t\t<1%%\r\n",
+                                               ( int ) configMAX_TASK_NAME_LEN,
+                                               pxTask->pcTaskName,
+                                               ( unsigned long long ) ulRunTime );
+                }
+
+                if( xCLIWriterCommitRow( &xWriter, xRowStart ) == pdFALSE )
+                {
+                    /* The row did not fit, so is returned by the next call. */
+                    return pdTRUE;
+                }
+
+                /* Only count the idle time once the row has been returned, as
+                 * a row that did not fit is calculated again. */
+                #if ( INCLUDE_xTaskGetIdleTaskHandle == 1 )
+                {
+                    if( pxTask->xHandle == xTaskGetIdleTaskHandle() )
+                    {
+                        ulIdleRunTime += ulRunTime;
+                    }
+                }
+                #endif
+
+                xIndex++;
+            }
+
+            /* All the rows have been returned, finish with the share of the
+             * interval that was spent idle. */
+            if( ulIntervalRunTime > 0 )
+            {
+                ulPercentage = ulIdleRunTime / ulIntervalRunTime;
+
+                if( ulPercentage > 100UL )
+                {
+                    ulPercentage = 100UL;
+                }
+
+                xRowStart = xCLIWriterGetMark( &xWriter );
+                ( void ) xCLIWriterPrintf( &xWriter, "Idle %u%%, busy %u%%\r\n",
+                                           ( unsigned ) ulPercentage,
+                                           ( unsigned ) ( 100UL - ulPercentage ) );
+
+                if( xCLIWriterCommitRow( &xWriter, xRowStart ) == pdFALSE )
+                {
+                    return pdTRUE;
+                }
+            }
+
+            /* The next command calculates its delta from this snapshot. */
+            xCurrent ^= 1;
+            xIndex = -1;
+        }
+    }
+    #else /* if ( configGENERATE_RUN_TIME_STATS == 1 ) */
+    {
+        ( void ) xCLIWriterAppendString( &xWriter, ( const char * ) pcHeader );
+    }
+    #endif /* if ( configGENERATE_RUN_TIME_STATS == 1 ) */
+
+    return xReturn;
 }
 /*-----------------------------------------------------------*/
 
-static portBASE_TYPE prvThreeParameterEchoCommand( int8_t * pcWriteBuffer,
-                                                   size_t xWriteBufferLen,
-                                                   const int8_t * pcCommandString )
+static portBASE_TYPE prvRunTimeStatsPerCore( CLIWriter_t * pxWriter,
+                                             const int8_t * pcCommandString )
 {
-    int8_t * pcParameter;
+    static CoreStatsTask_t xSnapshot[ corestatsMAX_TASKS ];
+    static UBaseType_t uxTasksInSnapshot = 0;
+    static uint32_t ulTicksInSnapshot = 0;
+    static portBASE_TYPE xIndex = -1;
+    const char * pcParameter;
     portBASE_TYPE xParameterStringLength, xReturn;
-    static portBASE_TYPE lParameterNumber = 0;
-
-    /* Remove compile time warnings about unused parameters, and check the
-     * write buffer is not NULL.  NOTE - for simplicity, this example assumes the
-     * write buffer length is adequate, so does not check for buffer overflows. */
-    ( void ) pcCommandString;
-    ( void ) xWriteBufferLen;
-    configASSERT( pcWriteBuffer );
+    UBaseType_t uxCore;
+    size_t xRowStart;
 
-    if( lParameterNumber == 0 )
+    if( xIndex < 0 )
     {
-        /* The first time the function is called after the command has been
-         * entered just a header string is returned. */
-        sprintf( ( char * ) pcWriteBuffer, "The three parameters were:\r\n" );
+        pcParameter = ( const char * ) FreeRTOS_CLIGetParameter( pcCommandString, 2, &xParameterStringLength );
 
-        /* Next time the function is called the first parameter will be echoed
-         * back. */
-        lParameterNumber = 1L;
+        if( pcParameter != NULL )
+        {
+            if( ( xParameterStringLength == ( portBASE_TYPE ) strlen( "reset" ) ) && ( strncmp( pcParameter, "reset", strlen( "reset" ) ) == 0 ) )
+            {
+                vCoreStatsReset();
+                ( void ) xCLIWriterAppendString( pxWriter, "Per core samples cleared\r\n" );
+            }
+            else
+            {
+                ( void ) xCLIWriterAppendString( pxWriter, "The only valid parameter after 'cores' is 'reset'\r\n" );
+            }
+
+            return pdFALSE;
+        }
 
-        /* There is more data to be returned as no parameters have been echoed
-         * back yet. */
-        xReturn = pdPASS;
+        /* As per run-time-stats, take the snapshot and return the header, then
+         * return as many rows as fit per call. */
+        uxTasksInSnapshot = uxCoreStatsGetTasks( xSnapshot, corestatsMAX_TASKS, &ulTicksInSnapshot );
+
+        if( ( ulTicksInSnapshot == 0 ) || ( uxTasksInSnapshot == 0 ) )
+        {
+            ( void ) xCLIWriterAppendString( pxWriter, "No samples - vApplicationTickHook() must call vCoreStatsTickHook(), which needs configUSE_TICK_HOOK 1\r\n" );
+            return pdFALSE;
+        }
+
+        ( void ) xCLIWriterPrintf( pxWriter, "Share of each core's ticks over %u ticks\r\n%-*s",
+                                   ( unsigned ) ulTicksInSnapshot,
+                                   ( int ) configMAX_TASK_NAME_LEN,
+                                   "Task" );
+
+        for( uxCore = 0; uxCore < corestatsNUMBER_OF_CORES; uxCore++ )
+        {
+            ( void ) xCLIWriterAppendString( pxWriter, "\tCore " );
+            ( void ) xCLIWriterAppendUnsigned( pxWriter, ( uint32_t ) uxCore );
+        }
+
+        ( void ) xCLIWriterAppendString( pxWriter, "\r\n" );
+        xIndex = 0;
+        xReturn = pdTRUE;
     }
     else
     {
-        /* Obtain the parameter string. */
-        pcParameter = ( int8_t * ) FreeRTOS_CLIGetParameter
-                      (
-            pcCommandString,        /* The command string itself. */
-            lParameterNumber,       /* Return the next parameter. */
-            &xParameterStringLength /* Store the parameter string length. */
-                      );
+        while( xIndex < ( portBASE_TYPE ) uxTasksInSnapshot )
+        {
+            xRowStart = xCLIWriterGetMark( pxWriter );
+            ( void ) xCLIWriterPrintf( pxWriter, "%-*s", ( int ) configMAX_TASK_NAME_LEN, xSnapshot[ xIndex ].cName );
 
-        /* Sanity check something was returned. */
-        configASSERT( pcParameter );
+            for( uxCore = 0; uxCore < corestatsNUMBER_OF_CORES; uxCore++ )
+            {
+                ( void ) xCLIWriterAppendString( pxWriter, "\t" );
+                ( void ) xCLIWriterAppendUnsigned( pxWriter, ( uint32_t ) ( ( ( uint64_t ) xSnapshot[ xIndex ].ulSamples[ uxCore ] * 100ULL ) / ulTicksInSnapshot ) );
+                ( void ) xCLIWriterAppendString( pxWriter, "%" );
+            }
 
-        /* Return the parameter string. */
-        memset( pcWriteBuffer, 0x00, xWriteBufferLen );
-        sprintf( ( char * ) pcWriteBuffer, "%d: ", ( int ) lParameterNumber );
-        strncat( ( char * ) pcWriteBuffer, ( const char * ) pcParameter, xParameterStringLength );
-        strncat( ( char * ) pcWriteBuffer, "\r\n", strlen( "\r\n" ) );
+            ( void ) xCLIWriterAppendString( pxWriter, "\r\n" );
 
-        /* If this is the last of the three parameters then there are no more
-         * strings to return after this one. */
-        if( lParameterNumber == 3L )
-        {
-            /* If this is the last of the three parameters then there are no more
-             * strings to return after this one. */
-            xReturn = pdFALSE;
-            lParameterNumber = 0L;
+            if( xCLIWriterCommitRow( pxWriter, xRowStart ) == pdFALSE )
+            {
+                break;
+            }
+
+            xIndex++;
         }
-        else
+
+        if( xIndex < ( portBASE_TYPE ) uxTasksInSnapshot )
         {
-            /* There are more parameters to return after this one. */
             xReturn = pdTRUE;
-            lParameterNumber++;
         }
-    }
+        else
+        {
+            xIndex = -1;
+            xReturn = pdFALSE;
+        }
+    }
+
+    return xReturn;
+}
+/*-----------------------------------------------------------*/
+
+static portBASE_TYPE prvCoreAffinityCommand( int8_t * pcWriteBuffer,
+                                             size_t xWriteBufferLen,
+                                             const int8_t * pcCommandString )
+{
+    static TaskStatus_t xSnapshot[ cliMAX_TASKS_IN_SNAPSHOT ];
+    static UBaseType_t uxTasksInSnapshot = 0;
+    static portBASE_TYPE xIndex = -1;
+    const char * pcName, * pcMask;
+    portBASE_TYPE xNameLength, xMaskLength, xReturn = pdFALSE;
+    UBaseType_t ux, uxMask;
+    CLIWriter_t xWriter;
+    size_t xRowStart;
+
+    /* Check the write buffer is not NULL. */
+    configASSERT( pcWriteBuffer );
+    vCLIWriterInit( &xWriter, pcWriteBuffer, xWriteBufferLen );
+
+    if( xIndex < 0 )
+    {
+        uxTasksInSnapshot = prvTakeTaskSnapshot( xSnapshot, cliMAX_TASKS_IN_SNAPSHOT, NULL );
+
+        if( uxTasksInSnapshot == 0 )
+        {
+            ( void ) xCLIWriterPrintf( &xWriter, "More than %u tasks, increase cliMAX_TASKS_IN_SNAPSHOT\r\n", ( unsigned ) cliMAX_TASKS_IN_SNAPSHOT );
+            return pdFALSE;
+        }
+
+        pcName = ( const char * ) FreeRTOS_CLIGetParameter( pcCommandString, 1, &xNameLength );
+
+        if( pcName == NULL )
+        {
+            /* List every task, as many rows per call as fit. */
+            ( void ) xCLIWriterPrintf( &xWriter, "%-*s\tCores (%u in this build)\r\n", ( int ) configMAX_TASK_NAME_LEN, "Task", ( unsigned ) corestatsNUMBER_OF_CORES );
+            xIndex = 0;
+            return pdTRUE;
+        }
+
+        pcMask = ( const char * ) FreeRTOS_CLIGetParameter( pcCommandString, 2, &xMaskLength );
+
+        if( pcMask == NULL )
+        {
+            ( void ) xCLIWriterAppendString( &xWriter, "Give both a task name and a mask, for example 'core-affinity H 0x2'\r\n" );
+            return pdFALSE;
+        }
+
+        for( ux = 0; ux < uxTasksInSnapshot; ux++ )
+        {
+            if( ( strlen( xSnapshot[ ux ].pcTaskName ) == ( size_t ) xNameLength ) && ( strncmp( xSnapshot[ ux ].pcTaskName, pcName, ( size_t ) xNameLength ) == 0 ) )
+            {
+                break;
+            }
+        }
+
+        uxMask = ( UBaseType_t ) strtoul( pcMask, NULL, 0 );
+
+        if( ux == uxTasksInSnapshot )
+        {
+            ( void ) xCLIWriterAppendString( &xWriter, "There is no task called " );
+            ( void ) xCLIWriterAppendStringN( &xWriter, pcName, ( size_t ) xNameLength );
+            ( void ) xCLIWriterAppendString( &xWriter, "\r\n" );
+        }
+        else if( xCoreStatsSetAffinity( xSnapshot[ ux ].xHandle, uxMask ) == pdFAIL )
+        {
+            ( void ) xCLIWriterPrintf( &xWriter, "The mask must include one of the %u cores, and the kernel must support core affinity\r\n", ( unsigned ) corestatsNUMBER_OF_CORES );
+        }
+        else
+        {
+            /* The earlier samples were taken with the old placement. */
+            ( void ) xCLIWriterPrintf( &xWriter, "%s can now run on cores 0x%x, 'run-time-stats cores reset' clears the old samples\r\n",
+                                       xSnapshot[ ux ].pcTaskName,
+                                       ( unsigned ) uxCoreStatsGetAffinity( xSnapshot[ ux ].xHandle ) );
+        }
+    }
+    else
+    {
+        while( xIndex < ( portBASE_TYPE ) uxTasksInSnapshot )
+        {
+            xRowStart = xCLIWriterGetMark( &xWriter );
+            ( void ) xCLIWriterPrintf( &xWriter, "%-*s\t0x%x\r\n",
+                                       ( int ) configMAX_TASK_NAME_LEN,
+                                       xSnapshot[ xIndex ].pcTaskName,
+                                       ( unsigned ) uxCoreStatsGetAffinity( xSnapshot[ xIndex ].xHandle ) );
+
+            if( xCLIWriterCommitRow( &xWriter, xRowStart ) == pdFALSE )
+            {
+                break;
+            }
+
+            xIndex++;
+        }
+
+        if( xIndex < ( portBASE_TYPE ) uxTasksInSnapshot )
+        {
+            xReturn = pdTRUE;
+        }
+        else
+        {
+            xIndex = -1;
+        }
+    }
+
+    return xReturn;
+}
+/*-----------------------------------------------------------*/
+
+static portBASE_TYPE prvThreeParameterEchoCommand( int8_t * pcWriteBuffer,
+                                                   size_t xWriteBufferLen,
+                                                   const int8_t * pcCommandString )
+{
+    int8_t * pcParameter;
+    portBASE_TYPE xParameterStringLength, xReturn;
+    static portBASE_TYPE lParameterNumber = 0;
+    CLIWriter_t xWriter;
+
+    /* Remove compile time warnings about unused parameters, and check the
+     * write buffer is not NULL. */
+    ( void ) pcCommandString;
+    configASSERT( pcWriteBuffer );
+    vCLIWriterInit( &xWriter, pcWriteBuffer, xWriteBufferLen );
+
+    if( lParameterNumber == 0 )
+    {
+        /* The first time the function is called after the command has been
+         * entered just a header string is returned. */
+        ( void ) xCLIWriterAppendString( &xWriter, "The three parameters were:\r\n" );
+
+        /* Next time the function is called the first parameter will be echoed
+         * back. */
+        lParameterNumber = 1L;
+
+        /* There is more data to be returned as no parameters have been echoed
+         * back yet. */
+        xReturn = pdPASS;
+    }
+    else
+    {
+        /* Obtain the parameter string. */
+        pcParameter = ( int8_t * ) FreeRTOS_CLIGetParameter
+                      (
+            pcCommandString,        /* The command string itself. */
+            lParameterNumber,       /* Return the next parameter. */
+            &xParameterStringLength /* Store the parameter string length. */
+                      );
+
+        /* Sanity check something was returned. */
+        configASSERT( pcParameter );
+
+        /* Return the parameter string. */
+        ( void ) xCLIWriterAppendInt( &xWriter, ( int32_t ) lParameterNumber );
+        ( void ) xCLIWriterAppendString( &xWriter, ": " );
+        ( void ) xCLIWriterAppendStringN( &xWriter, ( const char * ) pcParameter, ( size_t ) xParameterStringLength );
+        ( void ) xCLIWriterAppendString( &xWriter, "\r\n" );
+
+        /* If this is the last of the three parameters then there are no more
+         * strings to return after this one. */
+        if( lParameterNumber == 3L )
+        {
+            /* If this is the last of the three parameters then there are no more
+             * strings to return after this one. */
+            xReturn = pdFALSE;
+            lParameterNumber = 0L;
+        }
+        else
+        {
+            /* There are more parameters to return after this one. */
+            xReturn = pdTRUE;
+            lParameterNumber++;
+        }
+    }
 
     return xReturn;
 }
@@ -350,19 +1228,19 @@ static portBASE_TYPE prvParameterEchoCommand( int8_t * pcWriteBuffer,
     int8_t * pcParameter;
     portBASE_TYPE xParameterStringLength, xReturn;
     static portBASE_TYPE lParameterNumber = 0;
+    CLIWriter_t xWriter;
 
     /* Remove compile time warnings about unused parameters, and check the
-     * write buffer is not NULL.  NOTE - for simplicity, this example assumes the
-     * write buffer length is adequate, so does not check for buffer overflows. */
+     * write buffer is not NULL. */
     ( void ) pcCommandString;
-    ( void ) xWriteBufferLen;
     configASSERT( pcWriteBuffer );
+    vCLIWriterInit( &xWriter, pcWriteBuffer, xWriteBufferLen );
 
     if( lParameterNumber == 0 )
     {
         /* The first time the function is called after the command has been
          * entered just a header string is returned. */
-        sprintf( ( char * ) pcWriteBuffer, "The parameters were:\r\n" );
+        ( void ) xCLIWriterAppendString( &xWriter, "The parameters were:\r\n" );
 
         /* Next time the function is called the first parameter will be echoed
          * back. */
@@ -385,10 +1263,10 @@ static portBASE_TYPE prvParameterEchoCommand( int8_t * pcWriteBuffer,
         if( pcParameter != NULL )
         {
             /* Return the parameter string. */
-            memset( pcWriteBuffer, 0x00, xWriteBufferLen );
-            sprintf( ( char * ) pcWriteBuffer, "%d: ", ( int ) lParameterNumber );
-            strncat( ( char * ) pcWriteBuffer, ( const char * ) pcParameter, xParameterStringLength );
-            strncat( ( char * ) pcWriteBuffer, "\r\n", strlen( "\r\n" ) );
+            ( void ) xCLIWriterAppendInt( &xWriter, ( int32_t ) lParameterNumber );
+            ( void ) xCLIWriterAppendString( &xWriter, ": " );
+            ( void ) xCLIWriterAppendStringN( &xWriter, ( const char * ) pcParameter, ( size_t ) xParameterStringLength );
+            ( void ) xCLIWriterAppendString( &xWriter, "\r\n" );
 
             /* There might be more parameters to return after this one. */
             xReturn = pdTRUE;
@@ -396,9 +1274,8 @@ static portBASE_TYPE prvParameterEchoCommand( int8_t * pcWriteBuffer,
         }
         else
         {
-            /* No more parameters were found.  Make sure the write buffer does
-             * not contain a valid string. */
-            pcWriteBuffer[ 0 ] = 0x00;
+            /* No more parameters were found.  The write buffer was emptied by
+             * vCLIWriterInit(). */
 
             /* No more data to return. */
             xReturn = pdFALSE;
@@ -419,37 +1296,32 @@ static portBASE_TYPE prvParameterEchoCommand( int8_t * pcWriteBuffer,
                                          const int8_t * pcCommandString )
     {
         int8_t * pcParameter;
-        portBASE_TYPE lParameterStringLength, xReturn;
-        uint32_t ulIPAddress, ulBytesToPing;
-        const uint32_t ulDefaultBytesToPing = 8UL;
-        int8_t cBuffer[ 16 ];
+        portBASE_TYPE lParameterStringLength;
+        uint32_t ulIPAddress, ulBytesToPing, ulCount, ulIntervalMs;
+        const uint32_t ulDefaultBytesToPing = 8UL, ulDefaultCount = 4UL, ulDefaultIntervalMs = 1000UL;
+        AsyncPingSummary_t xSummary;
+        CLIWriter_t xWriter;
 
-        /* Remove compile time warnings about unused parameters, and check the
-         * write buffer is not NULL.  NOTE - for simplicity, this example assumes the
-         * write buffer length is adequate, so does not check for buffer overflows. */
-        ( void ) pcCommandString;
-        ( void ) xWriteBufferLen;
+        /* Check the write buffer is not NULL, then start with an empty
+         * string. */
         configASSERT( pcWriteBuffer );
+        vCLIWriterInit( &xWriter, pcWriteBuffer, xWriteBufferLen );
 
-        /* Start with an empty string. */
-        pcWriteBuffer[ 0 ] = 0x00;
+        /* Obtain the optional number of bytes to ping, number of pings and
+         * interval between pings. */
+        pcParameter = ( int8_t * ) FreeRTOS_CLIGetParameter( pcCommandString, 2, &lParameterStringLength );
+        ulBytesToPing = ( pcParameter != NULL ) ? ( uint32_t ) atol( ( const char * ) pcParameter ) : ulDefaultBytesToPing;
 
-        /* Obtain the number of bytes to ping. */
-        pcParameter = ( int8_t * ) FreeRTOS_CLIGetParameter
-                      (
-            pcCommandString,        /* The command string itself. */
-            2,                      /* Return the second parameter. */
-            &lParameterStringLength /* Store the parameter string length. */
-                      );
+        pcParameter = ( int8_t * ) FreeRTOS_CLIGetParameter( pcCommandString, 3, &lParameterStringLength );
+        ulCount = ( pcParameter != NULL ) ? ( uint32_t ) atol( ( const char * ) pcParameter ) : ulDefaultCount;
 
-        if( pcParameter == NULL )
-        {
-            /* The number of bytes was not specified, so default it. */
-            ulBytesToPing = ulDefaultBytesToPing;
-        }
-        else
+        pcParameter = ( int8_t * ) FreeRTOS_CLIGetParameter( pcCommandString, 4, &lParameterStringLength );
+        ulIntervalMs = ( pcParameter != NULL ) ? ( uint32_t ) atol( ( const char * ) pcParameter ) : ulDefaultIntervalMs;
+
+        if( ( ulCount == 0 ) || ( ulCount > pingMAX_COUNT ) || ( ulIntervalMs < pingMIN_INTERVAL_MS ) )
         {
-            ulBytesToPing = atol( ( const char * ) pcParameter );
+            ( void ) xCLIWriterPrintf( &xWriter, "Count must be 1 to %u and interval at least %u ms\r\n", ( unsigned ) pingMAX_COUNT, ( unsigned ) pingMIN_INTERVAL_MS );
+            return pdFALSE;
         }
 
         /* Obtain the IP address string. */
@@ -474,29 +1346,37 @@ static portBASE_TYPE prvParameterEchoCommand( int8_t * pcWriteBuffer,
             /* Terminate the host name. */
             pcParameter[ lParameterStringLength ] = 0x00;
 
-            /* Attempt to resolve host. */
-            ulIPAddress = FreeRTOS_gethostbyname( ( uint8_t * ) pcParameter );
-        }
-
-        /* Convert IP address, which may have come from a DNS lookup, to string. */
-        FreeRTOS_inet_ntoa( ulIPAddress, ( char * ) cBuffer );
-
-        if( ulIPAddress != 0 )
-        {
-            xReturn = FreeRTOS_SendPingRequest( ulIPAddress, ( uint16_t ) ulBytesToPing, portMAX_DELAY );
-        }
-        else
-        {
-            xReturn = pdFALSE;
+            /* Attempt to resolve host, using the cached address if the host
+             * has been resolved recently. */
+            ulIPAddress = ulDNSCacheLookup( ( const char * ) pcParameter );
         }
 
-        if( xReturn == pdFALSE )
+        if( ( ulIPAddress == 0 ) ||
+            ( xAsyncPingRun( ulIPAddress, ( size_t ) ulBytesToPing, ulCount, pdMS_TO_TICKS( ulIntervalMs ), pdMS_TO_TICKS( cliPING_REPLY_TIMEOUT_MS ), &xSummary ) == pdFAIL ) )
         {
-            sprintf( ( char * ) pcWriteBuffer, "%s", "Could not send ping request\r\n" );
+            ( void ) xCLIWriterAppendString( &xWriter, "Could not send ping request\r\n" );
         }
         else
         {
-            sprintf( ( char * ) pcWriteBuffer, "Ping sent to %s with identifier %d\r\n", cBuffer, xReturn );
+            /* The IP address may have come from a DNS lookup. */
+            ( void ) xCLIWriterAppendString( &xWriter, "Ping " );
+            ( void ) xCLIWriterAppendIP( &xWriter, ulIPAddress );
+            ( void ) xCLIWriterPrintf( &xWriter, ", %u bytes: %u sent, %u not sent, %u received, %u failed, %u lost\r\n",
+                                       ( unsigned ) ulBytesToPing,
+                                       ( unsigned ) xSummary.ulSent,
+                                       ( unsigned ) xSummary.ulNotSent,
+                                       ( unsigned ) xSummary.ulReceived,
+                                       ( unsigned ) xSummary.ulFailed,
+                                       ( unsigned ) xSummary.ulLost );
+
+            if( xSummary.ulReceived > 0 )
+            {
+                ( void ) xCLIWriterPrintf( &xWriter, "Round trip min/avg/max/jitter %u/%u/%u/%u us\r\n",
+                                           ( unsigned ) xSummary.ulMinUs,
+                                           ( unsigned ) xSummary.ulAverageUs,
+                                           ( unsigned ) xSummary.ulMaxUs,
+                                           ( unsigned ) xSummary.ulJitterUs );
+            }
         }
 
         return pdFALSE;
@@ -512,30 +1392,116 @@ static portBASE_TYPE prvParameterEchoCommand( int8_t * pcWriteBuffer,
                                                  const int8_t * pcCommandString )
     {
         static portBASE_TYPE xIndex = -1;
+        static uint32_t ulSnapshot[ cliMAX_DEBUG_STATS ], ulPrevious[ cliMAX_DEBUG_STATS ];
+        static portBASE_TYPE xEntries = 0, xPreviousEntries = 0, xShowDelta = pdFALSE;
+        static TickType_t xSnapshotTime = 0, xPreviousTime = 0;
         extern xExampleDebugStatEntry_t xIPTraceValues[];
-        portBASE_TYPE xReturn;
+        const char * pcParameter;
+        portBASE_TYPE xParameterStringLength, xReturn, x;
+        CLIWriter_t xWriter;
+        size_t xRowStart;
 
-        /* Remove compile time warnings about unused parameters, and check the
-         * write buffer is not NULL.  NOTE - for simplicity, this example assumes the
-         * write buffer length is adequate, so does not check for buffer overflows. */
-        ( void ) pcCommandString;
-        ( void ) xWriteBufferLen;
         configASSERT( pcWriteBuffer );
+        vCLIWriterInit( &xWriter, pcWriteBuffer, xWriteBufferLen );
 
-        xIndex++;
+        if( xIndex < 0 )
+        {
+            pcParameter = ( const char * ) FreeRTOS_CLIGetParameter( pcCommandString, 1, &xParameterStringLength );
+
+            if( pcParameter == NULL )
+            {
+                xShowDelta = pdFALSE;
+            }
+            else if( ( xParameterStringLength == ( portBASE_TYPE ) strlen( "delta" ) ) && ( strncmp( pcParameter, "delta", strlen( "delta" ) ) == 0 ) )
+            {
+                xShowDelta = pdTRUE;
+            }
+            else
+            {
+                ( void ) xCLIWriterAppendString( &xWriter, "Valid parameters are 'delta'\r\n" );
+                return pdFALSE;
+            }
+
+            /* Keep the previous snapshot to calculate the deltas from. */
+            memcpy( ulPrevious, ulSnapshot, sizeof( ulSnapshot ) );
+            xPreviousEntries = xEntries;
+            xPreviousTime = xSnapshotTime;
+
+            xEntries = xExampleDebugStatEntries();
+
+            if( xEntries > cliMAX_DEBUG_STATS )
+            {
+                xEntries = cliMAX_DEBUG_STATS;
+            }
+
+            /* The values are updated by the IP task, so copy them all at once
+             * to get a set of values that are consistent with each other.  The
+             * (slower) formatting is then done outside of the critical
+             * section. */
+            taskENTER_CRITICAL();
+            {
+                for( x = 0; x < xEntries; x++ )
+                {
+                    ulSnapshot[ x ] = xIPTraceValues[ x ].ulData;
+                }
+            }
+            taskEXIT_CRITICAL();
+
+            xSnapshotTime = xTaskGetTickCount();
+
+            if( ( xShowDelta != pdFALSE ) && ( xPreviousEntries == 0 ) )
+            {
+                /* There is no previous snapshot to compare against. */
+                xShowDelta = pdFALSE;
+                ( void ) xCLIWriterAppendString( &xWriter, "No previous snapshot, showing values only\r\n" );
+            }
+            else if( xShowDelta != pdFALSE )
+            {
+                ( void ) xCLIWriterPrintf( &xWriter, "Change over the last %u ms\r\n",
+                                           ( unsigned ) ( ( ( xSnapshotTime - xPreviousTime ) * portTICK_PERIOD_MS ) ) );
+            }
+
+            xIndex = 0;
+        }
+
+        /* Pack as many values as will fit into the write buffer. */
+        while( xIndex < xEntries )
+        {
+            xRowStart = xCLIWriterGetMark( &xWriter );
+
+            if( ( xShowDelta != pdFALSE ) && ( xIndex < xPreviousEntries ) )
+            {
+                ( void ) xCLIWriterPrintf( &xWriter, "%s %u (%+d)\r\n",
+                                           ( char * ) xIPTraceValues[ xIndex ].pucDescription,
+                                           ( unsigned ) ulSnapshot[ xIndex ],
+                                           ( int ) ( ulSnapshot[ xIndex ] - ulPrevious[ xIndex ] ) );
+            }
+            else
+            {
+                ( void ) xCLIWriterPrintf( &xWriter, "%s %u\r\n",
+                                           ( char * ) xIPTraceValues[ xIndex ].pucDescription,
+                                           ( unsigned ) ulSnapshot[ xIndex ] );
+            }
+
+            /* If not even one line fits then what does fit is returned, rather
+             * than never making progress. */
+            if( xCLIWriterCommitRow( &xWriter, xRowStart ) == pdFALSE )
+            {
+                /* The rest of the values are returned by the next call. */
+                break;
+            }
+
+            xIndex++;
+        }
 
-        if( xIndex < xExampleDebugStatEntries() )
+        if( xIndex < xEntries )
         {
-            sprintf( ( char * ) pcWriteBuffer, "%s %d\r\n", ( char * ) xIPTraceValues[ xIndex ].pucDescription, ( int ) xIPTraceValues[ xIndex ].ulData );
-            xReturn = pdPASS;
+            xReturn = pdTRUE;
         }
         else
         {
             /* Reset the index for the next time it is called. */
             xIndex = -1;
-
-            /* Ensure nothing remains in the write buffer. */
-            pcWriteBuffer[ 0 ] = 0x00;
             xReturn = pdFALSE;
         }
 
@@ -549,80 +1515,1346 @@ static portBASE_TYPE prvDisplayIPConfig( int8_t * pcWriteBuffer,
                                          size_t xWriteBufferLen,
                                          const int8_t * pcCommandString )
 {
+    static const char * const pcLabels[] = { "\r\nIP address ", "\r\nNet mask ", "\r\nGateway address ", "\r\nDNS server address " };
     static portBASE_TYPE xIndex = 0;
-    portBASE_TYPE xReturn;
-    uint32_t ulAddress;
+    uint32_t ulAddresses[ sizeof( pcLabels ) / sizeof( pcLabels[ 0 ] ) ];
+    CLIWriter_t xWriter;
+    size_t xRowStart;
 
     /* Remove compile time warnings about unused parameters, and check the
-     * write buffer is not NULL.  NOTE - for simplicity, this example assumes the
-     * write buffer length is adequate, so does not check for buffer overflows. */
+     * write buffer is not NULL. */
     ( void ) pcCommandString;
-    ( void ) xWriteBufferLen;
     configASSERT( pcWriteBuffer );
+    vCLIWriterInit( &xWriter, pcWriteBuffer, xWriteBufferLen );
 
-    switch( xIndex )
+    #if defined( ipconfigIPv4_BACKWARD_COMPATIBLE ) && ( ipconfigIPv4_BACKWARD_COMPATIBLE == 0 )
+        FreeRTOS_GetEndPointConfiguration( &( ulAddresses[ 0 ] ), &( ulAddresses[ 1 ] ), &( ulAddresses[ 2 ] ), &( ulAddresses[ 3 ] ), pxNetworkEndPoints );
+    #else
+        FreeRTOS_GetAddressConfiguration( &( ulAddresses[ 0 ] ), &( ulAddresses[ 1 ] ), &( ulAddresses[ 2 ] ), &( ulAddresses[ 3 ] ) );
+    #endif /* defined( ipconfigIPv4_BACKWARD_COMPATIBLE ) && ( ipconfigIPv4_BACKWARD_COMPATIBLE == 0 ) */
+
+    /* Return as many of the addresses as fit, then the closing line breaks.
+     * xIndex remembers where to continue from if they do not all fit. */
+    while( xIndex < ( portBASE_TYPE ) ( sizeof( pcLabels ) / sizeof( pcLabels[ 0 ] ) ) )
     {
-        case 0:
-            #if defined( ipconfigIPv4_BACKWARD_COMPATIBLE ) && ( ipconfigIPv4_BACKWARD_COMPATIBLE == 0 )
-                FreeRTOS_GetEndPointConfiguration( &ulAddress, NULL, NULL, NULL, pxNetworkEndPoints );
-            #else
-                FreeRTOS_GetAddressConfiguration( &ulAddress, NULL, NULL, NULL );
-            #endif /* defined( ipconfigIPv4_BACKWARD_COMPATIBLE ) && ( ipconfigIPv4_BACKWARD_COMPATIBLE == 0 ) */
-            sprintf( ( char * ) pcWriteBuffer, "\r\nIP address " );
-            xReturn = pdTRUE;
-            xIndex++;
-            break;
+        xRowStart = xCLIWriterGetMark( &xWriter );
+        ( void ) xCLIWriterAppendString( &xWriter, pcLabels[ xIndex ] );
 
-        case 1:
-            #if defined( ipconfigIPv4_BACKWARD_COMPATIBLE ) && ( ipconfigIPv4_BACKWARD_COMPATIBLE == 0 )
-                FreeRTOS_GetEndPointConfiguration( NULL, &ulAddress, NULL, NULL, pxNetworkEndPoints );
-            #else
-                FreeRTOS_GetAddressConfiguration( NULL, &ulAddress, NULL, NULL );
-            #endif /* defined( ipconfigIPv4_BACKWARD_COMPATIBLE ) && ( ipconfigIPv4_BACKWARD_COMPATIBLE == 0 ) */
-            sprintf( ( char * ) pcWriteBuffer, "\r\nNet mask " );
-            xReturn = pdTRUE;
-            xIndex++;
-            break;
+        if( ulAddresses[ xIndex ] != 0 )
+        {
+            ( void ) xCLIWriterAppendIP( &xWriter, ulAddresses[ xIndex ] );
+        }
 
-        case 2:
-            #if defined( ipconfigIPv4_BACKWARD_COMPATIBLE ) && ( ipconfigIPv4_BACKWARD_COMPATIBLE == 0 )
-                FreeRTOS_GetEndPointConfiguration( NULL, NULL, &ulAddress, NULL, pxNetworkEndPoints );
-            #else
-                FreeRTOS_GetAddressConfiguration( NULL, NULL, &ulAddress, NULL );
-            #endif /* defined( ipconfigIPv4_BACKWARD_COMPATIBLE ) && ( ipconfigIPv4_BACKWARD_COMPATIBLE == 0 ) */
-            sprintf( ( char * ) pcWriteBuffer, "\r\nGateway address " );
-            xReturn = pdTRUE;
-            xIndex++;
-            break;
+        if( xCLIWriterCommitRow( &xWriter, xRowStart ) == pdFALSE )
+        {
+            return pdTRUE;
+        }
 
-        case 3:
-            #if defined( ipconfigIPv4_BACKWARD_COMPATIBLE ) && ( ipconfigIPv4_BACKWARD_COMPATIBLE == 0 )
-                FreeRTOS_GetEndPointConfiguration( NULL, NULL, NULL, &ulAddress, pxNetworkEndPoints );
-            #else
-                FreeRTOS_GetAddressConfiguration( NULL, NULL, NULL, &ulAddress );
-            #endif /* defined( ipconfigIPv4_BACKWARD_COMPATIBLE ) && ( ipconfigIPv4_BACKWARD_COMPATIBLE == 0 ) */
-            sprintf( ( char * ) pcWriteBuffer, "\r\nDNS server address " );
-            xReturn = pdTRUE;
-            xIndex++;
-            break;
+        xIndex++;
+    }
 
-        default:
-            ulAddress = 0;
-            sprintf( ( char * ) pcWriteBuffer, "\r\n\r\n" );
-            xReturn = pdFALSE;
-            xIndex = 0;
+    xRowStart = xCLIWriterGetMark( &xWriter );
+    ( void ) xCLIWriterAppendString( &xWriter, "\r\n\r\n" );
+
+    if( xCLIWriterCommitRow( &xWriter, xRowStart ) == pdFALSE )
+    {
+        return pdTRUE;
+    }
+
+    xIndex = 0;
+
+    return pdFALSE;
+}
+/*-----------------------------------------------------------*/
+
+static portBASE_TYPE prvDisplayCLIStats( int8_t * pcWriteBuffer,
+                                         size_t xWriteBufferLen,
+                                         const int8_t * pcCommandString )
+{
+    UDPCommandInterpreterStats_t xStats;
+    CLIWriter_t xWriter;
+
+    /* Remove compile time warnings about unused parameters, and check the
+     * write buffer is not NULL. */
+    ( void ) pcCommandString;
+    configASSERT( pcWriteBuffer );
+    vCLIWriterInit( &xWriter, pcWriteBuffer, xWriteBufferLen );
+
+    vUDPCommandInterpreterGetStats( &xStats );
+
+    ( void ) xCLIWriterPrintf( &xWriter, "Wake-ups %u\r\nDatagrams %u\r\nLast batch %u\r\nLargest batch %u\r\n"
+                                         "Sessions %u of %u\r\nSessions timed out %u\r\nSessions evicted %u\r\n"
+                                         "Reply chunks %u\r\nReply datagrams %u\r\n"
+                                         "Deferred commands %u\r\nRejected commands %u\r\nDropped replies %u\r\n",
+                               ( unsigned ) xStats.ulWakeUps,
+                               ( unsigned ) xStats.ulDatagrams,
+                               ( unsigned ) xStats.ulLastBatch,
+                               ( unsigned ) xStats.ulMaxBatch,
+                               ( unsigned ) xStats.ulActiveSessions,
+                               ( unsigned ) xStats.ulMaxSessions,
+                               ( unsigned ) xStats.ulSessionsTimedOut,
+                               ( unsigned ) xStats.ulSessionsEvicted,
+                               ( unsigned ) xStats.ulReplyChunks,
+                               ( unsigned ) xStats.ulReplyDatagrams,
+                               ( unsigned ) xStats.ulDeferred,
+                               ( unsigned ) xStats.ulRejected,
+                               ( unsigned ) xStats.ulRepliesDropped );
+
+    /* There is no more data to return after this single string, so return
+     * pdFALSE. */
+    return pdFALSE;
+}
+/*-----------------------------------------------------------*/
+
+static portBASE_TYPE prvDisplayLockStats( int8_t * pcWriteBuffer,
+                                          size_t xWriteBufferLen,
+                                          const int8_t * pcCommandString )
+{
+    static UBaseType_t uxIndex = 0;
+    LockStats_t xStats;
+    const int8_t * pcParameter;
+    portBASE_TYPE xParameterStringLength;
+    const char * pcHolder;
+    portBASE_TYPE xReturn;
+    CLIWriter_t xWriter;
+    size_t xRowStart;
+
+    /* Check the write buffer is not NULL. */
+    configASSERT( pcWriteBuffer );
+    vCLIWriterInit( &xWriter, pcWriteBuffer, xWriteBufferLen );
+
+    if( uxIndex == 0 )
+    {
+        pcParameter = ( const int8_t * ) FreeRTOS_CLIGetParameter( pcCommandString, 1, &xParameterStringLength );
+
+        if( pcParameter != NULL )
+        {
+            if( ( xParameterStringLength == ( portBASE_TYPE ) strlen( "reset" ) ) && ( strncmp( ( const char * ) pcParameter, "reset", strlen( "reset" ) ) == 0 ) )
+            {
+                vLockProfilerReset();
+                ( void ) xCLIWriterAppendString( &xWriter, "Lock statistics cleared\r\n" );
+            }
+            else
+            {
+                ( void ) xCLIWriterAppendString( &xWriter, "The only valid parameter is 'reset'\r\n" );
+            }
+
+            return pdFALSE;
+        }
+
+        if( uxLockProfilerGetCount() == 0 )
+        {
+            ( void ) xCLIWriterAppendString( &xWriter, "No locks are being profiled\r\n" );
+            return pdFALSE;
+        }
+    }
+
+    /* As many locks as fit are returned by each call. */
+    while( xLockProfilerGetStats( uxIndex, &xStats ) == pdPASS )
+    {
+        if( xStats.xHolder != NULL )
+        {
+            pcHolder = ( const char * ) pcTaskGetName( xStats.xHolder );
+        }
+        else
+        {
+            pcHolder = "-";
+        }
+
+        xRowStart = xCLIWriterGetMark( &xWriter );
+        ( void ) xCLIWriterPrintf( &xWriter, "%s (%s) holder %s\r\n"
+                                             " Acquired %u, contended %u, timed out %u, inversions %u, inherited %u\r\n"
+                                             " Wait mean %u p50 %u p99 %u max %u\r\n"
+                                             " Hold mean %u p50 %u p99 %u max %u\r\n",
+                                   xStats.pcName,
+                                   ( xStats.xIsMutex != pdFALSE ) ? "mutex" : "semaphore",
+                                   pcHolder,
+                                   ( unsigned ) xStats.ulAcquisitions,
+                                   ( unsigned ) xStats.ulContended,
+                                   ( unsigned ) xStats.ulTimeouts,
+                                   ( unsigned ) xStats.ulInversions,
+                                   ( unsigned ) xStats.ulInheritances,
+                                   ( unsigned ) ulLogHistogramMean( &( xStats.xWaitTime ) ),
+                                   ( unsigned ) ulLogHistogramPercentile( &( xStats.xWaitTime ), 500 ),
+                                   ( unsigned ) ulLogHistogramPercentile( &( xStats.xWaitTime ), 990 ),
+                                   ( unsigned ) xStats.xWaitTime.ulMax,
+                                   ( unsigned ) ulLogHistogramMean( &( xStats.xHoldTime ) ),
+                                   ( unsigned ) ulLogHistogramPercentile( &( xStats.xHoldTime ), 500 ),
+                                   ( unsigned ) ulLogHistogramPercentile( &( xStats.xHoldTime ), 990 ),
+                                   ( unsigned ) xStats.xHoldTime.ulMax );
+
+        if( xCLIWriterCommitRow( &xWriter, xRowStart ) == pdFALSE )
+        {
+            /* The lock is returned by the next call. */
             break;
+        }
+
+        uxIndex++;
     }
 
-    if( ulAddress != 0 )
+    xReturn = ( uxIndex < uxLockProfilerGetCount() ) ? pdTRUE : pdFALSE;
+
+    if( xReturn == pdFALSE )
     {
-        FreeRTOS_inet_ntoa( ulAddress, ( ( char * ) &( pcWriteBuffer[ strlen( ( char * ) pcWriteBuffer ) ] ) ) );
+        /* Start from the first lock next time. */
+        uxIndex = 0;
     }
 
     return xReturn;
 }
 /*-----------------------------------------------------------*/
 
+static portBASE_TYPE prvTraceDumpCommand( int8_t * pcWriteBuffer,
+                                          size_t xWriteBufferLen,
+                                          const int8_t * pcCommandString )
+{
+    static UBaseType_t uxRemaining = 0;
+    static BaseType_t xDumping = pdFALSE;
+    portBASE_TYPE xReturn = pdFALSE;
+    char cLine[ ringMAX_LINE_LENGTH ];
+    CLIWriter_t xWriter;
+    size_t xRowStart;
+
+    ( void ) pcCommandString;
+    configASSERT( pcWriteBuffer );
+    vCLIWriterInit( &xWriter, pcWriteBuffer, xWriteBufferLen );
+
+    if( xDumping == pdFALSE )
+    {
+        /* Only return the records that were already waiting when the command
+         * was entered, otherwise a busy task could keep the command running
+         * forever. */
+        uxRemaining = uxTraceRingGetPending();
+        xDumping = pdTRUE;
+    }
+
+    /* A record is removed from its ring when it is formatted, so a record is
+     * only formatted while there is room for the longest line, or when the
+     * write buffer is empty so the command always makes progress. */
+    while( ( uxRemaining > 0 ) &&
+           ( ( xCLIWriterGetMark( &xWriter ) == 0 ) || ( xCLIWriterGetRemaining( &xWriter ) >= sizeof( cLine ) ) ) )
+    {
+        if( xTraceRingFormatNext( cLine, sizeof( cLine ) ) == pdFALSE )
+        {
+            uxRemaining = 0;
+            break;
+        }
+
+        ( void ) xCLIWriterAppendString( &xWriter, cLine );
+        uxRemaining--;
+    }
+
+    if( uxRemaining > 0 )
+    {
+        /* The rest of the records are returned by the next call. */
+        xReturn = pdTRUE;
+    }
+    else
+    {
+        xRowStart = xCLIWriterGetMark( &xWriter );
+        ( void ) xCLIWriterPrintf( &xWriter, "%u events pending, %u dropped\r\n",
+                                   ( unsigned ) uxTraceRingGetPending(),
+                                   ( unsigned ) ulTraceRingGetDropped() );
+
+        if( xCLIWriterCommitRow( &xWriter, xRowStart ) == pdFALSE )
+        {
+            /* The summary is returned by itself by the next call. */
+            xReturn = pdTRUE;
+        }
+        else
+        {
+            xDumping = pdFALSE;
+        }
+    }
+
+    return xReturn;
+}
+/*-----------------------------------------------------------*/
+
+static portBASE_TYPE prvTaskTimelineCommand( int8_t * pcWriteBuffer,
+                                             size_t xWriteBufferLen,
+                                             const int8_t * pcCommandString )
+{
+    static const char cStateLetters[] = { 'B', 'r', 'R', 'S' };
+    static StateRecorderInfo_t xInfo;
+    static uint32_t ulRowStart = 0;
+    static UBaseType_t uxTask = 0;
+    static BaseType_t xDumping = pdFALSE;
+    StateRecorderInfo_t xLive;
+    const int8_t * pcParameter;
+    portBASE_TYPE xParameterStringLength;
+    uint32_t ulSample, ulRowEnd;
+    TickType_t xPeriod = 1;
+    CLIWriter_t xWriter;
+    size_t xRowStart;
+
+    configASSERT( pcWriteBuffer );
+    vCLIWriterInit( &xWriter, pcWriteBuffer, xWriteBufferLen );
+
+    if( xDumping == pdFALSE )
+    {
+        pcParameter = ( const int8_t * ) FreeRTOS_CLIGetParameter( pcCommandString, 1, &xParameterStringLength );
+
+        if( pcParameter != NULL )
+        {
+            if( ( xParameterStringLength == ( portBASE_TYPE ) strlen( "start" ) ) && ( strncmp( ( const char * ) pcParameter, "start", strlen( "start" ) ) == 0 ) )
+            {
+                pcParameter = ( const int8_t * ) FreeRTOS_CLIGetParameter( pcCommandString, 2, &xParameterStringLength );
+
+                if( pcParameter != NULL )
+                {
+                    xPeriod = ( TickType_t ) atol( ( const char * ) pcParameter );
+                }
+
+                if( xPeriod == 0 )
+                {
+                    ( void ) xCLIWriterAppendString( &xWriter, "The period must be at least 1 tick\r\n" );
+                }
+                else
+                {
+                    vStateRecorderStart( xPeriod );
+                    ( void ) xCLIWriterPrintf( &xWriter, "Recording a sample every %u ticks\r\n", ( unsigned ) xPeriod );
+                }
+            }
+            else if( ( xParameterStringLength == ( portBASE_TYPE ) strlen( "stop" ) ) && ( strncmp( ( const char * ) pcParameter, "stop", strlen( "stop" ) ) == 0 ) )
+            {
+                vStateRecorderStop();
+                ( void ) xCLIWriterAppendString( &xWriter, "Recording stopped\r\n" );
+            }
+            else
+            {
+                ( void ) xCLIWriterAppendString( &xWriter, "Valid parameters are 'start', 'start <ticks>' and 'stop'\r\n" );
+            }
+
+            return pdFALSE;
+        }
+
+        /* Dump the timeline.  The first call returns a summary, then each
+         * subsequent call returns as many rows as fit, each row holding the
+         * samples of one task for up to cliTIMELINE_SAMPLES_PER_ROW samples,
+         * starting with the oldest.  The dump ends at the newest sample that
+         * had been taken when the summary was generated. */
+        vStateRecorderGetInfo( &xInfo );
+
+        ( void ) xCLIWriterPrintf( &xWriter, "%u samples, one every %u ticks, %u late%s\r\n",
+                                   ( unsigned ) ( xInfo.ulSamples - xInfo.ulFirstSample ),
+                                   ( unsigned ) xInfo.xPeriod,
+                                   ( unsigned ) xInfo.ulLateSamples,
+                                   ( xInfo.xRecording != pdFALSE ) ? ", still recording" : "" );
+
+        if( ( xInfo.uxTasks == 0 ) || ( xInfo.ulSamples == xInfo.ulFirstSample ) )
+        {
+            return pdFALSE;
+        }
+
+        ulRowStart = xInfo.ulFirstSample;
+        uxTask = 0;
+        xDumping = pdTRUE;
+        return pdTRUE;
+    }
+
+    while( xDumping != pdFALSE )
+    {
+        /* The recorder can still be running, so check the samples of the
+         * next row have not been overwritten. */
+        vStateRecorderGetInfo( &xLive );
+
+        if( ( xLive.xStartTime != xInfo.xStartTime ) || ( xLive.ulSamples < xInfo.ulSamples ) )
+        {
+            ( void ) xCLIWriterAppendString( &xWriter, "The recorder was restarted, the rest of the timeline is lost\r\n" );
+            xDumping = pdFALSE;
+            break;
+        }
+
+        if( xLive.ulFirstSample > ulRowStart )
+        {
+            xRowStart = xCLIWriterGetMark( &xWriter );
+            ( void ) xCLIWriterPrintf( &xWriter, "%u samples were overwritten while being dumped\r\n",
+                                       ( unsigned ) ( xLive.ulFirstSample - ulRowStart ) );
+
+            if( xCLIWriterCommitRow( &xWriter, xRowStart ) == pdFALSE )
+            {
+                break;
+            }
+
+            /* Carry on from the oldest sample still held, at the first
+             * task. */
+            ulRowStart = xLive.ulFirstSample;
+            uxTask = 0;
+
+            if( ulRowStart >= xInfo.ulSamples )
+            {
+                xDumping = pdFALSE;
+                break;
+            }
+        }
+
+        ulRowEnd = ( ( ulRowStart / cliTIMELINE_SAMPLES_PER_ROW ) + 1UL ) * cliTIMELINE_SAMPLES_PER_ROW;
+
+        if( ulRowEnd > xInfo.ulSamples )
+        {
+            ulRowEnd = xInfo.ulSamples;
+        }
+
+        /* Each row starts with the time of its first sample, relative to when
+         * recording started. */
+        xRowStart = xCLIWriterGetMark( &xWriter );
+        ( void ) xCLIWriterPrintf( &xWriter, "%8u ms %-*s ",
+                                   ( unsigned ) pdTICKS_TO_MS( xStateRecorderGetSampleTime( ulRowStart ) - xInfo.xStartTime ),
+                                   ( int ) configMAX_TASK_NAME_LEN,
+                                   pcTaskGetName( xStateRecorderGetTask( uxTask ) ) );
+
+        for( ulSample = ulRowStart; ulSample < ulRowEnd; ulSample++ )
+        {
+            ( void ) xCLIWriterAppendStringN( &xWriter, &( cStateLetters[ uxStateRecorderGetState( ulSample, uxTask ) ] ), 1 );
+        }
+
+        ( void ) xCLIWriterAppendString( &xWriter, ( uxTask == ( xInfo.uxTasks - 1 ) ) ? "\r\n\r\n" : "\r\n" );
+
+        if( xCLIWriterCommitRow( &xWriter, xRowStart ) == pdFALSE )
+        {
+            /* The row is returned by the next call. */
+            break;
+        }
+
+        /* Move to the next task, then to the next block of samples. */
+        uxTask++;
+
+        if( uxTask >= xInfo.uxTasks )
+        {
+            uxTask = 0;
+            ulRowStart = ulRowEnd;
+        }
+
+        if( ulRowStart >= xInfo.ulSamples )
+        {
+            xDumping = pdFALSE;
+        }
+    }
+
+    return xDumping;
+}
+/*-----------------------------------------------------------*/
+
+static portBASE_TYPE prvEchoBenchCommand( int8_t * pcWriteBuffer,
+                                          size_t xWriteBufferLen,
+                                          const int8_t * pcCommandString )
+{
+    EchoBenchResult_t xResults[ 2 ];
+    const int8_t * pcParameter;
+    portBASE_TYPE xParameterStringLength;
+    uint32_t ulBytes, ulSeconds, ulWindow, ulLoss[ 2 ], ulRate[ 2 ];
+    BaseType_t xRunning, x;
+    CLIWriter_t xWriter;
+
+    /* Check the write buffer is not NULL. */
+    configASSERT( pcWriteBuffer );
+    vCLIWriterInit( &xWriter, pcWriteBuffer, xWriteBufferLen );
+
+    pcParameter = ( const int8_t * ) FreeRTOS_CLIGetParameter( pcCommandString, 1, &xParameterStringLength );
+
+    if( pcParameter != NULL )
+    {
+        ulBytes = ( uint32_t ) atol( ( const char * ) pcParameter );
+        pcParameter = ( const int8_t * ) FreeRTOS_CLIGetParameter( pcCommandString, 2, &xParameterStringLength );
+        ulSeconds = ( pcParameter != NULL ) ? ( uint32_t ) atol( ( const char * ) pcParameter ) : 0UL;
+        pcParameter = ( const int8_t * ) FreeRTOS_CLIGetParameter( pcCommandString, 3, &xParameterStringLength );
+        ulWindow = ( pcParameter != NULL ) ? ( uint32_t ) atol( ( const char * ) pcParameter ) : 1UL;
+
+        if( xEchoBenchStart( ( size_t ) ulBytes, ulSeconds * 1000UL, ( UBaseType_t ) ulWindow ) == pdPASS )
+        {
+            ( void ) xCLIWriterPrintf( &xWriter, "Benchmark started, results in about %u seconds\r\n", ( unsigned ) ( ulSeconds * 2UL ) );
+        }
+        else
+        {
+            ( void ) xCLIWriterPrintf( &xWriter, "Either a benchmark is running or the parameters are invalid.  Use 'echo-bench <%u to %u bytes> <1 to %u seconds> [1 to %u]'\r\n",
+                                       ( unsigned ) echoBENCH_MIN_PAYLOAD,
+                                       ( unsigned ) echoBENCH_MAX_PAYLOAD,
+                                       ( unsigned ) ( echoBENCH_MAX_RUN_TIME_MS / 1000UL ),
+                                       ( unsigned ) echoBENCH_MAX_WINDOW );
+        }
+
+        return pdFALSE;
+    }
+
+    xRunning = xEchoBenchGetResults( &( xResults[ 0 ] ), &( xResults[ 1 ] ) );
+
+    /* Loss is shown to a tenth of a percent. */
+    for( x = 0; x < 2; x++ )
+    {
+        ulLoss[ x ] = 0;
+        ulRate[ x ] = 0;
+
+        if( xResults[ x ].ulSent > 0 )
+        {
+            ulLoss[ x ] = ( uint32_t ) ( ( ( uint64_t ) xResults[ x ].ulLost * 1000ULL ) / xResults[ x ].ulSent );
+        }
+
+        if( xResults[ x ].ulDurationMs > 0 )
+        {
+            ulRate[ x ] = ( uint32_t ) ( ( ( uint64_t ) xResults[ x ].ulReceived * 1000ULL ) / xResults[ x ].ulDurationMs );
+        }
+    }
+
+    ( void ) xCLIWriterPrintf( &xWriter,
+                               "%s                       Copy  Zero copy\r\n"
+                               "Payload bytes   %10u %10u\r\n"
+                               "Window          %10u %10u\r\n"
+                               "Run time ms     %10u %10u\r\n"
+                               "Sent            %10u %10u\r\n"
+                               "Received        %10u %10u\r\n"
+                               "Erroneous       %10u %10u\r\n"
+                               "Lost            %10u %10u\r\n"
+                               "Late            %10u %10u\r\n"
+                               "Loss %%          %8u.%u %8u.%u\r\n"
+                               "Packets/s       %10u %10u\r\n"
+                               "RTT p50 us      %10u %10u\r\n"
+                               "RTT p99 us      %10u %10u\r\n"
+                               "RTT p99.9 us    %10u %10u\r\n"
+                               "RTT max us      %10u %10u\r\n",
+                               ( xRunning != pdFALSE ) ? "Benchmark running, previous results:\r\n" : "",
+                               ( unsigned ) xResults[ 0 ].ulPayloadBytes, ( unsigned ) xResults[ 1 ].ulPayloadBytes,
+                               ( unsigned ) xResults[ 0 ].ulWindow, ( unsigned ) xResults[ 1 ].ulWindow,
+                               ( unsigned ) xResults[ 0 ].ulDurationMs, ( unsigned ) xResults[ 1 ].ulDurationMs,
+                               ( unsigned ) xResults[ 0 ].ulSent, ( unsigned ) xResults[ 1 ].ulSent,
+                               ( unsigned ) xResults[ 0 ].ulReceived, ( unsigned ) xResults[ 1 ].ulReceived,
+                               ( unsigned ) xResults[ 0 ].ulErroneous, ( unsigned ) xResults[ 1 ].ulErroneous,
+                               ( unsigned ) xResults[ 0 ].ulLost, ( unsigned ) xResults[ 1 ].ulLost,
+                               ( unsigned ) xResults[ 0 ].ulLate, ( unsigned ) xResults[ 1 ].ulLate,
+                               ( unsigned ) ( ulLoss[ 0 ] / 10UL ), ( unsigned ) ( ulLoss[ 0 ] % 10UL ),
+                               ( unsigned ) ( ulLoss[ 1 ] / 10UL ), ( unsigned ) ( ulLoss[ 1 ] % 10UL ),
+                               ( unsigned ) ulRate[ 0 ], ( unsigned ) ulRate[ 1 ],
+                               ( unsigned ) ulLogHistogramPercentile( &( xResults[ 0 ].xRoundTrip ), 500 ),
+                               ( unsigned ) ulLogHistogramPercentile( &( xResults[ 1 ].xRoundTrip ), 500 ),
+                               ( unsigned ) ulLogHistogramPercentile( &( xResults[ 0 ].xRoundTrip ), 990 ),
+                               ( unsigned ) ulLogHistogramPercentile( &( xResults[ 1 ].xRoundTrip ), 990 ),
+                               ( unsigned ) ulLogHistogramPercentile( &( xResults[ 0 ].xRoundTrip ), 999 ),
+                               ( unsigned ) ulLogHistogramPercentile( &( xResults[ 1 ].xRoundTrip ), 999 ),
+                               ( unsigned ) xResults[ 0 ].xRoundTrip.ulMax, ( unsigned ) xResults[ 1 ].xRoundTrip.ulMax );
+
+    return pdFALSE;
+}
+/*-----------------------------------------------------------*/
+
+static portBASE_TYPE prvDisplayServerStats( int8_t * pcWriteBuffer,
+                                            size_t xWriteBufferLen,
+                                            const int8_t * pcCommandString )
+{
+    static UBaseType_t uxIndex = 0;
+    UDPServerStats_t xStats;
+    UBaseType_t ux;
+    portBASE_TYPE xReturn;
+    CLIWriter_t xWriter;
+    size_t xRowStart;
+
+    /* Remove compile time warnings about unused parameters, and check the
+     * write buffer is not NULL. */
+    ( void ) pcCommandString;
+    configASSERT( pcWriteBuffer );
+    vCLIWriterInit( &xWriter, pcWriteBuffer, xWriteBufferLen );
+
+    if( ( uxIndex == 0 ) && ( uxUDPServerGetCount() == 0 ) )
+    {
+        ( void ) xCLIWriterAppendString( &xWriter, "No UDP servers have been started\r\n" );
+        return pdFALSE;
+    }
+
+    /* As many servers as fit are returned by each call. */
+    while( xUDPServerGetStats( uxIndex, &xStats ) != pdFALSE )
+    {
+        xRowStart = xCLIWriterGetMark( &xWriter );
+        ( void ) xCLIWriterPrintf( &xWriter, "%s port %u (%s): received %u, dropped %u\r\n",
+                                   xStats.pcName,
+                                   ( unsigned ) xStats.usPort,
+                                   ( xStats.xZeroCopy != pdFALSE ) ? "zero copy" : "copy",
+                                   ( unsigned ) xStats.ulReceived,
+                                   ( unsigned ) xStats.ulDropped );
+
+        for( ux = 0; ux < srvNUMBER_OF_WORKERS; ux++ )
+        {
+            ( void ) xCLIWriterPrintf( &xWriter, " Worker %u: handled %u, bytes %u, most waiting %u of %u\r\n",
+                                       ( unsigned ) ux,
+                                       ( unsigned ) xStats.xWorkers[ ux ].ulHandled,
+                                       ( unsigned ) xStats.xWorkers[ ux ].ulBytes,
+                                       ( unsigned ) xStats.xWorkers[ ux ].ulHighWater,
+                                       ( unsigned ) srvQUEUE_LENGTH );
+        }
+
+        if( xCLIWriterCommitRow( &xWriter, xRowStart ) == pdFALSE )
+        {
+            /* The server is returned by the next call. */
+            break;
+        }
+
+        uxIndex++;
+    }
+
+    xReturn = ( uxIndex < uxUDPServerGetCount() ) ? pdTRUE : pdFALSE;
+
+    if( xReturn == pdFALSE )
+    {
+        /* Start from the first server next time. */
+        uxIndex = 0;
+    }
+
+    return xReturn;
+}
+/*-----------------------------------------------------------*/
+
+static portBASE_TYPE prvDNSCacheCommand( int8_t * pcWriteBuffer,
+                                         size_t xWriteBufferLen,
+                                         const int8_t * pcCommandString )
+{
+    static UBaseType_t uxNextEntry = 0;
+    const char * pcParameter;
+    portBASE_TYPE xParameterStringLength;
+    char cName[ dnscacheMAX_NAME_LENGTH ];
+    DNSCacheEntryInfo_t xEntry;
+    DNSCacheStats_t xStats;
+    UBaseType_t ux;
+    uint32_t ulIPAddress;
+    CLIWriter_t xWriter;
+    size_t xRowStart;
+
+    /* Check the write buffer is not NULL. */
+    configASSERT( pcWriteBuffer );
+    vCLIWriterInit( &xWriter, pcWriteBuffer, xWriteBufferLen );
+
+    pcParameter = ( const char * ) FreeRTOS_CLIGetParameter( pcCommandString, 1, &xParameterStringLength );
+
+    if( ( pcParameter == NULL ) || ( ( xParameterStringLength == ( portBASE_TYPE ) strlen( "show" ) ) && ( strncmp( pcParameter, "show", strlen( "show" ) ) == 0 ) ) )
+    {
+        if( uxNextEntry == 0 )
+        {
+            vDNSCacheGetStats( &xStats );
+            ( void ) xCLIWriterPrintf( &xWriter, "Hits %u, misses %u, expired %u, evicted %u, failed %u\r\n",
+                                       ( unsigned ) xStats.ulHits,
+                                       ( unsigned ) xStats.ulMisses,
+                                       ( unsigned ) xStats.ulExpired,
+                                       ( unsigned ) xStats.ulEvictions,
+                                       ( unsigned ) xStats.ulFailures );
+        }
+
+        /* Return as many entries as fit, the rest are returned by the next
+         * call. */
+        for( ; xDNSCacheGetEntry( uxNextEntry, &xEntry ) != pdFALSE; uxNextEntry++ )
+        {
+            xRowStart = xCLIWriterGetMark( &xWriter );
+            ( void ) xCLIWriterPrintf( &xWriter, " %s ", xEntry.cName );
+            ( void ) xCLIWriterAppendIP( &xWriter, xEntry.ulIPAddress );
+            ( void ) xCLIWriterPrintf( &xWriter, ", expires in %u s, %u hits\r\n",
+                                       ( unsigned ) xEntry.ulSecondsToLive,
+                                       ( unsigned ) xEntry.ulHits );
+
+            if( xCLIWriterCommitRow( &xWriter, xRowStart ) == pdFALSE )
+            {
+                return pdTRUE;
+            }
+        }
+
+        uxNextEntry = 0;
+    }
+    else if( ( xParameterStringLength == ( portBASE_TYPE ) strlen( "flush" ) ) && ( strncmp( pcParameter, "flush", strlen( "flush" ) ) == 0 ) )
+    {
+        vDNSCacheFlush();
+        ( void ) xCLIWriterAppendString( &xWriter, "DNS cache flushed\r\n" );
+    }
+    else if( ( xParameterStringLength == ( portBASE_TYPE ) strlen( "warm" ) ) && ( strncmp( pcParameter, "warm", strlen( "warm" ) ) == 0 ) )
+    {
+        /* Resolve each of the remaining parameters in turn. */
+        for( ux = 2; ( pcParameter = ( const char * ) FreeRTOS_CLIGetParameter( pcCommandString, ux, &xParameterStringLength ) ) != NULL; ux++ )
+        {
+            if( xParameterStringLength >= dnscacheMAX_NAME_LENGTH )
+            {
+                ( void ) xCLIWriterPrintf( &xWriter, "Name %u is too long to cache\r\n", ( unsigned ) ( ux - 1 ) );
+                continue;
+            }
+
+            memcpy( cName, pcParameter, xParameterStringLength );
+            cName[ xParameterStringLength ] = 0x00;
+
+            ulIPAddress = ulDNSCacheRefresh( cName );
+
+            ( void ) xCLIWriterAppendStringN( &xWriter, cName, ( size_t ) xParameterStringLength );
+
+            if( ulIPAddress != 0 )
+            {
+                ( void ) xCLIWriterAppendString( &xWriter, " " );
+                ( void ) xCLIWriterAppendIP( &xWriter, ulIPAddress );
+                ( void ) xCLIWriterAppendString( &xWriter, "\r\n" );
+            }
+            else
+            {
+                ( void ) xCLIWriterAppendString( &xWriter, " could not be resolved\r\n" );
+            }
+        }
+
+        if( ux == 2 )
+        {
+            ( void ) xCLIWriterAppendString( &xWriter, "Enter the names to resolve after 'warm'\r\n" );
+        }
+    }
+    else
+    {
+        ( void ) xCLIWriterAppendString( &xWriter, "Valid parameters are 'show', 'flush' and 'warm'\r\n" );
+    }
+
+    return pdFALSE;
+}
+/*-----------------------------------------------------------*/
+
+static portBASE_TYPE prvStackStatsCommand( int8_t * pcWriteBuffer,
+                                           size_t xWriteBufferLen,
+                                           const int8_t * pcCommandString )
+{
+    const int8_t * const pcHeader = ( int8_t * ) "Task          Depth  MinFree  Used  Recommended\r\n************************************************\r\n";
+    static UBaseType_t uxIndex = 0;
+    static BaseType_t xHeaderSent = pdFALSE;
+    StackAuditEntry_t xEntry;
+    portBASE_TYPE xReturn;
+    CLIWriter_t xWriter;
+    size_t xRowStart;
+
+    /* Remove compile time warnings about unused parameters, and check the
+     * write buffer is not NULL. */
+    ( void ) pcCommandString;
+    configASSERT( pcWriteBuffer );
+    vCLIWriterInit( &xWriter, pcWriteBuffer, xWriteBufferLen );
+
+    if( xHeaderSent == pdFALSE )
+    {
+        /* The first time the function is called after the command has been
+         * entered just the header is returned.  As many rows of the table as
+         * fit are returned by each subsequent call. */
+        if( ulStackAuditorGetSamples() == 0 )
+        {
+            ( void ) xCLIWriterAppendString( &xWriter, "The stack auditor has not taken a sample yet\r\n" );
+            xReturn = pdFALSE;
+        }
+        else
+        {
+            ( void ) xCLIWriterPrintf( &xWriter, "%u samples, values in words\r\n", ( unsigned ) ulStackAuditorGetSamples() );
+            ( void ) xCLIWriterAppendString( &xWriter, ( const char * ) pcHeader );
+            xHeaderSent = pdTRUE;
+            uxIndex = 0;
+            xReturn = pdTRUE;
+        }
+    }
+    else
+    {
+        xReturn = pdFALSE;
+
+        while( xStackAuditorGetEntry( uxIndex, &xEntry ) != pdFALSE )
+        {
+            xRowStart = xCLIWriterGetMark( &xWriter );
+            ( void ) xCLIWriterPrintf( &xWriter, "%-*s\t", ( int ) configMAX_TASK_NAME_LEN, xEntry.cName );
+
+            if( xEntry.uxStackDepth != 0 )
+            {
+                ( void ) xCLIWriterAppendUnsigned( &xWriter, ( uint32_t ) xEntry.uxStackDepth );
+                ( void ) xCLIWriterAppendString( &xWriter, "\t" );
+                ( void ) xCLIWriterAppendUnsigned( &xWriter, ( uint32_t ) xEntry.uxMinHighWater );
+                ( void ) xCLIWriterAppendString( &xWriter, "\t" );
+                ( void ) xCLIWriterAppendUnsigned( &xWriter, ( uint32_t ) ( xEntry.uxStackDepth - xEntry.uxMinHighWater ) );
+                ( void ) xCLIWriterAppendString( &xWriter, "\t" );
+                ( void ) xCLIWriterAppendUnsigned( &xWriter, ( uint32_t ) xEntry.uxRecommended );
+            }
+            else
+            {
+                /* The depth the task was created with is not known, so neither
+                 * is how much of it has been used. */
+                ( void ) xCLIWriterAppendString( &xWriter, "-\t" );
+                ( void ) xCLIWriterAppendUnsigned( &xWriter, ( uint32_t ) xEntry.uxMinHighWater );
+                ( void ) xCLIWriterAppendString( &xWriter, "\t-\t-" );
+            }
+
+            ( void ) xCLIWriterAppendString( &xWriter, ( xEntry.xDeleted != pdFALSE ) ? " (deleted)\r\n" : "\r\n" );
+
+            if( xCLIWriterCommitRow( &xWriter, xRowStart ) == pdFALSE )
+            {
+                /* The row is returned by the next call. */
+                xReturn = pdTRUE;
+                break;
+            }
+
+            uxIndex++;
+        }
+
+        if( xReturn == pdFALSE )
+        {
+            /* No more rows.  Reset for the next time the command is
+             * executed. */
+            xHeaderSent = pdFALSE;
+        }
+    }
+
+    return xReturn;
+}
+/*-----------------------------------------------------------*/
+
+static portBASE_TYPE prvWorkloadCommand( int8_t * pcWriteBuffer,
+                                         size_t xWriteBufferLen,
+                                         const int8_t * pcCommandString )
+{
+    static portBASE_TYPE xIndex = -1;
+    const char * pcParameter, * pcDescription;
+    portBASE_TYPE xParameterStringLength, xLocksLength = 0;
+    char cName[ 16 ];
+    const char * pcLocks = NULL;
+    WorkloadTaskConfig_t xConfig;
+    WorkloadTaskStats_t xStats;
+    UBaseType_t ux, uxTask;
+    uint32_t ulLocksLeft;
+    BaseType_t xValid;
+    portBASE_TYPE xReturn = pdFALSE;
+    CLIWriter_t xWriter;
+    size_t xRowStart;
+
+    /* Check the write buffer is not NULL. */
+    configASSERT( pcWriteBuffer );
+    vCLIWriterInit( &xWriter, pcWriteBuffer, xWriteBufferLen );
+
+    if( xIndex >= 0 )
+    {
+        /* Continue returning the table, as many used tasks per call as fit. */
+        while( ( xIndex < workloadMAX_TASKS ) && ( xWorkloadGetTask( ( UBaseType_t ) xIndex, &xConfig, &xStats ) != pdFALSE ) )
+        {
+            if( xConfig.uxPriority == 0 )
+            {
+                xIndex++;
+                continue;
+            }
+
+            xRowStart = xCLIWriterGetMark( &xWriter );
+            ( void ) xCLIWriterPrintf( &xWriter, "WL%u prio %u period %u offset %u burst %u locks ",
+                                       ( unsigned ) xIndex,
+                                       ( unsigned ) xConfig.uxPriority,
+                                       ( unsigned ) xConfig.ulPeriodMs,
+                                       ( unsigned ) xConfig.ulOffsetMs,
+                                       ( unsigned ) xConfig.ulBurstMs );
+
+            if( xConfig.ulLockMask == 0 )
+            {
+                ( void ) xCLIWriterAppendString( &xWriter, "-" );
+            }
+
+            ulLocksLeft = xConfig.ulLockMask;
+
+            for( ux = 0; ux < workloadMAX_LOCKS; ux++ )
+            {
+                if( ( ulLocksLeft & ( 1UL << ux ) ) != 0 )
+                {
+                    ulLocksLeft &= ~( 1UL << ux );
+                    ( void ) xCLIWriterAppendUnsigned( &xWriter, ( uint32_t ) ux );
+
+                    if( ulLocksLeft != 0 )
+                    {
+                        ( void ) xCLIWriterAppendString( &xWriter, "," );
+                    }
+                }
+            }
+
+            ( void ) xCLIWriterPrintf( &xWriter, " hold %u output %u\r\n"
+                                                 " Jobs %u, missed %u, response mean %u p50 %u p99 %u max %u us\r\n",
+                                       ( unsigned ) xConfig.ulHoldMs,
+                                       ( unsigned ) xConfig.ulOutputChars,
+                                       ( unsigned ) xStats.xPeriodic.xResponseTime.ulCount,
+                                       ( unsigned ) xStats.xPeriodic.ulMisses,
+                                       ( unsigned ) ulLogHistogramMean( &( xStats.xPeriodic.xResponseTime ) ),
+                                       ( unsigned ) ulLogHistogramPercentile( &( xStats.xPeriodic.xResponseTime ), 500 ),
+                                       ( unsigned ) ulLogHistogramPercentile( &( xStats.xPeriodic.xResponseTime ), 990 ),
+                                       ( unsigned ) xStats.xPeriodic.xResponseTime.ulMax );
+
+            if( xConfig.ulLockMask != 0 )
+            {
+                ( void ) xCLIWriterPrintf( &xWriter, " Blocked mean %u p50 %u p99 %u max %u us\r\n",
+                                           ( unsigned ) ulLogHistogramMean( &( xStats.xBlockingTime ) ),
+                                           ( unsigned ) ulLogHistogramPercentile( &( xStats.xBlockingTime ), 500 ),
+                                           ( unsigned ) ulLogHistogramPercentile( &( xStats.xBlockingTime ), 990 ),
+                                           ( unsigned ) xStats.xBlockingTime.ulMax );
+            }
+
+            if( xCLIWriterCommitRow( &xWriter, xRowStart ) == pdFALSE )
+            {
+                /* The task is returned by the next call. */
+                return pdTRUE;
+            }
+
+            xIndex++;
+        }
+
+        /* That was the last row.  Reset the index for the next time the
+         * command is executed. */
+        xIndex = -1;
+        return pdFALSE;
+    }
+
+    pcParameter = ( const char * ) FreeRTOS_CLIGetParameter( pcCommandString, 1, &xParameterStringLength );
+
+    if( ( pcParameter == NULL ) || ( ( xParameterStringLength == ( portBASE_TYPE ) strlen( "show" ) ) && ( strncmp( pcParameter, "show", strlen( "show" ) ) == 0 ) ) )
+    {
+        /* Just the status is returned by this call, the tasks are returned by
+         * subsequent calls. */
+        ( void ) xCLIWriterPrintf( &xWriter, "Workload %s, configured times in ms, measured times in us\r\n", ( xWorkloadIsRunning() != pdFALSE ) ? "running" : "stopped" );
+        xIndex = 0;
+        xReturn = pdTRUE;
+    }
+    else if( ( xParameterStringLength == ( portBASE_TYPE ) strlen( "list" ) ) && ( strncmp( pcParameter, "list", strlen( "list" ) ) == 0 ) )
+    {
+        for( ux = 0; ( pcParameter = pcWorkloadGetScenario( ux, &pcDescription ) ) != NULL; ux++ )
+        {
+            ( void ) xCLIWriterPrintf( &xWriter, " %-12s %s\r\n", pcParameter, pcDescription );
+        }
+    }
+    else if( ( xParameterStringLength == ( portBASE_TYPE ) strlen( "load" ) ) && ( strncmp( pcParameter, "load", strlen( "load" ) ) == 0 ) )
+    {
+        pcParameter = ( const char * ) FreeRTOS_CLIGetParameter( pcCommandString, 2, &xParameterStringLength );
+
+        if( ( pcParameter == NULL ) || ( xParameterStringLength >= ( portBASE_TYPE ) sizeof( cName ) ) )
+        {
+            ( void ) xCLIWriterAppendString( &xWriter, "Enter the name of a scenario - see 'workload list'\r\n" );
+        }
+        else
+        {
+            memcpy( cName, pcParameter, xParameterStringLength );
+            cName[ xParameterStringLength ] = 0x00;
+
+            if( xWorkloadLoadScenario( cName ) == pdPASS )
+            {
+                ( void ) xCLIWriterPrintf( &xWriter, "Loaded %s, use 'workload start' to run it\r\n", cName );
+            }
+            else
+            {
+                ( void ) xCLIWriterPrintf( &xWriter, "Unknown scenario %s - see 'workload list'\r\n", cName );
+            }
+        }
+    }
+    else if( ( xParameterStringLength == ( portBASE_TYPE ) strlen( "start" ) ) && ( strncmp( pcParameter, "start", strlen( "start" ) ) == 0 ) )
+    {
+        vWorkloadStart();
+        ( void ) xCLIWriterAppendString( &xWriter, "Workload started\r\n" );
+    }
+    else if( ( xParameterStringLength == ( portBASE_TYPE ) strlen( "stop" ) ) && ( strncmp( pcParameter, "stop", strlen( "stop" ) ) == 0 ) )
+    {
+        vWorkloadStop();
+        ( void ) xCLIWriterAppendString( &xWriter, "Workload stopped\r\n" );
+    }
+    else if( ( xParameterStringLength == ( portBASE_TYPE ) strlen( "set" ) ) && ( strncmp( pcParameter, "set", strlen( "set" ) ) == 0 ) )
+    {
+        memset( &xConfig, 0x00, sizeof( xConfig ) );
+        xValid = pdTRUE;
+
+        /* Parameters 2 to 9 are the task, priority, period, burst, locks, hold
+         * and optional offset and output.  Only the task and priority are
+         * needed to remove a task. */
+        pcParameter = ( const char * ) FreeRTOS_CLIGetParameter( pcCommandString, 2, &xParameterStringLength );
+        uxTask = ( pcParameter != NULL ) ? ( UBaseType_t ) atol( pcParameter ) : workloadMAX_TASKS;
+
+        pcParameter = ( const char * ) FreeRTOS_CLIGetParameter( pcCommandString, 3, &xParameterStringLength );
+        xConfig.uxPriority = ( pcParameter != NULL ) ? ( UBaseType_t ) atol( pcParameter ) : 0;
+
+        if( pcParameter == NULL )
+        {
+            xValid = pdFALSE;
+        }
+        else if( xConfig.uxPriority != 0 )
+        {
+            pcParameter = ( const char * ) FreeRTOS_CLIGetParameter( pcCommandString, 4, &xParameterStringLength );
+            xConfig.ulPeriodMs = ( pcParameter != NULL ) ? ( uint32_t ) atol( pcParameter ) : 0UL;
+
+            pcParameter = ( const char * ) FreeRTOS_CLIGetParameter( pcCommandString, 5, &xParameterStringLength );
+            xConfig.ulBurstMs = ( pcParameter != NULL ) ? ( uint32_t ) atol( pcParameter ) : 0UL;
+
+            pcLocks = ( const char * ) FreeRTOS_CLIGetParameter( pcCommandString, 6, &xLocksLength );
+
+            pcParameter = ( const char * ) FreeRTOS_CLIGetParameter( pcCommandString, 7, &xParameterStringLength );
+            xConfig.ulHoldMs = ( pcParameter != NULL ) ? ( uint32_t ) atol( pcParameter ) : 0UL;
+
+            if( ( pcParameter == NULL ) || ( prvParseLockList( pcLocks, xLocksLength, &( xConfig.ulLockMask ) ) == pdFALSE ) )
+            {
+                xValid = pdFALSE;
+            }
+
+            pcParameter = ( const char * ) FreeRTOS_CLIGetParameter( pcCommandString, 8, &xParameterStringLength );
+            xConfig.ulOffsetMs = ( pcParameter != NULL ) ? ( uint32_t ) atol( pcParameter ) : 0UL;
+
+            pcParameter = ( const char * ) FreeRTOS_CLIGetParameter( pcCommandString, 9, &xParameterStringLength );
+            xConfig.ulOutputChars = ( pcParameter != NULL ) ? ( uint32_t ) atol( pcParameter ) : 0UL;
+        }
+
+        if( ( xValid != pdFALSE ) && ( xWorkloadSetTask( uxTask, &xConfig ) == pdPASS ) )
+        {
+            ( void ) xCLIWriterPrintf( &xWriter, "WL%u %s\r\n", ( unsigned ) uxTask, ( xConfig.uxPriority != 0 ) ? "set" : "removed" );
+        }
+        else
+        {
+            ( void ) xCLIWriterPrintf( &xWriter, "Expected set <task 0-%u> <priority> <period> <burst> <locks> <hold> [offset [output]],\r\n"
+                                                 " with a priority below %u, a period of at least one tick, locks 0-%u and\r\n"
+                                                 " at most %u output characters\r\n",
+                                       ( unsigned ) ( workloadMAX_TASKS - 1 ),
+                                       ( unsigned ) configMAX_PRIORITIES,
+                                       ( unsigned ) ( workloadMAX_LOCKS - 1 ),
+                                       ( unsigned ) deferredMAX_MESSAGE_LENGTH );
+        }
+    }
+    else
+    {
+        ( void ) xCLIWriterAppendString( &xWriter, "Valid parameters are 'show', 'list', 'load', 'start', 'stop' and 'set'\r\n" );
+    }
+
+    return xReturn;
+}
+/*-----------------------------------------------------------*/
+
+static portBASE_TYPE prvPeriodicStatsCommand( int8_t * pcWriteBuffer,
+                                              size_t xWriteBufferLen,
+                                              const int8_t * pcCommandString )
+{
+    static UBaseType_t uxIndex = 0;
+    PeriodicTaskStats_t xStats;
+    const int8_t * pcParameter;
+    portBASE_TYPE xParameterStringLength;
+    portBASE_TYPE xReturn;
+    CLIWriter_t xWriter;
+    size_t xRowStart;
+
+    /* Check the write buffer is not NULL. */
+    configASSERT( pcWriteBuffer );
+    vCLIWriterInit( &xWriter, pcWriteBuffer, xWriteBufferLen );
+
+    if( uxIndex == 0 )
+    {
+        pcParameter = ( const int8_t * ) FreeRTOS_CLIGetParameter( pcCommandString, 1, &xParameterStringLength );
+
+        if( pcParameter != NULL )
+        {
+            if( ( xParameterStringLength == ( portBASE_TYPE ) strlen( "reset" ) ) && ( strncmp( ( const char * ) pcParameter, "reset", strlen( "reset" ) ) == 0 ) )
+            {
+                vPeriodicTaskReset();
+                ( void ) xCLIWriterAppendString( &xWriter, "Periodic task statistics cleared\r\n" );
+            }
+            else
+            {
+                ( void ) xCLIWriterAppendString( &xWriter, "The only valid parameter is 'reset'\r\n" );
+            }
+
+            return pdFALSE;
+        }
+
+        if( uxPeriodicTaskGetCount() == 0 )
+        {
+            ( void ) xCLIWriterAppendString( &xWriter, "There are no periodic tasks\r\n" );
+            return pdFALSE;
+        }
+    }
+
+    /* As many tasks as fit are returned by each call.  Worst case figures are
+     * shown as well as the percentiles, as for a control loop the worst case
+     * is what matters. */
+    while( xPeriodicTaskGetStats( uxIndex, &xStats ) == pdPASS )
+    {
+        xRowStart = xCLIWriterGetMark( &xWriter );
+        ( void ) xCLIWriterPrintf( &xWriter, "%s period %u deadline %u ticks\r\n"
+                                             " Released %u, missed %u, late %u\r\n"
+                                             " Start min %u p50 %u p99 %u max %u\r\n"
+                                             " Response min %u p50 %u p99 %u max %u\r\n",
+                                   pcTaskGetName( xStats.xTask ),
+                                   ( unsigned ) xStats.xPeriod,
+                                   ( unsigned ) xStats.xDeadline,
+                                   ( unsigned ) xStats.ulReleases,
+                                   ( unsigned ) xStats.ulMisses,
+                                   ( unsigned ) xStats.ulLateReleases,
+                                   ( unsigned ) ( ( xStats.xStartLatency.ulCount > 0 ) ? xStats.xStartLatency.ulMin : 0 ),
+                                   ( unsigned ) ulLogHistogramPercentile( &( xStats.xStartLatency ), 500 ),
+                                   ( unsigned ) ulLogHistogramPercentile( &( xStats.xStartLatency ), 990 ),
+                                   ( unsigned ) xStats.xStartLatency.ulMax,
+                                   ( unsigned ) ( ( xStats.xResponseTime.ulCount > 0 ) ? xStats.xResponseTime.ulMin : 0 ),
+                                   ( unsigned ) ulLogHistogramPercentile( &( xStats.xResponseTime ), 500 ),
+                                   ( unsigned ) ulLogHistogramPercentile( &( xStats.xResponseTime ), 990 ),
+                                   ( unsigned ) xStats.xResponseTime.ulMax );
+
+        if( xCLIWriterCommitRow( &xWriter, xRowStart ) == pdFALSE )
+        {
+            /* The task is returned by the next call. */
+            break;
+        }
+
+        uxIndex++;
+    }
+
+    xReturn = ( uxIndex < uxPeriodicTaskGetCount() ) ? pdTRUE : pdFALSE;
+
+    if( xReturn == pdFALSE )
+    {
+        /* Start from the first task the next time the command is executed. */
+        uxIndex = 0;
+    }
+
+    return xReturn;
+}
+/*-----------------------------------------------------------*/
+
+static portBASE_TYPE prvLockModeCommand( int8_t * pcWriteBuffer,
+                                         size_t xWriteBufferLen,
+                                         const int8_t * pcCommandString )
+{
+    const char * pcParameter;
+    portBASE_TYPE xParameterStringLength;
+    DemoLockHandle_t xLock;
+    eDemoLockMode eMode;
+    UBaseType_t ux;
+    CLIWriter_t xWriter;
+
+    /* Check the write buffer is not NULL. */
+    configASSERT( pcWriteBuffer );
+    vCLIWriterInit( &xWriter, pcWriteBuffer, xWriteBufferLen );
+
+    pcParameter = ( const char * ) FreeRTOS_CLIGetParameter( pcCommandString, 1, &xParameterStringLength );
+
+    if( pcParameter != NULL )
+    {
+        eMode = eDemoLockModeFromName( pcParameter, ( size_t ) xParameterStringLength );
+
+        if( eMode == eDemoLockNumberOfModes )
+        {
+            ( void ) xCLIWriterAppendString( &xWriter, "Valid parameters are 'mutex', 'semaphore' and 'ceiling'\r\n" );
+            return pdFALSE;
+        }
+
+        /* Each lock has to be free before its mode can be changed, which can
+         * take a while if a task holds it for a long time. */
+        if( xDemoLockSetAllModes( eMode, pdMS_TO_TICKS( cliLOCK_MODE_TIMEOUT_MS ) ) == pdFAIL )
+        {
+            ( void ) xCLIWriterPrintf( &xWriter, "Some locks were not free for %u ms, so were not changed\r\n", ( unsigned ) cliLOCK_MODE_TIMEOUT_MS );
+        }
+    }
+
+    for( ux = 0; ( xLock = xDemoLockGetLock( ux ) ) != NULL; ux++ )
+    {
+        ( void ) xCLIWriterPrintf( &xWriter, "%-12s %-10s ceiling %u\r\n",
+                                   pcDemoLockGetName( xLock ),
+                                   pcDemoLockModeName( eDemoLockGetMode( xLock ) ),
+                                   ( unsigned ) uxDemoLockGetCeiling( xLock ) );
+    }
+
+    if( ux == 0 )
+    {
+        ( void ) xCLIWriterAppendString( &xWriter, "There are no locks\r\n" );
+    }
+
+    return pdFALSE;
+}
+/*-----------------------------------------------------------*/
+
+static portBASE_TYPE prvLockCompareCommand( int8_t * pcWriteBuffer,
+                                            size_t xWriteBufferLen,
+                                            const int8_t * pcCommandString )
+{
+    /* Static as each holds several histograms. */
+    static WorkloadTaskStats_t xResults[ eDemoLockNumberOfModes ];
+    static WorkloadTaskStats_t xStats;
+    const char * pcParameter;
+    portBASE_TYPE xParameterStringLength;
+    WorkloadTaskConfig_t xConfig;
+    UBaseType_t ux, uxTask = workloadMAX_TASKS, uxPriority = 0;
+    uint32_t ulSeconds = cliLOCK_COMPARE_DEFAULT_SECONDS, ulModeSeconds;
+    eDemoLockMode eMode, eOriginalMode;
+    BaseType_t xWasRunning, xModeSet[ eDemoLockNumberOfModes ];
+    CLIWriter_t xWriter;
+
+    /* Check the write buffer is not NULL. */
+    configASSERT( pcWriteBuffer );
+    vCLIWriterInit( &xWriter, pcWriteBuffer, xWriteBufferLen );
+
+    pcParameter = ( const char * ) FreeRTOS_CLIGetParameter( pcCommandString, 1, &xParameterStringLength );
+
+    if( pcParameter != NULL )
+    {
+        ulSeconds = ( uint32_t ) atol( pcParameter );
+
+        if( ( ulSeconds < ( uint32_t ) eDemoLockNumberOfModes ) || ( ulSeconds > cliLOCK_COMPARE_MAX_SECONDS ) )
+        {
+            ( void ) xCLIWriterPrintf( &xWriter, "The time must be from %u to %u seconds\r\n", ( unsigned ) eDemoLockNumberOfModes, ( unsigned ) cliLOCK_COMPARE_MAX_SECONDS );
+            return pdFALSE;
+        }
+    }
+
+    /* Compare the blocking time of the highest priority worker that uses
+     * locks, which is the one priority inversion hurts. */
+    for( ux = 0; xWorkloadGetTask( ux, &xConfig, &xStats ) != pdFALSE; ux++ )
+    {
+        if( ( xConfig.ulLockMask != 0 ) && ( xConfig.uxPriority > uxPriority ) )
+        {
+            uxPriority = xConfig.uxPriority;
+            uxTask = ux;
+        }
+    }
+
+    if( ( uxTask == workloadMAX_TASKS ) || ( xDemoLockGetLock( 0 ) == NULL ) )
+    {
+        ( void ) xCLIWriterAppendString( &xWriter, "No worker uses a lock - load a workload that does, for example 'inversion'\r\n" );
+        return pdFALSE;
+    }
+
+    ulModeSeconds = ulSeconds / ( uint32_t ) eDemoLockNumberOfModes;
+    xWasRunning = xWorkloadIsRunning();
+    eOriginalMode = eDemoLockGetMode( xDemoLockGetLock( 0 ) );
+
+    for( eMode = eDemoLockMutex; eMode < eDemoLockNumberOfModes; eMode++ )
+    {
+        /* Restarting the workload clears the results, so each mode starts
+         * from the same point. */
+        xModeSet[ eMode ] = xDemoLockSetAllModes( eMode, pdMS_TO_TICKS( cliLOCK_MODE_TIMEOUT_MS ) );
+
+        if( xModeSet[ eMode ] != pdFAIL )
+        {
+            vWorkloadStart();
+            vTaskDelay( pdMS_TO_TICKS( ulModeSeconds * 1000UL ) );
+            ( void ) xWorkloadGetTask( uxTask, &xConfig, &( xResults[ eMode ] ) );
+        }
+    }
+
+    /* Leave the locks and the workload as they were found. */
+    ( void ) xDemoLockSetAllModes( eOriginalMode, pdMS_TO_TICKS( cliLOCK_MODE_TIMEOUT_MS ) );
+
+    if( xWasRunning != pdFALSE )
+    {
+        vWorkloadStart();
+    }
+    else
+    {
+        vWorkloadStop();
+    }
+
+    ( void ) xCLIWriterPrintf( &xWriter, "WL%u (priority %u) blocking time over %u s per mode, in us\r\n"
+                                         "Mode        Jobs  Missed  p50       p99       max\r\n",
+                               ( unsigned ) uxTask,
+                               ( unsigned ) uxPriority,
+                               ( unsigned ) ulModeSeconds );
+
+    for( eMode = eDemoLockMutex; eMode < eDemoLockNumberOfModes; eMode++ )
+    {
+        if( xModeSet[ eMode ] == pdFAIL )
+        {
+            ( void ) xCLIWriterPrintf( &xWriter, "%-10s  the locks were not free, so the mode was not run\r\n", pcDemoLockModeName( eMode ) );
+        }
+        else
+        {
+            ( void ) xCLIWriterPrintf( &xWriter, "%-10s  %-4u  %-6u  %-8u  %-8u  %u\r\n",
+                                       pcDemoLockModeName( eMode ),
+                                       ( unsigned ) xResults[ eMode ].xPeriodic.xResponseTime.ulCount,
+                                       ( unsigned ) xResults[ eMode ].xPeriodic.ulMisses,
+                                       ( unsigned ) ulLogHistogramPercentile( &( xResults[ eMode ].xBlockingTime ), 500 ),
+                                       ( unsigned ) ulLogHistogramPercentile( &( xResults[ eMode ].xBlockingTime ), 990 ),
+                                       ( unsigned ) xResults[ eMode ].xBlockingTime.ulMax );
+        }
+    }
+
+    return pdFALSE;
+}
+/*-----------------------------------------------------------*/
+
+static portBASE_TYPE prvOutputModeCommand( int8_t * pcWriteBuffer,
+                                           size_t xWriteBufferLen,
+                                           const int8_t * pcCommandString )
+{
+    const char * pcParameter;
+    portBASE_TYPE xParameterStringLength;
+    DeferredOutputStats_t xStats;
+    CLIWriter_t xWriter;
+
+    /* Check the write buffer is not NULL. */
+    configASSERT( pcWriteBuffer );
+    vCLIWriterInit( &xWriter, pcWriteBuffer, xWriteBufferLen );
+
+    if( xDeferredOutputIsStarted() == pdFALSE )
+    {
+        ( void ) xCLIWriterAppendString( &xWriter, "Deferred output is not in use - the output task has not been started\r\n" );
+        return pdFALSE;
+    }
+
+    pcParameter = ( const char * ) FreeRTOS_CLIGetParameter( pcCommandString, 1, &xParameterStringLength );
+
+    if( pcParameter != NULL )
+    {
+        if( ( xParameterStringLength == ( portBASE_TYPE ) strlen( "direct" ) ) && ( strncmp( pcParameter, "direct", strlen( "direct" ) ) == 0 ) )
+        {
+            vDeferredOutputSetEnabled( pdFALSE );
+        }
+        else if( ( xParameterStringLength == ( portBASE_TYPE ) strlen( "deferred" ) ) && ( strncmp( pcParameter, "deferred", strlen( "deferred" ) ) == 0 ) )
+        {
+            vDeferredOutputSetEnabled( pdTRUE );
+        }
+        else
+        {
+            ( void ) xCLIWriterAppendString( &xWriter, "Valid parameters are 'direct' and 'deferred'\r\n" );
+            return pdFALSE;
+        }
+    }
+
+    vDeferredOutputGetStats( &xStats );
+    ( void ) xCLIWriterPrintf( &xWriter, "Output is %s\r\n"
+                                         "Messages written %u, dropped %u, output %u, most bytes waiting %u of %u\r\n",
+                               ( xDeferredOutputIsEnabled() != pdFALSE ) ? "deferred" : "direct",
+                               ( unsigned ) xStats.ulWritten,
+                               ( unsigned ) xStats.ulDropped,
+                               ( unsigned ) xStats.ulOutput,
+                               ( unsigned ) xStats.xMaxBytesWaiting,
+                               ( unsigned ) deferredBUFFER_BYTES );
+
+    return pdFALSE;
+}
+/*-----------------------------------------------------------*/
+
+static BaseType_t prvParseLockList( const char * pcList,
+                                    portBASE_TYPE xLength,
+                                    uint32_t * pulMask )
+{
+    portBASE_TYPE x;
+    uint32_t ulLock = 0;
+    BaseType_t xHaveDigit = pdFALSE;
+
+    *pulMask = 0;
+
+    if( pcList == NULL )
+    {
+        return pdFALSE;
+    }
+
+    if( ( xLength == 1 ) && ( pcList[ 0 ] == '-' ) )
+    {
+        return pdTRUE;
+    }
+
+    /* One extra pass past the end of the list adds the last lock. */
+    for( x = 0; x <= xLength; x++ )
+    {
+        if( ( x < xLength ) && ( pcList[ x ] >= '0' ) && ( pcList[ x ] <= '9' ) )
+        {
+            ulLock = ( ulLock * 10UL ) + ( uint32_t ) ( pcList[ x ] - '0' );
+            xHaveDigit = pdTRUE;
+
+            if( ulLock >= workloadMAX_LOCKS )
+            {
+                return pdFALSE;
+            }
+        }
+        else if( ( xHaveDigit != pdFALSE ) && ( ( x == xLength ) || ( pcList[ x ] == ',' ) ) )
+        {
+            *pulMask |= ( 1UL << ulLock );
+            ulLock = 0;
+            xHaveDigit = pdFALSE;
+        }
+        else
+        {
+            return pdFALSE;
+        }
+    }
+
+    return pdTRUE;
+}
+/*-----------------------------------------------------------*/
+
 #if configINCLUDE_TRACE_RELATED_CLI_COMMANDS == 1
 
     static portBASE_TYPE prvStartStopTraceCommand( int8_t * pcWriteBuffer,
@@ -631,13 +2863,13 @@ static portBASE_TYPE prvDisplayIPConfig( int8_t * pcWriteBuffer,
     {
         int8_t * pcParameter;
         portBASE_TYPE lParameterStringLength;
+        CLIWriter_t xWriter;
 
         /* Remove compile time warnings about unused parameters, and check the
-         * write buffer is not NULL.  NOTE - for simplicity, this example assumes the
-         * write buffer length is adequate, so does not check for buffer overflows. */
+         * write buffer is not NULL. */
         ( void ) pcCommandString;
-        ( void ) xWriteBufferLen;
         configASSERT( pcWriteBuffer );
+        vCLIWriterInit( &xWriter, pcWriteBuffer, xWriteBufferLen );
 
         /* Obtain the parameter string. */
         pcParameter = ( int8_t * ) FreeRTOS_CLIGetParameter
@@ -658,17 +2890,17 @@ static portBASE_TYPE prvDisplayIPConfig( int8_t * pcWriteBuffer,
             vTraceClear();
             vTraceStart();
 
-            sprintf( ( char * ) pcWriteBuffer, "Trace recording (re)started.\r\n" );
+            ( void ) xCLIWriterAppendString( &xWriter, "Trace recording (re)started.\r\n" );
         }
         else if( strncmp( ( const char * ) pcParameter, "stop", strlen( "stop" ) ) == 0 )
         {
             /* End the trace, if one is running. */
             vTraceStop();
-            sprintf( ( char * ) pcWriteBuffer, "Stopping trace recording.\r\n" );
+            ( void ) xCLIWriterAppendString( &xWriter, "Stopping trace recording.\r\n" );
         }
         else
         {
-            sprintf( ( char * ) pcWriteBuffer, "Valid parameters are 'start' and 'stop'.\r\n" );
+            ( void ) xCLIWriterAppendString( &xWriter, "Valid parameters are 'start' and 'stop'.\r\n" );
         }
 
         /* There is no more data to return after this single string, so return
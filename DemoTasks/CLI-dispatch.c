@@ -0,0 +1,399 @@
+/*
+ * FreeRTOS V202411.00
+ * Copyright (C) 2020 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * https://www.FreeRTOS.org
+ * https://github.com/FreeRTOS
+ *
+ */
+
+/*
+ * FreeRTOS+CLI keeps registered commands in a linked list and compares every
+ * input line against each entry in turn.  The functions in this file keep an
+ * additional index of the registered commands, sorted by command string, that
+ * is searched with a binary search - so locating a command takes O(log n)
+ * string comparisons however many commands are registered.  The index is
+ * built once, as the commands are registered, and the command callbacks are
+ * called exactly as FreeRTOS+CLI would call them.  The index also records the
+ * cost class of each command, along with the mutex that serialises the
+ * execution of each heavy command.  The light commands share a single mutex,
+ * so a light command that returns its output over several calls can not be
+ * interleaved with itself when it is executed from more than one task.  The
+ * commands left to FreeRTOS+CLI, such as "help", have a mutex of their own, so
+ * they do not hold up the light commands.
+ */
+
+/* Standard includes. */
+#include <stdint.h>
+#include <string.h>
+
+/* FreeRTOS includes. */
+#include "FreeRTOS.h"
+#include "task.h"
+#include "queue.h"
+#include "semphr.h"
+
+/* FreeRTOS+CLI includes. */
+#include "FreeRTOS_CLI.h"
+
+/* Demo app includes. */
+#include "DemoStatic.h"
+#include "CLIDispatch.h"
+
+/* The maximum number of commands that can be held in the index.  Commands
+ * registered after the index is full are still registered with FreeRTOS+CLI,
+ * so still work, but are found by FreeRTOS+CLI's linear search. */
+#ifndef cliMAX_INDEXED_COMMANDS
+    #define cliMAX_INDEXED_COMMANDS    32
+#endif
+
+/* An entry in the dispatch index. */
+typedef struct xCLI_INDEX_ENTRY
+{
+    const CLI_Command_Definition_t * pxCommand; /* The registered command. */
+    size_t xCommandLength;                      /* strlen() of the command string, calculated once at registration. */
+    BaseType_t xCostClass;                      /* cliCOST_LIGHT or cliCOST_HEAVY. */
+    SemaphoreHandle_t xLock;                    /* Held while the command executes, shared by the light commands. */
+} CLIIndexEntry_t;
+
+/*
+ * Compare the first xWordLength characters of pcWord with the command string
+ * of pxEntry, returning a value less than, equal to, or greater than zero in
+ * the same way as strcmp().
+ */
+static int prvCompareCommand( const char * pcWord,
+                              size_t xWordLength,
+                              const CLIIndexEntry_t * pxEntry );
+
+/*
+ * Return the number of space separated parameters that follow the command in
+ * pcCommandString, counted the same way as FreeRTOS+CLI counts them.
+ */
+static int8_t prvGetNumberOfParameters( const char * pcCommandString );
+
+/*
+ * Binary search the index for the command at the start of pcInput, returning
+ * NULL if it is not in the index.
+ */
+static const CLIIndexEntry_t * prvFindCommand( const char * pcInput );
+
+/*-----------------------------------------------------------*/
+
+/* The index, kept sorted by command string. */
+static CLIIndexEntry_t xCommandIndex[ cliMAX_INDEXED_COMMANDS ];
+static UBaseType_t uxIndexedCommands = 0;
+
+/* Held while a light command executes, and while a command is executed by
+ * FreeRTOS+CLI itself.  Created when the first command is registered. */
+static SemaphoreHandle_t xLightLock = NULL;
+static SemaphoreHandle_t xFallbackLock = NULL;
+
+/*-----------------------------------------------------------*/
+
+portBASE_TYPE xCLIDispatchRegisterCommand( const CLI_Command_Definition_t * const pxCommandToRegister )
+{
+    return xCLIDispatchRegisterCommandWithCost( pxCommandToRegister, cliCOST_LIGHT );
+}
+/*-----------------------------------------------------------*/
+
+portBASE_TYPE xCLIDispatchRegisterCommandWithCost( const CLI_Command_Definition_t * const pxCommandToRegister,
+                                                   BaseType_t xCostClass )
+{
+    portBASE_TYPE xReturn;
+    const char * pcCommand;
+    size_t xLength;
+    UBaseType_t uxPosition;
+
+    configASSERT( pxCommandToRegister );
+
+    if( xLightLock == NULL )
+    {
+        /* If the mutexes cannot be created the commands still work, but must
+         * not be executed by two tasks at once. */
+        xLightLock = xDemoSemaphoreCreateMutex();
+        xFallbackLock = xDemoSemaphoreCreateMutex();
+    }
+
+    /* FreeRTOS+CLI still owns the command, so it is listed by "help". */
+    xReturn = FreeRTOS_CLIRegisterCommand( pxCommandToRegister );
+
+    if( ( xReturn != pdFAIL ) && ( uxIndexedCommands < cliMAX_INDEXED_COMMANDS ) )
+    {
+        pcCommand = ( const char * ) pxCommandToRegister->pcCommand;
+        xLength = strlen( pcCommand );
+
+        /* Find where the command belongs in the sorted index, moving each
+         * entry that sorts after it up by one position.  This is only done at
+         * registration time. */
+        uxPosition = uxIndexedCommands;
+
+        while( ( uxPosition > 0 ) && ( prvCompareCommand( pcCommand, xLength, &( xCommandIndex[ uxPosition - 1 ] ) ) < 0 ) )
+        {
+            xCommandIndex[ uxPosition ] = xCommandIndex[ uxPosition - 1 ];
+            uxPosition--;
+        }
+
+        xCommandIndex[ uxPosition ].pxCommand = pxCommandToRegister;
+        xCommandIndex[ uxPosition ].xCommandLength = xLength;
+        xCommandIndex[ uxPosition ].xCostClass = xCostClass;
+        xCommandIndex[ uxPosition ].xLock = xLightLock;
+
+        if( xCostClass == cliCOST_HEAVY )
+        {
+            /* Each heavy command has its own mutex, so a heavy command that
+             * blocks only holds up other executions of the same command. */
+            xCommandIndex[ uxPosition ].xLock = xDemoSemaphoreCreateMutex();
+        }
+
+        uxIndexedCommands++;
+    }
+
+    return xReturn;
+}
+/*-----------------------------------------------------------*/
+
+void vCLIDispatchInitContext( CLIDispatchContext_t * pxContext )
+{
+    configASSERT( pxContext );
+
+    pxContext->pxActiveCommand = NULL;
+    pxContext->xInFallback = pdFALSE;
+    pxContext->xHeldLock = NULL;
+}
+/*-----------------------------------------------------------*/
+
+BaseType_t xCLIDispatchGetCostClass( const int8_t * const pcCommandInput )
+{
+    const CLIIndexEntry_t * pxEntry = prvFindCommand( ( const char * ) pcCommandInput );
+
+    return ( pxEntry != NULL ) ? pxEntry->xCostClass : cliCOST_LIGHT;
+}
+/*-----------------------------------------------------------*/
+
+portBASE_TYPE xCLIDispatchProcessCommand( CLIDispatchContext_t * pxContext,
+                                          const int8_t * const pcCommandInput,
+                                          int8_t * pcWriteBuffer,
+                                          size_t xWriteBufferLen )
+{
+    const char * pcInput = ( const char * ) pcCommandInput;
+    const CLIIndexEntry_t * pxEntry;
+    int8_t cExpectedParameters;
+    SemaphoreHandle_t xLock;
+    TickType_t xTicksToWait;
+    portBASE_TYPE xReturn;
+
+    configASSERT( pxContext );
+    configASSERT( pcWriteBuffer );
+
+    if( ( pxContext->pxActiveCommand == NULL ) && ( pxContext->xInFallback == pdFALSE ) )
+    {
+        /* This is a new command. */
+        pxEntry = prvFindCommand( pcInput );
+
+        if( pxEntry != NULL )
+        {
+            /* Check the expected number of parameters, if the command has
+             * declared how many it expects. */
+            cExpectedParameters = pxEntry->pxCommand->cExpectedNumberOfParameters;
+
+            if( ( cExpectedParameters >= 0 ) && ( prvGetNumberOfParameters( pcInput ) != cExpectedParameters ) )
+            {
+                strncpy( ( char * ) pcWriteBuffer, "Incorrect command parameter(s).  Enter \"help\" to view a list of available commands.\r\n\r\n", xWriteBufferLen );
+                return pdFALSE;
+            }
+
+            xLock = pxEntry->xLock;
+        }
+        else
+        {
+            /* Not in the index, maybe it is "help" or an unknown command, so
+             * it is left to FreeRTOS+CLI.  "help" keeps its position in the
+             * command list between calls, so is serialised by a lock of its
+             * own. */
+            xLock = xFallbackLock;
+        }
+
+        if( xLock != NULL )
+        {
+            /* Held until the command has returned all its output.  A task
+             * can not block while the scheduler is suspended, in which case
+             * the command is only executed if the lock is free. */
+            xTicksToWait = ( xTaskGetSchedulerState() == taskSCHEDULER_SUSPENDED ) ? 0 : portMAX_DELAY;
+
+            if( xSemaphoreTake( xLock, xTicksToWait ) != pdPASS )
+            {
+                strncpy( ( char * ) pcWriteBuffer, "The command is being executed by another task, try again later.\r\n", xWriteBufferLen );
+                return pdFALSE;
+            }
+
+            pxContext->xHeldLock = xLock;
+        }
+
+        if( pxEntry != NULL )
+        {
+            pxContext->pxActiveCommand = pxEntry->pxCommand;
+        }
+        else
+        {
+            pxContext->xInFallback = pdTRUE;
+        }
+    }
+
+    if( pxContext->pxActiveCommand != NULL )
+    {
+        xReturn = pxContext->pxActiveCommand->pxCommandInterpreter( pcWriteBuffer, xWriteBufferLen, pcCommandInput );
+
+        if( xReturn == pdFALSE )
+        {
+            pxContext->pxActiveCommand = NULL;
+
+            if( pxContext->xHeldLock != NULL )
+            {
+                xSemaphoreGive( pxContext->xHeldLock );
+                pxContext->xHeldLock = NULL;
+            }
+        }
+    }
+    else
+    {
+        xReturn = FreeRTOS_CLIProcessCommand( pcCommandInput, pcWriteBuffer, xWriteBufferLen );
+
+        if( xReturn == pdFALSE )
+        {
+            pxContext->xInFallback = pdFALSE;
+
+            if( pxContext->xHeldLock != NULL )
+            {
+                xSemaphoreGive( pxContext->xHeldLock );
+                pxContext->xHeldLock = NULL;
+            }
+        }
+    }
+
+    return xReturn;
+}
+/*-----------------------------------------------------------*/
+
+static const CLIIndexEntry_t * prvFindCommand( const char * pcInput )
+{
+    size_t xWordLength = 0;
+    UBaseType_t uxLow, uxHigh, uxMiddle;
+    int lComparison;
+
+    /* The command itself is everything up to the first space. */
+    while( ( pcInput[ xWordLength ] != 0x00 ) && ( pcInput[ xWordLength ] != ' ' ) )
+    {
+        xWordLength++;
+    }
+
+    uxLow = 0;
+    uxHigh = uxIndexedCommands;
+
+    while( uxLow < uxHigh )
+    {
+        uxMiddle = uxLow + ( ( uxHigh - uxLow ) / 2 );
+        lComparison = prvCompareCommand( pcInput, xWordLength, &( xCommandIndex[ uxMiddle ] ) );
+
+        if( lComparison == 0 )
+        {
+            return &( xCommandIndex[ uxMiddle ] );
+        }
+        else if( lComparison < 0 )
+        {
+            uxHigh = uxMiddle;
+        }
+        else
+        {
+            uxLow = uxMiddle + 1;
+        }
+    }
+
+    return NULL;
+}
+/*-----------------------------------------------------------*/
+
+static int prvCompareCommand( const char * pcWord,
+                              size_t xWordLength,
+                              const CLIIndexEntry_t * pxEntry )
+{
+    size_t xLength = xWordLength;
+    int lReturn;
+
+    if( pxEntry->xCommandLength < xLength )
+    {
+        xLength = pxEntry->xCommandLength;
+    }
+
+    lReturn = strncmp( pcWord, ( const char * ) pxEntry->pxCommand->pcCommand, xLength );
+
+    if( lReturn == 0 )
+    {
+        /* One string is a prefix of the other, so the shorter string sorts
+         * first. */
+        if( xWordLength < pxEntry->xCommandLength )
+        {
+            lReturn = -1;
+        }
+        else if( xWordLength > pxEntry->xCommandLength )
+        {
+            lReturn = 1;
+        }
+    }
+
+    return lReturn;
+}
+/*-----------------------------------------------------------*/
+
+static int8_t prvGetNumberOfParameters( const char * pcCommandString )
+{
+    int8_t cParameters = 0;
+    BaseType_t xLastCharacterWasSpace = pdFALSE;
+
+    /* Count the number of space delimited words in pcCommandString. */
+    while( *pcCommandString != 0x00 )
+    {
+        if( ( *pcCommandString ) == ' ' )
+        {
+            if( xLastCharacterWasSpace != pdTRUE )
+            {
+                cParameters++;
+                xLastCharacterWasSpace = pdTRUE;
+            }
+        }
+        else
+        {
+            xLastCharacterWasSpace = pdFALSE;
+        }
+
+        pcCommandString++;
+    }
+
+    /* If the command string ended with spaces, then there will have been too
+     * many parameters counted. */
+    if( xLastCharacterWasSpace == pdTRUE )
+    {
+        cParameters--;
+    }
+
+    /* The value returned is one less than the number of space delimited words,
+     * as the first word should be the command itself. */
+    return cParameters;
+}
+/*-----------------------------------------------------------*/
@@ -0,0 +1,233 @@
+/*
+ * FreeRTOS V202411.00
+ * Copyright (C) 2020 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * https://www.FreeRTOS.org
+ * https://github.com/FreeRTOS
+ *
+ */
+/*
+ * See CLIWriter.h.
+ */
+
+/* Standard includes. */
+#include <stdint.h>
+#include <stdio.h>
+#include <stdarg.h>
+#include <string.h>
+
+/* FreeRTOS includes. */
+#include "FreeRTOS.h"
+
+/* Demo app includes. */
+#include "CLIWriter.h"
+
+/* Enough for the digits of a 32-bit number and a sign. */
+#define cliwriterMAX_NUMBER_LENGTH    11
+
+/*-----------------------------------------------------------*/
+
+void vCLIWriterInit( CLIWriter_t * pxWriter,
+                     int8_t * pcBuffer,
+                     size_t xLength )
+{
+    configASSERT( pxWriter );
+    configASSERT( pcBuffer );
+    configASSERT( xLength > 0 );
+
+    pxWriter->pcBuffer = ( char * ) pcBuffer;
+    pxWriter->xLength = xLength;
+    pxWriter->xUsed = 0;
+    pxWriter->xTruncated = pdFALSE;
+    pxWriter->pcBuffer[ 0 ] = 0x00;
+}
+/*-----------------------------------------------------------*/
+
+BaseType_t xCLIWriterAppendString( CLIWriter_t * pxWriter,
+                                   const char * pcString )
+{
+    return xCLIWriterAppendStringN( pxWriter, pcString, strlen( pcString ) );
+}
+/*-----------------------------------------------------------*/
+
+BaseType_t xCLIWriterAppendStringN( CLIWriter_t * pxWriter,
+                                    const char * pcString,
+                                    size_t xLength )
+{
+    size_t xRemaining = xCLIWriterGetRemaining( pxWriter );
+    BaseType_t xReturn = pdPASS;
+
+    if( xLength > xRemaining )
+    {
+        xLength = xRemaining;
+        pxWriter->xTruncated = pdTRUE;
+        xReturn = pdFAIL;
+    }
+
+    memcpy( &( pxWriter->pcBuffer[ pxWriter->xUsed ] ), pcString, xLength );
+    pxWriter->xUsed += xLength;
+    pxWriter->pcBuffer[ pxWriter->xUsed ] = 0x00;
+
+    return xReturn;
+}
+/*-----------------------------------------------------------*/
+
+BaseType_t xCLIWriterAppendUnsigned( CLIWriter_t * pxWriter,
+                                     uint32_t ulValue )
+{
+    char cDigits[ cliwriterMAX_NUMBER_LENGTH ];
+    size_t x = sizeof( cDigits );
+
+    /* Generate the digits from the least significant end. */
+    do
+    {
+        cDigits[ --x ] = ( char ) ( '0' + ( ulValue % 10UL ) );
+        ulValue /= 10UL;
+    } while( ulValue != 0 );
+
+    return xCLIWriterAppendStringN( pxWriter, &( cDigits[ x ] ), sizeof( cDigits ) - x );
+}
+/*-----------------------------------------------------------*/
+
+BaseType_t xCLIWriterAppendInt( CLIWriter_t * pxWriter,
+                                int32_t lValue )
+{
+    uint32_t ulMagnitude = ( uint32_t ) lValue;
+
+    if( lValue < 0 )
+    {
+        /* Negating the unsigned value also works for the most negative
+         * value. */
+        ulMagnitude = 0UL - ulMagnitude;
+
+        if( xCLIWriterAppendStringN( pxWriter, "-", 1 ) == pdFAIL )
+        {
+            return pdFAIL;
+        }
+    }
+
+    return xCLIWriterAppendUnsigned( pxWriter, ulMagnitude );
+}
+/*-----------------------------------------------------------*/
+
+BaseType_t xCLIWriterAppendIP( CLIWriter_t * pxWriter,
+                               uint32_t ulIPAddress )
+{
+    /* In network byte order the first octet is first in memory whatever the
+     * byte order of the processor. */
+    const uint8_t * pucOctets = ( const uint8_t * ) &ulIPAddress;
+    BaseType_t xReturn = pdPASS;
+    size_t x;
+
+    for( x = 0; ( x < sizeof( ulIPAddress ) ) && ( xReturn == pdPASS ); x++ )
+    {
+        if( x > 0 )
+        {
+            xReturn = xCLIWriterAppendStringN( pxWriter, ".", 1 );
+        }
+
+        if( xReturn == pdPASS )
+        {
+            xReturn = xCLIWriterAppendUnsigned( pxWriter, ( uint32_t ) pucOctets[ x ] );
+        }
+    }
+
+    return xReturn;
+}
+/*-----------------------------------------------------------*/
+
+BaseType_t xCLIWriterPrintf( CLIWriter_t * pxWriter,
+                             const char * pcFormat,
+                             ... )
+{
+    size_t xSpace = pxWriter->xLength - pxWriter->xUsed;
+    va_list xArguments;
+    int iLength;
+
+    va_start( xArguments, pcFormat );
+    iLength = vsnprintf( &( pxWriter->pcBuffer[ pxWriter->xUsed ] ), xSpace, pcFormat, xArguments );
+    va_end( xArguments );
+
+    if( iLength < 0 )
+    {
+        /* An encoding error, so discard whatever was written. */
+        pxWriter->pcBuffer[ pxWriter->xUsed ] = 0x00;
+        pxWriter->xTruncated = pdTRUE;
+        return pdFAIL;
+    }
+
+    if( ( size_t ) iLength >= xSpace )
+    {
+        /* vsnprintf() wrote as much as fits, and terminated it. */
+        pxWriter->xUsed = pxWriter->xLength - 1;
+        pxWriter->xTruncated = pdTRUE;
+        return pdFAIL;
+    }
+
+    pxWriter->xUsed += ( size_t ) iLength;
+
+    return pdPASS;
+}
+/*-----------------------------------------------------------*/
+
+BaseType_t xCLIWriterIsTruncated( const CLIWriter_t * pxWriter )
+{
+    return pxWriter->xTruncated;
+}
+/*-----------------------------------------------------------*/
+
+size_t xCLIWriterGetRemaining( const CLIWriter_t * pxWriter )
+{
+    /* One byte is always kept for the terminator. */
+    return pxWriter->xLength - pxWriter->xUsed - 1;
+}
+/*-----------------------------------------------------------*/
+
+size_t xCLIWriterGetMark( const CLIWriter_t * pxWriter )
+{
+    return pxWriter->xUsed;
+}
+/*-----------------------------------------------------------*/
+
+void vCLIWriterRewind( CLIWriter_t * pxWriter,
+                       size_t xMark )
+{
+    configASSERT( xMark <= pxWriter->xUsed );
+
+    pxWriter->xUsed = xMark;
+    pxWriter->pcBuffer[ xMark ] = 0x00;
+    pxWriter->xTruncated = pdFALSE;
+}
+/*-----------------------------------------------------------*/
+
+BaseType_t xCLIWriterCommitRow( CLIWriter_t * pxWriter,
+                                size_t xRowStart )
+{
+    BaseType_t xReturn = pdTRUE;
+
+    if( ( pxWriter->xTruncated != pdFALSE ) && ( xRowStart > 0 ) )
+    {
+        vCLIWriterRewind( pxWriter, xRowStart );
+        xReturn = pdFALSE;
+    }
+
+    return xReturn;
+}
+/*-----------------------------------------------------------*/
@@ -0,0 +1,158 @@
+/*
+ * FreeRTOS V202411.00
+ * Copyright (C) 2020 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * https://www.FreeRTOS.org
+ * https://github.com/FreeRTOS
+ *
+ */
+
+/*
+ * See ClientSocket.h.
+ */
+
+/* Standard includes. */
+#include <stdint.h>
+
+/* FreeRTOS includes. */
+#include "FreeRTOS.h"
+#include "task.h"
+
+/* FreeRTOS+UDP includes. */
+#include "FreeRTOS_IP.h"
+#include "FreeRTOS_Sockets.h"
+
+/* Demo app includes. */
+#include "ClientSocket.h"
+
+/*
+ * Close the socket, if it is open.
+ */
+static void prvCloseSocket( ClientSocket_t * pxClient );
+
+/*-----------------------------------------------------------*/
+
+void vClientSocketInit( ClientSocket_t * pxClient,
+                        TickType_t xReceiveTimeout )
+{
+    configASSERT( pxClient );
+
+    pxClient->xSocket = FREERTOS_INVALID_SOCKET;
+    pxClient->xReceiveTimeout = xReceiveTimeout;
+    pxClient->xReconnectDelay = pdMS_TO_TICKS( clientsockMIN_RECONNECT_DELAY_MS );
+    pxClient->uxConsecutiveErrors = 0;
+    pxClient->xReplacing = pdFALSE;
+    pxClient->ulOpened = 0;
+}
+/*-----------------------------------------------------------*/
+
+Socket_t xClientSocketOpen( ClientSocket_t * pxClient )
+{
+    TickType_t xMaxDelay = pdMS_TO_TICKS( clientsockMAX_RECONNECT_DELAY_MS );
+
+    if( pxClient->xSocket == FREERTOS_INVALID_SOCKET )
+    {
+        if( pxClient->xReplacing != pdFALSE )
+        {
+            /* The previous socket failed.  Back off before trying again, and
+             * back off for longer next time if this socket fails too. */
+            vTaskDelay( pxClient->xReconnectDelay );
+
+            if( pxClient->xReconnectDelay < ( xMaxDelay / 2 ) )
+            {
+                pxClient->xReconnectDelay *= 2;
+            }
+            else
+            {
+                pxClient->xReconnectDelay = xMaxDelay;
+            }
+        }
+
+        pxClient->xSocket = FreeRTOS_socket( FREERTOS_AF_INET, FREERTOS_SOCK_DGRAM, FREERTOS_IPPROTO_UDP );
+
+        if( pxClient->xSocket != FREERTOS_INVALID_SOCKET )
+        {
+            pxClient->ulOpened++;
+
+            if( pxClient->xReceiveTimeout != 0 )
+            {
+                FreeRTOS_setsockopt( pxClient->xSocket, 0, FREERTOS_SO_RCVTIMEO, &( pxClient->xReceiveTimeout ), sizeof( pxClient->xReceiveTimeout ) );
+            }
+        }
+        else
+        {
+            /* Treat failing to create a socket as an error, so there is a
+             * delay before the next attempt. */
+            pxClient->xReplacing = pdTRUE;
+        }
+    }
+
+    return pxClient->xSocket;
+}
+/*-----------------------------------------------------------*/
+
+void vClientSocketReport( ClientSocket_t * pxClient,
+                          BaseType_t xSuccess )
+{
+    if( xSuccess != pdFALSE )
+    {
+        /* The socket works, so the next failure starts backing off from the
+         * minimum delay again. */
+        pxClient->uxConsecutiveErrors = 0;
+        pxClient->xReplacing = pdFALSE;
+        pxClient->xReconnectDelay = pdMS_TO_TICKS( clientsockMIN_RECONNECT_DELAY_MS );
+    }
+    else
+    {
+        pxClient->uxConsecutiveErrors++;
+
+        if( pxClient->uxConsecutiveErrors >= clientsockMAX_CONSECUTIVE_ERRORS )
+        {
+            prvCloseSocket( pxClient );
+            pxClient->uxConsecutiveErrors = 0;
+            pxClient->xReplacing = pdTRUE;
+        }
+    }
+}
+/*-----------------------------------------------------------*/
+
+void vClientSocketEndOfBatch( ClientSocket_t * pxClient )
+{
+    #if ( clientsockPERSISTENT == 0 )
+    {
+        prvCloseSocket( pxClient );
+    }
+    #else
+    {
+        ( void ) pxClient;
+    }
+    #endif
+}
+/*-----------------------------------------------------------*/
+
+static void prvCloseSocket( ClientSocket_t * pxClient )
+{
+    if( pxClient->xSocket != FREERTOS_INVALID_SOCKET )
+    {
+        FreeRTOS_closesocket( pxClient->xSocket );
+        pxClient->xSocket = FREERTOS_INVALID_SOCKET;
+    }
+}
+/*-----------------------------------------------------------*/
@@ -0,0 +1,173 @@
+/*
+ * FreeRTOS V202411.00
+ * Copyright (C) 2020 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * https://www.FreeRTOS.org
+ * https://github.com/FreeRTOS
+ *
+ */
+
+/*
+ * See ConsoleInput.h.
+ *
+ * The Windows thread must not call the FreeRTOS API, so key presses are first
+ * placed in ucPending[], which only the Windows thread writes to and only the
+ * simulated interrupt handler reads from.  Each side only ever updates its own
+ * index, so no lock is needed between them.  The handler then moves the keys
+ * into the stream buffer, which wakes the receiving task.
+ */
+
+/* Standard includes. */
+#include <stdint.h>
+#include <conio.h>
+
+/* FreeRTOS includes. */
+#include "FreeRTOS.h"
+#include "task.h"
+#include "queue.h"
+#include "semphr.h"
+#include "stream_buffer.h"
+
+/* Demo app includes. */
+#include "DemoStatic.h"
+#include "ConsoleInput.h"
+
+/*
+ * The Windows thread that waits for key presses.
+ */
+static DWORD WINAPI prvKeyboardThread( void * pvParameter );
+
+/*
+ * The simulated interrupt handler that moves key presses from ucPending[] into
+ * the stream buffer.
+ */
+static uint32_t prvConsoleInputInterruptHandler( void );
+
+/*-----------------------------------------------------------*/
+
+static StreamBufferHandle_t xKeyBuffer = NULL;
+
+/* Keys read by the Windows thread that the interrupt handler has not yet moved
+ * into the stream buffer.  ulPendingHead is only written by the Windows thread
+ * and ulPendingTail only by the interrupt handler. */
+static uint8_t ucPending[ consoleINPUT_BUFFER_BYTES ];
+static volatile uint32_t ulPendingHead = 0, ulPendingTail = 0;
+
+/* Keys dropped by the Windows thread and by the interrupt handler
+ * respectively, kept apart as each is only written by one side. */
+static volatile uint32_t ulPendingDropped = 0, ulBufferDropped = 0;
+
+/*-----------------------------------------------------------*/
+
+void vConsoleInputStart( void )
+{
+    HANDLE xThread;
+
+    configASSERT( xKeyBuffer == NULL );
+
+    #if ( demoSTATIC_ALLOCATION == 1 )
+    {
+        /* One byte more than the capacity, see xStreamBufferCreateStatic(). */
+        static uint8_t ucStorage[ consoleINPUT_BUFFER_BYTES + 1 ];
+        static StaticStreamBuffer_t xStreamBuffer;
+
+        xKeyBuffer = xStreamBufferCreateStatic( sizeof( ucStorage ), 1, ucStorage, &xStreamBuffer );
+    }
+    #else
+    {
+        xKeyBuffer = xStreamBufferCreate( consoleINPUT_BUFFER_BYTES, 1 );
+    }
+    #endif
+    configASSERT( xKeyBuffer );
+
+    vPortSetInterruptHandler( consoleINPUT_INTERRUPT_NUMBER, prvConsoleInputInterruptHandler );
+
+    /* The thread spends almost all its time blocked in _getch(). */
+    xThread = CreateThread( NULL, 0, prvKeyboardThread, NULL, 0, NULL );
+    configASSERT( xThread );
+    SetThreadPriority( xThread, THREAD_PRIORITY_BELOW_NORMAL );
+}
+/*-----------------------------------------------------------*/
+
+BaseType_t xConsoleInputReceive( char * pcKey,
+                                 TickType_t xTicksToWait )
+{
+    configASSERT( pcKey );
+    configASSERT( xKeyBuffer );
+
+    return ( xStreamBufferReceive( xKeyBuffer, pcKey, sizeof( char ), xTicksToWait ) == sizeof( char ) ) ? pdTRUE : pdFALSE;
+}
+/*-----------------------------------------------------------*/
+
+uint32_t ulConsoleInputGetDropped( void )
+{
+    return ulPendingDropped + ulBufferDropped;
+}
+/*-----------------------------------------------------------*/
+
+static DWORD WINAPI prvKeyboardThread( void * pvParameter )
+{
+    int iKey;
+
+    ( void ) pvParameter;
+
+    for( ; ; )
+    {
+        iKey = _getch();
+
+        if( ( ulPendingHead - ulPendingTail ) < consoleINPUT_BUFFER_BYTES )
+        {
+            ucPending[ ulPendingHead % consoleINPUT_BUFFER_BYTES ] = ( uint8_t ) iKey;
+            ulPendingHead++;
+        }
+        else
+        {
+            ulPendingDropped++;
+        }
+
+        vPortGenerateSimulatedInterruptFromWindowsThread( consoleINPUT_INTERRUPT_NUMBER );
+    }
+
+    return 0;
+}
+/*-----------------------------------------------------------*/
+
+static uint32_t prvConsoleInputInterruptHandler( void )
+{
+    BaseType_t xHigherPriorityTaskWoken = pdFALSE;
+    uint8_t ucKey;
+
+    while( ulPendingTail != ulPendingHead )
+    {
+        ucKey = ucPending[ ulPendingTail % consoleINPUT_BUFFER_BYTES ];
+
+        if( xStreamBufferSendFromISR( xKeyBuffer, &ucKey, sizeof( ucKey ), &xHigherPriorityTaskWoken ) == 0 )
+        {
+            ulBufferDropped++;
+        }
+
+        ulPendingTail++;
+    }
+
+    /* A non-zero return value requests a context switch on exit from the
+     * simulated interrupt. */
+    return ( uint32_t ) xHigherPriorityTaskWoken;
+}
+/*-----------------------------------------------------------*/
@@ -0,0 +1,181 @@
+/*
+ * FreeRTOS V202411.00
+ * Copyright (C) 2020 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * https://www.FreeRTOS.org
+ * https://github.com/FreeRTOS
+ *
+ */
+/*
+ * See CoreStats.h.
+ *
+ * The samples are written by the tick interrupt and read by tasks that could
+ * be running on another core, so both sides use a critical section, which on
+ * an SMP kernel also excludes the other cores.
+ */
+
+/* Standard includes. */
+#include <stdint.h>
+#include <string.h>
+
+/* FreeRTOS includes. */
+#include "FreeRTOS.h"
+#include "task.h"
+
+/* Demo app includes. */
+#include "CoreStats.h"
+
+/* Set to 1 if the kernel can restrict tasks to a subset of the cores. */
+#if defined( configNUMBER_OF_CORES ) && ( configNUMBER_OF_CORES > 1 ) && ( configUSE_CORE_AFFINITY == 1 )
+    #define corestatsAFFINITY_SUPPORTED    1
+#else
+    #define corestatsAFFINITY_SUPPORTED    0
+#endif
+
+/*-----------------------------------------------------------*/
+
+static CoreStatsTask_t xTasks[ corestatsMAX_TASKS ];
+static UBaseType_t uxTasks = 0;
+static uint32_t ulTicks = 0;
+
+/*-----------------------------------------------------------*/
+
+void vCoreStatsTickHook( void )
+{
+    UBaseType_t uxSavedInterruptStatus, uxCore, ux;
+    TaskHandle_t xTask;
+
+    uxSavedInterruptStatus = taskENTER_CRITICAL_FROM_ISR();
+    {
+        ulTicks++;
+
+        for( uxCore = 0; uxCore < corestatsNUMBER_OF_CORES; uxCore++ )
+        {
+            #if ( corestatsNUMBER_OF_CORES > 1 )
+            {
+                xTask = xTaskGetCurrentTaskHandleForCore( ( BaseType_t ) uxCore );
+            }
+            #else
+            {
+                xTask = xTaskGetCurrentTaskHandle();
+            }
+            #endif
+
+            /* There are only a few tasks, so a linear search is fast enough
+             * to do on every tick. */
+            for( ux = 0; ux < uxTasks; ux++ )
+            {
+                if( xTasks[ ux ].xTask == xTask )
+                {
+                    break;
+                }
+            }
+
+            if( ux == uxTasks )
+            {
+                if( uxTasks == corestatsMAX_TASKS )
+                {
+                    /* Only counted in ulTicks. */
+                    continue;
+                }
+
+                memset( &( xTasks[ ux ] ), 0x00, sizeof( xTasks[ ux ] ) );
+                xTasks[ ux ].xTask = xTask;
+                strncpy( xTasks[ ux ].cName, pcTaskGetName( xTask ), sizeof( xTasks[ ux ].cName ) - 1 );
+                uxTasks++;
+            }
+
+            xTasks[ ux ].ulSamples[ uxCore ]++;
+        }
+    }
+    taskEXIT_CRITICAL_FROM_ISR( uxSavedInterruptStatus );
+}
+/*-----------------------------------------------------------*/
+
+UBaseType_t uxCoreStatsGetTasks( CoreStatsTask_t * pxTaskArray,
+                                 UBaseType_t uxMaxTasks,
+                                 uint32_t * pulTicks )
+{
+    UBaseType_t uxCopied;
+
+    configASSERT( pxTaskArray );
+    configASSERT( pulTicks );
+
+    taskENTER_CRITICAL();
+    {
+        uxCopied = ( uxTasks < uxMaxTasks ) ? uxTasks : uxMaxTasks;
+        memcpy( pxTaskArray, xTasks, uxCopied * sizeof( CoreStatsTask_t ) );
+        *pulTicks = ulTicks;
+    }
+    taskEXIT_CRITICAL();
+
+    return uxCopied;
+}
+/*-----------------------------------------------------------*/
+
+void vCoreStatsReset( void )
+{
+    taskENTER_CRITICAL();
+    {
+        uxTasks = 0;
+        ulTicks = 0;
+    }
+    taskEXIT_CRITICAL();
+}
+/*-----------------------------------------------------------*/
+
+BaseType_t xCoreStatsSetAffinity( TaskHandle_t xTask,
+                                  UBaseType_t uxCoreMask )
+{
+    BaseType_t xReturn = pdFAIL;
+
+    #if ( corestatsAFFINITY_SUPPORTED == 1 )
+    {
+        if( ( uxCoreMask & corestatsALL_CORES ) != 0 )
+        {
+            vTaskCoreAffinitySet( xTask, uxCoreMask & corestatsALL_CORES );
+            xReturn = pdPASS;
+        }
+    }
+    #else
+    {
+        ( void ) xTask;
+        ( void ) uxCoreMask;
+    }
+    #endif
+
+    return xReturn;
+}
+/*-----------------------------------------------------------*/
+
+UBaseType_t uxCoreStatsGetAffinity( TaskHandle_t xTask )
+{
+    #if ( corestatsAFFINITY_SUPPORTED == 1 )
+    {
+        return vTaskCoreAffinityGet( xTask ) & corestatsALL_CORES;
+    }
+    #else
+    {
+        ( void ) xTask;
+        return corestatsALL_CORES;
+    }
+    #endif
+}
+/*-----------------------------------------------------------*/
@@ -0,0 +1,320 @@
+/*
+ * FreeRTOS V202411.00
+ * Copyright (C) 2020 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * https://www.FreeRTOS.org
+ * https://github.com/FreeRTOS
+ *
+ */
+
+/*
+ * See DNSCache.h.
+ *
+ * The cache is only searched and updated inside short critical sections.  A
+ * name that is not in the cache is resolved outside of any critical section,
+ * so a slow DNS request does not hold up other users of the cache.
+ */
+
+/* Standard includes. */
+#include <stdint.h>
+#include <string.h>
+
+/* FreeRTOS includes. */
+#include "FreeRTOS.h"
+#include "task.h"
+
+/* FreeRTOS+UDP includes. */
+#include "FreeRTOS_IP.h"
+#include "FreeRTOS_Sockets.h"
+
+/* Demo app includes. */
+#include "DNSCache.h"
+
+/* The time for which an entry is valid, in ticks. */
+#define dnscacheTTL_TICKS    pdMS_TO_TICKS( dnscacheTTL_SECONDS * 1000UL )
+
+/* An entry in the cache. */
+typedef struct xDNS_CACHE_ENTRY
+{
+    BaseType_t xInUse;                     /* pdTRUE if the entry holds a name. */
+    char cName[ dnscacheMAX_NAME_LENGTH ]; /* The host name. */
+    uint32_t ulIPAddress;                  /* The address the name resolved to. */
+    TickType_t xResolved;                  /* The time at which the name was resolved. */
+    uint32_t ulLastUsed;                   /* The value of ulUseCount when the entry was last used. */
+    uint32_t ulHits;                       /* The number of lookups answered by the entry. */
+} DNSCacheEntry_t;
+
+/*
+ * Search the cache for pcName, writing its address to pulIPAddress and
+ * returning pdTRUE if it is present and has not expired.
+ */
+static BaseType_t prvCacheGet( const char * pcName,
+                               uint32_t * pulIPAddress );
+
+/*
+ * Add pcName to the cache, or update its entry if it is already present.
+ */
+static void prvCachePut( const char * pcName,
+                         uint32_t ulIPAddress );
+
+/*
+ * Resolve pcName with a DNS request and cache the result.
+ */
+static uint32_t prvResolve( const char * pcName );
+
+/*-----------------------------------------------------------*/
+
+static DNSCacheEntry_t xEntries[ dnscacheNUMBER_OF_ENTRIES ];
+static DNSCacheStats_t xCacheStats = { 0 };
+
+/* Incremented each time an entry is used, to order the entries from least to
+ * most recently used. */
+static uint32_t ulUseCount = 0;
+
+/*-----------------------------------------------------------*/
+
+uint32_t ulDNSCacheLookup( const char * pcName )
+{
+    uint32_t ulIPAddress;
+
+    configASSERT( pcName );
+
+    if( prvCacheGet( pcName, &ulIPAddress ) == pdFALSE )
+    {
+        ulIPAddress = prvResolve( pcName );
+    }
+
+    return ulIPAddress;
+}
+/*-----------------------------------------------------------*/
+
+uint32_t ulDNSCacheRefresh( const char * pcName )
+{
+    configASSERT( pcName );
+
+    return prvResolve( pcName );
+}
+/*-----------------------------------------------------------*/
+
+void vDNSCacheFlush( void )
+{
+    UBaseType_t uxEntry;
+
+    taskENTER_CRITICAL();
+    {
+        for( uxEntry = 0; uxEntry < dnscacheNUMBER_OF_ENTRIES; uxEntry++ )
+        {
+            xEntries[ uxEntry ].xInUse = pdFALSE;
+        }
+    }
+    taskEXIT_CRITICAL();
+}
+/*-----------------------------------------------------------*/
+
+BaseType_t xDNSCacheGetEntry( UBaseType_t uxIndex,
+                              DNSCacheEntryInfo_t * pxInfo )
+{
+    UBaseType_t uxEntry;
+    BaseType_t xReturn = pdFALSE;
+    TickType_t xAge, xNow = xTaskGetTickCount();
+
+    configASSERT( pxInfo );
+
+    taskENTER_CRITICAL();
+    {
+        for( uxEntry = 0; uxEntry < dnscacheNUMBER_OF_ENTRIES; uxEntry++ )
+        {
+            if( xEntries[ uxEntry ].xInUse == pdFALSE )
+            {
+                continue;
+            }
+
+            xAge = xNow - xEntries[ uxEntry ].xResolved;
+
+            if( xAge >= dnscacheTTL_TICKS )
+            {
+                continue;
+            }
+
+            if( uxIndex == 0 )
+            {
+                memcpy( pxInfo->cName, xEntries[ uxEntry ].cName, sizeof( pxInfo->cName ) );
+                pxInfo->ulIPAddress = xEntries[ uxEntry ].ulIPAddress;
+                pxInfo->ulSecondsToLive = ( uint32_t ) ( ( dnscacheTTL_TICKS - xAge ) / configTICK_RATE_HZ );
+                pxInfo->ulHits = xEntries[ uxEntry ].ulHits;
+                xReturn = pdTRUE;
+                break;
+            }
+
+            uxIndex--;
+        }
+    }
+    taskEXIT_CRITICAL();
+
+    return xReturn;
+}
+/*-----------------------------------------------------------*/
+
+void vDNSCacheGetStats( DNSCacheStats_t * pxStats )
+{
+    configASSERT( pxStats );
+
+    taskENTER_CRITICAL();
+    {
+        *pxStats = xCacheStats;
+    }
+    taskEXIT_CRITICAL();
+}
+/*-----------------------------------------------------------*/
+
+static BaseType_t prvCacheGet( const char * pcName,
+                               uint32_t * pulIPAddress )
+{
+    UBaseType_t uxEntry;
+    BaseType_t xReturn = pdFALSE;
+    DNSCacheEntry_t * pxEntry;
+
+    taskENTER_CRITICAL();
+    {
+        for( uxEntry = 0; uxEntry < dnscacheNUMBER_OF_ENTRIES; uxEntry++ )
+        {
+            pxEntry = &( xEntries[ uxEntry ] );
+
+            if( ( pxEntry->xInUse != pdFALSE ) && ( strncmp( pxEntry->cName, pcName, dnscacheMAX_NAME_LENGTH ) == 0 ) )
+            {
+                if( ( xTaskGetTickCount() - pxEntry->xResolved ) >= dnscacheTTL_TICKS )
+                {
+                    /* The entry is too old to use, so the name must be looked
+                     * up again. */
+                    pxEntry->xInUse = pdFALSE;
+                    xCacheStats.ulExpired++;
+                }
+                else
+                {
+                    *pulIPAddress = pxEntry->ulIPAddress;
+                    pxEntry->ulLastUsed = ++ulUseCount;
+                    pxEntry->ulHits++;
+                    xReturn = pdTRUE;
+                }
+
+                break;
+            }
+        }
+
+        if( xReturn != pdFALSE )
+        {
+            xCacheStats.ulHits++;
+        }
+        else
+        {
+            xCacheStats.ulMisses++;
+        }
+    }
+    taskEXIT_CRITICAL();
+
+    return xReturn;
+}
+/*-----------------------------------------------------------*/
+
+static void prvCachePut( const char * pcName,
+                         uint32_t ulIPAddress )
+{
+    UBaseType_t uxEntry;
+    DNSCacheEntry_t * pxEntry, * pxMatch = NULL, * pxFree = NULL, * pxOldest = NULL;
+
+    taskENTER_CRITICAL();
+    {
+        for( uxEntry = 0; uxEntry < dnscacheNUMBER_OF_ENTRIES; uxEntry++ )
+        {
+            pxEntry = &( xEntries[ uxEntry ] );
+
+            if( pxEntry->xInUse == pdFALSE )
+            {
+                if( pxFree == NULL )
+                {
+                    pxFree = pxEntry;
+                }
+            }
+            else if( strncmp( pxEntry->cName, pcName, dnscacheMAX_NAME_LENGTH ) == 0 )
+            {
+                /* The name is already cached, maybe because another task
+                 * resolved it at the same time. */
+                pxMatch = pxEntry;
+                break;
+            }
+            else if( ( pxOldest == NULL ) || ( pxEntry->ulLastUsed < pxOldest->ulLastUsed ) )
+            {
+                pxOldest = pxEntry;
+            }
+        }
+
+        if( pxMatch != NULL )
+        {
+            pxEntry = pxMatch;
+        }
+        else
+        {
+            if( pxFree != NULL )
+            {
+                pxEntry = pxFree;
+            }
+            else
+            {
+                /* The cache is full, so the least recently used entry is
+                 * replaced. */
+                pxEntry = pxOldest;
+                xCacheStats.ulEvictions++;
+            }
+
+            strcpy( pxEntry->cName, pcName );
+            pxEntry->ulHits = 0;
+            pxEntry->xInUse = pdTRUE;
+        }
+
+        pxEntry->ulIPAddress = ulIPAddress;
+        pxEntry->xResolved = xTaskGetTickCount();
+        pxEntry->ulLastUsed = ++ulUseCount;
+    }
+    taskEXIT_CRITICAL();
+}
+/*-----------------------------------------------------------*/
+
+static uint32_t prvResolve( const char * pcName )
+{
+    uint32_t ulIPAddress;
+
+    ulIPAddress = FreeRTOS_gethostbyname( ( const uint8_t * ) pcName );
+
+    if( ulIPAddress == 0 )
+    {
+        taskENTER_CRITICAL();
+        {
+            xCacheStats.ulFailures++;
+        }
+        taskEXIT_CRITICAL();
+    }
+    else if( strlen( pcName ) < dnscacheMAX_NAME_LENGTH )
+    {
+        prvCachePut( pcName, ulIPAddress );
+    }
+
+    return ulIPAddress;
+}
+/*-----------------------------------------------------------*/
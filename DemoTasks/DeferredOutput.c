@@ -0,0 +1,206 @@
+/*
+ * FreeRTOS V202411.00
+ * Copyright (C) 2020 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * https://www.FreeRTOS.org
+ * https://github.com/FreeRTOS
+ *
+ */
+/*
+ * See DeferredOutput.h.
+ *
+ * A message buffer only supports one writer at a time, so each write is made
+ * in a critical section with a block time of zero, as the FreeRTOS
+ * documentation requires when there is more than one writer.  The critical
+ * section only lasts as long as copying the message.
+ */
+
+/* Standard includes. */
+#include <stdint.h>
+
+/* FreeRTOS includes. */
+#include "FreeRTOS.h"
+#include "task.h"
+#include "queue.h"
+#include "semphr.h"
+#include "message_buffer.h"
+
+/* Demo app includes. */
+#include "DemoStatic.h"
+#include "DeferredOutput.h"
+
+/*
+ * The task that passes the messages to the output function.
+ */
+static void prvDeferredOutputTask( void * pvParameters );
+
+/*-----------------------------------------------------------*/
+
+static MessageBufferHandle_t xMessageBuffer = NULL;
+static DeferredOutputFunction_t pxOutput = NULL;
+static volatile BaseType_t xEnabled = pdFALSE;
+static DeferredOutputStats_t xStats = { 0 };
+
+/*-----------------------------------------------------------*/
+
+void vStartDeferredOutputTask( uint16_t usStackSize,
+                               UBaseType_t uxPriority,
+                               DeferredOutputFunction_t pxOutputFunction )
+{
+    demoTASK_MEMORY( xOutputMemory, 1, demoSTATIC_TASK_STACK_DEPTH );
+
+    configASSERT( xMessageBuffer == NULL );
+    configASSERT( pxOutputFunction );
+
+    pxOutput = pxOutputFunction;
+
+    #if ( demoSTATIC_ALLOCATION == 1 )
+    {
+        /* One byte more than the capacity, see xMessageBufferCreateStatic(). */
+        static uint8_t ucStorage[ deferredBUFFER_BYTES + 1 ];
+        static StaticMessageBuffer_t xStaticMessageBuffer;
+
+        xMessageBuffer = xMessageBufferCreateStatic( sizeof( ucStorage ), ucStorage, &xStaticMessageBuffer );
+    }
+    #else
+    {
+        xMessageBuffer = xMessageBufferCreate( deferredBUFFER_BYTES );
+    }
+    #endif
+    configASSERT( xMessageBuffer );
+
+    xDemoTaskCreate( prvDeferredOutputTask, "Output", usStackSize, NULL, uxPriority, NULL, &xOutputMemory );
+}
+/*-----------------------------------------------------------*/
+
+BaseType_t xDeferredOutputWrite( const char * pcMessage,
+                                 size_t xLength )
+{
+    BaseType_t xReturn = pdFAIL;
+    size_t xBytesWaiting;
+
+    configASSERT( pcMessage );
+    configASSERT( xMessageBuffer );
+
+    taskENTER_CRITICAL();
+    {
+        if( ( xLength <= deferredMAX_MESSAGE_LENGTH ) &&
+            ( xMessageBufferSend( xMessageBuffer, pcMessage, xLength, 0 ) == xLength ) )
+        {
+            xStats.ulWritten++;
+            xBytesWaiting = deferredBUFFER_BYTES - xMessageBufferSpacesAvailable( xMessageBuffer );
+
+            if( xBytesWaiting > xStats.xMaxBytesWaiting )
+            {
+                xStats.xMaxBytesWaiting = xBytesWaiting;
+            }
+
+            xReturn = pdPASS;
+        }
+        else
+        {
+            xStats.ulDropped++;
+        }
+    }
+    taskEXIT_CRITICAL();
+
+    return xReturn;
+}
+/*-----------------------------------------------------------*/
+
+BaseType_t xDeferredOutputSend( const char * pcMessage,
+                                size_t xLength )
+{
+    BaseType_t xReturn = pdFAIL;
+
+    configASSERT( pcMessage );
+
+    if( xMessageBuffer != NULL )
+    {
+        if( xEnabled != pdFALSE )
+        {
+            xReturn = xDeferredOutputWrite( pcMessage, xLength );
+        }
+        else
+        {
+            pxOutput( pcMessage, xLength );
+            xReturn = pdPASS;
+        }
+    }
+
+    return xReturn;
+}
+/*-----------------------------------------------------------*/
+
+void vDeferredOutputSetEnabled( BaseType_t xEnable )
+{
+    xEnabled = xEnable;
+}
+/*-----------------------------------------------------------*/
+
+BaseType_t xDeferredOutputIsEnabled( void )
+{
+    return xEnabled;
+}
+/*-----------------------------------------------------------*/
+
+BaseType_t xDeferredOutputIsStarted( void )
+{
+    return ( xMessageBuffer != NULL ) ? pdTRUE : pdFALSE;
+}
+/*-----------------------------------------------------------*/
+
+void vDeferredOutputGetStats( DeferredOutputStats_t * pxStats )
+{
+    configASSERT( pxStats );
+
+    taskENTER_CRITICAL();
+    {
+        *pxStats = xStats;
+    }
+    taskEXIT_CRITICAL();
+}
+/*-----------------------------------------------------------*/
+
+static void prvDeferredOutputTask( void * pvParameters )
+{
+    static char cMessage[ deferredMAX_MESSAGE_LENGTH ];
+    size_t xLength;
+
+    ( void ) pvParameters;
+
+    for( ; ; )
+    {
+        /* There is only one reader, so no critical section is needed. */
+        xLength = xMessageBufferReceive( xMessageBuffer, cMessage, sizeof( cMessage ), portMAX_DELAY );
+
+        if( xLength > 0 )
+        {
+            pxOutput( cMessage, xLength );
+
+            taskENTER_CRITICAL();
+            {
+                xStats.ulOutput++;
+            }
+            taskEXIT_CRITICAL();
+        }
+    }
+}
+/*-----------------------------------------------------------*/
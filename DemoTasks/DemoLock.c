@@ -0,0 +1,346 @@
+/*
+ * FreeRTOS V202411.00
+ * Copyright (C) 2020 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * https://www.FreeRTOS.org
+ * https://github.com/FreeRTOS
+ *
+ */
+
+/*
+ * See DemoLock.h.
+ *
+ * The mode is read before waiting for the lock and checked again once the lock
+ * has been obtained.  xDemoLockSetMode() changes the mode while holding the
+ * handle used by the old mode, so a task that obtains the old handle after the
+ * change sees the mode has changed, gives the old handle back, and waits again
+ * on the new handle.  That way only one task ever holds the lock, however many
+ * tasks were waiting when the mode changed.
+ */
+
+/* Standard includes. */
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+/* FreeRTOS includes. */
+#include "FreeRTOS.h"
+#include "task.h"
+#include "queue.h"
+#include "semphr.h"
+
+/* Demo app includes. */
+#include "DemoStatic.h"
+#include "LockProfiler.h"
+#include "DemoLock.h"
+
+/* The calling task's priority ignoring any priority it has inherited from a
+ * mutex.  The ceiling is compared with, and the holder restored to, this
+ * priority: vTaskPrioritySet() only changes the base priority of a task that
+ * has inherited a priority, so restoring the inherited priority would make the
+ * inherited priority permanent. */
+#if ( configUSE_MUTEXES == 1 )
+    #define demolockGET_BASE_PRIORITY()    uxTaskBasePriorityGet( NULL )
+#else
+    #define demolockGET_BASE_PRIORITY()    uxTaskPriorityGet( NULL )
+#endif
+
+/* A lock. */
+typedef struct xDEMO_LOCK
+{
+    SemaphoreHandle_t xMutex;                             /* Used in eDemoLockMutex mode. */
+    SemaphoreHandle_t xSemaphore;                         /* Used in the other modes. */
+    volatile eDemoLockMode eMode;                         /* The mode used by the next take. */
+    UBaseType_t uxCeiling;                                /* The priority the lock is taken at in eDemoLockCeiling mode. */
+    eDemoLockMode eHeldMode;                              /* The mode the lock was taken in, only valid while it is held. */
+    UBaseType_t uxHolderPriority;                         /* The holder's base priority before it was raised to the ceiling. */
+    BaseType_t xRaised;                                   /* pdTRUE if the holder's priority was raised to the ceiling. */
+    char cName[ demolockMAX_NAME_LENGTH + 1 ];            /* The lock's name. */
+    char cMutexName[ demolockMAX_NAME_LENGTH + 7 ];       /* The name of xMutex in the lock profiler. */
+    char cSemaphoreName[ demolockMAX_NAME_LENGTH + 5 ];   /* The name of xSemaphore in the lock profiler. */
+} DemoLock_t;
+
+/*
+ * Return the handle used by mode eMode.
+ */
+static SemaphoreHandle_t prvGetHandle( DemoLock_t * pxLock,
+                                       eDemoLockMode eMode );
+
+/*-----------------------------------------------------------*/
+
+static DemoLock_t xLocks[ demolockMAX_LOCKS ];
+static UBaseType_t uxLocks = 0;
+
+static const char * const pcModeNames[ eDemoLockNumberOfModes ] =
+{
+    "mutex",     /* eDemoLockMutex */
+    "semaphore", /* eDemoLockSemaphore */
+    "ceiling"    /* eDemoLockCeiling */
+};
+
+/*-----------------------------------------------------------*/
+
+DemoLockHandle_t xDemoLockCreate( const char * pcName,
+                                  eDemoLockMode eMode,
+                                  UBaseType_t uxCeiling )
+{
+    DemoLock_t * pxLock = NULL;
+
+    configASSERT( pcName );
+    configASSERT( eMode < eDemoLockNumberOfModes );
+
+    /* Locks are created before the scheduler starts, or by a single task, so
+     * the array does not need protecting here. */
+    if( uxLocks < demolockMAX_LOCKS )
+    {
+        pxLock = &( xLocks[ uxLocks ] );
+        memset( ( void * ) pxLock, 0x00, sizeof( *pxLock ) );
+        pxLock->xMutex = xDemoSemaphoreCreateMutex();
+        pxLock->xSemaphore = xDemoSemaphoreCreateBinary();
+        configASSERT( pxLock->xMutex );
+        configASSERT( pxLock->xSemaphore );
+
+        /* Binary semaphores start empty, give once so it starts unlocked. */
+        xSemaphoreGive( pxLock->xSemaphore );
+
+        pxLock->eMode = eMode;
+        pxLock->uxCeiling = uxCeiling;
+        strncpy( pxLock->cName, pcName, demolockMAX_NAME_LENGTH );
+        sprintf( pxLock->cMutexName, "%s/mutex", pxLock->cName );
+        sprintf( pxLock->cSemaphoreName, "%s/sem", pxLock->cName );
+        xLockProfilerRegister( pxLock->xMutex, pxLock->cMutexName, pdTRUE );
+        xLockProfilerRegister( pxLock->xSemaphore, pxLock->cSemaphoreName, pdFALSE );
+
+        uxLocks++;
+    }
+
+    return pxLock;
+}
+/*-----------------------------------------------------------*/
+
+BaseType_t xDemoLockTake( DemoLockHandle_t xLock,
+                          TickType_t xTicksToWait )
+{
+    DemoLock_t * pxLock = ( DemoLock_t * ) xLock;
+    eDemoLockMode eMode;
+    UBaseType_t uxPriority;
+    BaseType_t xRaised, xReturn;
+
+    configASSERT( pxLock );
+
+    for( ; ; )
+    {
+        eMode = pxLock->eMode;
+        uxPriority = demolockGET_BASE_PRIORITY();
+        xRaised = pdFALSE;
+
+        if( ( eMode == eDemoLockCeiling ) && ( pxLock->uxCeiling > uxPriority ) )
+        {
+            /* Raise the priority before taking the lock, so no task that uses
+             * the lock can preempt this task while it holds the lock. */
+            vTaskPrioritySet( NULL, pxLock->uxCeiling );
+            xRaised = pdTRUE;
+        }
+
+        xReturn = xTracedSemaphoreTake( prvGetHandle( pxLock, eMode ), xTicksToWait );
+
+        if( ( xReturn != pdFALSE ) && ( pxLock->eMode != eMode ) )
+        {
+            /* The mode changed while this task was waiting, so wait again
+             * using the new mode.  The new wait gets the full block time
+             * again. */
+            ( void ) xTracedSemaphoreGive( prvGetHandle( pxLock, eMode ) );
+
+            if( xRaised != pdFALSE )
+            {
+                vTaskPrioritySet( NULL, uxPriority );
+            }
+
+            continue;
+        }
+
+        if( xReturn != pdFALSE )
+        {
+            pxLock->eHeldMode = eMode;
+            pxLock->uxHolderPriority = uxPriority;
+            pxLock->xRaised = xRaised;
+        }
+        else if( xRaised != pdFALSE )
+        {
+            vTaskPrioritySet( NULL, uxPriority );
+        }
+
+        break;
+    }
+
+    return xReturn;
+}
+/*-----------------------------------------------------------*/
+
+BaseType_t xDemoLockGive( DemoLockHandle_t xLock )
+{
+    DemoLock_t * pxLock = ( DemoLock_t * ) xLock;
+    UBaseType_t uxPriority;
+    BaseType_t xRaised, xReturn;
+
+    configASSERT( pxLock );
+
+    /* Read the holder's state before giving the lock, after which it can be
+     * overwritten by the next holder. */
+    uxPriority = pxLock->uxHolderPriority;
+    xRaised = pxLock->xRaised;
+
+    xReturn = xTracedSemaphoreGive( prvGetHandle( pxLock, pxLock->eHeldMode ) );
+
+    if( ( xReturn != pdFALSE ) && ( xRaised != pdFALSE ) )
+    {
+        /* Only lower the priority once the lock is free, so a waiter of this
+         * task's original priority or above never runs while it is held. */
+        vTaskPrioritySet( NULL, uxPriority );
+    }
+
+    return xReturn;
+}
+/*-----------------------------------------------------------*/
+
+BaseType_t xDemoLockSetMode( DemoLockHandle_t xLock,
+                             eDemoLockMode eMode,
+                             TickType_t xTicksToWait )
+{
+    DemoLock_t * pxLock = ( DemoLock_t * ) xLock;
+    SemaphoreHandle_t xOldHandle;
+    BaseType_t xReturn = pdFAIL;
+
+    configASSERT( pxLock );
+    configASSERT( eMode < eDemoLockNumberOfModes );
+
+    if( eMode == pxLock->eMode )
+    {
+        return pdPASS;
+    }
+
+    /* Only this function changes the mode, and it is only called from one
+     * task at a time, so the old handle can not change under it.  The untraced
+     * API is used so the change does not show in the lock statistics. */
+    xOldHandle = prvGetHandle( pxLock, pxLock->eMode );
+
+    if( xSemaphoreTake( xOldHandle, xTicksToWait ) != pdFALSE )
+    {
+        pxLock->eMode = eMode;
+        xSemaphoreGive( xOldHandle );
+        xReturn = pdPASS;
+    }
+
+    return xReturn;
+}
+/*-----------------------------------------------------------*/
+
+BaseType_t xDemoLockSetAllModes( eDemoLockMode eMode,
+                                 TickType_t xTicksToWait )
+{
+    BaseType_t xReturn = pdPASS;
+    UBaseType_t ux;
+
+    for( ux = 0; ux < uxLocks; ux++ )
+    {
+        if( xDemoLockSetMode( &( xLocks[ ux ] ), eMode, xTicksToWait ) == pdFAIL )
+        {
+            xReturn = pdFAIL;
+        }
+    }
+
+    return xReturn;
+}
+/*-----------------------------------------------------------*/
+
+void vDemoLockSetCeiling( DemoLockHandle_t xLock,
+                          UBaseType_t uxCeiling )
+{
+    configASSERT( xLock );
+
+    ( ( DemoLock_t * ) xLock )->uxCeiling = uxCeiling;
+}
+/*-----------------------------------------------------------*/
+
+eDemoLockMode eDemoLockGetMode( DemoLockHandle_t xLock )
+{
+    configASSERT( xLock );
+
+    return ( ( DemoLock_t * ) xLock )->eMode;
+}
+/*-----------------------------------------------------------*/
+
+UBaseType_t uxDemoLockGetCeiling( DemoLockHandle_t xLock )
+{
+    configASSERT( xLock );
+
+    return ( ( DemoLock_t * ) xLock )->uxCeiling;
+}
+/*-----------------------------------------------------------*/
+
+const char * pcDemoLockGetName( DemoLockHandle_t xLock )
+{
+    configASSERT( xLock );
+
+    return ( ( DemoLock_t * ) xLock )->cName;
+}
+/*-----------------------------------------------------------*/
+
+UBaseType_t uxDemoLockGetCount( void )
+{
+    return uxLocks;
+}
+/*-----------------------------------------------------------*/
+
+DemoLockHandle_t xDemoLockGetLock( UBaseType_t uxIndex )
+{
+    return ( uxIndex < uxLocks ) ? &( xLocks[ uxIndex ] ) : NULL;
+}
+/*-----------------------------------------------------------*/
+
+const char * pcDemoLockModeName( eDemoLockMode eMode )
+{
+    return ( eMode < eDemoLockNumberOfModes ) ? pcModeNames[ eMode ] : "?";
+}
+/*-----------------------------------------------------------*/
+
+eDemoLockMode eDemoLockModeFromName( const char * pcName,
+                                     size_t xLength )
+{
+    eDemoLockMode eMode;
+
+    for( eMode = eDemoLockMutex; eMode < eDemoLockNumberOfModes; eMode++ )
+    {
+        if( ( xLength == strlen( pcModeNames[ eMode ] ) ) && ( strncmp( pcName, pcModeNames[ eMode ], xLength ) == 0 ) )
+        {
+            break;
+        }
+    }
+
+    return eMode;
+}
+/*-----------------------------------------------------------*/
+
+static SemaphoreHandle_t prvGetHandle( DemoLock_t * pxLock,
+                                       eDemoLockMode eMode )
+{
+    return ( eMode == eDemoLockMutex ) ? pxLock->xMutex : pxLock->xSemaphore;
+}
+/*-----------------------------------------------------------*/
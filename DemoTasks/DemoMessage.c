@@ -0,0 +1,328 @@
+/*
+ * FreeRTOS V202411.00
+ * Copyright (C) 2020 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * https://www.FreeRTOS.org
+ * https://github.com/FreeRTOS
+ *
+ */
+
+/*
+ * See DemoMessage.h.
+ */
+
+/* Standard includes. */
+#include <stdint.h>
+#include <string.h>
+
+/* FreeRTOS includes. */
+#include "FreeRTOS.h"
+#include "task.h"
+
+/* Demo app includes. */
+#include "DemoTimestamp.h"
+#include "DemoMessage.h"
+
+/* Offsets of the fields in the header of a binary message. */
+#define msgSEQUENCE_OFFSET     0
+#define msgTIMESTAMP_OFFSET    4
+#define msgLENGTH_OFFSET       8
+#define msgCHECKSUM_OFFSET     10
+
+/* The number of characters used by the largest uint32_t in decimal. */
+#define msgMAX_DIGITS          10
+
+/*
+ * Write ulValue to pucDest in network byte order.  Bytes are written one at a
+ * time because message buffers need not be aligned.
+ */
+static void prvWrite32( uint8_t * pucDest,
+                        uint32_t ulValue );
+static void prvWrite16( uint8_t * pucDest,
+                        uint16_t usValue );
+static uint32_t prvRead32( const uint8_t * pucSource );
+static uint16_t prvRead16( const uint8_t * pucSource );
+
+/*
+ * Add the xLength bytes at pucData, taken as big endian 16-bit words, to
+ * ulSum.  pucData must start at an even offset into the message for the result
+ * to be part of the message's checksum.
+ */
+static uint32_t prvChecksumAdd( uint32_t ulSum,
+                                const uint8_t * pucData,
+                                size_t xLength );
+
+/*
+ * Fold a partial sum into a 16-bit ones' complement sum.
+ */
+static uint16_t prvChecksumFold( uint32_t ulSum );
+
+/*
+ * Write ulValue in decimal to pucDest, returning the number of characters
+ * written.  No terminator is written.
+ */
+static size_t prvUInt32ToDecimal( uint32_t ulValue,
+                                  uint8_t * pucDest );
+
+/*-----------------------------------------------------------*/
+
+void vDemoMessageInitBinary( DemoMessageTemplate_t * pxTemplate,
+                             size_t xPayloadLength )
+{
+    size_t x;
+
+    configASSERT( pxTemplate );
+    configASSERT( xPayloadLength <= msgMAX_FIXED_LENGTH );
+
+    pxTemplate->xFormat = msgFORMAT_BINARY;
+    pxTemplate->xTerminate = pdFALSE;
+    pxTemplate->xFixedLength = xPayloadLength;
+
+    /* The payload is a recognisable pattern, to make captures easy to read. */
+    for( x = 0; x < xPayloadLength; x++ )
+    {
+        pxTemplate->ucFixed[ x ] = ( uint8_t ) ( 'A' + ( x % 26 ) );
+    }
+
+    /* The payload follows the header, which is an even number of bytes long,
+     * so its words line up with the words of the message. */
+    pxTemplate->ulFixedSum = prvChecksumAdd( 0, pxTemplate->ucFixed, xPayloadLength );
+}
+/*-----------------------------------------------------------*/
+
+void vDemoMessageInitText( DemoMessageTemplate_t * pxTemplate,
+                           const char * pcText,
+                           BaseType_t xTerminate )
+{
+    size_t xLength;
+
+    configASSERT( pxTemplate );
+    configASSERT( pcText );
+
+    xLength = strlen( pcText );
+    configASSERT( xLength <= msgMAX_FIXED_LENGTH );
+
+    pxTemplate->xFormat = msgFORMAT_TEXT;
+    pxTemplate->xTerminate = xTerminate;
+    pxTemplate->xFixedLength = xLength;
+    pxTemplate->ulFixedSum = 0;
+    memcpy( pxTemplate->ucFixed, pcText, xLength );
+}
+/*-----------------------------------------------------------*/
+
+size_t xDemoMessageMaxLength( const DemoMessageTemplate_t * pxTemplate )
+{
+    size_t xReturn;
+
+    if( pxTemplate->xFormat == msgFORMAT_BINARY )
+    {
+        xReturn = msgHEADER_LENGTH + pxTemplate->xFixedLength;
+    }
+    else
+    {
+        /* The number, "\r\n", and space for the terminator, which is always
+         * written. */
+        xReturn = pxTemplate->xFixedLength + msgMAX_DIGITS + 3;
+    }
+
+    return xReturn;
+}
+/*-----------------------------------------------------------*/
+
+size_t xDemoMessageEncode( const DemoMessageTemplate_t * pxTemplate,
+                           uint32_t ulSequence,
+                           uint8_t * pucBuffer,
+                           size_t xBufferLength )
+{
+    size_t xLength;
+    uint32_t ulSum;
+
+    configASSERT( pxTemplate );
+    configASSERT( pucBuffer );
+
+    if( xBufferLength < xDemoMessageMaxLength( pxTemplate ) )
+    {
+        xLength = 0;
+    }
+    else if( pxTemplate->xFormat == msgFORMAT_BINARY )
+    {
+        xLength = msgHEADER_LENGTH + pxTemplate->xFixedLength;
+
+        prvWrite32( &( pucBuffer[ msgSEQUENCE_OFFSET ] ), ulSequence );
+        prvWrite32( &( pucBuffer[ msgTIMESTAMP_OFFSET ] ), ( uint32_t ) demoGET_TIMESTAMP() );
+        prvWrite16( &( pucBuffer[ msgLENGTH_OFFSET ] ), ( uint16_t ) xLength );
+        prvWrite16( &( pucBuffer[ msgCHECKSUM_OFFSET ] ), 0 );
+        memcpy( &( pucBuffer[ msgHEADER_LENGTH ] ), pxTemplate->ucFixed, pxTemplate->xFixedLength );
+
+        /* Only the header has to be summed, the payload was summed when the
+         * template was created. */
+        ulSum = prvChecksumAdd( pxTemplate->ulFixedSum, pucBuffer, msgHEADER_LENGTH );
+        prvWrite16( &( pucBuffer[ msgCHECKSUM_OFFSET ] ), ( uint16_t ) ~prvChecksumFold( ulSum ) );
+    }
+    else
+    {
+        memcpy( pucBuffer, pxTemplate->ucFixed, pxTemplate->xFixedLength );
+        xLength = pxTemplate->xFixedLength;
+        xLength += prvUInt32ToDecimal( ulSequence, &( pucBuffer[ xLength ] ) );
+        pucBuffer[ xLength++ ] = '\r';
+        pucBuffer[ xLength++ ] = '\n';
+        pucBuffer[ xLength ] = 0x00;
+
+        if( pxTemplate->xTerminate != pdFALSE )
+        {
+            xLength++;
+        }
+    }
+
+    return xLength;
+}
+/*-----------------------------------------------------------*/
+
+BaseType_t xDemoMessageVerify( const uint8_t * pucMessage,
+                               size_t xLength,
+                               uint32_t * pulSequence )
+{
+    BaseType_t xReturn = pdFALSE;
+
+    if( ( pucMessage != NULL ) && ( xLength >= msgHEADER_LENGTH ) && ( xLength <= 0xffffU ) )
+    {
+        /* Summing a message that includes a correct checksum gives 0xffff. */
+        if( ( prvRead16( &( pucMessage[ msgLENGTH_OFFSET ] ) ) == ( uint16_t ) xLength ) &&
+            ( prvChecksumFold( prvChecksumAdd( 0, pucMessage, xLength ) ) == 0xffffU ) )
+        {
+            if( pulSequence != NULL )
+            {
+                *pulSequence = prvRead32( &( pucMessage[ msgSEQUENCE_OFFSET ] ) );
+            }
+
+            xReturn = pdTRUE;
+        }
+    }
+
+    return xReturn;
+}
+/*-----------------------------------------------------------*/
+
+BaseType_t xDemoMessageMatches( const uint8_t * pucSent,
+                                size_t xSentLength,
+                                const uint8_t * pucReceived,
+                                int32_t lReceivedLength )
+{
+    BaseType_t xReturn = pdFALSE;
+
+    if( ( lReceivedLength >= 0 ) && ( ( size_t ) lReceivedLength == xSentLength ) )
+    {
+        if( memcmp( pucSent, pucReceived, xSentLength ) == 0 )
+        {
+            xReturn = pdTRUE;
+        }
+    }
+
+    return xReturn;
+}
+/*-----------------------------------------------------------*/
+
+static void prvWrite32( uint8_t * pucDest,
+                        uint32_t ulValue )
+{
+    pucDest[ 0 ] = ( uint8_t ) ( ulValue >> 24 );
+    pucDest[ 1 ] = ( uint8_t ) ( ulValue >> 16 );
+    pucDest[ 2 ] = ( uint8_t ) ( ulValue >> 8 );
+    pucDest[ 3 ] = ( uint8_t ) ulValue;
+}
+/*-----------------------------------------------------------*/
+
+static void prvWrite16( uint8_t * pucDest,
+                        uint16_t usValue )
+{
+    pucDest[ 0 ] = ( uint8_t ) ( usValue >> 8 );
+    pucDest[ 1 ] = ( uint8_t ) usValue;
+}
+/*-----------------------------------------------------------*/
+
+static uint32_t prvRead32( const uint8_t * pucSource )
+{
+    return ( ( ( uint32_t ) pucSource[ 0 ] ) << 24 ) |
+           ( ( ( uint32_t ) pucSource[ 1 ] ) << 16 ) |
+           ( ( ( uint32_t ) pucSource[ 2 ] ) << 8 ) |
+           ( ( uint32_t ) pucSource[ 3 ] );
+}
+/*-----------------------------------------------------------*/
+
+static uint16_t prvRead16( const uint8_t * pucSource )
+{
+    return ( uint16_t ) ( ( ( ( uint16_t ) pucSource[ 0 ] ) << 8 ) | ( ( uint16_t ) pucSource[ 1 ] ) );
+}
+/*-----------------------------------------------------------*/
+
+static uint32_t prvChecksumAdd( uint32_t ulSum,
+                                const uint8_t * pucData,
+                                size_t xLength )
+{
+    size_t x;
+
+    for( x = 0; ( x + 1 ) < xLength; x += 2 )
+    {
+        ulSum += ( ( ( uint32_t ) pucData[ x ] ) << 8 ) | ( ( uint32_t ) pucData[ x + 1 ] );
+    }
+
+    /* An odd byte at the end is summed as if it were followed by a zero. */
+    if( ( xLength & 0x01U ) != 0 )
+    {
+        ulSum += ( ( uint32_t ) pucData[ xLength - 1 ] ) << 8;
+    }
+
+    return ulSum;
+}
+/*-----------------------------------------------------------*/
+
+static uint16_t prvChecksumFold( uint32_t ulSum )
+{
+    while( ( ulSum >> 16 ) != 0 )
+    {
+        ulSum = ( ulSum & 0xffffUL ) + ( ulSum >> 16 );
+    }
+
+    return ( uint16_t ) ulSum;
+}
+/*-----------------------------------------------------------*/
+
+static size_t prvUInt32ToDecimal( uint32_t ulValue,
+                                  uint8_t * pucDest )
+{
+    uint8_t ucDigits[ msgMAX_DIGITS ];
+    size_t xDigits = 0, x;
+
+    /* Generate the digits least significant first, then copy them out in the
+     * right order. */
+    do
+    {
+        ucDigits[ xDigits++ ] = ( uint8_t ) ( '0' + ( ulValue % 10UL ) );
+        ulValue /= 10UL;
+    } while( ulValue != 0 );
+
+    for( x = 0; x < xDigits; x++ )
+    {
+        pucDest[ x ] = ucDigits[ xDigits - 1 - x ];
+    }
+
+    return xDigits;
+}
+/*-----------------------------------------------------------*/
@@ -0,0 +1,387 @@
+/*
+ * FreeRTOS V202411.00
+ * Copyright (C) 2020 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * https://www.FreeRTOS.org
+ * https://github.com/FreeRTOS
+ *
+ */
+
+/*
+ * See DemoStatic.h.
+ *
+ * Task stacks and control blocks are taken in order from the memory defined
+ * with demoTASK_MEMORY() by the code creating the task.  Semaphores and queues
+ * are taken from fixed arrays in order, and queue storage is carved from the
+ * front of one array, so queues of different sizes can share the space.  In
+ * both profiles the stack depth of each task is recorded, as the kernel does
+ * not report it.  When demoSTATIC_ALLOCATION is 1 this file also provides the
+ * memory for the idle and timer tasks, as the kernel requires it to be
+ * supplied by the application.
+ */
+
+/* Standard includes. */
+#include <stdint.h>
+#include <string.h>
+
+/* FreeRTOS includes. */
+#include "FreeRTOS.h"
+#include "task.h"
+#include "queue.h"
+#include "semphr.h"
+
+/* Demo app includes. */
+#include "DemoStatic.h"
+
+#if ( demoSTATIC_ALLOCATION == 1 ) && ( configSUPPORT_STATIC_ALLOCATION != 1 )
+    #error demoSTATIC_ALLOCATION requires configSUPPORT_STATIC_ALLOCATION to be 1 in FreeRTOSConfig.h.
+#endif
+
+/* The stack depth each task was created with. */
+typedef struct xDEMO_TASK_DEPTH
+{
+    TaskHandle_t xTask;                  /* The task. */
+    configSTACK_DEPTH_TYPE uxStackDepth; /* The depth it was created with. */
+} DemoTaskDepth_t;
+
+/*
+ * Record the stack depth of a task that has just been created.
+ */
+static void prvRecordStackDepth( TaskHandle_t xTask,
+                                 configSTACK_DEPTH_TYPE uxStackDepth );
+
+static DemoTaskDepth_t xTaskDepths[ demoSTATIC_MAX_TASKS ];
+static UBaseType_t uxTaskDepths = 0;
+
+#if ( demoSTATIC_ALLOCATION == 1 )
+
+/*
+ * Return the next free object of xObjectSize bytes from pvArray, which holds
+ * uxCount objects, or NULL if they are all used.  *puxUsed counts the objects
+ * that have been taken.
+ */
+    static void * prvTakeObject( void * pvArray,
+                                 size_t xObjectSize,
+                                 UBaseType_t uxCount,
+                                 UBaseType_t * puxUsed );
+
+/*-----------------------------------------------------------*/
+
+    static StaticSemaphore_t xSemaphoreBuffers[ demoSTATIC_MAX_SEMAPHORES ];
+    static StaticQueue_t xQueueBuffers[ demoSTATIC_MAX_QUEUES ];
+    static uint8_t ucQueueArena[ demoSTATIC_QUEUE_BYTES ];
+    static DemoStaticStats_t xUsage = { 0 };
+
+#endif /* demoSTATIC_ALLOCATION */
+
+/*-----------------------------------------------------------*/
+
+BaseType_t xDemoTaskCreate( TaskFunction_t pxTaskCode,
+                            const char * const pcName,
+                            configSTACK_DEPTH_TYPE uxStackDepth,
+                            void * const pvParameters,
+                            UBaseType_t uxPriority,
+                            TaskHandle_t * const pxCreatedTask,
+                            DemoTaskMemory_t * pxMemory )
+{
+    TaskHandle_t xTask;
+
+    configASSERT( pxMemory );
+
+    #if ( demoSTATIC_ALLOCATION == 1 )
+    {
+        StaticTask_t * pxTaskBuffer = NULL;
+        StackType_t * pxStack = NULL;
+
+        /* Tasks can be created after the scheduler has started, for example
+         * when the network comes up. */
+        taskENTER_CRITICAL();
+        {
+            if( ( pxMemory->uxUsed < pxMemory->uxTasks ) && ( uxStackDepth <= pxMemory->uxStackDepth ) )
+            {
+                pxTaskBuffer = &( pxMemory->pxTaskBuffers[ pxMemory->uxUsed ] );
+                pxStack = &( pxMemory->pxStacks[ pxMemory->uxUsed * pxMemory->uxStackDepth ] );
+                pxMemory->uxUsed++;
+                xUsage.uxTasks++;
+                xUsage.xStackWords += uxStackDepth;
+            }
+            else
+            {
+                xUsage.ulFailures++;
+            }
+        }
+        taskEXIT_CRITICAL();
+
+        if( pxTaskBuffer == NULL )
+        {
+            return pdFAIL;
+        }
+
+        xTask = xTaskCreateStatic( pxTaskCode, pcName, uxStackDepth, pvParameters, uxPriority, pxStack, pxTaskBuffer );
+    }
+    #else /* if ( demoSTATIC_ALLOCATION == 1 ) */
+    {
+        ( void ) pxMemory;
+
+        if( xTaskCreate( pxTaskCode, pcName, uxStackDepth, pvParameters, uxPriority, &xTask ) != pdPASS )
+        {
+            xTask = NULL;
+        }
+    }
+    #endif /* if ( demoSTATIC_ALLOCATION == 1 ) */
+
+    if( xTask == NULL )
+    {
+        return pdFAIL;
+    }
+
+    prvRecordStackDepth( xTask, uxStackDepth );
+
+    if( pxCreatedTask != NULL )
+    {
+        *pxCreatedTask = xTask;
+    }
+
+    return pdPASS;
+}
+/*-----------------------------------------------------------*/
+
+configSTACK_DEPTH_TYPE uxDemoTaskGetStackDepth( TaskHandle_t xTask )
+{
+    UBaseType_t uxTask;
+    configSTACK_DEPTH_TYPE uxStackDepth = 0;
+
+    taskENTER_CRITICAL();
+    {
+        for( uxTask = 0; uxTask < uxTaskDepths; uxTask++ )
+        {
+            if( xTaskDepths[ uxTask ].xTask == xTask )
+            {
+                uxStackDepth = xTaskDepths[ uxTask ].uxStackDepth;
+                break;
+            }
+        }
+    }
+    taskEXIT_CRITICAL();
+
+    return uxStackDepth;
+}
+/*-----------------------------------------------------------*/
+
+SemaphoreHandle_t xDemoSemaphoreCreateMutex( void )
+{
+    #if ( demoSTATIC_ALLOCATION == 1 )
+    {
+        StaticSemaphore_t * pxBuffer;
+
+        taskENTER_CRITICAL();
+        {
+            pxBuffer = ( StaticSemaphore_t * ) prvTakeObject( xSemaphoreBuffers, sizeof( StaticSemaphore_t ), demoSTATIC_MAX_SEMAPHORES, &( xUsage.uxSemaphores ) );
+        }
+        taskEXIT_CRITICAL();
+
+        return ( pxBuffer != NULL ) ? xSemaphoreCreateMutexStatic( pxBuffer ) : NULL;
+    }
+    #else
+    {
+        return xSemaphoreCreateMutex();
+    }
+    #endif
+}
+/*-----------------------------------------------------------*/
+
+SemaphoreHandle_t xDemoSemaphoreCreateBinary( void )
+{
+    #if ( demoSTATIC_ALLOCATION == 1 )
+    {
+        StaticSemaphore_t * pxBuffer;
+
+        taskENTER_CRITICAL();
+        {
+            pxBuffer = ( StaticSemaphore_t * ) prvTakeObject( xSemaphoreBuffers, sizeof( StaticSemaphore_t ), demoSTATIC_MAX_SEMAPHORES, &( xUsage.uxSemaphores ) );
+        }
+        taskEXIT_CRITICAL();
+
+        return ( pxBuffer != NULL ) ? xSemaphoreCreateBinaryStatic( pxBuffer ) : NULL;
+    }
+    #else
+    {
+        return xSemaphoreCreateBinary();
+    }
+    #endif
+}
+/*-----------------------------------------------------------*/
+
+QueueHandle_t xDemoQueueCreate( UBaseType_t uxQueueLength,
+                                UBaseType_t uxItemSize )
+{
+    #if ( demoSTATIC_ALLOCATION == 1 )
+    {
+        StaticQueue_t * pxBuffer = NULL;
+        uint8_t * pucStorage = NULL;
+        size_t xBytes = ( size_t ) uxQueueLength * ( size_t ) uxItemSize;
+
+        taskENTER_CRITICAL();
+        {
+            if( ( xUsage.xQueueBytes + xBytes ) <= demoSTATIC_QUEUE_BYTES )
+            {
+                pxBuffer = ( StaticQueue_t * ) prvTakeObject( xQueueBuffers, sizeof( StaticQueue_t ), demoSTATIC_MAX_QUEUES, &( xUsage.uxQueues ) );
+            }
+
+            if( pxBuffer != NULL )
+            {
+                pucStorage = &( ucQueueArena[ xUsage.xQueueBytes ] );
+                xUsage.xQueueBytes += xBytes;
+            }
+            else
+            {
+                xUsage.ulFailures++;
+            }
+        }
+        taskEXIT_CRITICAL();
+
+        return ( pxBuffer != NULL ) ? xQueueCreateStatic( uxQueueLength, uxItemSize, pucStorage, pxBuffer ) : NULL;
+    }
+    #else
+    {
+        return xQueueCreate( uxQueueLength, uxItemSize );
+    }
+    #endif
+}
+/*-----------------------------------------------------------*/
+
+void vDemoStaticGetStats( DemoStaticStats_t * pxStats )
+{
+    configASSERT( pxStats );
+
+    #if ( demoSTATIC_ALLOCATION == 1 )
+    {
+        taskENTER_CRITICAL();
+        {
+            *pxStats = xUsage;
+        }
+        taskEXIT_CRITICAL();
+    }
+    #else
+    {
+        memset( pxStats, 0x00, sizeof( DemoStaticStats_t ) );
+    }
+    #endif
+}
+/*-----------------------------------------------------------*/
+
+static void prvRecordStackDepth( TaskHandle_t xTask,
+                                 configSTACK_DEPTH_TYPE uxStackDepth )
+{
+    taskENTER_CRITICAL();
+    {
+        if( uxTaskDepths < demoSTATIC_MAX_TASKS )
+        {
+            xTaskDepths[ uxTaskDepths ].xTask = xTask;
+            xTaskDepths[ uxTaskDepths ].uxStackDepth = uxStackDepth;
+            uxTaskDepths++;
+        }
+    }
+    taskEXIT_CRITICAL();
+}
+/*-----------------------------------------------------------*/
+
+#if ( demoSTATIC_ALLOCATION == 1 )
+
+    static void * prvTakeObject( void * pvArray,
+                                 size_t xObjectSize,
+                                 UBaseType_t uxCount,
+                                 UBaseType_t * puxUsed )
+    {
+        void * pvObject = NULL;
+
+        if( *puxUsed < uxCount )
+        {
+            pvObject = ( void * ) ( ( ( uint8_t * ) pvArray ) + ( *puxUsed * xObjectSize ) );
+            ( *puxUsed )++;
+        }
+
+        return pvObject;
+    }
+    /*-----------------------------------------------------------*/
+
+#endif /* demoSTATIC_ALLOCATION */
+
+#if ( demoSTATIC_ALLOCATION == 1 ) && ( configKERNEL_PROVIDED_STATIC_MEMORY == 0 )
+
+/*
+ * Provide the memory used by the idle task.
+ */
+    void vApplicationGetIdleTaskMemory( StaticTask_t ** ppxIdleTaskTCBBuffer,
+                                        StackType_t ** ppxIdleTaskStackBuffer,
+                                        configSTACK_DEPTH_TYPE * puxIdleTaskStackSize )
+    {
+        static StaticTask_t xIdleTaskTCB;
+        static StackType_t uxIdleTaskStack[ configMINIMAL_STACK_SIZE ];
+
+        *ppxIdleTaskTCBBuffer = &xIdleTaskTCB;
+        *ppxIdleTaskStackBuffer = uxIdleTaskStack;
+        *puxIdleTaskStackSize = configMINIMAL_STACK_SIZE;
+    }
+    /*-----------------------------------------------------------*/
+
+    #if ( configNUMBER_OF_CORES > 1 )
+
+/*
+ * Provide the memory used by the passive idle tasks that run on the other
+ * cores.
+ */
+        void vApplicationGetPassiveIdleTaskMemory( StaticTask_t ** ppxIdleTaskTCBBuffer,
+                                                   StackType_t ** ppxIdleTaskStackBuffer,
+                                                   configSTACK_DEPTH_TYPE * puxIdleTaskStackSize,
+                                                   BaseType_t xPassiveIdleTaskIndex )
+        {
+            static StaticTask_t xIdleTaskTCBs[ configNUMBER_OF_CORES - 1 ];
+            static StackType_t uxIdleTaskStacks[ configNUMBER_OF_CORES - 1 ][ configMINIMAL_STACK_SIZE ];
+
+            *ppxIdleTaskTCBBuffer = &( xIdleTaskTCBs[ xPassiveIdleTaskIndex ] );
+            *ppxIdleTaskStackBuffer = &( uxIdleTaskStacks[ xPassiveIdleTaskIndex ][ 0 ] );
+            *puxIdleTaskStackSize = configMINIMAL_STACK_SIZE;
+        }
+        /*-----------------------------------------------------------*/
+
+    #endif /* configNUMBER_OF_CORES > 1 */
+
+    #if ( configUSE_TIMERS == 1 )
+
+/*
+ * Provide the memory used by the timer service task.
+ */
+        void vApplicationGetTimerTaskMemory( StaticTask_t ** ppxTimerTaskTCBBuffer,
+                                             StackType_t ** ppxTimerTaskStackBuffer,
+                                             configSTACK_DEPTH_TYPE * puxTimerTaskStackSize )
+        {
+            static StaticTask_t xTimerTaskTCB;
+            static StackType_t uxTimerTaskStack[ configTIMER_TASK_STACK_DEPTH ];
+
+            *ppxTimerTaskTCBBuffer = &xTimerTaskTCB;
+            *ppxTimerTaskStackBuffer = uxTimerTaskStack;
+            *puxTimerTaskStackSize = configTIMER_TASK_STACK_DEPTH;
+        }
+        /*-----------------------------------------------------------*/
+
+    #endif /* configUSE_TIMERS */
+
+#endif /* ( demoSTATIC_ALLOCATION == 1 ) && ( configKERNEL_PROVIDED_STATIC_MEMORY == 0 ) */
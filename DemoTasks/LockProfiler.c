@@ -0,0 +1,289 @@
+/*
+ * FreeRTOS V202411.00
+ * Copyright (C) 2020 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * https://www.FreeRTOS.org
+ * https://github.com/FreeRTOS
+ *
+ */
+
+/*
+ * See LockProfiler.h.
+ *
+ * Each registered lock has an entry in a small fixed size array.  The entry is
+ * located by a linear search of the array each time the lock is taken or
+ * given - there are only a few locks so this is cheaper than maintaining
+ * anything more elaborate.  The statistics are updated in short critical
+ * sections so a copy taken by xLockProfilerGetStats() is always consistent,
+ * even though the statistics are read by a different task (normally the CLI
+ * task) to the tasks using the lock.
+ */
+
+/* Standard includes. */
+#include <stdint.h>
+#include <string.h>
+
+/* FreeRTOS includes. */
+#include "FreeRTOS.h"
+#include "task.h"
+#include "semphr.h"
+
+/* Demo app includes. */
+#include "DemoTimestamp.h"
+#include "LockProfiler.h"
+
+/* A registered lock. */
+typedef struct xLOCK_PROFILE
+{
+    LockStats_t xStats;                 /* The statistics that are made available to other tasks. */
+    DemoTimestamp_t xAcquiredAt;        /* When the current holder obtained the lock. */
+    UBaseType_t uxPriorityWhenAcquired; /* The priority of the current holder when it obtained the lock. */
+} LockProfile_t;
+
+/*
+ * Return the entry for xLock, or NULL if xLock has not been registered.
+ */
+static LockProfile_t * prvFindLock( SemaphoreHandle_t xLock );
+
+/*-----------------------------------------------------------*/
+
+static LockProfile_t xLocks[ lockprofMAX_LOCKS ];
+static UBaseType_t uxRegisteredLocks = 0;
+
+/*-----------------------------------------------------------*/
+
+BaseType_t xLockProfilerRegister( SemaphoreHandle_t xLock,
+                                  const char * pcName,
+                                  BaseType_t xIsMutex )
+{
+    BaseType_t xReturn = pdFAIL;
+    LockProfile_t * pxLock;
+
+    configASSERT( xLock );
+
+    taskENTER_CRITICAL();
+    {
+        if( ( uxRegisteredLocks < lockprofMAX_LOCKS ) && ( prvFindLock( xLock ) == NULL ) )
+        {
+            pxLock = &( xLocks[ uxRegisteredLocks ] );
+            memset( ( void * ) pxLock, 0x00, sizeof( *pxLock ) );
+            pxLock->xStats.xLock = xLock;
+            pxLock->xStats.pcName = pcName;
+            pxLock->xStats.xIsMutex = xIsMutex;
+
+            /* Only count the lock once it is fully initialised, so
+             * prvFindLock() never sees a partially initialised entry. */
+            uxRegisteredLocks++;
+            xReturn = pdPASS;
+        }
+    }
+    taskEXIT_CRITICAL();
+
+    return xReturn;
+}
+/*-----------------------------------------------------------*/
+
+BaseType_t xTracedSemaphoreTake( SemaphoreHandle_t xLock,
+                                 TickType_t xTicksToWait )
+{
+    LockProfile_t * pxLock = prvFindLock( xLock );
+    DemoTimestamp_t xStart, xNow;
+    TaskHandle_t xHolder;
+    UBaseType_t uxMyPriority;
+    BaseType_t xReturn, xContended = pdFALSE, xInversion = pdFALSE;
+
+    if( pxLock == NULL )
+    {
+        /* Not a lock that is being profiled. */
+        return xSemaphoreTake( xLock, xTicksToWait );
+    }
+
+    uxMyPriority = uxTaskPriorityGet( NULL );
+    xStart = demoGET_TIMESTAMP();
+
+    /* Try without blocking first, so it is known whether or not this task had
+     * to wait. */
+    xReturn = xSemaphoreTake( xLock, 0 );
+
+    if( xReturn != pdPASS )
+    {
+        xContended = pdTRUE;
+
+        /* If the lock is held by a lower priority task then this task is about
+         * to be delayed by a lower priority task - a priority inversion.  If
+         * the lock is a mutex then the holder will inherit this task's
+         * priority, which xTracedSemaphoreGive() counts separately. */
+        taskENTER_CRITICAL();
+        {
+            xHolder = pxLock->xStats.xHolder;
+
+            if( ( xHolder != NULL ) && ( uxTaskPriorityGet( xHolder ) < uxMyPriority ) )
+            {
+                xInversion = pdTRUE;
+            }
+        }
+        taskEXIT_CRITICAL();
+
+        if( xTicksToWait != 0 )
+        {
+            xReturn = xSemaphoreTake( xLock, xTicksToWait );
+        }
+    }
+
+    xNow = demoGET_TIMESTAMP();
+
+    taskENTER_CRITICAL();
+    {
+        if( xInversion != pdFALSE )
+        {
+            pxLock->xStats.ulInversions++;
+        }
+
+        if( xReturn == pdPASS )
+        {
+            pxLock->xStats.ulAcquisitions++;
+
+            if( xContended != pdFALSE )
+            {
+                pxLock->xStats.ulContended++;
+            }
+
+            vLogHistogramRecord( &( pxLock->xStats.xWaitTime ), demoTIMESTAMP_TO_US( xNow - xStart ) );
+            pxLock->xStats.xHolder = xTaskGetCurrentTaskHandle();
+            pxLock->xAcquiredAt = xNow;
+            pxLock->uxPriorityWhenAcquired = uxMyPriority;
+        }
+        else
+        {
+            pxLock->xStats.ulTimeouts++;
+        }
+    }
+    taskEXIT_CRITICAL();
+
+    return xReturn;
+}
+/*-----------------------------------------------------------*/
+
+BaseType_t xTracedSemaphoreGive( SemaphoreHandle_t xLock )
+{
+    LockProfile_t * pxLock = prvFindLock( xLock );
+    DemoTimestamp_t xNow;
+    UBaseType_t uxMyPriority;
+
+    if( pxLock != NULL )
+    {
+        /* Record the statistics before the lock is given, as the moment it is
+         * given a waiting task can start updating them.  The priority is read
+         * before giving a mutex because giving it disinherits any priority
+         * inherited from the tasks that were waiting. */
+        uxMyPriority = uxTaskPriorityGet( NULL );
+        xNow = demoGET_TIMESTAMP();
+
+        taskENTER_CRITICAL();
+        {
+            if( pxLock->xStats.xHolder == xTaskGetCurrentTaskHandle() )
+            {
+                if( ( pxLock->xStats.xIsMutex != pdFALSE ) && ( uxMyPriority > pxLock->uxPriorityWhenAcquired ) )
+                {
+                    pxLock->xStats.ulInheritances++;
+                }
+
+                vLogHistogramRecord( &( pxLock->xStats.xHoldTime ), demoTIMESTAMP_TO_US( xNow - pxLock->xAcquiredAt ) );
+            }
+
+            pxLock->xStats.xHolder = NULL;
+        }
+        taskEXIT_CRITICAL();
+    }
+
+    return xSemaphoreGive( xLock );
+}
+/*-----------------------------------------------------------*/
+
+UBaseType_t uxLockProfilerGetCount( void )
+{
+    return uxRegisteredLocks;
+}
+/*-----------------------------------------------------------*/
+
+BaseType_t xLockProfilerGetStats( UBaseType_t uxIndex,
+                                  LockStats_t * pxStats )
+{
+    BaseType_t xReturn = pdFAIL;
+
+    configASSERT( pxStats );
+
+    taskENTER_CRITICAL();
+    {
+        if( uxIndex < uxRegisteredLocks )
+        {
+            *pxStats = xLocks[ uxIndex ].xStats;
+            xReturn = pdPASS;
+        }
+    }
+    taskEXIT_CRITICAL();
+
+    return xReturn;
+}
+/*-----------------------------------------------------------*/
+
+void vLockProfilerReset( void )
+{
+    UBaseType_t ux;
+    LockStats_t * pxStats;
+
+    for( ux = 0; ux < uxRegisteredLocks; ux++ )
+    {
+        pxStats = &( xLocks[ ux ].xStats );
+
+        /* The holder is left alone so the current hold time is still
+         * recorded when the lock is given. */
+        taskENTER_CRITICAL();
+        {
+            pxStats->ulAcquisitions = 0;
+            pxStats->ulContended = 0;
+            pxStats->ulTimeouts = 0;
+            pxStats->ulInversions = 0;
+            pxStats->ulInheritances = 0;
+            vLogHistogramReset( &( pxStats->xWaitTime ) );
+            vLogHistogramReset( &( pxStats->xHoldTime ) );
+        }
+        taskEXIT_CRITICAL();
+    }
+}
+/*-----------------------------------------------------------*/
+
+static LockProfile_t * prvFindLock( SemaphoreHandle_t xLock )
+{
+    LockProfile_t * pxReturn = NULL;
+    UBaseType_t ux;
+
+    for( ux = 0; ux < uxRegisteredLocks; ux++ )
+    {
+        if( xLocks[ ux ].xStats.xLock == xLock )
+        {
+            pxReturn = &( xLocks[ ux ] );
+            break;
+        }
+    }
+
+    return pxReturn;
+}
+/*-----------------------------------------------------------*/
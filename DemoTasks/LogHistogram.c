@@ -0,0 +1,199 @@
+/*
+ * FreeRTOS V202411.00
+ * Copyright (C) 2020 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * https://www.FreeRTOS.org
+ * https://github.com/FreeRTOS
+ *
+ */
+
+/*
+ * See LogHistogram.h.
+ */
+
+/* Standard includes. */
+#include <stdint.h>
+#include <string.h>
+
+/* FreeRTOS includes. */
+#include "FreeRTOS.h"
+
+/* Demo app includes. */
+#include "LogHistogram.h"
+
+/*
+ * Return the bucket into which ulValue is counted, which is the number of
+ * significant bits in ulValue.
+ */
+static UBaseType_t prvGetBucket( uint32_t ulValue );
+
+/*-----------------------------------------------------------*/
+
+void vLogHistogramReset( LogHistogram_t * pxHistogram )
+{
+    configASSERT( pxHistogram );
+
+    memset( ( void * ) pxHistogram, 0x00, sizeof( *pxHistogram ) );
+}
+/*-----------------------------------------------------------*/
+
+void vLogHistogramRecord( LogHistogram_t * pxHistogram,
+                          uint32_t ulValue )
+{
+    pxHistogram->ulBuckets[ prvGetBucket( ulValue ) ]++;
+
+    if( ( pxHistogram->ulCount == 0 ) || ( ulValue < pxHistogram->ulMin ) )
+    {
+        pxHistogram->ulMin = ulValue;
+    }
+
+    if( ulValue > pxHistogram->ulMax )
+    {
+        pxHistogram->ulMax = ulValue;
+    }
+
+    pxHistogram->ulCount++;
+    pxHistogram->ullSum += ulValue;
+}
+/*-----------------------------------------------------------*/
+
+uint32_t ulLogHistogramPercentile( const LogHistogram_t * pxHistogram,
+                                   uint32_t ulPerMille )
+{
+    uint64_t ullRank, ullSeen = 0, ullEstimate;
+    uint32_t ulLow, ulHigh, ulReturn = 0;
+    UBaseType_t uxBucket;
+
+    if( pxHistogram->ulCount > 0 )
+    {
+        /* The number of values, counting from the smallest, that are at or
+         * below the wanted percentile, rounded up. */
+        ullRank = ( ( ( uint64_t ) pxHistogram->ulCount * ulPerMille ) + 999ULL ) / 1000ULL;
+
+        if( ullRank == 0 )
+        {
+            ullRank = 1;
+        }
+
+        ulReturn = pxHistogram->ulMax;
+
+        for( uxBucket = 0; uxBucket < histNUM_BUCKETS; uxBucket++ )
+        {
+            if( ( ullSeen + pxHistogram->ulBuckets[ uxBucket ] ) >= ullRank )
+            {
+                /* The percentile falls in this bucket.  Assume the values are
+                 * spread evenly across the bucket. */
+                ulLow = ( uxBucket == 0 ) ? 0UL : ( 1UL << ( uxBucket - 1 ) );
+                ulHigh = ulLogHistogramBucketLimit( uxBucket );
+                ullEstimate = ulLow + ( ( ( uint64_t ) ( ulHigh - ulLow ) * ( ullRank - ullSeen ) ) / pxHistogram->ulBuckets[ uxBucket ] );
+                ulReturn = ( uint32_t ) ullEstimate;
+                break;
+            }
+
+            ullSeen += pxHistogram->ulBuckets[ uxBucket ];
+        }
+
+        if( ulReturn < pxHistogram->ulMin )
+        {
+            ulReturn = pxHistogram->ulMin;
+        }
+        else if( ulReturn > pxHistogram->ulMax )
+        {
+            ulReturn = pxHistogram->ulMax;
+        }
+    }
+
+    return ulReturn;
+}
+/*-----------------------------------------------------------*/
+
+uint32_t ulLogHistogramMean( const LogHistogram_t * pxHistogram )
+{
+    uint32_t ulReturn = 0;
+
+    if( pxHistogram->ulCount > 0 )
+    {
+        ulReturn = ( uint32_t ) ( pxHistogram->ullSum / pxHistogram->ulCount );
+    }
+
+    return ulReturn;
+}
+/*-----------------------------------------------------------*/
+
+uint32_t ulLogHistogramBucketLimit( UBaseType_t uxBucket )
+{
+    uint32_t ulReturn;
+
+    if( uxBucket == 0 )
+    {
+        ulReturn = 0;
+    }
+    else if( uxBucket >= 32 )
+    {
+        ulReturn = 0xffffffffUL;
+    }
+    else
+    {
+        ulReturn = ( 1UL << uxBucket ) - 1UL;
+    }
+
+    return ulReturn;
+}
+/*-----------------------------------------------------------*/
+
+static UBaseType_t prvGetBucket( uint32_t ulValue )
+{
+    UBaseType_t uxBits = 0;
+
+    /* Find the number of significant bits with a binary search, so the cost
+     * is the same for every value. */
+    if( ulValue >= 0x10000UL )
+    {
+        ulValue >>= 16;
+        uxBits += 16;
+    }
+
+    if( ulValue >= 0x100UL )
+    {
+        ulValue >>= 8;
+        uxBits += 8;
+    }
+
+    if( ulValue >= 0x10UL )
+    {
+        ulValue >>= 4;
+        uxBits += 4;
+    }
+
+    if( ulValue >= 0x4UL )
+    {
+        ulValue >>= 2;
+        uxBits += 2;
+    }
+
+    if( ulValue >= 0x2UL )
+    {
+        ulValue >>= 1;
+        uxBits += 1;
+    }
+
+    return uxBits + ulValue;
+}
+/*-----------------------------------------------------------*/
@@ -0,0 +1,660 @@
+/*
+ * FreeRTOS V202411.00
+ * Copyright (C) 2020 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * https://www.FreeRTOS.org
+ * https://github.com/FreeRTOS
+ *
+ */
+/*
+ * See MetricsServer.h.
+ *
+ * A single task owns the socket.  It waits for requests with a receive
+ * timeout that ends when the next push is due, so it only wakes to answer a
+ * poll or to push.  Each reply is built in one static buffer from copies of
+ * the statistics taken by the modules' own get functions, so nothing is held
+ * while the reply is formatted or sent.
+ */
+
+/* Standard includes. */
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdarg.h>
+#include <string.h>
+
+/* FreeRTOS includes. */
+#include "FreeRTOS.h"
+#include "task.h"
+#include "queue.h"
+#include "semphr.h"
+
+/* FreeRTOS+UDP includes. */
+#include "FreeRTOS_IP.h"
+#include "FreeRTOS_Sockets.h"
+
+/* Demo app includes. */
+#include "DemoStatic.h"
+#include "LockProfiler.h"
+#include "StackAuditor.h"
+#include "TwoEchoClients.h"
+#include "MetricsServer.h"
+
+/* The sections a reply can contain.  Bit n is selected by the n'th letter of
+ * pcSectionLetters. */
+#define metricsSECTION_TASKS      ( 1UL << 0 )
+#define metricsSECTION_STACKS     ( 1UL << 1 )
+#define metricsSECTION_LOCKS      ( 1UL << 2 )
+#define metricsSECTION_NETWORK    ( 1UL << 3 )
+#define metricsSECTION_ECHO       ( 1UL << 4 )
+#define metricsALL_SECTIONS       ( ( 1UL << 5 ) - 1UL )
+
+/* Space kept free for the "end" line, the longest of which is
+ * "end lines=4294967295 dropped=4294967295\n". */
+#define metricsEND_LINE_RESERVE    40
+
+/* The longest request, and the longest line of a reply. */
+#define metricsMAX_REQUEST_LENGTH    32
+#define metricsMAX_LINE_LENGTH       160
+
+/* The most IP stack debug counters that are included in the "n" records. */
+#define metricsMAX_DEBUG_STATS    32
+
+/* pdTRUE if xTime is not in the future, allowing for the tick count
+ * wrapping. */
+#define metricsTIME_REACHED( xNow, xTime )    ( ( TickType_t ) ( ( xNow ) - ( xTime ) ) < ( portMAX_DELAY / 2 ) )
+
+/* A collector that has asked for the metrics to be pushed to it. */
+typedef struct xMETRICS_SUBSCRIBER
+{
+    BaseType_t xInUse;                /* pdTRUE if the entry is in use. */
+    struct freertos_sockaddr xClient; /* Where the metrics are pushed to. */
+    uint32_t ulSections;              /* The sections pushed. */
+    TickType_t xInterval;             /* The time between pushes. */
+    TickType_t xNextPush;             /* When the next push is due. */
+    TickType_t xLeaseEnds;            /* When the subscription lapses unless it is renewed. */
+} MetricsSubscriber_t;
+
+/* The reply being built in cReply[]. */
+typedef struct xMETRICS_REPLY
+{
+    size_t xUsed;       /* The bytes of cReply[] used so far. */
+    uint32_t ulLines;   /* The lines added. */
+    uint32_t ulDropped; /* The lines that did not fit. */
+} MetricsReply_t;
+
+/*
+ * The task that owns the socket.
+ */
+static void prvMetricsServerTask( void * pvParameters );
+
+/*
+ * Create a UDP socket bound to usPort.
+ */
+static Socket_t prvOpenMetricsSocket( uint16_t usPort );
+
+/*
+ * Answer the request in pcRequest, which came from pxClient.
+ */
+static void prvHandleRequest( Socket_t xSocket,
+                              const char * pcRequest,
+                              const struct freertos_sockaddr * pxClient );
+
+/*
+ * Send a reply to every subscriber whose push is due, and drop subscriptions
+ * whose lease has ended.  Returns the time until the next push is due.
+ */
+static TickType_t prvSendPushes( Socket_t xSocket );
+
+/*
+ * Build a reply containing ulSections in cReply[], returning its length.
+ */
+static size_t prvBuildReply( uint32_t ulSections );
+
+/*
+ * Append one printf() style line to the reply, or count it as dropped if it
+ * does not fit.
+ */
+static void prvAppendLine( MetricsReply_t * pxReply,
+                           const char * pcFormat,
+                           ... );
+
+/*
+ * Copy the name pcName into pcBuffer with spaces replaced by '_', so it is a
+ * single field of a record.
+ */
+static const char * prvFieldName( char * pcBuffer,
+                                  size_t xBufferLength,
+                                  const char * pcName );
+
+/*
+ * Convert a string of section letters into a mask of metricsSECTION_ bits.
+ * Returns pdFALSE if the string contains any other character.
+ */
+static BaseType_t prvParseSections( const char * pcLetters,
+                                    uint32_t * pulSections );
+
+/*
+ * Return pdTRUE if both addresses refer to the same IP address and port.
+ */
+static BaseType_t prvSameClient( const struct freertos_sockaddr * pxA,
+                                 const struct freertos_sockaddr * pxB );
+
+/*-----------------------------------------------------------*/
+
+static const char * const pcSectionLetters = "tslne";
+
+static MetricsSubscriber_t xSubscribers[ metricsMAX_SUBSCRIBERS ];
+
+/* The reply, and the copies of the statistics it is built from, are static as
+ * they are too large for the task's stack. */
+static char cReply[ metricsMAX_PAYLOAD ];
+static TaskStatus_t xTaskSnapshot[ metricsMAX_TASKS ];
+static LockStats_t xLockSnapshot;
+static EchoBenchResult_t xEchoSnapshot[ 2 ];
+
+/* Counters included in the header line. */
+static uint32_t ulReplies = 0, ulPolls = 0, ulPushes = 0;
+
+/*-----------------------------------------------------------*/
+
+void vStartMetricsServerTask( uint16_t usStackSize,
+                              uint32_t ulPort,
+                              UBaseType_t uxPriority )
+{
+    demoTASK_MEMORY( xMetricsMemory, 1, demoSTATIC_TASK_STACK_DEPTH );
+
+    /* The port number is passed in the task parameter. */
+    xDemoTaskCreate( prvMetricsServerTask, "Metrics", usStackSize, ( void * ) ulPort, uxPriority, NULL, &xMetricsMemory );
+}
+/*-----------------------------------------------------------*/
+
+static void prvMetricsServerTask( void * pvParameters )
+{
+    static char cRequest[ metricsMAX_REQUEST_LENGTH ];
+    struct freertos_sockaddr xClient;
+    socklen_t xClientAddressLength = sizeof( xClient );
+    Socket_t xSocket;
+    TickType_t xTimeout;
+    int32_t lBytes;
+    uint16_t usPort;
+
+    /* The strange casting is to remove compiler warnings on 32-bit
+     * machines. */
+    usPort = ( uint16_t ) ( ( ( uint32_t ) pvParameters ) & 0xffffUL );
+    xSocket = prvOpenMetricsSocket( usPort );
+
+    while( xSocket == FREERTOS_INVALID_SOCKET )
+    {
+        /* For example because the port is already in use.  Nothing else
+         * depends on the metrics server, so the rest of the demo carries on
+         * without it while it waits to try again.  The task is not deleted as
+         * it was created by xDemoTaskCreate(). */
+        FreeRTOS_debug_printf( ( "Metrics server: could not open UDP port %u, trying again in %u ms\r\n", ( unsigned ) usPort, ( unsigned ) metricsOPEN_RETRY_DELAY_MS ) );
+        vTaskDelay( pdMS_TO_TICKS( metricsOPEN_RETRY_DELAY_MS ) );
+        xSocket = prvOpenMetricsSocket( usPort );
+    }
+
+    for( ; ; )
+    {
+        /* Wake for the next request, or when the next push is due. */
+        xTimeout = prvSendPushes( xSocket );
+        FreeRTOS_setsockopt( xSocket, 0, FREERTOS_SO_RCVTIMEO, &xTimeout, sizeof( xTimeout ) );
+
+        lBytes = FreeRTOS_recvfrom( xSocket, ( void * ) cRequest, sizeof( cRequest ) - 1, 0, &xClient, &xClientAddressLength );
+
+        if( lBytes > 0 )
+        {
+            cRequest[ lBytes ] = 0x00;
+            prvHandleRequest( xSocket, cRequest, &xClient );
+        }
+    }
+}
+/*-----------------------------------------------------------*/
+
+static void prvHandleRequest( Socket_t xSocket,
+                              const char * pcRequest,
+                              const struct freertos_sockaddr * pxClient )
+{
+    char cCommand[ 8 ], cArgument1[ 12 ], cArgument2[ 12 ];
+    const char * pcSections = NULL, * pcReply = NULL;
+    BaseType_t xIsError = pdFALSE;
+    MetricsSubscriber_t * pxSubscriber = NULL;
+    uint32_t ulSections = metricsALL_SECTIONS, ulIntervalMs = 0;
+    size_t xLength;
+    int iFields;
+    UBaseType_t ux;
+
+    iFields = sscanf( pcRequest, "%7s %11s %11s", cCommand, cArgument1, cArgument2 );
+
+    if( ( iFields >= 1 ) && ( strcmp( cCommand, "poll" ) == 0 ) && ( iFields <= 2 ) )
+    {
+        pcSections = ( iFields == 2 ) ? cArgument1 : NULL;
+    }
+    else if( ( iFields >= 2 ) && ( strcmp( cCommand, "push" ) == 0 ) )
+    {
+        ulIntervalMs = ( uint32_t ) strtoul( cArgument1, NULL, 10 );
+        pcSections = ( iFields == 3 ) ? cArgument2 : NULL;
+
+        if( ( ulIntervalMs != 0 ) && ( ulIntervalMs < metricsMIN_PUSH_INTERVAL_MS ) )
+        {
+            pcReply = "err interval\n";
+            xIsError = pdTRUE;
+        }
+    }
+    else
+    {
+        pcReply = "err request\n";
+        xIsError = pdTRUE;
+    }
+
+    if( ( xIsError == pdFALSE ) && ( pcSections != NULL ) && ( prvParseSections( pcSections, &ulSections ) == pdFALSE ) )
+    {
+        pcReply = "err sections\n";
+        xIsError = pdTRUE;
+    }
+
+    if( ( xIsError == pdFALSE ) && ( strcmp( cCommand, "push" ) == 0 ) )
+    {
+        /* A collector renews its subscription by sending the same request
+         * again, so look for its existing entry first. */
+        for( ux = 0; ux < metricsMAX_SUBSCRIBERS; ux++ )
+        {
+            if( ( xSubscribers[ ux ].xInUse != pdFALSE ) && ( prvSameClient( &( xSubscribers[ ux ].xClient ), pxClient ) != pdFALSE ) )
+            {
+                pxSubscriber = &( xSubscribers[ ux ] );
+                break;
+            }
+        }
+
+        for( ux = 0; ( ux < metricsMAX_SUBSCRIBERS ) && ( pxSubscriber == NULL ) && ( ulIntervalMs != 0 ); ux++ )
+        {
+            if( xSubscribers[ ux ].xInUse == pdFALSE )
+            {
+                pxSubscriber = &( xSubscribers[ ux ] );
+            }
+        }
+
+        if( ulIntervalMs == 0 )
+        {
+            if( pxSubscriber != NULL )
+            {
+                pxSubscriber->xInUse = pdFALSE;
+            }
+
+            pcReply = "ok\n";
+        }
+        else if( pxSubscriber == NULL )
+        {
+            pcReply = "err full\n";
+            xIsError = pdTRUE;
+        }
+        else
+        {
+            /* The reply to the request is the first push. */
+            pxSubscriber->xInUse = pdTRUE;
+            pxSubscriber->xClient = *pxClient;
+            pxSubscriber->ulSections = ulSections;
+            pxSubscriber->xInterval = pdMS_TO_TICKS( ulIntervalMs );
+            pxSubscriber->xNextPush = xTaskGetTickCount() + pxSubscriber->xInterval;
+            pxSubscriber->xLeaseEnds = xTaskGetTickCount() + pdMS_TO_TICKS( metricsPUSH_LEASE_MS );
+        }
+    }
+
+    if( pcReply != NULL )
+    {
+        /* An error, or the acknowledgement of a push request that ended a
+         * subscription, which is answered with a short reply rather than
+         * with the metrics. */
+        FreeRTOS_sendto( xSocket, ( const void * ) pcReply, strlen( pcReply ), 0, pxClient, sizeof( *pxClient ) );
+    }
+    else
+    {
+        if( strcmp( cCommand, "poll" ) == 0 )
+        {
+            ulPolls++;
+        }
+        else
+        {
+            /* The reply to a push request is its first push. */
+            ulPushes++;
+        }
+
+        xLength = prvBuildReply( ulSections );
+        FreeRTOS_sendto( xSocket, ( const void * ) cReply, xLength, 0, pxClient, sizeof( *pxClient ) );
+    }
+}
+/*-----------------------------------------------------------*/
+
+static TickType_t prvSendPushes( Socket_t xSocket )
+{
+    TickType_t xNow, xWait = portMAX_DELAY, xUntilNext;
+    MetricsSubscriber_t * pxSubscriber;
+    size_t xLength;
+    UBaseType_t ux;
+
+    for( ux = 0; ux < metricsMAX_SUBSCRIBERS; ux++ )
+    {
+        pxSubscriber = &( xSubscribers[ ux ] );
+        xNow = xTaskGetTickCount();
+
+        if( pxSubscriber->xInUse == pdFALSE )
+        {
+            continue;
+        }
+
+        if( metricsTIME_REACHED( xNow, pxSubscriber->xLeaseEnds ) )
+        {
+            pxSubscriber->xInUse = pdFALSE;
+            continue;
+        }
+
+        if( metricsTIME_REACHED( xNow, pxSubscriber->xNextPush ) )
+        {
+            ulPushes++;
+            xLength = prvBuildReply( pxSubscriber->ulSections );
+            FreeRTOS_sendto( xSocket, ( const void * ) cReply, xLength, 0, &( pxSubscriber->xClient ), sizeof( pxSubscriber->xClient ) );
+
+            /* Keep to the interval without drift, unless a push was missed
+             * altogether, in which case start again from now. */
+            pxSubscriber->xNextPush += pxSubscriber->xInterval;
+
+            if( metricsTIME_REACHED( xNow, pxSubscriber->xNextPush ) )
+            {
+                pxSubscriber->xNextPush = xNow + pxSubscriber->xInterval;
+            }
+        }
+
+        xUntilNext = pxSubscriber->xNextPush - xNow;
+
+        if( xUntilNext < xWait )
+        {
+            xWait = xUntilNext;
+        }
+    }
+
+    return xWait;
+}
+/*-----------------------------------------------------------*/
+
+static size_t prvBuildReply( uint32_t ulSections )
+{
+    MetricsReply_t xReply = { 0 };
+    configRUN_TIME_COUNTER_TYPE ulTotalRunTime = 0;
+    UBaseType_t uxTasks = 0, ux;
+    StackAuditEntry_t xStackEntry;
+    char cName[ configMAX_TASK_NAME_LEN ], cLockName[ 24 ];
+
+    #if ( configINCLUDE_DEMO_DEBUG_STATS != 0 )
+        static uint32_t ulDebugValues[ metricsMAX_DEBUG_STATS ];
+        extern xExampleDebugStatEntry_t xIPTraceValues[];
+        char cCounterName[ 48 ];
+        portBASE_TYPE x, xEntries;
+    #endif
+
+    /* The task snapshot is taken first so the header can give the total run
+     * time the task run times belong to. */
+    if( ( ulSections & metricsSECTION_TASKS ) != 0 )
+    {
+        /* Returns 0 if there are more than metricsMAX_TASKS tasks, which is
+         * reported after the header rather than silently sending no "t"
+         * records. */
+        uxTasks = uxTaskGetSystemState( xTaskSnapshot, metricsMAX_TASKS, &ulTotalRunTime );
+    }
+    else
+    {
+        #if ( configGENERATE_RUN_TIME_STATS == 1 )
+            ulTotalRunTime = ( configRUN_TIME_COUNTER_TYPE ) portGET_RUN_TIME_COUNTER_VALUE();
+        #endif
+    }
+
+    ulReplies++;
+    prvAppendLine( &xReply, "m1 seq=%u up=%u rt=%llu polls=%u pushes=%u\n",
+                   ( unsigned ) ulReplies,
+                   ( unsigned ) pdTICKS_TO_MS( xTaskGetTickCount() ),
+                   ( unsigned long long ) ulTotalRunTime,
+                   ( unsigned ) ulPolls,
+                   ( unsigned ) ulPushes );
+
+    if( ( ( ulSections & metricsSECTION_TASKS ) != 0 ) && ( uxTasks == 0 ) )
+    {
+        prvAppendLine( &xReply, "tover tasks=%u max=%u\n",
+                       ( unsigned ) uxTaskGetNumberOfTasks(),
+                       ( unsigned ) metricsMAX_TASKS );
+    }
+
+    for( ux = 0; ux < uxTasks; ux++ )
+    {
+        prvAppendLine( &xReply, "t %s rt=%llu pri=%u hw=%u\n",
+                       prvFieldName( cName, sizeof( cName ), xTaskSnapshot[ ux ].pcTaskName ),
+                       ( unsigned long long ) xTaskSnapshot[ ux ].ulRunTimeCounter,
+                       ( unsigned ) xTaskSnapshot[ ux ].uxCurrentPriority,
+                       ( unsigned ) xTaskSnapshot[ ux ].usStackHighWaterMark );
+    }
+
+    if( ( ulSections & metricsSECTION_STACKS ) != 0 )
+    {
+        for( ux = 0; xStackAuditorGetEntry( ux, &xStackEntry ) != pdFALSE; ux++ )
+        {
+            if( xStackEntry.xDeleted == pdFALSE )
+            {
+                prvAppendLine( &xReply, "s %s min=%u depth=%u rec=%u\n",
+                               prvFieldName( cName, sizeof( cName ), xStackEntry.cName ),
+                               ( unsigned ) xStackEntry.uxMinHighWater,
+                               ( unsigned ) xStackEntry.uxStackDepth,
+                               ( unsigned ) xStackEntry.uxRecommended );
+            }
+        }
+    }
+
+    if( ( ulSections & metricsSECTION_LOCKS ) != 0 )
+    {
+        for( ux = 0; xLockProfilerGetStats( ux, &xLockSnapshot ) != pdFAIL; ux++ )
+        {
+            prvAppendLine( &xReply, "l %s acq=%u cont=%u to=%u inv=%u inh=%u w99=%u wmax=%u h99=%u hmax=%u\n",
+                           prvFieldName( cLockName, sizeof( cLockName ), xLockSnapshot.pcName ),
+                           ( unsigned ) xLockSnapshot.ulAcquisitions,
+                           ( unsigned ) xLockSnapshot.ulContended,
+                           ( unsigned ) xLockSnapshot.ulTimeouts,
+                           ( unsigned ) xLockSnapshot.ulInversions,
+                           ( unsigned ) xLockSnapshot.ulInheritances,
+                           ( unsigned ) ulLogHistogramPercentile( &( xLockSnapshot.xWaitTime ), 990 ),
+                           ( unsigned ) xLockSnapshot.xWaitTime.ulMax,
+                           ( unsigned ) ulLogHistogramPercentile( &( xLockSnapshot.xHoldTime ), 990 ),
+                           ( unsigned ) xLockSnapshot.xHoldTime.ulMax );
+        }
+    }
+
+    #if ( configINCLUDE_DEMO_DEBUG_STATS != 0 )
+    {
+        if( ( ulSections & metricsSECTION_NETWORK ) != 0 )
+        {
+            xEntries = xExampleDebugStatEntries();
+
+            if( xEntries > metricsMAX_DEBUG_STATS )
+            {
+                xEntries = metricsMAX_DEBUG_STATS;
+            }
+
+            /* As per the ip-debug-stats command, copy the values all at once
+             * so they are consistent with each other. */
+            taskENTER_CRITICAL();
+            {
+                for( x = 0; x < xEntries; x++ )
+                {
+                    ulDebugValues[ x ] = xIPTraceValues[ x ].ulData;
+                }
+            }
+            taskEXIT_CRITICAL();
+
+            for( x = 0; x < xEntries; x++ )
+            {
+                prvAppendLine( &xReply, "n %s %u\n",
+                               prvFieldName( cCounterName, sizeof( cCounterName ), ( const char * ) xIPTraceValues[ x ].pucDescription ),
+                               ( unsigned ) ulDebugValues[ x ] );
+            }
+        }
+    }
+    #endif /* configINCLUDE_DEMO_DEBUG_STATS */
+
+    if( ( ulSections & metricsSECTION_ECHO ) != 0 )
+    {
+        ( void ) xEchoBenchGetResults( &( xEchoSnapshot[ 0 ] ), &( xEchoSnapshot[ 1 ] ) );
+
+        for( ux = 0; ux < 2; ux++ )
+        {
+            /* Only phases that have been run have results. */
+            if( xEchoSnapshot[ ux ].ulSent > 0 )
+            {
+                prvAppendLine( &xReply, "e %s bytes=%u sent=%u recv=%u lost=%u late=%u err=%u p50=%u p99=%u max=%u\n",
+                               ( ux == 0 ) ? "copy" : "zcopy",
+                               ( unsigned ) xEchoSnapshot[ ux ].ulPayloadBytes,
+                               ( unsigned ) xEchoSnapshot[ ux ].ulSent,
+                               ( unsigned ) xEchoSnapshot[ ux ].ulReceived,
+                               ( unsigned ) xEchoSnapshot[ ux ].ulLost,
+                               ( unsigned ) xEchoSnapshot[ ux ].ulLate,
+                               ( unsigned ) xEchoSnapshot[ ux ].ulErroneous,
+                               ( unsigned ) ulLogHistogramPercentile( &( xEchoSnapshot[ ux ].xRoundTrip ), 500 ),
+                               ( unsigned ) ulLogHistogramPercentile( &( xEchoSnapshot[ ux ].xRoundTrip ), 990 ),
+                               ( unsigned ) xEchoSnapshot[ ux ].xRoundTrip.ulMax );
+            }
+        }
+    }
+
+    /* Space for the end line was kept free, so it always fits. */
+    xReply.xUsed += ( size_t ) snprintf( &( cReply[ xReply.xUsed ] ), sizeof( cReply ) - xReply.xUsed, "end lines=%u dropped=%u\n",
+                                         ( unsigned ) ( xReply.ulLines + 1 ),
+                                         ( unsigned ) xReply.ulDropped );
+
+    return xReply.xUsed;
+}
+/*-----------------------------------------------------------*/
+
+static void prvAppendLine( MetricsReply_t * pxReply,
+                           const char * pcFormat,
+                           ... )
+{
+    char cLine[ metricsMAX_LINE_LENGTH ];
+    va_list xArguments;
+    int iLength;
+
+    va_start( xArguments, pcFormat );
+    iLength = vsnprintf( cLine, sizeof( cLine ), pcFormat, xArguments );
+    va_end( xArguments );
+
+    if( ( iLength > 0 ) &&
+        ( ( size_t ) iLength < sizeof( cLine ) ) &&
+        ( ( pxReply->xUsed + ( size_t ) iLength + metricsEND_LINE_RESERVE ) <= sizeof( cReply ) ) )
+    {
+        memcpy( &( cReply[ pxReply->xUsed ] ), cLine, ( size_t ) iLength );
+        pxReply->xUsed += ( size_t ) iLength;
+        pxReply->ulLines++;
+    }
+    else
+    {
+        pxReply->ulDropped++;
+    }
+}
+/*-----------------------------------------------------------*/
+
+static const char * prvFieldName( char * pcBuffer,
+                                  size_t xBufferLength,
+                                  const char * pcName )
+{
+    size_t x;
+
+    for( x = 0; ( x < ( xBufferLength - 1 ) ) && ( pcName[ x ] != 0x00 ); x++ )
+    {
+        pcBuffer[ x ] = ( pcName[ x ] == ' ' ) ? '_' : pcName[ x ];
+    }
+
+    /* A record's name field must not be empty. */
+    if( x == 0 )
+    {
+        pcBuffer[ x++ ] = '_';
+    }
+
+    pcBuffer[ x ] = 0x00;
+
+    return pcBuffer;
+}
+/*-----------------------------------------------------------*/
+
+static BaseType_t prvParseSections( const char * pcLetters,
+                                    uint32_t * pulSections )
+{
+    const char * pcFound;
+
+    *pulSections = 0;
+
+    for( ; *pcLetters != 0x00; pcLetters++ )
+    {
+        pcFound = strchr( pcSectionLetters, *pcLetters );
+
+        if( pcFound == NULL )
+        {
+            return pdFALSE;
+        }
+
+        *pulSections |= 1UL << ( pcFound - pcSectionLetters );
+    }
+
+    return pdTRUE;
+}
+/*-----------------------------------------------------------*/
+
+static BaseType_t prvSameClient( const struct freertos_sockaddr * pxA,
+                                 const struct freertos_sockaddr * pxB )
+{
+    #if defined( ipconfigIPv4_BACKWARD_COMPATIBLE ) && ( ipconfigIPv4_BACKWARD_COMPATIBLE == 0 )
+        return ( ( pxA->sin_address.ulIP_IPv4 == pxB->sin_address.ulIP_IPv4 ) && ( pxA->sin_port == pxB->sin_port ) ) ? pdTRUE : pdFALSE;
+    #else
+        return ( ( pxA->sin_addr == pxB->sin_addr ) && ( pxA->sin_port == pxB->sin_port ) ) ? pdTRUE : pdFALSE;
+    #endif /* defined( ipconfigIPv4_BACKWARD_COMPATIBLE ) && ( ipconfigIPv4_BACKWARD_COMPATIBLE == 0 ) */
+}
+/*-----------------------------------------------------------*/
+
+static Socket_t prvOpenMetricsSocket( uint16_t usPort )
+{
+    struct freertos_sockaddr xServer;
+    Socket_t xSocket = FREERTOS_INVALID_SOCKET;
+
+    xSocket = FreeRTOS_socket( FREERTOS_AF_INET, FREERTOS_SOCK_DGRAM, FREERTOS_IPPROTO_UDP );
+
+    if( xSocket != FREERTOS_INVALID_SOCKET )
+    {
+        /* Zero out the server structure. */
+        memset( ( void * ) &xServer, 0x00, sizeof( xServer ) );
+
+        /* Set family and port. */
+        xServer.sin_port = FreeRTOS_htons( usPort );
+        xServer.sin_family = FREERTOS_AF_INET;
+
+        /* Bind the address to the socket. */
+        if( FreeRTOS_bind( xSocket, &xServer, sizeof( xServer ) ) == -1 )
+        {
+            FreeRTOS_closesocket( xSocket );
+            xSocket = FREERTOS_INVALID_SOCKET;
+        }
+    }
+
+    return xSocket;
+}
+/*-----------------------------------------------------------*/
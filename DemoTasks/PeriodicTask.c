@@ -0,0 +1,322 @@
+/*
+ * FreeRTOS V202411.00
+ * Copyright (C) 2020 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * https://www.FreeRTOS.org
+ * https://github.com/FreeRTOS
+ *
+ */
+
+/*
+ * See PeriodicTask.h.
+ *
+ * Each periodic task has an entry in a small fixed size array, which is located
+ * by a linear search using the task's handle.  Only the owning task writes to
+ * an entry, other than to clear its statistics, but the statistics are read by
+ * other tasks so are updated in short critical sections.
+ *
+ * vPeriodicTaskWaitForRelease() is built from the same vPeriodicTaskEndJob()
+ * and vPeriodicTaskStartJob() calls that are available to tasks that time
+ * their own releases, so both kinds of task are measured the same way.
+ */
+
+/* Standard includes. */
+#include <stdint.h>
+#include <string.h>
+
+/* FreeRTOS includes. */
+#include "FreeRTOS.h"
+#include "task.h"
+
+/* Demo app includes. */
+#include "DemoTimestamp.h"
+#include "PeriodicTask.h"
+
+/* A periodic task. */
+typedef struct xPERIODIC_TASK
+{
+    PeriodicTaskStats_t xStats;  /* The statistics that are made available to other tasks. */
+    TickType_t xRelease;         /* The release time of the current job. */
+    TickType_t xCompleted;       /* The tick at which the previous job completed. */
+    BaseType_t xJobRunning;      /* pdTRUE from a job starting to it completing. */
+    BaseType_t xHasCompleted;    /* pdTRUE once a job has completed. */
+    DemoTimestamp_t xStarted;    /* When the current job started. */
+    uint32_t ulStartLatencyUs;   /* The start latency of the current job. */
+} PeriodicTask_t;
+
+/*
+ * Return the entry for xTask, or NULL if xTask is not a periodic task.
+ */
+static PeriodicTask_t * prvFindTask( TaskHandle_t xTask );
+
+/*-----------------------------------------------------------*/
+
+static PeriodicTask_t xTasks[ periodicMAX_TASKS ];
+static UBaseType_t uxTasks = 0;
+
+/* Convert a number of ticks to microseconds. */
+#define periodicTICKS_TO_US( xTicks )    ( ( uint32_t ) ( ( ( uint64_t ) ( xTicks ) * 1000000ULL ) / ( uint64_t ) configTICK_RATE_HZ ) )
+
+/*-----------------------------------------------------------*/
+
+BaseType_t xPeriodicTaskInit( TickType_t xPeriod,
+                              TickType_t xDeadline )
+{
+    BaseType_t xReturn = pdFAIL;
+
+    /* Only the calling task can add itself, so the entry can not appear
+     * between the search and the registration. */
+    if( prvFindTask( xTaskGetCurrentTaskHandle() ) == NULL )
+    {
+        xReturn = xPeriodicTaskRegister( xPeriod, xDeadline );
+
+        if( xReturn == pdPASS )
+        {
+            /* The first job is released now and starts straight away. */
+            vPeriodicTaskStartJob( xTaskGetTickCount() );
+        }
+    }
+
+    return xReturn;
+}
+/*-----------------------------------------------------------*/
+
+BaseType_t xPeriodicTaskRegister( TickType_t xPeriod,
+                                  TickType_t xDeadline )
+{
+    BaseType_t xReturn = pdFAIL;
+    PeriodicTask_t * pxTask;
+
+    configASSERT( xPeriod > 0 );
+
+    taskENTER_CRITICAL();
+    {
+        pxTask = prvFindTask( xTaskGetCurrentTaskHandle() );
+
+        if( pxTask != NULL )
+        {
+            pxTask->xStats.xPeriod = xPeriod;
+            pxTask->xStats.xDeadline = ( xDeadline != 0 ) ? xDeadline : xPeriod;
+            xReturn = pdPASS;
+        }
+        else if( uxTasks < periodicMAX_TASKS )
+        {
+            pxTask = &( xTasks[ uxTasks ] );
+            memset( ( void * ) pxTask, 0x00, sizeof( *pxTask ) );
+            pxTask->xStats.xTask = xTaskGetCurrentTaskHandle();
+            pxTask->xStats.xPeriod = xPeriod;
+            pxTask->xStats.xDeadline = ( xDeadline != 0 ) ? xDeadline : xPeriod;
+            vLogHistogramReset( &( pxTask->xStats.xStartLatency ) );
+            vLogHistogramReset( &( pxTask->xStats.xResponseTime ) );
+
+            /* Only count the task once it is fully initialised, so
+             * prvFindTask() never sees a partially initialised entry. */
+            uxTasks++;
+            xReturn = pdPASS;
+        }
+    }
+    taskEXIT_CRITICAL();
+
+    return xReturn;
+}
+/*-----------------------------------------------------------*/
+
+void vPeriodicTaskStartJob( TickType_t xRelease )
+{
+    PeriodicTask_t * pxTask = prvFindTask( xTaskGetCurrentTaskHandle() );
+    BaseType_t xLate = pdFALSE;
+
+    if( pxTask == NULL )
+    {
+        return;
+    }
+
+    pxTask->xStarted = demoGET_TIMESTAMP();
+    pxTask->ulStartLatencyUs = periodicTICKS_TO_US( xTaskGetTickCount() - xRelease );
+    pxTask->xRelease = xRelease;
+    pxTask->xJobRunning = pdTRUE;
+
+    /* True if the previous job completed at or after this job's release,
+     * allowing for the tick count overflowing. */
+    if( ( pxTask->xHasCompleted != pdFALSE ) &&
+        ( ( TickType_t ) ( pxTask->xCompleted - xRelease ) < ( portMAX_DELAY >> 1 ) ) )
+    {
+        xLate = pdTRUE;
+    }
+
+    taskENTER_CRITICAL();
+    {
+        pxTask->xStats.ulReleases++;
+        vLogHistogramRecord( &( pxTask->xStats.xStartLatency ), pxTask->ulStartLatencyUs );
+
+        if( xLate != pdFALSE )
+        {
+            pxTask->xStats.ulLateReleases++;
+        }
+    }
+    taskEXIT_CRITICAL();
+}
+/*-----------------------------------------------------------*/
+
+void vPeriodicTaskEndJob( void )
+{
+    PeriodicTask_t * pxTask = prvFindTask( xTaskGetCurrentTaskHandle() );
+    uint32_t ulResponseUs;
+
+    if( ( pxTask == NULL ) || ( pxTask->xJobRunning == pdFALSE ) )
+    {
+        return;
+    }
+
+    ulResponseUs = pxTask->ulStartLatencyUs + demoTIMESTAMP_TO_US( demoGET_TIMESTAMP() - pxTask->xStarted );
+    pxTask->xCompleted = xTaskGetTickCount();
+    pxTask->xHasCompleted = pdTRUE;
+    pxTask->xJobRunning = pdFALSE;
+
+    taskENTER_CRITICAL();
+    {
+        vLogHistogramRecord( &( pxTask->xStats.xResponseTime ), ulResponseUs );
+
+        if( ulResponseUs > periodicTICKS_TO_US( pxTask->xStats.xDeadline ) )
+        {
+            pxTask->xStats.ulMisses++;
+        }
+    }
+    taskEXIT_CRITICAL();
+}
+/*-----------------------------------------------------------*/
+
+void vPeriodicTaskWaitForRelease( void )
+{
+    PeriodicTask_t * pxTask = prvFindTask( xTaskGetCurrentTaskHandle() );
+
+    if( pxTask == NULL )
+    {
+        return;
+    }
+
+    vPeriodicTaskEndJob();
+
+    /* Updates xRelease to the release time of the next job, returning without
+     * blocking if that time has already passed. */
+    ( void ) xTaskDelayUntil( &( pxTask->xRelease ), pxTask->xStats.xPeriod );
+
+    vPeriodicTaskStartJob( pxTask->xRelease );
+}
+/*-----------------------------------------------------------*/
+
+UBaseType_t uxPeriodicTaskGetCount( void )
+{
+    return uxTasks;
+}
+/*-----------------------------------------------------------*/
+
+BaseType_t xPeriodicTaskGetStats( UBaseType_t uxIndex,
+                                  PeriodicTaskStats_t * pxStats )
+{
+    BaseType_t xReturn = pdFAIL;
+
+    configASSERT( pxStats );
+
+    taskENTER_CRITICAL();
+    {
+        if( uxIndex < uxTasks )
+        {
+            *pxStats = xTasks[ uxIndex ].xStats;
+            xReturn = pdPASS;
+        }
+    }
+    taskEXIT_CRITICAL();
+
+    return xReturn;
+}
+/*-----------------------------------------------------------*/
+
+BaseType_t xPeriodicTaskGetTaskStats( TaskHandle_t xTask,
+                                      PeriodicTaskStats_t * pxStats )
+{
+    PeriodicTask_t * pxTask;
+    BaseType_t xReturn = pdFAIL;
+
+    configASSERT( pxStats );
+
+    taskENTER_CRITICAL();
+    {
+        pxTask = prvFindTask( xTask );
+
+        if( pxTask != NULL )
+        {
+            *pxStats = pxTask->xStats;
+            xReturn = pdPASS;
+        }
+    }
+    taskEXIT_CRITICAL();
+
+    return xReturn;
+}
+/*-----------------------------------------------------------*/
+
+void vPeriodicTaskReset( void )
+{
+    UBaseType_t ux;
+
+    for( ux = 0; ux < uxTasks; ux++ )
+    {
+        vPeriodicTaskResetTask( xTasks[ ux ].xStats.xTask );
+    }
+}
+/*-----------------------------------------------------------*/
+
+void vPeriodicTaskResetTask( TaskHandle_t xTask )
+{
+    PeriodicTask_t * pxTask;
+
+    taskENTER_CRITICAL();
+    {
+        pxTask = prvFindTask( xTask );
+
+        if( pxTask != NULL )
+        {
+            pxTask->xStats.ulReleases = 0;
+            pxTask->xStats.ulMisses = 0;
+            pxTask->xStats.ulLateReleases = 0;
+            vLogHistogramReset( &( pxTask->xStats.xStartLatency ) );
+            vLogHistogramReset( &( pxTask->xStats.xResponseTime ) );
+        }
+    }
+    taskEXIT_CRITICAL();
+}
+/*-----------------------------------------------------------*/
+
+static PeriodicTask_t * prvFindTask( TaskHandle_t xTask )
+{
+    UBaseType_t ux;
+
+    for( ux = 0; ux < uxTasks; ux++ )
+    {
+        if( xTasks[ ux ].xStats.xTask == xTask )
+        {
+            return &( xTasks[ ux ] );
+        }
+    }
+
+    return NULL;
+}
+/*-----------------------------------------------------------*/
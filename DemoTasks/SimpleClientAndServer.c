@@ -31,36 +31,60 @@
 /* FreeRTOS includes. */
 #include "FreeRTOS.h"
 #include "task.h"
+#include "queue.h"
+#include "semphr.h"
 
 /* FreeRTOS+UDP includes. */
 #include "FreeRTOS_IP.h"
 #include "FreeRTOS_Sockets.h"
 
+/* Demo app includes. */
+#include "DemoStatic.h"
+#include "DemoMessage.h"
+#include "ClientSocket.h"
+#include "UDPBufferPool.h"
+#include "UDPServer.h"
+
 #define simpTINY_DELAY    ( ( portTickType ) 2 )
 
+/* The format of the messages sent by the client tasks, msgFORMAT_BINARY or
+ * msgFORMAT_TEXT - see DemoMessage.h.  Text messages are printed by the
+ * servers, binary messages are checked by the servers but not printed.
+ * Binary messages carry simpBINARY_PAYLOAD_LENGTH bytes after the header. */
+#ifndef simpMESSAGE_FORMAT
+    #define simpMESSAGE_FORMAT    msgFORMAT_TEXT
+#endif
+
+#define simpBINARY_PAYLOAD_LENGTH    32
+
 /*
- * Uses a socket to send data without using the zero copy option.
- * prvSimpleServerTask() will receive the data.
+ * Uses a socket to send data without using the zero copy option.  The data is
+ * received by a server that does not use the zero copy option either.
  */
 static void prvSimpleClientTask( void * pvParameters );
 
 /*
- * Uses a socket to receive the data sent by the prvSimpleClientTask() task.
- * Does not use the zero copy option.
+ * Uses a socket to send data using the zero copy option.  The data is
+ * received by a server that also uses the zero copy option.
  */
-static void prvSimpleServerTask( void * pvParameters );
+static void prvSimpleZeroCopyUDPClientTask( void * pvParameters );
 
 /*
- * Uses a socket to send data using the zero copy option.
- * prvSimpleZeroCopyServerTask() will receive the data.
+ * Prepare the template used to build the messages sent by a client task.
+ * pcText is only used by text messages, which include the null terminator if
+ * xTerminate is pdTRUE.
  */
-static void prvSimpleZeroCopyUDPClientTask( void * pvParameters );
+static void prvInitMessageTemplate( DemoMessageTemplate_t * pxTemplate,
+                                    const char * pcText,
+                                    BaseType_t xTerminate );
 
 /*
- * Uses a socket to receive the data sent by the prvSimpleZeroCopyUDPClientTask()
- * task.  Uses the zero copy option.
+ * The handler of both servers.  Checks a received message, printing it if it
+ * is a text message.  lBytes is the number of bytes received.  Called by the
+ * server's worker tasks, so the printing is kept off the receive path.
  */
-static void prvSimpleZeroCopyServerTask( void * pvParameters );
+static void prvCheckReceivedMessage( const uint8_t * pucMessage,
+                                     int32_t lBytes );
 
 /*-----------------------------------------------------------*/
 
@@ -68,22 +92,33 @@ void vStartSimpleUDPClientServerTasks( uint16_t usStackSize,
                                        uint32_t ulPort,
                                        unsigned portBASE_TYPE uxPriority )
 {
-    /* Create the client and server tasks that do not use the zero copy
-     * interface. */
-    xTaskCreate( prvSimpleClientTask, "SimpCpyClnt", usStackSize, ( void * ) ulPort, uxPriority, NULL );
-    xTaskCreate( prvSimpleServerTask, "SimpCpySrv", usStackSize, ( void * ) ulPort, uxPriority + 1, NULL );
-
-    /* Create the client and server tasks that do use the zero copy interface. */
-    xTaskCreate( prvSimpleZeroCopyUDPClientTask, "SimpZCpyClnt", usStackSize, ( void * ) ( ulPort + 1 ), uxPriority, NULL );
-    xTaskCreate( prvSimpleZeroCopyServerTask, "SimpZCpySrv", usStackSize, ( void * ) ( ulPort + 1 ), uxPriority + 1, NULL );
+    demoTASK_MEMORY( xCopyClientMemory, 1, demoSTATIC_TASK_STACK_DEPTH );
+    demoTASK_MEMORY( xZeroCopyClientMemory, 1, demoSTATIC_TASK_STACK_DEPTH );
+
+    /* The zero copy client takes its buffers from the pool, which is refilled
+     * at a lower priority than the client runs. */
+    vUDPBufferPoolStart( usStackSize, ( uxPriority > tskIDLE_PRIORITY ) ? ( uxPriority - 1 ) : tskIDLE_PRIORITY );
+
+    /* Create the client task and server that do not use the zero copy
+     * interface.  Each server is a receive task and srvNUMBER_OF_WORKERS
+     * worker tasks - see UDPServer.h. */
+    xDemoTaskCreate( prvSimpleClientTask, "SimpCpyClnt", usStackSize, ( void * ) ulPort, uxPriority, NULL, &xCopyClientMemory );
+    xUDPServerStart( "SimpCpySrv", ( uint16_t ) ulPort, pdFALSE, prvCheckReceivedMessage, usStackSize, uxPriority + 1 );
+
+    /* Create the client task and server that do use the zero copy interface. */
+    xDemoTaskCreate( prvSimpleZeroCopyUDPClientTask, "SimpZCpyClnt", usStackSize, ( void * ) ( ulPort + 1 ), uxPriority, NULL, &xZeroCopyClientMemory );
+    xUDPServerStart( "SimpZCpySrv", ( uint16_t ) ( ulPort + 1 ), pdTRUE, prvCheckReceivedMessage, usStackSize, uxPriority + 1 );
 }
 /*-----------------------------------------------------------*/
 
 static void prvSimpleClientTask( void * pvParameters )
 {
     Socket_t xClientSocket;
+    ClientSocket_t xClient;
     struct freertos_sockaddr xDestinationAddress;
-    uint8_t cString[ 50 ];
+    uint8_t cString[ msgMAX_MESSAGE_LENGTH ];
+    DemoMessageTemplate_t xTemplate;
+    size_t xLength;
     portBASE_TYPE lReturned;
     uint32_t ulCount = 0UL, ulIPAddress;
     const uint32_t ulLoopsPerSocket = 10UL;
@@ -118,11 +153,20 @@ static void prvSimpleClientTask( void * pvParameters )
     xDestinationAddress.sin_port = FreeRTOS_htons( xDestinationAddress.sin_port );
     xDestinationAddress.sin_family = FREERTOS_AF_INET;
 
+    /* Nothing is received, so the default receive timeout is fine. */
+    vClientSocketInit( &xClient, 0 );
+    prvInitMessageTemplate( &xTemplate, "Server received (not zero copy): Message number ", pdFALSE );
+
     for( ; ; )
     {
-        /* Create the socket. */
-        xClientSocket = FreeRTOS_socket( FREERTOS_AF_INET, FREERTOS_SOCK_DGRAM, FREERTOS_IPPROTO_UDP );
-        configASSERT( xClientSocket != FREERTOS_INVALID_SOCKET );
+        /* Obtain the socket, which is only created if there is not already
+         * one open. */
+        xClientSocket = xClientSocketOpen( &xClient );
+
+        if( xClientSocket == FREERTOS_INVALID_SOCKET )
+        {
+            continue;
+        }
 
         /* The count is used to differentiate between different messages sent to
          * the server, and to break out of the do while loop below. */
@@ -130,19 +174,20 @@ static void prvSimpleClientTask( void * pvParameters )
 
         do
         {
-            /* Create the string that is sent to the server. */
-            sprintf( ( char * ) cString, "Server received (not zero copy): Message number %lu\r\n", ulCount );
+            /* Create the message that is sent to the server. */
+            xLength = xDemoMessageEncode( &xTemplate, ulCount, cString, sizeof( cString ) );
 
-            /* Send the string to the socket.  ulFlags is set to 0, so the zero
+            /* Send the message to the socket.  ulFlags is set to 0, so the zero
              * copy option is not selected.  That means the data from cString[] is
              * copied into a network buffer inside FreeRTOS_sendto(), and cString[]
              * can be reused as soon as FreeRTOS_sendto() has returned. */
-            lReturned = FreeRTOS_sendto( xClientSocket, ( void * ) cString, strlen( ( const char * ) cString ), 0, &xDestinationAddress, sizeof( xDestinationAddress ) );
+            lReturned = FreeRTOS_sendto( xClientSocket, ( void * ) cString, xLength, 0, &xDestinationAddress, sizeof( xDestinationAddress ) );
+            vClientSocketReport( &xClient, ( lReturned > 0 ) ? pdTRUE : pdFALSE );
 
             ulCount++;
-        } while( ( lReturned != FREERTOS_SOCKET_ERROR ) && ( ulCount < ulLoopsPerSocket ) );
+        } while( ( lReturned != FREERTOS_SOCKET_ERROR ) && ( ulCount < ulLoopsPerSocket ) && ( xClient.xSocket != FREERTOS_INVALID_SOCKET ) );
 
-        FreeRTOS_closesocket( xClientSocket );
+        vClientSocketEndOfBatch( &xClient );
 
         /* A short delay to prevent the messages printed by the server task
          * scrolling off the screen too quickly, and to prevent reduce the network
@@ -152,70 +197,18 @@ static void prvSimpleClientTask( void * pvParameters )
 }
 /*-----------------------------------------------------------*/
 
-static void prvSimpleServerTask( void * pvParameters )
-{
-    long lBytes;
-    uint8_t cReceivedString[ 60 ];
-    struct freertos_sockaddr xClient, xBindAddress;
-    uint32_t xClientLength = sizeof( xClient );
-    Socket_t xListeningSocket;
-
-    /* Just to prevent compiler warnings. */
-    ( void ) pvParameters;
-
-    /* Attempt to open the socket. */
-    xListeningSocket = FreeRTOS_socket( FREERTOS_AF_INET, FREERTOS_SOCK_DGRAM, FREERTOS_IPPROTO_UDP );
-    configASSERT( xListeningSocket != FREERTOS_INVALID_SOCKET );
-
-    /* This test receives data sent from a different port on the same IP
-     * address.  Configure the freertos_sockaddr structure with the address being
-     * bound to.  The strange casting is to try and remove	compiler warnings on 32
-     * bit machines.  Note that this task is only created after the network is up,
-     * so the IP address is valid here. */
-    xBindAddress.sin_port = ( uint16_t ) ( ( uint32_t ) pvParameters ) & 0xffffUL;
-    xBindAddress.sin_port = FreeRTOS_htons( xBindAddress.sin_port );
-    xBindAddress.sin_family = FREERTOS_AF_INET;
-
-    /* Bind the socket to the port that the client task will send to. */
-    FreeRTOS_bind( xListeningSocket, &xBindAddress, sizeof( xBindAddress ) );
-
-    for( ; ; )
-    {
-        /* Zero out the receive array so there is NULL at the end of the string
-         * when it is printed out. */
-        memset( cReceivedString, 0x00, sizeof( cReceivedString ) );
-
-        /* Receive data on the socket.  ulFlags is zero, so the zero copy option
-         * is not set and the received data is copied into the buffer pointed to by
-         * cReceivedString.  By default the block time is portMAX_DELAY.
-         * xClientLength is not actually used by FreeRTOS_recvfrom(), but is set
-         * appropriately in case future versions do use it. */
-        lBytes = FreeRTOS_recvfrom( xListeningSocket, cReceivedString, sizeof( cReceivedString ), 0, &xClient, &xClientLength );
-
-        /* Print the received characters. */
-        if( lBytes > 0 )
-        {
-            FreeRTOS_debug_printf( ( ( char * ) cReceivedString ) );
-        }
-
-        /* Error check. */
-        configASSERT( lBytes == ( portBASE_TYPE ) strlen( ( const char * ) cReceivedString ) );
-    }
-}
-/*-----------------------------------------------------------*/
-
 static void prvSimpleZeroCopyUDPClientTask( void * pvParameters )
 {
     Socket_t xClientSocket;
+    ClientSocket_t xClient;
     uint8_t * pucUDPPayloadBuffer;
     struct freertos_sockaddr xDestinationAddress;
     portBASE_TYPE lReturned;
     uint32_t ulCount = 0UL, ulIPAddress;
     const uint32_t ulLoopsPerSocket = 10UL;
-    const uint8_t * pucStringToSend = ( const uint8_t * ) "Server received (using zero copy): Message number ";
     const portTickType x150ms = 150UL / portTICK_RATE_MS;
-/* 15 is added to ensure the number, \r\n and terminating zero fit. */
-    const size_t xStringLength = strlen( ( char * ) pucStringToSend ) + 15;
+    DemoMessageTemplate_t xTemplate;
+    size_t xLength;
 
     /* Remove compiler warning about unused parameters. */
     ( void ) pvParameters;
@@ -246,11 +239,20 @@ static void prvSimpleZeroCopyUDPClientTask( void * pvParameters )
     xDestinationAddress.sin_port = FreeRTOS_htons( xDestinationAddress.sin_port );
     xDestinationAddress.sin_family = FREERTOS_AF_INET;
 
+    /* Nothing is received, so the default receive timeout is fine. */
+    vClientSocketInit( &xClient, 0 );
+    prvInitMessageTemplate( &xTemplate, "Server received (using zero copy): Message number ", pdTRUE );
+
     for( ; ; )
     {
-        /* Create the socket. */
-        xClientSocket = FreeRTOS_socket( FREERTOS_AF_INET, FREERTOS_SOCK_DGRAM, FREERTOS_IPPROTO_UDP );
-        configASSERT( xClientSocket != FREERTOS_INVALID_SOCKET );
+        /* Obtain the socket, which is only created if there is not already
+         * one open. */
+        xClientSocket = xClientSocketOpen( &xClient );
+
+        if( xClientSocket == FREERTOS_INVALID_SOCKET )
+        {
+            continue;
+        }
 
         /* The count is used to differentiate between different messages sent to
          * the server, and to break out of the do while loop below. */
@@ -263,44 +265,39 @@ static void prvSimpleZeroCopyUDPClientTask( void * pvParameters )
              * passed into, rather than copied into, the FreeRTOS_sendto()
              * function.
              *
-             * First obtain a buffer of adequate length from the IP stack into which
-             * the string will be written.  Although a max delay is used, the actual
-             * delay will be capped to ipconfigMAX_SEND_BLOCK_TIME_TICKS, hence
-             * the do while loop is used to ensure a buffer is obtained. */
+             * First take a buffer into which the string will be written from the
+             * pool of buffers already obtained from the IP stack.  If the pool is
+             * empty only a short time is spent waiting for it to be refilled,
+             * hence the do while loop is used to ensure a buffer is obtained. */
+            configASSERT( xDemoMessageMaxLength( &xTemplate ) <= udppoolBUFFER_SIZE );
+
             do
             {
-                #if defined( ipconfigIPv4_BACKWARD_COMPATIBLE ) && ( ipconfigIPv4_BACKWARD_COMPATIBLE == 0 )
-            } while( ( pucUDPPayloadBuffer = ( uint8_t * ) FreeRTOS_GetUDPPayloadBuffer_Multi( xStringLength, portMAX_DELAY, ipTYPE_IPv4 ) ) == NULL );
-                #else
-            } while( ( pucUDPPayloadBuffer = ( uint8_t * ) FreeRTOS_GetUDPPayloadBuffer( xStringLength, portMAX_DELAY ) ) == NULL );
-            #endif /* defined( ipconfigIPv4_BACKWARD_COMPATIBLE ) && ( ipconfigIPv4_BACKWARD_COMPATIBLE == 0 ) */
-
-            /* A buffer was successfully obtained.  Create the string that is
-             * sent to the server.  First the string is filled with zeros as this will
-             * effectively be the null terminator when the string is received at the other
-             * end.  Note that the string is being written directly into the buffer
-             * obtained from the IP stack above. */
-            memset( ( void * ) pucUDPPayloadBuffer, 0x00, xStringLength );
-            sprintf( ( char * ) pucUDPPayloadBuffer, "%s%lu\r\n", ( char * ) pucStringToSend, ulCount );
+            } while( ( pucUDPPayloadBuffer = pucUDPBufferPoolTake( simpTINY_DELAY ) ) == NULL );
+
+            /* A buffer was successfully obtained.  Create the message that is
+             * sent to the server.  Note that the message is being written directly
+             * into the buffer obtained from the IP stack above. */
+            xLength = xDemoMessageEncode( &xTemplate, ulCount, pucUDPPayloadBuffer, udppoolBUFFER_SIZE );
 
             /* Pass the buffer into the send function.  ulFlags has the
              * FREERTOS_ZERO_COPY bit set so the IP stack will take control of the
              * buffer rather than copy data out of the buffer. */
-            lReturned = FreeRTOS_sendto( xClientSocket,                                      /* The socket being sent to. */
-                                         ( void * ) pucUDPPayloadBuffer,                     /* A pointer to the the data being sent. */
-                                         strlen( ( const char * ) pucUDPPayloadBuffer ) + 1, /* The length of the data being sent - including the string's null terminator. */
-                                         FREERTOS_ZERO_COPY,                                 /* ulFlags with the FREERTOS_ZERO_COPY bit set. */
-                                         &xDestinationAddress,                               /* Where the data is being sent. */
+            lReturned = FreeRTOS_sendto( xClientSocket,                  /* The socket being sent to. */
+                                         ( void * ) pucUDPPayloadBuffer, /* A pointer to the the data being sent. */
+                                         xLength,                        /* The length of the data being sent - including a text message's null terminator. */
+                                         FREERTOS_ZERO_COPY,             /* ulFlags with the FREERTOS_ZERO_COPY bit set. */
+                                         &xDestinationAddress,           /* Where the data is being sent. */
                                          sizeof( xDestinationAddress ) );
 
             if( lReturned == 0 )
             {
                 /* The send operation failed, so this task is still responsible
-                * for the buffer obtained from the IP stack.  To ensure the buffer
-                * is not lost it must either be used again, or, as in this case,
-                * returned to the IP stack using FreeRTOS_ReleaseUDPPayloadBuffer().
+                * for the buffer taken from the pool.  To ensure the buffer is not
+                * lost it must either be used again, or, as in this case, given
+                * back to the pool using vUDPBufferPoolReturn().
                 * pucUDPPayloadBuffer can be safely re-used after this call. */
-                FreeRTOS_ReleaseUDPPayloadBuffer( ( void * ) pucUDPPayloadBuffer );
+                vUDPBufferPoolReturn( pucUDPPayloadBuffer );
             }
             else
             {
@@ -310,10 +307,12 @@ static void prvSimpleZeroCopyUDPClientTask( void * pvParameters )
                  * be safely re-used. */
             }
 
+            vClientSocketReport( &xClient, ( lReturned > 0 ) ? pdTRUE : pdFALSE );
+
             ulCount++;
-        } while( ( lReturned != FREERTOS_SOCKET_ERROR ) && ( ulCount < ulLoopsPerSocket ) );
+        } while( ( lReturned != FREERTOS_SOCKET_ERROR ) && ( ulCount < ulLoopsPerSocket ) && ( xClient.xSocket != FREERTOS_INVALID_SOCKET ) );
 
-        FreeRTOS_closesocket( xClientSocket );
+        vClientSocketEndOfBatch( &xClient );
 
         /* A short delay to prevent the messages scrolling off the screen too
          * quickly. */
@@ -322,66 +321,42 @@ static void prvSimpleZeroCopyUDPClientTask( void * pvParameters )
 }
 /*-----------------------------------------------------------*/
 
-static void prvSimpleZeroCopyServerTask( void * pvParameters )
+static void prvInitMessageTemplate( DemoMessageTemplate_t * pxTemplate,
+                                    const char * pcText,
+                                    BaseType_t xTerminate )
 {
-    int32_t lBytes;
-    uint8_t * pucUDPPayloadBuffer;
-    struct freertos_sockaddr xClient, xBindAddress;
-    uint32_t xClientLength = sizeof( xClient ), ulIPAddress;
-    Socket_t xListeningSocket;
-
-    /* Just to prevent compiler warnings. */
-    ( void ) pvParameters;
-
-    /* Attempt to open the socket. */
-    xListeningSocket = FreeRTOS_socket( FREERTOS_AF_INET, FREERTOS_SOCK_DGRAM, FREERTOS_IPPROTO_UDP );
-    configASSERT( xListeningSocket != FREERTOS_INVALID_SOCKET );
-
-    /* This test receives data sent from a different port on the same IP address.
-     * Obtain the nodes IP address.  Configure the freertos_sockaddr structure with
-     * the address being bound to.  The strange casting is to try and remove
-     * compiler warnings on 32 bit machines.  Note that this task is only created
-     * after the network is up, so the IP address is valid here. */
-    #if defined( ipconfigIPv4_BACKWARD_COMPATIBLE ) && ( ipconfigIPv4_BACKWARD_COMPATIBLE == 0 )
-        FreeRTOS_GetEndPointConfiguration( &ulIPAddress, NULL, NULL, NULL, pxNetworkEndPoints );
-        xBindAddress.sin_address.ulIP_IPv4 = ulIPAddress;
+    #if ( simpMESSAGE_FORMAT == msgFORMAT_TEXT )
+    {
+        vDemoMessageInitText( pxTemplate, pcText, xTerminate );
+    }
     #else
-        FreeRTOS_GetAddressConfiguration( &ulIPAddress, NULL, NULL, NULL );
-        xBindAddress.sin_addr = ulIPAddress;
-    #endif /* defined( ipconfigIPv4_BACKWARD_COMPATIBLE ) && ( ipconfigIPv4_BACKWARD_COMPATIBLE == 0 ) */
-
-    xBindAddress.sin_port = ( uint16_t ) ( ( uint32_t ) pvParameters ) & 0xffffUL;
-    xBindAddress.sin_port = FreeRTOS_htons( xBindAddress.sin_port );
-    xBindAddress.sin_family = FREERTOS_AF_INET;
-
-    /* Bind the socket to the port that the client task will send to. */
-    FreeRTOS_bind( xListeningSocket, &xBindAddress, sizeof( xBindAddress ) );
+    {
+        ( void ) pcText;
+        ( void ) xTerminate;
+        vDemoMessageInitBinary( pxTemplate, simpBINARY_PAYLOAD_LENGTH );
+    }
+    #endif
+}
+/*-----------------------------------------------------------*/
 
-    for( ; ; )
+static void prvCheckReceivedMessage( const uint8_t * pucMessage,
+                                     int32_t lBytes )
+{
+    #if ( simpMESSAGE_FORMAT == msgFORMAT_TEXT )
     {
-        /* Receive data on the socket.  ulFlags has the zero copy bit set
-         * (FREERTOS_ZERO_COPY) indicating to the stack that a reference to the
-         * received data should be passed out to this task using the second
-         * parameter to the FreeRTOS_recvfrom() call.  When this is done the
-         * IP stack is no longer responsible for releasing the buffer, and
-         * the task *must* return the buffer to the stack when it is no longer
-         * needed.  By default the block time is portMAX_DELAY. */
-        lBytes = FreeRTOS_recvfrom( xListeningSocket, ( void * ) &pucUDPPayloadBuffer, 0, FREERTOS_ZERO_COPY, &xClient, &xClientLength );
-
-        /* It is expected to receive one more byte than the string length as
-         * the NULL terminator is also transmitted. */
-        configASSERT( lBytes == ( ( portBASE_TYPE ) strlen( ( const char * ) pucUDPPayloadBuffer ) + 1 ) );
-
-        /* Print the received characters. */
+        /* Print the received characters.  Every message ends with "\r\n",
+         * optionally followed by the terminator. */
         if( lBytes > 0 )
         {
-            FreeRTOS_debug_printf( ( ( char * ) pucUDPPayloadBuffer ) );
-        }
-
-        if( lBytes >= 0 )
-        {
-            /* The buffer *must* be freed once it is no longer needed. */
-            FreeRTOS_ReleaseUDPPayloadBuffer( pucUDPPayloadBuffer );
+            configASSERT( ( pucMessage[ lBytes - 1 ] == '\n' ) || ( pucMessage[ lBytes - 1 ] == 0x00 ) );
+            FreeRTOS_debug_printf( ( ( char * ) pucMessage ) );
         }
     }
+    #else
+    {
+        /* Error check. */
+        configASSERT( xDemoMessageVerify( pucMessage, ( size_t ) lBytes, NULL ) != pdFALSE );
+    }
+    #endif
 }
+/*-----------------------------------------------------------*/
@@ -0,0 +1,244 @@
+/*
+ * FreeRTOS V202411.00
+ * Copyright (C) 2020 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * https://www.FreeRTOS.org
+ * https://github.com/FreeRTOS
+ *
+ */
+
+/*
+ * See StackAuditor.h.
+ *
+ * Each sample is taken with uxTaskGetSystemState(), which calculates the high
+ * water mark of every task in one pass.  That can take a while when there are
+ * many tasks with deep stacks, so it is done by a low priority task rather than
+ * by the CLI command that displays the results.
+ */
+
+/* Standard includes. */
+#include <stdint.h>
+#include <string.h>
+
+/* FreeRTOS includes. */
+#include "FreeRTOS.h"
+#include "task.h"
+#include "queue.h"
+#include "semphr.h"
+
+/* Demo app includes. */
+#include "DemoStatic.h"
+#include "PeriodicTask.h"
+#include "StackAuditor.h"
+
+/*
+ * Takes a sample every stackauditPERIOD_MS milliseconds.
+ */
+static void prvStackAuditorTask( void * pvParameters );
+
+/*
+ * Merge the high water marks in the uxTasks entries of pxTasks into the
+ * history.
+ */
+static void prvMergeSample( const TaskStatus_t * pxTasks,
+                            UBaseType_t uxTasks );
+
+/*
+ * Return the entry for pxTask, allocating one if the task is new, and mark it
+ * as seen in pxSeen.  Returns NULL if there is no space for a new task.
+ */
+static StackAuditEntry_t * prvGetEntry( const TaskStatus_t * pxTask,
+                                        BaseType_t * pxSeen );
+
+/*-----------------------------------------------------------*/
+
+static StackAuditEntry_t xEntries[ stackauditMAX_TASKS ];
+static UBaseType_t uxEntries = 0;
+static uint32_t ulSamples = 0;
+
+/*-----------------------------------------------------------*/
+
+void vStartStackAuditorTask( uint16_t usStackSize,
+                             UBaseType_t uxPriority )
+{
+    demoTASK_MEMORY( xAuditorMemory, 1, demoSTATIC_TASK_STACK_DEPTH );
+
+    xDemoTaskCreate( prvStackAuditorTask, "StackAudit", usStackSize, NULL, uxPriority, NULL, &xAuditorMemory );
+}
+/*-----------------------------------------------------------*/
+
+BaseType_t xStackAuditorGetEntry( UBaseType_t uxIndex,
+                                  StackAuditEntry_t * pxEntry )
+{
+    BaseType_t xReturn = pdFALSE;
+
+    configASSERT( pxEntry );
+
+    taskENTER_CRITICAL();
+    {
+        if( uxIndex < uxEntries )
+        {
+            *pxEntry = xEntries[ uxIndex ];
+            xReturn = pdTRUE;
+        }
+    }
+    taskEXIT_CRITICAL();
+
+    return xReturn;
+}
+/*-----------------------------------------------------------*/
+
+uint32_t ulStackAuditorGetSamples( void )
+{
+    return ulSamples;
+}
+/*-----------------------------------------------------------*/
+
+static void prvStackAuditorTask( void * pvParameters )
+{
+    static TaskStatus_t xTasks[ stackauditMAX_TASKS ];
+    UBaseType_t uxTasks;
+
+    ( void ) pvParameters;
+
+    ( void ) xPeriodicTaskInit( pdMS_TO_TICKS( stackauditPERIOD_MS ), 0 );
+
+    for( ; ; )
+    {
+        /* Returns 0 if there are more tasks than the array can hold. */
+        uxTasks = uxTaskGetSystemState( xTasks, stackauditMAX_TASKS, NULL );
+
+        if( uxTasks > 0 )
+        {
+            prvMergeSample( xTasks, uxTasks );
+        }
+
+        vPeriodicTaskWaitForRelease();
+    }
+}
+/*-----------------------------------------------------------*/
+
+static void prvMergeSample( const TaskStatus_t * pxTasks,
+                            UBaseType_t uxTasks )
+{
+    static BaseType_t xSeen[ stackauditMAX_TASKS ];
+    UBaseType_t uxTask, uxEntry;
+    StackAuditEntry_t * pxEntry;
+    configSTACK_DEPTH_TYPE uxUsed, uxMargin;
+
+    memset( xSeen, 0x00, sizeof( xSeen ) );
+
+    for( uxTask = 0; uxTask < uxTasks; uxTask++ )
+    {
+        /* The history is only written by this task, but is read by other
+         * tasks, so each entry is updated inside a critical section. */
+        taskENTER_CRITICAL();
+        {
+            pxEntry = prvGetEntry( &( pxTasks[ uxTask ] ), xSeen );
+
+            if( pxEntry != NULL )
+            {
+                pxEntry->ulSamples++;
+
+                if( ( pxEntry->ulSamples == 1 ) || ( pxTasks[ uxTask ].usStackHighWaterMark < pxEntry->uxMinHighWater ) )
+                {
+                    pxEntry->uxMinHighWater = pxTasks[ uxTask ].usStackHighWaterMark;
+                }
+
+                if( ( pxEntry->uxStackDepth > 0 ) && ( pxEntry->uxStackDepth >= pxEntry->uxMinHighWater ) )
+                {
+                    uxUsed = pxEntry->uxStackDepth - pxEntry->uxMinHighWater;
+                    uxMargin = ( configSTACK_DEPTH_TYPE ) ( ( ( uint32_t ) uxUsed * stackauditMARGIN_PERCENT + 99UL ) / 100UL );
+
+                    if( uxMargin < stackauditMIN_MARGIN_WORDS )
+                    {
+                        uxMargin = stackauditMIN_MARGIN_WORDS;
+                    }
+
+                    pxEntry->uxRecommended = uxUsed + uxMargin;
+                }
+            }
+        }
+        taskEXIT_CRITICAL();
+    }
+
+    /* Any task not in this sample has been deleted. */
+    taskENTER_CRITICAL();
+    {
+        for( uxEntry = 0; uxEntry < uxEntries; uxEntry++ )
+        {
+            xEntries[ uxEntry ].xDeleted = ( xSeen[ uxEntry ] == pdFALSE ) ? pdTRUE : pdFALSE;
+        }
+
+        ulSamples++;
+    }
+    taskEXIT_CRITICAL();
+}
+/*-----------------------------------------------------------*/
+
+static StackAuditEntry_t * prvGetEntry( const TaskStatus_t * pxTask,
+                                        BaseType_t * pxSeen )
+{
+    UBaseType_t uxEntry;
+    StackAuditEntry_t * pxEntry = NULL;
+
+    for( uxEntry = 0; uxEntry < uxEntries; uxEntry++ )
+    {
+        /* The name is compared too, as a new task can be given the memory, and
+         * so the handle, of a deleted task. */
+        if( ( xEntries[ uxEntry ].xTask == pxTask->xHandle ) && ( strncmp( xEntries[ uxEntry ].cName, pxTask->pcTaskName, configMAX_TASK_NAME_LEN - 1 ) == 0 ) )
+        {
+            pxSeen[ uxEntry ] = pdTRUE;
+            return &( xEntries[ uxEntry ] );
+        }
+    }
+
+    if( uxEntries < stackauditMAX_TASKS )
+    {
+        uxEntry = uxEntries;
+        pxEntry = &( xEntries[ uxEntry ] );
+        uxEntries++;
+    }
+    else
+    {
+        /* Reuse the entry of a task that was missing from the previous
+         * sample and has not been seen in this one. */
+        for( uxEntry = 0; uxEntry < uxEntries; uxEntry++ )
+        {
+            if( ( xEntries[ uxEntry ].xDeleted != pdFALSE ) && ( pxSeen[ uxEntry ] == pdFALSE ) )
+            {
+                pxEntry = &( xEntries[ uxEntry ] );
+                break;
+            }
+        }
+    }
+
+    if( pxEntry != NULL )
+    {
+        pxSeen[ uxEntry ] = pdTRUE;
+        memset( pxEntry, 0x00, sizeof( StackAuditEntry_t ) );
+        pxEntry->xTask = pxTask->xHandle;
+        strncpy( pxEntry->cName, pxTask->pcTaskName, configMAX_TASK_NAME_LEN - 1 );
+        pxEntry->uxStackDepth = uxDemoTaskGetStackDepth( pxTask->xHandle );
+    }
+
+    return pxEntry;
+}
+/*-----------------------------------------------------------*/
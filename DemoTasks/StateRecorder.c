@@ -0,0 +1,313 @@
+/*
+ * FreeRTOS V202411.00
+ * Copyright (C) 2020 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * https://www.FreeRTOS.org
+ * https://github.com/FreeRTOS
+ *
+ */
+
+/*
+ * See StateRecorder.h.
+ *
+ * Sample n occupies the ( 2 * uxTasks ) bits starting at bit
+ * ( ( n % ulCapacity ) * 2 * uxTasks ) of ucTimeline[].  A state is always
+ * stored at an even bit offset, so never straddles two bytes.  The tick count
+ * at which sample n was taken, where n is a multiple of
+ * staterecSAMPLES_PER_STAMP, is held in xStamps[], which is also used as a
+ * circular buffer and has room for every stamped sample the timeline can
+ * hold.  Only the sampling task writes to the timeline and the stamps.
+ */
+
+/* Standard includes. */
+#include <stdint.h>
+#include <string.h>
+
+/* FreeRTOS includes. */
+#include "FreeRTOS.h"
+#include "task.h"
+#include "queue.h"
+#include "semphr.h"
+
+/* Demo app includes. */
+#include "DemoStatic.h"
+#include "StateRecorder.h"
+
+/*
+ * Takes a sample every period while the recorder is running, and waits for a
+ * notification while it is stopped.
+ */
+static void prvStateRecorderTask( void * pvParameters );
+
+/*
+ * Read the state of every registered task and store it as sample ulSample.
+ */
+static void prvTakeSample( uint32_t ulSample );
+
+/*-----------------------------------------------------------*/
+
+/* Enough stamps for the longest timeline, which is held when a single task is
+ * registered, plus one for each end of the timeline being part way through a
+ * block of staterecSAMPLES_PER_STAMP samples. */
+#define staterecMAX_STAMPS    ( ( ( ( uint32_t ) staterecBUFFER_BYTES * 4UL ) / ( uint32_t ) staterecSAMPLES_PER_STAMP ) + 2UL )
+
+static uint8_t ucTimeline[ staterecBUFFER_BYTES ];
+static TickType_t xStamps[ staterecMAX_STAMPS ];
+static TaskHandle_t xTasks[ staterecMAX_TASKS ];
+static UBaseType_t uxTasks = 0;
+static uint32_t ulCapacity = 0;
+
+static volatile uint32_t ulSamples = 0;
+static volatile uint32_t ulLateSamples = 0;
+static volatile BaseType_t xRecording = pdFALSE;
+static TickType_t xPeriod = 1;
+static TickType_t xStartTime = 0;
+
+/* The task that takes the samples. */
+static TaskHandle_t xRecorderTask = NULL;
+
+/*-----------------------------------------------------------*/
+
+void vStartStateRecorderTask( uint16_t usStackSize,
+                              UBaseType_t uxPriority )
+{
+    demoTASK_MEMORY( xRecorderMemory, 1, demoSTATIC_TASK_STACK_DEPTH );
+
+    xDemoTaskCreate( prvStateRecorderTask, "StateRec", usStackSize, NULL, uxPriority, &xRecorderTask, &xRecorderMemory );
+}
+/*-----------------------------------------------------------*/
+
+BaseType_t xStateRecorderRegisterTask( TaskHandle_t xTask )
+{
+    BaseType_t xReturn = pdFAIL;
+
+    configASSERT( xTask );
+
+    taskENTER_CRITICAL();
+    {
+        if( ( xRecording == pdFALSE ) && ( uxTasks < staterecMAX_TASKS ) )
+        {
+            xTasks[ uxTasks ] = xTask;
+            uxTasks++;
+            ulCapacity = ( ( uint32_t ) staterecBUFFER_BYTES * 4UL ) / ( uint32_t ) uxTasks;
+            ulSamples = 0;
+            ulLateSamples = 0;
+            xReturn = pdPASS;
+        }
+    }
+    taskEXIT_CRITICAL();
+
+    return xReturn;
+}
+/*-----------------------------------------------------------*/
+
+void vStateRecorderStart( TickType_t xNewPeriod )
+{
+    configASSERT( xRecorderTask );
+
+    if( xNewPeriod == 0 )
+    {
+        xNewPeriod = 1;
+    }
+
+    taskENTER_CRITICAL();
+    {
+        xPeriod = xNewPeriod;
+        ulSamples = 0;
+        ulLateSamples = 0;
+        xRecording = pdTRUE;
+    }
+    taskEXIT_CRITICAL();
+
+    /* Wake the recorder task if it is waiting for the recorder to start.  If
+     * the recorder was already running the task starts again from sample 0
+     * when it next wakes. */
+    xTaskNotifyGive( xRecorderTask );
+}
+/*-----------------------------------------------------------*/
+
+void vStateRecorderStop( void )
+{
+    xRecording = pdFALSE;
+}
+/*-----------------------------------------------------------*/
+
+void vStateRecorderGetInfo( StateRecorderInfo_t * pxInfo )
+{
+    configASSERT( pxInfo );
+
+    taskENTER_CRITICAL();
+    {
+        pxInfo->uxTasks = uxTasks;
+        pxInfo->ulCapacity = ulCapacity;
+        pxInfo->ulSamples = ulSamples;
+        pxInfo->ulFirstSample = ( ulSamples > ulCapacity ) ? ( ulSamples - ulCapacity ) : 0UL;
+        pxInfo->ulLateSamples = ulLateSamples;
+        pxInfo->xPeriod = xPeriod;
+        pxInfo->xStartTime = xStartTime;
+        pxInfo->xRecording = xRecording;
+    }
+    taskEXIT_CRITICAL();
+}
+/*-----------------------------------------------------------*/
+
+TaskHandle_t xStateRecorderGetTask( UBaseType_t uxTask )
+{
+    configASSERT( uxTask < uxTasks );
+
+    return xTasks[ uxTask ];
+}
+/*-----------------------------------------------------------*/
+
+UBaseType_t uxStateRecorderGetState( uint32_t ulSample,
+                                     UBaseType_t uxTask )
+{
+    uint32_t ulBit;
+
+    configASSERT( uxTask < uxTasks );
+
+    ulBit = ( ( ulSample % ulCapacity ) * ( uint32_t ) uxTasks + ( uint32_t ) uxTask ) * 2UL;
+
+    return ( UBaseType_t ) ( ( ucTimeline[ ulBit >> 3 ] >> ( ulBit & 0x07UL ) ) & 0x03U );
+}
+/*-----------------------------------------------------------*/
+
+TickType_t xStateRecorderGetSampleTime( uint32_t ulSample )
+{
+    uint32_t ulStamp = ulSample / ( uint32_t ) staterecSAMPLES_PER_STAMP;
+
+    return xStamps[ ulStamp % staterecMAX_STAMPS ] +
+           ( TickType_t ) ( ulSample - ( ulStamp * ( uint32_t ) staterecSAMPLES_PER_STAMP ) ) * xPeriod;
+}
+/*-----------------------------------------------------------*/
+
+static void prvStateRecorderTask( void * pvParameters )
+{
+    TickType_t xNextSampleTime;
+    uint32_t ulSample;
+
+    ( void ) pvParameters;
+
+    for( ; ; )
+    {
+        /* Sleep until the recorder is started.  The notification count is
+         * cleared so a start that happened while recording does not cause a
+         * spurious restart. */
+        while( xRecording == pdFALSE )
+        {
+            ulTaskNotifyTake( pdTRUE, portMAX_DELAY );
+        }
+
+        ( void ) ulTaskNotifyTake( pdTRUE, 0 );
+        xNextSampleTime = xTaskGetTickCount();
+        xStartTime = xNextSampleTime;
+        ulSample = 0;
+
+        while( xRecording != pdFALSE )
+        {
+            if( ulSamples != ulSample )
+            {
+                /* vStateRecorderStart() was called again, start over. */
+                break;
+            }
+
+            if( ( ulSample % ( uint32_t ) staterecSAMPLES_PER_STAMP ) == 0UL )
+            {
+                xStamps[ ( ulSample / ( uint32_t ) staterecSAMPLES_PER_STAMP ) % staterecMAX_STAMPS ] = xTaskGetTickCount();
+            }
+
+            prvTakeSample( ulSample );
+            ulSample++;
+            ulSamples = ulSample;
+
+            /* xTaskDelayUntil() returns pdFALSE if the next sample time has
+             * already passed, in which case the timeline is stretched. */
+            if( xTaskDelayUntil( &xNextSampleTime, xPeriod ) == pdFALSE )
+            {
+                ulLateSamples++;
+            }
+        }
+    }
+}
+/*-----------------------------------------------------------*/
+
+static void prvTakeSample( uint32_t ulSample )
+{
+    eTaskState eStates[ staterecMAX_TASKS ];
+    UBaseType_t uxPriorities[ staterecMAX_TASKS ];
+    UBaseType_t ux, uxState, uxRunning = staterecMAX_TASKS;
+    uint32_t ulBit;
+
+    if( uxTasks == 0 )
+    {
+        return;
+    }
+
+    /* Read every state with the scheduler suspended so the sample is a
+     * consistent picture of a single moment. */
+    vTaskSuspendAll();
+    {
+        for( ux = 0; ux < uxTasks; ux++ )
+        {
+            eStates[ ux ] = eTaskGetState( xTasks[ ux ] );
+            uxPriorities[ ux ] = uxTaskPriorityGet( xTasks[ ux ] );
+        }
+    }
+    ( void ) xTaskResumeAll();
+
+    /* The task this task preempted is Ready - assume it was the Ready task
+     * with the highest priority. */
+    for( ux = 0; ux < uxTasks; ux++ )
+    {
+        if( ( eStates[ ux ] == eReady ) &&
+            ( ( uxRunning == staterecMAX_TASKS ) || ( uxPriorities[ ux ] > uxPriorities[ uxRunning ] ) ) )
+        {
+            uxRunning = ux;
+        }
+    }
+
+    ulBit = ( ulSample % ulCapacity ) * ( uint32_t ) uxTasks * 2UL;
+
+    for( ux = 0; ux < uxTasks; ux++, ulBit += 2UL )
+    {
+        switch( eStates[ ux ] )
+        {
+            case eRunning:
+                uxState = staterecSTATE_RUNNING;
+                break;
+
+            case eReady:
+                uxState = ( ux == uxRunning ) ? staterecSTATE_RUNNING : staterecSTATE_READY;
+                break;
+
+            case eBlocked:
+                uxState = staterecSTATE_BLOCKED;
+                break;
+
+            default:
+                uxState = staterecSTATE_SUSPENDED;
+                break;
+        }
+
+        ucTimeline[ ulBit >> 3 ] = ( uint8_t ) ( ( ucTimeline[ ulBit >> 3 ] & ~( 0x03U << ( ulBit & 0x07UL ) ) ) |
+                                                 ( uxState << ( ulBit & 0x07UL ) ) );
+    }
+}
+/*-----------------------------------------------------------*/
@@ -0,0 +1,367 @@
+/*
+ * FreeRTOS V202411.00
+ * Copyright (C) 2020 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * https://www.FreeRTOS.org
+ * https://github.com/FreeRTOS
+ *
+ */
+
+/*
+ * See TraceRing.h.
+ *
+ * The writer of a ring only ever updates ulHead and the reader only ever
+ * updates ulTail.  Both are free running counts that are masked to index the
+ * records, so the ring is empty when they are equal and full when they differ
+ * by ringRECORDS_PER_RING.  The writer fills in a record before publishing it
+ * by updating ulHead, and the reader reads a record before releasing it by
+ * updating ulTail, with a memory barrier in between in both cases.
+ *
+ * Records are given a sequence number from a single counter that is shared
+ * by all the rings, and the reader always returns the record with the lowest
+ * sequence number of those it can see.  The order is only best effort: a
+ * record's sequence number is taken before the record is published, so while
+ * one writer is between the two the reader can return another ring's record
+ * that has a higher sequence number.  Records that were all published before
+ * the reader looked are returned in sequence order.
+ */
+
+/* Standard includes. */
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+/* FreeRTOS includes. */
+#include "FreeRTOS.h"
+#include "task.h"
+#include "queue.h"
+#include "semphr.h"
+#include "atomic.h"
+
+/* Demo app includes. */
+#include "DemoStatic.h"
+#include "DemoTimestamp.h"
+#include "TraceRing.h"
+
+#if ( ( ringRECORDS_PER_RING & ( ringRECORDS_PER_RING - 1 ) ) != 0 )
+    #error ringRECORDS_PER_RING must be a power of two
+#endif
+
+/* How often the drain task checks for records. */
+#define ringDRAIN_PERIOD_MS    20
+
+/* The records are masked into the ring with this. */
+#define ringINDEX_MASK         ( ( uint32_t ) ringRECORDS_PER_RING - 1UL )
+
+/* An event, as written by vTraceRingRecord(). */
+typedef struct xTRACE_RECORD
+{
+    DemoTimestamp_t xTimestamp;
+    uint32_t ulSequence;
+    uint32_t ulArgument1;
+    uint32_t ulArgument2;
+    uint16_t usEventId;
+} TraceRecord_t;
+
+/* The ring belonging to one task. */
+typedef struct xTRACE_RING
+{
+    TaskHandle_t xTask;          /* The only task that writes to this ring. */
+    volatile uint32_t ulHead;    /* The number of records written, only updated by the writer. */
+    volatile uint32_t ulTail;    /* The number of records read, only updated by the reader. */
+    volatile uint32_t ulDropped; /* The number of events dropped because the ring was full, only updated by the writer. */
+    TraceRecord_t xRecords[ ringRECORDS_PER_RING ];
+} TraceRing_t;
+
+/*
+ * Return the ring belonging to the calling task, or NULL if it does not have
+ * one.
+ */
+static TraceRing_t * prvGetRing( void );
+
+/*
+ * Periodically prints the records to the console.
+ */
+static void prvTraceRingDrainTask( void * pvParameters );
+
+/*-----------------------------------------------------------*/
+
+static TraceRing_t xRings[ ringMAX_RINGS ];
+static UBaseType_t uxRegisteredRings = 0;
+
+/* The sequence number given to the next record. */
+static volatile uint32_t ulNextSequence = 0;
+
+/* Serialises the readers. */
+static SemaphoreHandle_t xReaderMutex = NULL;
+
+/* The formats set by vTraceRingSetFormats(). */
+static const char * const * ppcEventFormats = NULL;
+static UBaseType_t uxEventFormats = 0;
+
+/*-----------------------------------------------------------*/
+
+void vTraceRingSetFormats( const char * const * ppcFormats,
+                           UBaseType_t uxNumberOfFormats )
+{
+    ppcEventFormats = ppcFormats;
+    uxEventFormats = uxNumberOfFormats;
+}
+/*-----------------------------------------------------------*/
+
+BaseType_t xTraceRingRegisterTask( TaskHandle_t xTask )
+{
+    BaseType_t xReturn = pdFAIL;
+
+    if( xTask == NULL )
+    {
+        xTask = xTaskGetCurrentTaskHandle();
+    }
+
+    if( xReaderMutex == NULL )
+    {
+        xReaderMutex = xDemoSemaphoreCreateMutex();
+        configASSERT( xReaderMutex );
+    }
+
+    if( uxRegisteredRings < ringMAX_RINGS )
+    {
+        memset( ( void * ) &( xRings[ uxRegisteredRings ] ), 0x00, sizeof( TraceRing_t ) );
+        xRings[ uxRegisteredRings ].xTask = xTask;
+        uxRegisteredRings++;
+        xReturn = pdPASS;
+    }
+
+    return xReturn;
+}
+/*-----------------------------------------------------------*/
+
+void vTraceRingRecord( uint16_t usEventId,
+                       uint32_t ulArgument1,
+                       uint32_t ulArgument2 )
+{
+    TraceRing_t * pxRing = prvGetRing();
+    TraceRecord_t * pxRecord;
+    uint32_t ulHead;
+
+    if( pxRing != NULL )
+    {
+        ulHead = pxRing->ulHead;
+
+        if( ( ulHead - pxRing->ulTail ) >= ( uint32_t ) ringRECORDS_PER_RING )
+        {
+            /* The ring is full.  Drop the new event rather than overwrite an
+             * old one, as the reader may be reading the old one. */
+            pxRing->ulDropped++;
+        }
+        else
+        {
+            pxRecord = &( pxRing->xRecords[ ulHead & ringINDEX_MASK ] );
+            pxRecord->xTimestamp = demoGET_TIMESTAMP();
+            pxRecord->ulSequence = Atomic_Increment_u32( &ulNextSequence );
+            pxRecord->ulArgument1 = ulArgument1;
+            pxRecord->ulArgument2 = ulArgument2;
+            pxRecord->usEventId = usEventId;
+
+            /* The record must be complete before the reader can see it. */
+            portMEMORY_BARRIER();
+            pxRing->ulHead = ulHead + 1UL;
+        }
+    }
+}
+/*-----------------------------------------------------------*/
+
+BaseType_t xTraceRingFormatNext( char * pcBuffer,
+                                 size_t xBufferLength )
+{
+    TraceRing_t * pxOldest = NULL;
+    TraceRecord_t xRecord;
+    const TraceRecord_t * pxCandidate;
+    UBaseType_t ux;
+    size_t xLength = 0;
+    int iWritten;
+
+    configASSERT( pcBuffer );
+
+    if( xReaderMutex == NULL )
+    {
+        /* No rings have been registered. */
+        return pdFALSE;
+    }
+
+    xSemaphoreTake( xReaderMutex, portMAX_DELAY );
+    {
+        /* Find the ring whose next published record has the lowest sequence
+         * number, which is not necessarily the lowest sequence number
+         * allocated, as described at the top of this file.  The
+         * sequence numbers are compared as a signed difference so the
+         * comparison still works when the counter wraps. */
+        for( ux = 0; ux < uxRegisteredRings; ux++ )
+        {
+            if( xRings[ ux ].ulHead != xRings[ ux ].ulTail )
+            {
+                pxCandidate = &( xRings[ ux ].xRecords[ xRings[ ux ].ulTail & ringINDEX_MASK ] );
+
+                if( ( pxOldest == NULL ) ||
+                    ( ( int32_t ) ( pxCandidate->ulSequence - pxOldest->xRecords[ pxOldest->ulTail & ringINDEX_MASK ].ulSequence ) < 0 ) )
+                {
+                    pxOldest = &( xRings[ ux ] );
+                }
+            }
+        }
+
+        if( pxOldest != NULL )
+        {
+            /* Take a copy of the record before releasing its slot back to the
+             * writer. */
+            portMEMORY_BARRIER();
+            xRecord = pxOldest->xRecords[ pxOldest->ulTail & ringINDEX_MASK ];
+            portMEMORY_BARRIER();
+            pxOldest->ulTail = pxOldest->ulTail + 1UL;
+        }
+    }
+    xSemaphoreGive( xReaderMutex );
+
+    if( pxOldest == NULL )
+    {
+        return pdFALSE;
+    }
+
+    /* Format the record now it has been removed from the ring, so the mutex
+     * is not held while formatting. */
+    iWritten = snprintf( pcBuffer, xBufferLength, "[%10u us] %-*s ",
+                         ( unsigned ) demoTIMESTAMP_TO_US( xRecord.xTimestamp ),
+                         ( int ) configMAX_TASK_NAME_LEN,
+                         pcTaskGetName( pxOldest->xTask ) );
+
+    if( iWritten > 0 )
+    {
+        xLength = ( size_t ) iWritten;
+    }
+
+    if( xLength < xBufferLength )
+    {
+        if( xRecord.usEventId < uxEventFormats )
+        {
+            iWritten = snprintf( &( pcBuffer[ xLength ] ), xBufferLength - xLength, ppcEventFormats[ xRecord.usEventId ],
+                                 ( unsigned ) xRecord.ulArgument1, ( unsigned ) xRecord.ulArgument2 );
+        }
+        else
+        {
+            iWritten = snprintf( &( pcBuffer[ xLength ] ), xBufferLength - xLength, "event %u (%u, %u)",
+                                 ( unsigned ) xRecord.usEventId, ( unsigned ) xRecord.ulArgument1, ( unsigned ) xRecord.ulArgument2 );
+        }
+
+        if( iWritten > 0 )
+        {
+            xLength += ( size_t ) iWritten;
+        }
+    }
+
+    if( xLength < xBufferLength )
+    {
+        snprintf( &( pcBuffer[ xLength ] ), xBufferLength - xLength, "\r\n" );
+    }
+
+    return pdTRUE;
+}
+/*-----------------------------------------------------------*/
+
+UBaseType_t uxTraceRingGetPending( void )
+{
+    UBaseType_t ux, uxPending = 0;
+
+    for( ux = 0; ux < uxRegisteredRings; ux++ )
+    {
+        uxPending += ( UBaseType_t ) ( xRings[ ux ].ulHead - xRings[ ux ].ulTail );
+    }
+
+    return uxPending;
+}
+/*-----------------------------------------------------------*/
+
+uint32_t ulTraceRingGetDropped( void )
+{
+    UBaseType_t ux;
+    uint32_t ulDropped = 0;
+
+    for( ux = 0; ux < uxRegisteredRings; ux++ )
+    {
+        ulDropped += xRings[ ux ].ulDropped;
+    }
+
+    return ulDropped;
+}
+/*-----------------------------------------------------------*/
+
+void vStartTraceRingDrainTask( uint16_t usStackSize,
+                               UBaseType_t uxPriority )
+{
+    demoTASK_MEMORY( xDrainMemory, 1, demoSTATIC_TASK_STACK_DEPTH );
+
+    xDemoTaskCreate( prvTraceRingDrainTask, "TraceDrain", usStackSize, NULL, uxPriority, NULL, &xDrainMemory );
+}
+/*-----------------------------------------------------------*/
+
+static void prvTraceRingDrainTask( void * pvParameters )
+{
+    static char cLine[ ringMAX_LINE_LENGTH ];
+    BaseType_t xPrinted;
+
+    ( void ) pvParameters;
+
+    for( ; ; )
+    {
+        xPrinted = pdFALSE;
+
+        while( xTraceRingFormatNext( cLine, sizeof( cLine ) ) != pdFALSE )
+        {
+            fputs( cLine, stdout );
+            xPrinted = pdTRUE;
+        }
+
+        if( xPrinted != pdFALSE )
+        {
+            fflush( stdout );
+        }
+
+        vTaskDelay( pdMS_TO_TICKS( ringDRAIN_PERIOD_MS ) );
+    }
+}
+/*-----------------------------------------------------------*/
+
+static TraceRing_t * prvGetRing( void )
+{
+    TaskHandle_t xTask = xTaskGetCurrentTaskHandle();
+    TraceRing_t * pxReturn = NULL;
+    UBaseType_t ux;
+
+    for( ux = 0; ux < uxRegisteredRings; ux++ )
+    {
+        if( xRings[ ux ].xTask == xTask )
+        {
+            pxReturn = &( xRings[ ux ] );
+            break;
+        }
+    }
+
+    return pxReturn;
+}
+/*-----------------------------------------------------------*/
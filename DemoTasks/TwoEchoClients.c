@@ -38,10 +38,13 @@
 #include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 
 /* FreeRTOS includes. */
 #include "FreeRTOS.h"
 #include "task.h"
+#include "queue.h"
+#include "semphr.h"
 
 /* FreeRTOS+UDP includes. */
 #include "FreeRTOS_IP.h"
@@ -49,14 +52,21 @@
 
 /* Demo Includes */
 #include "user_settings.h"
+#include "DemoStatic.h"
+#include "DemoTimestamp.h"
+#include "DemoMessage.h"
+#include "ClientSocket.h"
+#include "UDPBufferPool.h"
+#include "TwoEchoClients.h"
 
 /* Small delay used between attempts to obtain a zero copy buffer. */
 #define echoTINY_DELAY    ( ( portTickType ) 2 )
 
-/* The echo tasks create a socket, send out a number of echo requests
- *  (listening for each echo reply), then close the socket again before
- *  starting over.  This delay is used between each iteration to ensure the
- *  network does not get too congested.  The delay is shorter when the Windows
+/* The echo tasks send out a number of echo requests (listening for each echo
+ *  reply), then pause before starting over.  The socket is kept open between
+ *  iterations unless clientsockPERSISTENT is 0 - see ClientSocket.h.  This
+ *  delay is used between each iteration to ensure the network does not get
+ *  too congested.  The delay is shorter when the Windows
  *  simulator is used because simulated time is slower than real time. */
 #ifdef _WINDOWS_
     #define echoLOOP_DELAY    ( ( portTickType ) 10 / portTICK_RATE_MS )
@@ -81,10 +91,37 @@
     #define xZeroCopyReceiveEvent    0
 #endif
 
+/* The format of the echo requests, msgFORMAT_BINARY or msgFORMAT_TEXT - see
+ * DemoMessage.h.  Binary requests carry echoBINARY_PAYLOAD_LENGTH bytes after
+ * the header. */
+#ifndef echoMESSAGE_FORMAT
+    #define echoMESSAGE_FORMAT    msgFORMAT_BINARY
+#endif
+
+#define echoBINARY_PAYLOAD_LENGTH    16
+
 /* The echo server is assumed to be on port 7, which is the standard echo
  * protocol port. */
 #define echoECHO_PORT    ( 8080 )
 
+/* The phases of a benchmark started by xEchoBenchStart(). */
+#define echoBENCH_IDLE                0
+#define echoBENCH_COPY                1
+#define echoBENCH_ZERO_COPY           2
+
+/* While the send window is full the benchmark blocks on the socket for this
+ * long at a time, between checks for requests that have timed out. */
+#define echoBENCH_POLL_TIME           ( ( TickType_t ) 10 / portTICK_RATE_MS )
+
+/* A request sent by the benchmark that has not been answered yet. */
+typedef struct xECHO_BENCH_IN_FLIGHT
+{
+    BaseType_t xInUse;         /* pdTRUE while the request is waiting for a reply. */
+    uint32_t ulSequence;       /* The sequence number of the request. */
+    DemoTimestamp_t xSendTime; /* When the request was sent, for the round trip time. */
+    TickType_t xSendTick;      /* When the request was sent, for the timeout. */
+} EchoBenchInFlight_t;
+
 /*
  * Uses a socket to send data to, then receive data from, the standard echo
  * port number 7.  prvEchoClientTask() uses the standard interface.
@@ -93,6 +130,42 @@
 static void prvEchoClientTask( void * pvParameters );
 static void prvZeroCopyEchoClientTask( void * pvParameters );
 
+/*
+ * Prepare the template used to build the echo requests sent by a task.
+ * pcText is only used by text requests.
+ */
+static void prvInitMessageTemplate( DemoMessageTemplate_t * pxTemplate,
+                                    const char * pcText );
+
+/*
+ * Fill in the address of the echo server.
+ */
+static void prvGetEchoServerAddress( struct freertos_sockaddr * pxAddress );
+
+/*
+ * Run the benchmark phase xPhase, sending requests using the zero copy
+ * interface if xPhase is echoBENCH_ZERO_COPY, then move on to the next phase.
+ * Called by the echo client task to which the phase belongs.
+ */
+static void prvRunBenchmark( BaseType_t xPhase );
+
+/*
+ * Return pdTRUE if pucReply is a correct echo of the benchmark request with
+ * sequence number ulSequence.
+ */
+static BaseType_t prvIsBenchmarkReply( const uint8_t * pucReply,
+                                       int32_t lReplyLength,
+                                       uint32_t ulSequence );
+
+/*
+ * Search the echoBENCH_MAX_WINDOW entries of pxInFlight for the request with
+ * sequence number ulSequence if xInUse is pdTRUE, or for a free entry if xInUse
+ * is pdFALSE.  Returns NULL if there is no such entry.
+ */
+static EchoBenchInFlight_t * prvFindInFlight( EchoBenchInFlight_t * pxInFlight,
+                                              BaseType_t xInUse,
+                                              uint32_t ulSequence );
+
 /* The receive timeout is set shorter when the windows simulator is used
  * because simulated time is slower than real time. */
 #ifdef _WINDOWS_
@@ -101,36 +174,61 @@ static void prvZeroCopyEchoClientTask( void * pvParameters );
     const portTickType xReceiveTimeOut = 1000 / portTICK_RATE_MS;
 #endif
 
+/* The benchmark currently being run, and its parameters. */
+static volatile BaseType_t xBenchPhase = echoBENCH_IDLE;
+static size_t xBenchPayloadBytes = 0;
+static UBaseType_t uxBenchWindow = 1;
+static uint32_t ulBenchRunTimeMs = 0;
+
+/* Each benchmark request is the sequence number followed by this pattern. */
+static uint8_t ucBenchTemplate[ echoBENCH_MAX_PAYLOAD ];
+
+/* The results of the latest benchmark run of each interface, indexed by
+ * phase - 1. */
+static EchoBenchResult_t xBenchResults[ 2 ];
+
 /*-----------------------------------------------------------*/
 
 void vStartEchoClientTasks( uint16_t usTaskStackSize,
                             unsigned portBASE_TYPE uxTaskPriority )
 {
+    demoTASK_MEMORY( xEchoClientMemory, 1, demoSTATIC_TASK_STACK_DEPTH );
+    demoTASK_MEMORY( xZeroCopyEchoClientMemory, 1, demoSTATIC_TASK_STACK_DEPTH );
+
+    /* The zero copy task takes its buffers from the pool, which is refilled
+     * at a lower priority than the echo tasks run. */
+    vUDPBufferPoolStart( usTaskStackSize, ( uxTaskPriority > tskIDLE_PRIORITY ) ? ( uxTaskPriority - 1 ) : tskIDLE_PRIORITY );
+
     /* Create the echo client task that does not use the zero copy interface. */
-    xTaskCreate( prvEchoClientTask,                     /* The function that implements the task. */
-                 ( const signed char * const ) "Echo0", /* Just a text name for the task to aid debugging. */
-                 usTaskStackSize,                       /* The stack size is defined in FreeRTOSIPConfig.h. */
-                 NULL,                                  /* The task parameter, not used in this case. */
-                 uxTaskPriority,                        /* The priority assigned to the task is defined in FreeRTOSConfig.h. */
-                 NULL );                                /* The task handle is not used. */
+    xDemoTaskCreate( prvEchoClientTask,                     /* The function that implements the task. */
+                     ( const signed char * const ) "Echo0", /* Just a text name for the task to aid debugging. */
+                     usTaskStackSize,                       /* The stack size is defined in FreeRTOSIPConfig.h. */
+                     NULL,                                  /* The task parameter, not used in this case. */
+                     uxTaskPriority,                        /* The priority assigned to the task is defined in FreeRTOSConfig.h. */
+                     NULL,                                  /* The task handle is not used. */
+                     &xEchoClientMemory );                  /* The task's memory if demoSTATIC_ALLOCATION is 1. */
 
     /* Create the echo client task that does use the zero copy interface. */
-    xTaskCreate( prvZeroCopyEchoClientTask,             /* The function that implements the task. */
-                 ( const signed char * const ) "Echo1", /* Just a text name for the task to aid debugging. */
-                 usTaskStackSize,                       /* The stack size is defined in FreeRTOSIPConfig.h. */
-                 NULL,                                  /* The task parameter, not used in this case. */
-                 uxTaskPriority,                        /* The priority assigned to the task is defined in FreeRTOSConfig.h. */
-                 NULL );                                /* The task handle is not used. */
+    xDemoTaskCreate( prvZeroCopyEchoClientTask,             /* The function that implements the task. */
+                     ( const signed char * const ) "Echo1", /* Just a text name for the task to aid debugging. */
+                     usTaskStackSize,                       /* The stack size is defined in FreeRTOSIPConfig.h. */
+                     NULL,                                  /* The task parameter, not used in this case. */
+                     uxTaskPriority,                        /* The priority assigned to the task is defined in FreeRTOSConfig.h. */
+                     NULL,                                  /* The task handle is not used. */
+                     &xZeroCopyEchoClientMemory );          /* The task's memory if demoSTATIC_ALLOCATION is 1. */
 }
 /*-----------------------------------------------------------*/
 
 static void prvEchoClientTask( void * pvParameters )
 {
     Socket_t xSocket;
+    ClientSocket_t xClient;
     struct freertos_sockaddr xEchoServerAddress;
-    int8_t cTxString[ 25 ], cRxString[ 25 ]; /* Make sure the stack is large enough to hold these.  Turn on stack overflow checking during debug to be sure. */
+    uint8_t ucTxMessage[ msgMAX_MESSAGE_LENGTH ], ucRxMessage[ msgMAX_MESSAGE_LENGTH ]; /* Make sure the stack is large enough to hold these.  Turn on stack overflow checking during debug to be sure. */
+    static DemoMessageTemplate_t xTemplate;
     int32_t lLoopCount = 0UL;
     int32_t lReturned;
+    size_t xTxLength;
     const int32_t lMaxLoopCount = 50;
     volatile uint32_t ulRxCount = 0UL, ulTxCount = 0UL;
     uint32_t xAddressLength = sizeof( xEchoServerAddress );
@@ -141,57 +239,64 @@ static void prvEchoClientTask( void * pvParameters )
     /* Echo requests are sent to the echo server.  The address of the echo
      * server is configured by the constants configECHO_SERVER_ADDR0 to
      * configECHO_SERVER_ADDR3 in FreeRTOSConfig.h. */
-    xEchoServerAddress.sin_port = FreeRTOS_htons( echoECHO_PORT );
+    prvGetEchoServerAddress( &xEchoServerAddress );
 
-    #if defined( ipconfigIPv4_BACKWARD_COMPATIBLE ) && ( ipconfigIPv4_BACKWARD_COMPATIBLE == 0 )
-    {
-        xEchoServerAddress.sin_address.ulIP_IPv4 = FreeRTOS_inet_addr_quick( configECHO_SERVER_ADDR0,
-                                                                             configECHO_SERVER_ADDR1,
-                                                                             configECHO_SERVER_ADDR2,
-                                                                             configECHO_SERVER_ADDR3 );
-    }
-    #else
-    {
-        xEchoServerAddress.sin_addr = FreeRTOS_inet_addr_quick( configECHO_SERVER_ADDR0,
-                                                                configECHO_SERVER_ADDR1,
-                                                                configECHO_SERVER_ADDR2,
-                                                                configECHO_SERVER_ADDR3 );
-    }
-    #endif /* defined( ipconfigIPv4_BACKWARD_COMPATIBLE ) && ( ipconfigIPv4_BACKWARD_COMPATIBLE == 0 ) */
-
-    xEchoServerAddress.sin_family = FREERTOS_AF_INET;
+    /* A time out is set on the socket so a missing reply does not cause the
+     * task to block indefinitely. */
+    vClientSocketInit( &xClient, xReceiveTimeOut );
+    prvInitMessageTemplate( &xTemplate, "Message number " );
 
     for( ; ; )
     {
-        /* Create a socket. */
-        xSocket = FreeRTOS_socket( FREERTOS_AF_INET, FREERTOS_SOCK_DGRAM, FREERTOS_IPPROTO_UDP );
-        configASSERT( xSocket != FREERTOS_INVALID_SOCKET );
+        /* Stop sending the normal echo requests while a benchmark is
+         * running, and run the benchmark if it is this task's turn. */
+        if( xBenchPhase != echoBENCH_IDLE )
+        {
+            if( xBenchPhase == echoBENCH_COPY )
+            {
+                prvRunBenchmark( echoBENCH_COPY );
+            }
+            else
+            {
+                vTaskDelay( echoLOOP_DELAY );
+            }
+
+            continue;
+        }
 
-        /* Set a time out so a missing reply does not cause the task to block
-         * indefinitely. */
-        FreeRTOS_setsockopt( xSocket, 0, FREERTOS_SO_RCVTIMEO, &xReceiveTimeOut, sizeof( xReceiveTimeOut ) );
+        /* Obtain the socket, which is only created if there is not already
+         * one open. */
+        xSocket = xClientSocketOpen( &xClient );
 
-        /* Send a number of echo requests. */
-        for( lLoopCount = 0; lLoopCount < lMaxLoopCount; lLoopCount++ )
+        if( xSocket == FREERTOS_INVALID_SOCKET )
         {
-            /* Create the string that is sent to the echo server. */
-            sprintf( ( char * ) cTxString, "Message number %u\r\n", ulTxCount );
-
-            /* Send the string to the socket.  ulFlags is set to 0, so the zero
-             * copy interface is not used.  That means the data from cTxString is
-             * copied into a network buffer inside FreeRTOS_sendto(), and cTxString
-             * can be reused as soon as FreeRTOS_sendto() has returned.  1 is added
-             * to ensure the NULL string terminator is sent as part of the message. */
-            lReturned = FreeRTOS_sendto( xSocket,                                  /* The socket being sent to. */
-                                         ( void * ) cTxString,                     /* The data being sent. */
-                                         strlen( ( const char * ) cTxString ) + 1, /* The length of the data being sent. */
-                                         0,                                        /* ulFlags with the FREERTOS_ZERO_COPY bit clear. */
-                                         &xEchoServerAddress,                      /* The destination address. */
+            continue;
+        }
+
+        /* Send a number of echo requests, stopping early if the socket is
+         * closed because of errors. */
+        for( lLoopCount = 0; ( lLoopCount < lMaxLoopCount ) && ( xClient.xSocket != FREERTOS_INVALID_SOCKET ); lLoopCount++ )
+        {
+            /* Create the message that is sent to the echo server. */
+            xTxLength = xDemoMessageEncode( &xTemplate, ulTxCount, ucTxMessage, sizeof( ucTxMessage ) );
+
+            /* Send the message to the socket.  ulFlags is set to 0, so the zero
+             * copy interface is not used.  That means the data from ucTxMessage
+             * is copied into a network buffer inside FreeRTOS_sendto(), and
+             * ucTxMessage can be reused as soon as FreeRTOS_sendto() has
+             * returned. */
+            lReturned = FreeRTOS_sendto( xSocket,                 /* The socket being sent to. */
+                                         ( void * ) ucTxMessage,  /* The data being sent. */
+                                         xTxLength,               /* The length of the data being sent. */
+                                         0,                       /* ulFlags with the FREERTOS_ZERO_COPY bit clear. */
+                                         &xEchoServerAddress,     /* The destination address. */
                                          sizeof( xEchoServerAddress ) );
 
             if( lReturned == 0 )
             {
                 /* The send operation failed. */
+                vClientSocketReport( &xClient, pdFALSE );
+                continue;
             }
             else
             {
@@ -207,23 +312,21 @@ static void prvEchoClientTask( void * pvParameters )
 
             /* Receive data echoed back to the socket.  ulFlags is zero, so the
              * zero copy option is not being used and the received data will be
-             * copied into the buffer pointed to by cRxString.  xAddressLength is
-             * not actually used (at the time of writing this comment, anyway) by
-             * FreeRTOS_recvfrom(), but is set appropriately in case future
+             * copied into the buffer pointed to by ucRxMessage.  xAddressLength
+             * is not actually used (at the time of writing this comment, anyway)
+             * by FreeRTOS_recvfrom(), but is set appropriately in case future
              * versions do use it. */
-
-            memset( ( void * ) cRxString, 0x00, sizeof( cRxString ) );
-            lReturned = FreeRTOS_recvfrom( xSocket,             /* The socket being received from. */
-                                           cRxString,           /* The buffer into which the received data will be written. */
-                                           sizeof( cRxString ), /* The size of the buffer provided to receive the data. */
-                                           0,                   /* ulFlags with the FREERTOS_ZERO_COPY bit clear. */
-                                           &xEchoServerAddress, /* The address from where the data was sent (the source address). */
+            lReturned = FreeRTOS_recvfrom( xSocket,               /* The socket being received from. */
+                                           ucRxMessage,           /* The buffer into which the received data will be written. */
+                                           sizeof( ucRxMessage ), /* The size of the buffer provided to receive the data. */
+                                           0,                     /* ulFlags with the FREERTOS_ZERO_COPY bit clear. */
+                                           &xEchoServerAddress,   /* The address from where the data was sent (the source address). */
                                            &xAddressLength );
 
             if( lReturned > 0 )
             {
-                /* Compare the transmitted string to the received string. */
-                if( strcmp( ( char * ) cRxString, ( char * ) cTxString ) == 0 )
+                /* Compare the transmitted message to the received message. */
+                if( xDemoMessageMatches( ucTxMessage, xTxLength, ucRxMessage, lReturned ) != pdFALSE )
                 {
                     /* The echo reply was received without error. */
                     ulRxCount++;
@@ -233,10 +336,13 @@ static void prvEchoClientTask( void * pvParameters )
                 {
                     FreeRTOS_debug_printf( ( "[Echo Client] Data received was erroneous.\r\n" ) );
                 }
+
+                vClientSocketReport( &xClient, pdTRUE );
             }
             else
             {
                 FreeRTOS_debug_printf( ( "[Echo Client] Data was not received\r\n" ) );
+                vClientSocketReport( &xClient, pdFALSE );
             }
         }
 
@@ -244,8 +350,7 @@ static void prvEchoClientTask( void * pvParameters )
          * congested. */
         vTaskDelay( echoLOOP_DELAY );
 
-        /* Close this socket before looping back to create another. */
-        FreeRTOS_closesocket( xSocket );
+        vClientSocketEndOfBatch( &xClient );
     }
 }
 /*-----------------------------------------------------------*/
@@ -253,8 +358,11 @@ static void prvEchoClientTask( void * pvParameters )
 static void prvZeroCopyEchoClientTask( void * pvParameters )
 {
     Socket_t xSocket;
+    ClientSocket_t xClient;
     struct freertos_sockaddr xEchoServerAddress;
-    static int8_t cTxString[ 40 ];
+    static uint8_t ucTxMessage[ msgMAX_MESSAGE_LENGTH ];
+    static DemoMessageTemplate_t xTemplate;
+    size_t xTxLength;
     int32_t lLoopCount = 0UL;
     volatile uint32_t ulRxCount = 0UL, ulTxCount = 0UL;
     uint32_t xAddressLength = sizeof( xEchoServerAddress );
@@ -262,9 +370,6 @@ static void prvZeroCopyEchoClientTask( void * pvParameters )
     uint8_t * pucUDPPayloadBuffer;
 
     const int32_t lMaxLoopCount = 50;
-    const uint8_t * const pucStringToSend = ( const uint8_t * const ) "Zero copy message number";
-/* The buffer is large enough to hold the string, a number, and the string terminator. */
-    const size_t xBufferLength = strlen( ( char * ) pucStringToSend ) + 15;
 
     #if ipconfigINCLUDE_EXAMPLE_FREERTOS_PLUS_TRACE_CALLS == 1
     {
@@ -286,85 +391,86 @@ static void prvZeroCopyEchoClientTask( void * pvParameters )
     /* Echo requests are sent to the echo server.  The address of the echo
      * server is configured by the constants configECHO_SERVER_ADDR0 to
      * configECHO_SERVER_ADDR3 in FreeRTOSConfig.h. */
-    xEchoServerAddress.sin_port = FreeRTOS_htons( echoECHO_PORT );
+    prvGetEchoServerAddress( &xEchoServerAddress );
 
-    #if defined( ipconfigIPv4_BACKWARD_COMPATIBLE ) && ( ipconfigIPv4_BACKWARD_COMPATIBLE == 0 )
-    {
-        xEchoServerAddress.sin_address.ulIP_IPv4 = FreeRTOS_inet_addr_quick( configECHO_SERVER_ADDR0,
-                                                                             configECHO_SERVER_ADDR1,
-                                                                             configECHO_SERVER_ADDR2,
-                                                                             configECHO_SERVER_ADDR3 );
-    }
-    #else
-    {
-        xEchoServerAddress.sin_addr = FreeRTOS_inet_addr_quick( configECHO_SERVER_ADDR0,
-                                                                configECHO_SERVER_ADDR1,
-                                                                configECHO_SERVER_ADDR2,
-                                                                configECHO_SERVER_ADDR3 );
-    }
-    #endif /* defined( ipconfigIPv4_BACKWARD_COMPATIBLE ) && ( ipconfigIPv4_BACKWARD_COMPATIBLE == 0 ) */
-
-    xEchoServerAddress.sin_family = FREERTOS_AF_INET;
+    /* A time out is set on the socket so a missing reply does not cause the
+     * task to block indefinitely. */
+    vClientSocketInit( &xClient, xReceiveTimeOut );
+    prvInitMessageTemplate( &xTemplate, "Zero copy message number " );
 
     for( ; ; )
     {
-        /* Create a socket. */
-        xSocket = FreeRTOS_socket( FREERTOS_AF_INET, FREERTOS_SOCK_DGRAM, FREERTOS_IPPROTO_UDP );
-        configASSERT( xSocket != FREERTOS_INVALID_SOCKET );
+        /* See the comment in prvEchoClientTask(). */
+        if( xBenchPhase != echoBENCH_IDLE )
+        {
+            if( xBenchPhase == echoBENCH_ZERO_COPY )
+            {
+                prvRunBenchmark( echoBENCH_ZERO_COPY );
+            }
+            else
+            {
+                vTaskDelay( echoLOOP_DELAY );
+            }
+
+            continue;
+        }
+
+        /* Obtain the socket, which is only created if there is not already
+         * one open. */
+        xSocket = xClientSocketOpen( &xClient );
 
-        /* Set a time out so a missing reply does not cause the task to block
-         * indefinitely. */
-        FreeRTOS_setsockopt( xSocket, 0, FREERTOS_SO_RCVTIMEO, &xReceiveTimeOut, sizeof( xReceiveTimeOut ) );
+        if( xSocket == FREERTOS_INVALID_SOCKET )
+        {
+            continue;
+        }
 
-        /* Send a number of echo requests. */
-        for( lLoopCount = 0; lLoopCount < lMaxLoopCount; lLoopCount++ )
+        /* Send a number of echo requests, stopping early if the socket is
+         * closed because of errors. */
+        for( lLoopCount = 0; ( lLoopCount < lMaxLoopCount ) && ( xClient.xSocket != FREERTOS_INVALID_SOCKET ); lLoopCount++ )
         {
             /* This task is going to send using the zero copy interface.  The
              * data being sent is therefore written directly into a buffer that is
-             * passed by reference into the FreeRTOS_sendto() function.  First
-             * obtain a buffer of adequate size from the IP stack.  Although a max
-             * delay is used, the actual delay will be capped to
-             * ipconfigMAX_SEND_BLOCK_TIME_TICKS, hence the test to ensure a buffer
-             * was actually obtained. */
-
-            #if defined( ipconfigIPv4_BACKWARD_COMPATIBLE ) && ( ipconfigIPv4_BACKWARD_COMPATIBLE == 0 )
-                pucUDPPayloadBuffer = ( uint8_t * ) FreeRTOS_GetUDPPayloadBuffer_Multi( xBufferLength, portMAX_DELAY, ipTYPE_IPv4 );
-            #else
-                pucUDPPayloadBuffer = ( uint8_t * ) FreeRTOS_GetUDPPayloadBuffer( xBufferLength, portMAX_DELAY );
-            #endif /* defined( ipconfigIPv4_BACKWARD_COMPATIBLE ) && ( ipconfigIPv4_BACKWARD_COMPATIBLE == 0 ) */
+             * passed by reference into the FreeRTOS_sendto() function.  The
+             * buffer is taken from the pool of buffers already obtained from the
+             * IP stack, so normally no wait is needed.  If the pool is empty
+             * only a short time is spent waiting for it to be refilled, hence
+             * the test to ensure a buffer was actually obtained. */
+            configASSERT( xDemoMessageMaxLength( &xTemplate ) <= udppoolBUFFER_SIZE );
+            pucUDPPayloadBuffer = pucUDPBufferPoolTake( echoTINY_DELAY );
 
             if( pucUDPPayloadBuffer != NULL )
             {
-                /* A buffer was successfully obtained.  Create the string that is
-                 * sent to the echo server.  Note the string is written directly
-                 * into the buffer obtained from the IP stack. */
-                sprintf( ( char * ) pucUDPPayloadBuffer, "%s %u\r\n", ( const char * ) "Zero copy message number", ulTxCount );
-
-                /* Also copy the string into a local buffer so it can be compared
-                 * with the string that is later received back from the echo server. */
-                strcpy( ( char * ) cTxString, ( char * ) pucUDPPayloadBuffer );
+                /* A buffer was successfully obtained.  Create the message that
+                 * is sent to the echo server in a local buffer, so it can be
+                 * compared with the message that is later received back from the
+                 * echo server, then copy it into the buffer obtained from the IP
+                 * stack. */
+                xTxLength = xDemoMessageEncode( &xTemplate, ulTxCount, ucTxMessage, sizeof( ucTxMessage ) );
+                memcpy( pucUDPPayloadBuffer, ucTxMessage, xTxLength );
 
                 /* Pass the buffer into the send function.  ulFlags has the
                  * FREERTOS_ZERO_COPY bit set so the IP stack will take control of
                  * the	buffer, rather than copy data out of the buffer. */
                 echoMARK_SEND_IN_TRACE_BUFFER( xZeroCopySendEvent );
-                lReturned = FreeRTOS_sendto( xSocket,                                  /* The socket being sent to. */
-                                             ( void * ) pucUDPPayloadBuffer,           /* The buffer being passed into the IP stack. */
-                                             strlen( ( const char * ) cTxString ) + 1, /* The length of the data being sent.  Plus 1 to ensure the null terminator is part of the data. */
-                                             FREERTOS_ZERO_COPY,                       /* ulFlags with the zero copy bit is set. */
-                                             &xEchoServerAddress,                      /* Where the data is being sent. */
+                lReturned = FreeRTOS_sendto( xSocket,                        /* The socket being sent to. */
+                                             ( void * ) pucUDPPayloadBuffer, /* The buffer being passed into the IP stack. */
+                                             xTxLength,                      /* The length of the data being sent. */
+                                             FREERTOS_ZERO_COPY,             /* ulFlags with the zero copy bit is set. */
+                                             &xEchoServerAddress,            /* Where the data is being sent. */
                                              sizeof( xEchoServerAddress ) );
 
                 if( lReturned == 0 )
                 {
                     /* The send operation failed, so this task is still
-                     * responsible	for the buffer obtained from the IP stack.  To
+                     * responsible	for the buffer taken from the pool.  To
                      * ensure the buffer is not lost it must either be used again,
-                     * or, as in this case, returned to the IP stack using
-                     * FreeRTOS_ReleaseUDPPayloadBuffer().  pucUDPPayloadBuffer can
-                     * be safely re-used to receive from the socket below once the
-                     * buffer has been returned to the stack. */
-                    FreeRTOS_ReleaseUDPPayloadBuffer( ( void * ) pucUDPPayloadBuffer );
+                     * or, as in this case, given back to the pool using
+                     * vUDPBufferPoolReturn().  pucUDPPayloadBuffer can be safely
+                     * re-used to receive from the socket below once the buffer
+                     * has been given back. */
+                    vUDPBufferPoolReturn( pucUDPPayloadBuffer );
+                    vClientSocketReport( &xClient, pdFALSE );
+                    continue;
                 }
                 else
                 {
@@ -400,11 +506,11 @@ static void prvZeroCopyEchoClientTask( void * pvParameters )
 
                 if( lReturned > 0 )
                 {
-                    /* Compare the string sent to the echo server with the string
-                     * received back from the echo server. */
-                    if( strcmp( ( char * ) pucUDPPayloadBuffer, ( char * ) cTxString ) == 0 )
+                    /* Compare the message sent to the echo server with the
+                     * message received back from the echo server. */
+                    if( xDemoMessageMatches( ucTxMessage, xTxLength, pucUDPPayloadBuffer, lReturned ) != pdFALSE )
                     {
-                        /* The strings matched. */
+                        /* The messages matched. */
                         ulRxCount++;
                         FreeRTOS_debug_printf( ( "[Zero Copy] Data was received correctly.\r\n" ) );
                     }
@@ -416,10 +522,12 @@ static void prvZeroCopyEchoClientTask( void * pvParameters )
                     /* The buffer that contains the data passed out of the stack
                      * must* be returned to the stack. */
                     FreeRTOS_ReleaseUDPPayloadBuffer( pucUDPPayloadBuffer );
+                    vClientSocketReport( &xClient, pdTRUE );
                 }
                 else
                 {
                     FreeRTOS_debug_printf( ( "[Zero Copy] Data was not received\r\n" ) );
+                    vClientSocketReport( &xClient, pdFALSE );
                 }
             }
         }
@@ -428,8 +536,321 @@ static void prvZeroCopyEchoClientTask( void * pvParameters )
          * congested. */
         vTaskDelay( echoLOOP_DELAY );
 
-        /* Close this socket before looping back to create another. */
+        vClientSocketEndOfBatch( &xClient );
+    }
+}
+/*-----------------------------------------------------------*/
+
+static void prvInitMessageTemplate( DemoMessageTemplate_t * pxTemplate,
+                                    const char * pcText )
+{
+    #if ( echoMESSAGE_FORMAT == msgFORMAT_TEXT )
+    {
+        /* The terminator is sent too, as the original demo did. */
+        vDemoMessageInitText( pxTemplate, pcText, pdTRUE );
+    }
+    #else
+    {
+        ( void ) pcText;
+        vDemoMessageInitBinary( pxTemplate, echoBINARY_PAYLOAD_LENGTH );
+    }
+    #endif
+}
+/*-----------------------------------------------------------*/
+
+static void prvGetEchoServerAddress( struct freertos_sockaddr * pxAddress )
+{
+    pxAddress->sin_port = FreeRTOS_htons( echoECHO_PORT );
+
+    #if defined( ipconfigIPv4_BACKWARD_COMPATIBLE ) && ( ipconfigIPv4_BACKWARD_COMPATIBLE == 0 )
+    {
+        pxAddress->sin_address.ulIP_IPv4 = FreeRTOS_inet_addr_quick( configECHO_SERVER_ADDR0,
+                                                                     configECHO_SERVER_ADDR1,
+                                                                     configECHO_SERVER_ADDR2,
+                                                                     configECHO_SERVER_ADDR3 );
+    }
+    #else
+    {
+        pxAddress->sin_addr = FreeRTOS_inet_addr_quick( configECHO_SERVER_ADDR0,
+                                                        configECHO_SERVER_ADDR1,
+                                                        configECHO_SERVER_ADDR2,
+                                                        configECHO_SERVER_ADDR3 );
+    }
+    #endif /* defined( ipconfigIPv4_BACKWARD_COMPATIBLE ) && ( ipconfigIPv4_BACKWARD_COMPATIBLE == 0 ) */
+
+    pxAddress->sin_family = FREERTOS_AF_INET;
+}
+/*-----------------------------------------------------------*/
+
+BaseType_t xEchoBenchStart( size_t xPayloadBytes,
+                            uint32_t ulRunTimeMs,
+                            UBaseType_t uxWindow )
+{
+    BaseType_t xReturn = pdFAIL;
+    size_t x;
+
+    if( ( xPayloadBytes >= echoBENCH_MIN_PAYLOAD ) && ( xPayloadBytes <= echoBENCH_MAX_PAYLOAD ) &&
+        ( ulRunTimeMs > 0 ) && ( ulRunTimeMs <= echoBENCH_MAX_RUN_TIME_MS ) &&
+        ( uxWindow > 0 ) && ( uxWindow <= echoBENCH_MAX_WINDOW ) &&
+        ( xBenchPhase == echoBENCH_IDLE ) )
+    {
+        /* Build the request template once, outside of the timed loop. */
+        for( x = 0; x < xPayloadBytes; x++ )
+        {
+            ucBenchTemplate[ x ] = ( uint8_t ) ( 'A' + ( x % 26 ) );
+        }
+
+        xBenchPayloadBytes = xPayloadBytes;
+        ulBenchRunTimeMs = ulRunTimeMs;
+        uxBenchWindow = uxWindow;
+
+        /* The echo client tasks poll the phase, so setting it last starts the
+         * benchmark. */
+        xBenchPhase = echoBENCH_COPY;
+        xReturn = pdPASS;
+    }
+
+    return xReturn;
+}
+/*-----------------------------------------------------------*/
+
+BaseType_t xEchoBenchGetResults( EchoBenchResult_t * pxCopyResult,
+                                 EchoBenchResult_t * pxZeroCopyResult )
+{
+    taskENTER_CRITICAL();
+    {
+        *pxCopyResult = xBenchResults[ 0 ];
+        *pxZeroCopyResult = xBenchResults[ 1 ];
+    }
+    taskEXIT_CRITICAL();
+
+    return ( xBenchPhase != echoBENCH_IDLE ) ? pdTRUE : pdFALSE;
+}
+/*-----------------------------------------------------------*/
+
+static BaseType_t prvIsBenchmarkReply( const uint8_t * pucReply,
+                                       int32_t lReplyLength,
+                                       uint32_t ulSequence )
+{
+    BaseType_t xReturn = pdFALSE;
+
+    if( ( lReplyLength == ( int32_t ) xBenchPayloadBytes ) &&
+        ( memcmp( pucReply, &ulSequence, sizeof( ulSequence ) ) == 0 ) &&
+        ( memcmp( &( pucReply[ sizeof( ulSequence ) ] ), &( ucBenchTemplate[ sizeof( ulSequence ) ] ), xBenchPayloadBytes - sizeof( ulSequence ) ) == 0 ) )
+    {
+        xReturn = pdTRUE;
+    }
+
+    return xReturn;
+}
+/*-----------------------------------------------------------*/
+
+static EchoBenchInFlight_t * prvFindInFlight( EchoBenchInFlight_t * pxInFlight,
+                                              BaseType_t xInUse,
+                                              uint32_t ulSequence )
+{
+    EchoBenchInFlight_t * pxReturn = NULL;
+    UBaseType_t ux;
+
+    /* The window is small, so a linear search is used.  Requests are not tied
+     * to an entry by their sequence number, so a request that is never
+     * answered only holds up its own entry. */
+    for( ux = 0; ux < echoBENCH_MAX_WINDOW; ux++ )
+    {
+        if( ( pxInFlight[ ux ].xInUse == xInUse ) &&
+            ( ( xInUse == pdFALSE ) || ( pxInFlight[ ux ].ulSequence == ulSequence ) ) )
+        {
+            pxReturn = &( pxInFlight[ ux ] );
+            break;
+        }
+    }
+
+    return pxReturn;
+}
+/*-----------------------------------------------------------*/
+
+static void prvRunBenchmark( BaseType_t xPhase )
+{
+    /* Static so the copy task does not need a stack big enough for an MTU
+     * sized buffer.  Only the copy task uses it. */
+    static uint8_t ucRxBuffer[ echoBENCH_MAX_PAYLOAD ];
+    EchoBenchInFlight_t xInFlight[ echoBENCH_MAX_WINDOW ];
+    EchoBenchInFlight_t * pxSlot;
+    EchoBenchResult_t xResult;
+    Socket_t xSocket;
+    struct freertos_sockaddr xEchoServerAddress;
+    uint32_t xAddressLength = sizeof( xEchoServerAddress );
+    uint32_t ulSequence = 0, ulReplySequence;
+    UBaseType_t uxOutstanding = 0, ux;
+    uint8_t * pucBuffer;
+    int32_t lReturned;
+    BaseType_t xFlags, xSending = pdTRUE;
+    const TickType_t xPollTime = echoBENCH_POLL_TIME;
+    TickType_t xStartTime, xNow, xRunTime = pdMS_TO_TICKS( ulBenchRunTimeMs );
+
+    memset( ( void * ) &xResult, 0x00, sizeof( xResult ) );
+    memset( ( void * ) xInFlight, 0x00, sizeof( xInFlight ) );
+    xResult.ulPayloadBytes = ( uint32_t ) xBenchPayloadBytes;
+    xResult.ulWindow = ( uint32_t ) uxBenchWindow;
+    xFlags = ( xPhase == echoBENCH_ZERO_COPY ) ? FREERTOS_ZERO_COPY : 0;
+
+    prvGetEchoServerAddress( &xEchoServerAddress );
+    xSocket = FreeRTOS_socket( FREERTOS_AF_INET, FREERTOS_SOCK_DGRAM, FREERTOS_IPPROTO_UDP );
+
+    if( xSocket != FREERTOS_INVALID_SOCKET )
+    {
+        /* The task only blocks on the socket when it cannot send, and then
+         * only for long enough to check whether any request has timed out. */
+        FreeRTOS_setsockopt( xSocket, 0, FREERTOS_SO_RCVTIMEO, &xPollTime, sizeof( xPollTime ) );
+        xStartTime = xTaskGetTickCount();
+
+        /* Keep up to uxBenchWindow requests in flight until the run time has
+         * passed, then wait for the requests still in flight to be answered or
+         * to time out. */
+        while( ( xSending != pdFALSE ) || ( uxOutstanding > 0 ) )
+        {
+            xNow = xTaskGetTickCount();
+
+            if( ( xNow - xStartTime ) >= xRunTime )
+            {
+                xSending = pdFALSE;
+            }
+
+            /* Send requests until the window is full.  If a send fails the
+             * receive below provides the delay before it is tried again. */
+            while( ( xSending != pdFALSE ) && ( uxOutstanding < uxBenchWindow ) )
+            {
+                pxSlot = prvFindInFlight( xInFlight, pdFALSE, 0 );
+                configASSERT( pxSlot );
+
+                /* Each request is the template with its sequence number at the
+                 * start. */
+                if( xPhase == echoBENCH_ZERO_COPY )
+                {
+                    /* The pool buffers are large enough for the biggest
+                     * benchmark payload. */
+                    pucBuffer = pucUDPBufferPoolTake( echoTINY_DELAY );
+
+                    if( pucBuffer == NULL )
+                    {
+                        break;
+                    }
+
+                    memcpy( pucBuffer, ucBenchTemplate, xBenchPayloadBytes );
+                }
+                else
+                {
+                    /* FreeRTOS_sendto() copies the data, so the template itself
+                     * can be sent. */
+                    pucBuffer = ucBenchTemplate;
+                }
+
+                memcpy( pucBuffer, &ulSequence, sizeof( ulSequence ) );
+
+                pxSlot->xSendTime = demoGET_TIMESTAMP();
+                lReturned = FreeRTOS_sendto( xSocket, ( void * ) pucBuffer, xBenchPayloadBytes, xFlags, &xEchoServerAddress, sizeof( xEchoServerAddress ) );
+
+                if( lReturned == 0 )
+                {
+                    if( xPhase == echoBENCH_ZERO_COPY )
+                    {
+                        /* The stack did not take the buffer, so it must be
+                         * given back. */
+                        vUDPBufferPoolReturn( pucBuffer );
+                    }
+
+                    break;
+                }
+
+                pxSlot->xInUse = pdTRUE;
+                pxSlot->ulSequence = ulSequence;
+                pxSlot->xSendTick = xTaskGetTickCount();
+                xResult.ulSent++;
+                uxOutstanding++;
+                ulSequence++;
+            }
+
+            /* No more requests can be sent until a reply arrives or a
+             * request times out, so wait for a reply.  The receive timeout is
+             * short, so the timeouts are still checked regularly. */
+            if( xPhase == echoBENCH_ZERO_COPY )
+            {
+                lReturned = FreeRTOS_recvfrom( xSocket, ( void * ) &pucBuffer, 0, FREERTOS_ZERO_COPY, &xEchoServerAddress, &xAddressLength );
+            }
+            else
+            {
+                pucBuffer = ucRxBuffer;
+                lReturned = FreeRTOS_recvfrom( xSocket, ( void * ) pucBuffer, sizeof( ucRxBuffer ), 0, &xEchoServerAddress, &xAddressLength );
+            }
+
+            if( lReturned > 0 )
+            {
+                /* Replies are matched to requests by sequence number, so can
+                 * arrive in any order. */
+                ulReplySequence = 0;
+
+                if( lReturned >= ( int32_t ) sizeof( ulReplySequence ) )
+                {
+                    memcpy( &ulReplySequence, pucBuffer, sizeof( ulReplySequence ) );
+                }
+
+                pxSlot = prvFindInFlight( xInFlight, pdTRUE, ulReplySequence );
+
+                if( pxSlot == NULL )
+                {
+                    /* A reply to a request that already timed out, or a
+                     * reply that is so damaged its sequence number is
+                     * unknown. */
+                    xResult.ulLate++;
+                }
+                else
+                {
+                    if( prvIsBenchmarkReply( pucBuffer, lReturned, ulReplySequence ) != pdFALSE )
+                    {
+                        xResult.ulReceived++;
+                        vLogHistogramRecord( &( xResult.xRoundTrip ), demoTIMESTAMP_TO_US( demoGET_TIMESTAMP() - pxSlot->xSendTime ) );
+                    }
+                    else
+                    {
+                        xResult.ulErroneous++;
+                    }
+
+                    pxSlot->xInUse = pdFALSE;
+                    uxOutstanding--;
+                }
+
+                if( xPhase == echoBENCH_ZERO_COPY )
+                {
+                    FreeRTOS_ReleaseUDPPayloadBuffer( ( void * ) pucBuffer );
+                }
+            }
+
+            /* Requests that have not been answered within the receive timeout
+             * are counted as lost, so freeing their place in the window. */
+            xNow = xTaskGetTickCount();
+
+            for( ux = 0; ux < echoBENCH_MAX_WINDOW; ux++ )
+            {
+                if( ( xInFlight[ ux ].xInUse != pdFALSE ) && ( ( xNow - xInFlight[ ux ].xSendTick ) >= xReceiveTimeOut ) )
+                {
+                    xInFlight[ ux ].xInUse = pdFALSE;
+                    xResult.ulLost++;
+                    uxOutstanding--;
+                }
+            }
+        }
+
+        xResult.ulDurationMs = ( uint32_t ) pdTICKS_TO_MS( xTaskGetTickCount() - xStartTime );
         FreeRTOS_closesocket( xSocket );
     }
+
+    taskENTER_CRITICAL();
+    {
+        xBenchResults[ xPhase - 1 ] = xResult;
+    }
+    taskEXIT_CRITICAL();
+
+    /* Hand over to the next phase. */
+    xBenchPhase = ( xPhase == echoBENCH_COPY ) ? echoBENCH_ZERO_COPY : echoBENCH_IDLE;
 }
 /*-----------------------------------------------------------*/
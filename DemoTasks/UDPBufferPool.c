@@ -0,0 +1,212 @@
+/*
+ * FreeRTOS V202411.00
+ * Copyright (C) 2020 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * https://www.FreeRTOS.org
+ * https://github.com/FreeRTOS
+ *
+ */
+
+/*
+ * See UDPBufferPool.h.
+ *
+ * The pool is a queue of buffer pointers.  Taking a buffer from the pool
+ * notifies the refill task, which then obtains buffers from the IP stack
+ * until the queue is full again.  It is the refill task, not the sending
+ * task, that waits if the IP stack has no network buffers available.
+ */
+
+/* Standard includes. */
+#include <stdint.h>
+
+/* FreeRTOS includes. */
+#include "FreeRTOS.h"
+#include "task.h"
+#include "queue.h"
+#include "semphr.h"
+
+/* FreeRTOS+UDP includes. */
+#include "FreeRTOS_IP.h"
+#include "FreeRTOS_Sockets.h"
+
+/* Demo app includes. */
+#include "DemoStatic.h"
+#include "UDPBufferPool.h"
+
+/* The refill task also checks the pool this often, in case a refill failed
+ * because the IP stack had no free network buffers. */
+#define udppoolREFILL_PERIOD_MS    100
+
+/*
+ * Keeps the pool full.
+ */
+static void prvUDPBufferPoolRefillTask( void * pvParameters );
+
+/*-----------------------------------------------------------*/
+
+static QueueHandle_t xPool = NULL;
+static TaskHandle_t xRefillTask = NULL;
+static UDPBufferPoolStats_t xPoolStats = { 0 };
+
+/*-----------------------------------------------------------*/
+
+void vUDPBufferPoolStart( uint16_t usStackSize,
+                          UBaseType_t uxRefillPriority )
+{
+    demoTASK_MEMORY( xRefillTaskMemory, 1, demoSTATIC_TASK_STACK_DEPTH );
+    static BaseType_t xStarted = pdFALSE;
+    BaseType_t xCreate = pdFALSE;
+
+    taskENTER_CRITICAL();
+    {
+        /* Claim the creation of the pool, so two tasks calling this function
+         * at the same time does not result in two pools. */
+        if( xStarted == pdFALSE )
+        {
+            xStarted = pdTRUE;
+            xCreate = pdTRUE;
+        }
+    }
+    taskEXIT_CRITICAL();
+
+    if( xCreate != pdFALSE )
+    {
+        xPool = xDemoQueueCreate( udppoolNUMBER_OF_BUFFERS, sizeof( uint8_t * ) );
+        configASSERT( xPool );
+        xDemoTaskCreate( prvUDPBufferPoolRefillTask, "UDPPool", usStackSize, NULL, uxRefillPriority, &xRefillTask, &xRefillTaskMemory );
+    }
+}
+/*-----------------------------------------------------------*/
+
+uint8_t * pucUDPBufferPoolTake( TickType_t xTicksToWait )
+{
+    uint8_t * pucBuffer = NULL;
+
+    configASSERT( xPool );
+
+    if( xQueueReceive( xPool, &pucBuffer, 0 ) != pdPASS )
+    {
+        taskENTER_CRITICAL();
+        {
+            xPoolStats.ulEmpty++;
+        }
+        taskEXIT_CRITICAL();
+
+        /* Make sure the refill task knows a buffer is wanted, then wait. */
+        xTaskNotifyGive( xRefillTask );
+
+        if( xQueueReceive( xPool, &pucBuffer, xTicksToWait ) != pdPASS )
+        {
+            pucBuffer = NULL;
+        }
+    }
+
+    if( pucBuffer != NULL )
+    {
+        taskENTER_CRITICAL();
+        {
+            xPoolStats.ulTaken++;
+        }
+        taskEXIT_CRITICAL();
+
+        xTaskNotifyGive( xRefillTask );
+    }
+
+    return pucBuffer;
+}
+/*-----------------------------------------------------------*/
+
+void vUDPBufferPoolReturn( uint8_t * pucBuffer )
+{
+    configASSERT( pucBuffer );
+
+    if( xQueueSend( xPool, &pucBuffer, 0 ) == pdPASS )
+    {
+        taskENTER_CRITICAL();
+        {
+            xPoolStats.ulReturned++;
+        }
+        taskEXIT_CRITICAL();
+    }
+    else
+    {
+        /* The refill task filled the pool in the meantime, so the buffer is
+         * not needed. */
+        FreeRTOS_ReleaseUDPPayloadBuffer( ( void * ) pucBuffer );
+    }
+}
+/*-----------------------------------------------------------*/
+
+void vUDPBufferPoolGetStats( UDPBufferPoolStats_t * pxStats )
+{
+    configASSERT( pxStats );
+
+    taskENTER_CRITICAL();
+    {
+        *pxStats = xPoolStats;
+    }
+    taskEXIT_CRITICAL();
+
+    pxStats->ulAvailable = ( xPool != NULL ) ? ( uint32_t ) uxQueueMessagesWaiting( xPool ) : 0UL;
+}
+/*-----------------------------------------------------------*/
+
+static void prvUDPBufferPoolRefillTask( void * pvParameters )
+{
+    uint8_t * pucBuffer;
+
+    ( void ) pvParameters;
+
+    for( ; ; )
+    {
+        while( uxQueueSpacesAvailable( xPool ) > 0 )
+        {
+            #if defined( ipconfigIPv4_BACKWARD_COMPATIBLE ) && ( ipconfigIPv4_BACKWARD_COMPATIBLE == 0 )
+                pucBuffer = ( uint8_t * ) FreeRTOS_GetUDPPayloadBuffer_Multi( udppoolBUFFER_SIZE, portMAX_DELAY, ipTYPE_IPv4 );
+            #else
+                pucBuffer = ( uint8_t * ) FreeRTOS_GetUDPPayloadBuffer( udppoolBUFFER_SIZE, portMAX_DELAY );
+            #endif /* defined( ipconfigIPv4_BACKWARD_COMPATIBLE ) && ( ipconfigIPv4_BACKWARD_COMPATIBLE == 0 ) */
+
+            if( pucBuffer == NULL )
+            {
+                /* The stack has no free network buffers, try again later. */
+                break;
+            }
+
+            if( xQueueSend( xPool, &pucBuffer, 0 ) != pdPASS )
+            {
+                /* Only a buffer given back by vUDPBufferPoolReturn() can have
+                 * filled the pool since it was checked. */
+                FreeRTOS_ReleaseUDPPayloadBuffer( ( void * ) pucBuffer );
+                break;
+            }
+
+            taskENTER_CRITICAL();
+            {
+                xPoolStats.ulAllocated++;
+            }
+            taskEXIT_CRITICAL();
+        }
+
+        /* Wait until a buffer is taken. */
+        ( void ) ulTaskNotifyTake( pdTRUE, pdMS_TO_TICKS( udppoolREFILL_PERIOD_MS ) );
+    }
+}
+/*-----------------------------------------------------------*/
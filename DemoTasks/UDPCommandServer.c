@@ -31,6 +31,8 @@
 /* FreeRTOS includes. */
 #include "FreeRTOS.h"
 #include "task.h"
+#include "queue.h"
+#include "semphr.h"
 
 /* FreeRTOS+CLI includes. */
 #include "FreeRTOS_CLI.h"
@@ -40,34 +42,332 @@
 #include "FreeRTOS_Sockets.h"
 
 /* Demo app includes. */
+#include "DemoStatic.h"
+#include "CLIDispatch.h"
 #include "UDPCommandInterpreter.h"
 
 /* Dimensions the buffer into which input characters are placed. */
 #define cmdMAX_INPUT_SIZE              60
 
-/* Dimensions the buffer into which string outputs can be placed. */
-#define cmdMAX_OUTPUT_SIZE             1024
+/* Commands write their output directly into a zero copy payload buffer, after
+ * the request ID prefix and any output already in the buffer, and are told
+ * about all the space left.  A buffer that already holds output is only
+ * passed to the command again if at least this much space is left, which is
+ * more than the longest row any command writes and the longest help string, so
+ * a row that does not fit is left for the next datagram rather than cut
+ * short.  Otherwise the buffer is sent first. */
+#ifndef cmdMIN_OUTPUT_SPACE
+    #define cmdMIN_OUTPUT_SPACE    512
+#endif
 
 /* Dimensions the buffer passed to the recvfrom() call. */
 #define cmdSOCKET_INPUT_BUFFER_SIZE    60
 
+/* When cmdUSE_BATCHED_RECEIVE is 1 each time the task wakes it drains every
+ * datagram already queued on the socket, using the zero copy interface so no
+ * datagram is limited to cmdSOCKET_INPUT_BUFFER_SIZE bytes, and runs the
+ * commands contained in them back to back.  When it is 0 one datagram is
+ * copied into cLocalBuffer per FreeRTOS_recvfrom() call, as per the original
+ * demo. */
+#ifndef cmdUSE_BATCHED_RECEIVE
+    #define cmdUSE_BATCHED_RECEIVE    1
+#endif
+
+/* The maximum number of datagrams processed in a single wake-up.  Limiting
+ * the batch prevents a continuous stream of commands holding the task in the
+ * drain loop indefinitely. */
+#define cmdMAX_DATAGRAMS_PER_WAKEUP    32
+
+/* The number of clients that can be partway through typing a command at the
+ * same time.  Each client, identified by its IP address and port number, is
+ * given its own input buffer from a pool of this many sessions. */
+#ifndef cmdMAX_SESSIONS
+    #define cmdMAX_SESSIONS    8
+#endif
+
+/* A session that has not received any characters for this long is released
+ * so its slot can be used by a different client.  Any partial command held by
+ * the session is discarded. */
+#ifndef cmdSESSION_IDLE_TIMEOUT_MS
+    #define cmdSESSION_IDLE_TIMEOUT_MS    ( 5UL * 60UL * 1000UL )
+#endif
+
+/* Command output is written by the command itself directly into zero copy
+ * payload buffers of up to cmdMAX_REPLY_PAYLOAD bytes.  When
+ * cmdCOALESCE_REPLIES is 1 a buffer is only passed to the IP stack when it
+ * does not have room for the next chunk of output or the command has
+ * completed.  When it is 0 each chunk of output is sent in its own datagram,
+ * as per the original demo. */
+#ifndef cmdCOALESCE_REPLIES
+    #define cmdCOALESCE_REPLIES    1
+#endif
+
+/* The largest reply payload that fits in a single frame - 20 bytes are
+ * needed for the IPv4 header and 8 bytes for the UDP header. */
+#ifndef cmdMAX_REPLY_PAYLOAD
+    #define cmdMAX_REPLY_PAYLOAD    ( ipconfigNETWORK_MTU - 28 )
+#endif
+
+/* The most digits a client chosen ID can have, which is enough for any 32-bit
+ * value.  A command whose ID is longer, or does not fit in 32 bits, is
+ * rejected. */
+#define cmdMAX_ID_DIGITS           10
+
+/* Commands registered as cliCOST_HEAVY are not executed by the CLI task
+ * itself, but are queued for one of cmdNUMBER_OF_WORKERS worker tasks that run
+ * at a lower priority, so a command that blocks cannot delay the commands
+ * received after it.  The CLI task replies "[<id>] deferred" straight away,
+ * and the worker sends the command's output, tagged with the same ID, when the
+ * command completes.  Set cmdNUMBER_OF_WORKERS to 0 to execute every command
+ * in the CLI task, as per the original demo. */
+#ifndef cmdNUMBER_OF_WORKERS
+    #define cmdNUMBER_OF_WORKERS    2
+#endif
+
+/* The number of heavy commands that can be waiting for a worker.  A heavy
+ * command received when the queue is full is rejected with "[<id>] busy". */
+#ifndef cmdJOB_QUEUE_LENGTH
+    #define cmdJOB_QUEUE_LENGTH    4
+#endif
+
+/* The time to wait before trying again when the IP stack has no payload
+ * buffer available for a reply. */
+#define cmdBUFFER_RETRY_DELAY    ( ( TickType_t ) 2 )
+
+/* The longest time a task waits for a payload buffer for a reply.  If no
+ * buffer becomes available in that time the rest of the reply is dropped, so
+ * running out of network buffers can not hold up the CLI task or the workers
+ * for ever. */
+#ifndef cmdBUFFER_MAX_WAIT_MS
+    #define cmdBUFFER_MAX_WAIT_MS    500
+#endif
+
+/* The state held for each client that is using the command interpreter. */
+typedef struct xCLI_SESSION
+{
+    BaseType_t xInUse;                             /* pdTRUE when the session is allocated to a client. */
+    uint32_t ulAddress;                            /* The client's IP address, as received from the network. */
+    uint16_t usPort;                               /* The client's port number, as received from the network. */
+    struct freertos_sockaddr xClient;              /* The address to which command output is sent. */
+    TickType_t xLastActivity;                      /* The time at which the client last sent data. */
+    signed char cInputString[ cmdMAX_INPUT_SIZE ]; /* The command being assembled from the received characters. */
+    signed char cInputIndex;                       /* The next free position in cInputString. */
+} CLISession_t;
+
+/* A reply that is being assembled for transmission to a client. */
+typedef struct xCLI_REPLY
+{
+    Socket_t xSocket;                          /* The socket the reply is sent from. */
+    const struct freertos_sockaddr * pxClient; /* The address the reply is sent to. */
+    uint8_t * pucBuffer;                       /* The zero copy payload buffer being filled, or NULL if no buffer is held. */
+    size_t xUsed;                              /* The number of bytes already written to pucBuffer. */
+    uint32_t ulRequestId;                      /* The ID written to the start of each datagram. */
+    size_t xPrefixLength;                      /* The length of the ID prefix at the start of pucBuffer. */
+    uint32_t ulChunks;                         /* Output chunks committed to the reply. */
+    uint32_t ulDatagrams;                      /* Datagrams sent for the reply. */
+    BaseType_t xDropped;                       /* pdTRUE if no payload buffer could be obtained, so the rest of the reply was dropped. */
+} CLIReply_t;
+
+/* A heavy command waiting to be executed by a worker task. */
+typedef struct xCLI_JOB
+{
+    uint32_t ulRequestId;                      /* The ID the command's output is tagged with. */
+    struct freertos_sockaddr xClient;          /* The address to which command output is sent. */
+    signed char cCommand[ cmdMAX_INPUT_SIZE ]; /* The null terminated command. */
+} CLIJob_t;
+
 /*
  * The task that runs FreeRTOS+CLI.
  */
 void vUDPCommandInterpreterTask( void * pvParameters );
 
+/*
+ * The tasks that execute heavy commands on behalf of the CLI task.
+ */
+static void prvCommandWorkerTask( void * pvParameters );
+
 /*
  * Open and configure the UDP socket.
  */
 static Socket_t prvOpenUDPServerSocket( uint16_t usPort );
 
+/*
+ * Add the lBytes characters pointed to by pcBytes to the input string of
+ * pxSession, executing the command each time a newline is found and sending
+ * the output generated by the command back to the session's client.  A
+ * complete command that needs no editing is executed where it is in pcBytes,
+ * which is modified to terminate it, rather than being copied into the
+ * session's input string first.
+ */
+static void prvProcessReceivedCharacters( Socket_t xSocket,
+                                          CLISession_t * pxSession,
+                                          signed char * pcBytes,
+                                          long lBytes );
+
+/*
+ * If pcBytes starts with a complete command of fewer than cmdMAX_INPUT_SIZE
+ * characters that contains no backspace or stray carriage return characters,
+ * return the number of characters up to, and including, the newline.  The
+ * command's length, without the line ending, is written to plCommandLength.
+ * Otherwise return 0.
+ */
+static long prvGetCompleteLine( const signed char * pcBytes,
+                                long lBytes,
+                                long * plCommandLength );
+
+/*
+ * Execute the null terminated command pcCommand on behalf of the client of
+ * pxSession, or pass it to a worker task if it is a heavy command.  pcCommand
+ * can start with "#<id> " to choose the ID the reply is tagged with, otherwise
+ * the next free ID is used.  A command whose ID does not fit in 32 bits is not
+ * executed, and "invalid request ID" is sent instead, tagged with the next
+ * free ID.
+ */
+static void prvExecuteCommand( Socket_t xSocket,
+                               CLISession_t * pxSession,
+                               const signed char * pcCommand );
+
+/*
+ * Execute the null terminated command pcCommand, sending the output it
+ * generates to pxClient with every datagram tagged with ulRequestId.
+ */
+static void prvRunCommand( Socket_t xSocket,
+                           const struct freertos_sockaddr * pxClient,
+                           uint32_t ulRequestId,
+                           const signed char * pcCommand );
+
+/*
+ * Send the single line pcMessage to pxClient, tagged with ulRequestId.
+ */
+static void prvSendStatus( Socket_t xSocket,
+                           const struct freertos_sockaddr * pxClient,
+                           uint32_t ulRequestId,
+                           const char * pcMessage );
+
+/*
+ * Prepare pxReply for a reply to pxClient tagged with ulRequestId.
+ */
+static void prvReplyInit( CLIReply_t * pxReply,
+                          Socket_t xSocket,
+                          const struct freertos_sockaddr * pxClient,
+                          uint32_t ulRequestId );
+
+/*
+ * Transmit anything left in pxReply and add its counters to xReceiveStats.
+ */
+static void prvReplyComplete( CLIReply_t * pxReply );
+
+/*
+ * Return the session that belongs to the client at pxClient.  If the client
+ * does not already have a session then a free or idle session is allocated to
+ * it, or, if all sessions are in use, the least recently used session is taken
+ * over.
+ */
+static CLISession_t * prvGetSession( const struct freertos_sockaddr * pxClient );
+
+/*
+ * Return where the next xLength bytes of output should be written in the
+ * reply being assembled in pxReply.  The reply buffer is transmitted first if
+ * it holds output and does not have that much space left, and a new buffer,
+ * starting with the request ID prefix, is obtained if no buffer is held.  A
+ * new buffer can have less than xLength bytes left if the payload is small, so
+ * the space actually available is cmdMAX_REPLY_PAYLOAD - pxReply->xUsed.
+ * Returns NULL, and marks the reply as dropped, if no buffer could be obtained
+ * within cmdBUFFER_MAX_WAIT_MS.
+ */
+static uint8_t * prvReplyReserve( CLIReply_t * pxReply,
+                                  size_t xLength );
+
+/*
+ * Record that xLength bytes were written to the space returned by
+ * prvReplyReserve().
+ */
+static void prvReplyCommit( CLIReply_t * pxReply,
+                            size_t xLength );
+
+/*
+ * Transmit whatever is held in the reply buffer of pxReply.
+ */
+static void prvReplyFlush( CLIReply_t * pxReply );
+
+/*-----------------------------------------------------------*/
+
+/* The pool from which sessions are allocated. */
+static CLISession_t xSessions[ cmdMAX_SESSIONS ];
+
+/* Receive and session counters, see UDPCommandInterpreterStats_t. */
+static UDPCommandInterpreterStats_t xReceiveStats = { 0 };
+
+/* The socket opened by the CLI task, which the worker tasks also reply from. */
+static Socket_t xCommandSocket = FREERTOS_INVALID_SOCKET;
+
+/* The heavy commands waiting for a worker task, or NULL if there are no
+ * worker tasks. */
+static QueueHandle_t xJobQueue = NULL;
+
+/* The ID given to the next request that does not choose its own. */
+static uint32_t ulNextRequestId = 1;
+
 /*-----------------------------------------------------------*/
 
 void vStartUDPCommandInterpreterTask( uint16_t usStackSize,
                                       uint32_t ulPort,
                                       unsigned portBASE_TYPE uxPriority )
 {
-    xTaskCreate( vUDPCommandInterpreterTask, ( signed char * ) "CLI", usStackSize, ( void * ) ulPort, uxPriority, NULL );
+    demoTASK_MEMORY( xCLIMemory, 1, demoSTATIC_TASK_STACK_DEPTH );
+
+    #if ( cmdNUMBER_OF_WORKERS > 0 )
+        demoTASK_MEMORY( xWorkerMemory, cmdNUMBER_OF_WORKERS, demoSTATIC_TASK_STACK_DEPTH );
+        char cWorkerName[] = "CLIWrk0";
+        UBaseType_t uxWorker, uxWorkerPriority;
+
+        xJobQueue = xDemoQueueCreate( cmdJOB_QUEUE_LENGTH, sizeof( CLIJob_t ) );
+
+        if( xJobQueue != NULL )
+        {
+            /* The workers run below the CLI task, so the CLI task always gets
+             * to receive and answer light commands while a heavy command is
+             * executing. */
+            uxWorkerPriority = ( uxPriority > tskIDLE_PRIORITY ) ? ( uxPriority - 1 ) : tskIDLE_PRIORITY;
+
+            for( uxWorker = 0; uxWorker < cmdNUMBER_OF_WORKERS; uxWorker++ )
+            {
+                cWorkerName[ sizeof( cWorkerName ) - 2 ] = ( char ) ( '0' + ( uxWorker % 10 ) );
+                xDemoTaskCreate( prvCommandWorkerTask, ( signed char * ) cWorkerName, usStackSize, NULL, uxWorkerPriority, NULL, &xWorkerMemory );
+            }
+        }
+    #endif /* if ( cmdNUMBER_OF_WORKERS > 0 ) */
+
+    xDemoTaskCreate( vUDPCommandInterpreterTask, ( signed char * ) "CLI", usStackSize, ( void * ) ulPort, uxPriority, NULL, &xCLIMemory );
+}
+/*-----------------------------------------------------------*/
+
+void vUDPCommandInterpreterGetStats( UDPCommandInterpreterStats_t * pxStats )
+{
+    UBaseType_t uxSession;
+    uint32_t ulActive = 0;
+
+    configASSERT( pxStats );
+
+    /* The statistics are updated by the CLI task and the workers, always in
+     * critical sections, so take a consistent copy.  Sessions that have timed
+     * out but not yet been reclaimed are still counted as active. */
+    taskENTER_CRITICAL();
+    {
+        *pxStats = xReceiveStats;
+
+        for( uxSession = 0; uxSession < cmdMAX_SESSIONS; uxSession++ )
+        {
+            if( xSessions[ uxSession ].xInUse != pdFALSE )
+            {
+                ulActive++;
+            }
+        }
+    }
+    taskEXIT_CRITICAL();
+
+    pxStats->ulActiveSessions = ulActive;
+    pxStats->ulMaxSessions = cmdMAX_SESSIONS;
 }
 /*-----------------------------------------------------------*/
 
@@ -78,15 +378,17 @@ void vStartUDPCommandInterpreterTask( uint16_t usStackSize,
  */
 void vUDPCommandInterpreterTask( void * pvParameters )
 {
-    long lBytes, lByte;
-    signed char cInChar, cInputIndex = 0;
-    static signed char cInputString[ cmdMAX_INPUT_SIZE ], cOutputString[ cmdMAX_OUTPUT_SIZE ], cLocalBuffer[ cmdSOCKET_INPUT_BUFFER_SIZE ];
-    portBASE_TYPE xMoreDataToFollow;
+    long lBytes;
     struct freertos_sockaddr xClient;
     socklen_t xClientAddressLength = 0; /* This is required as a parameter to maintain the sendto() Berkeley sockets API - but it is not actually used so can take any value. */
     Socket_t xSocket;
-    extern const uint8_t ucIPAddress[ 4 ];
-    extern const uint8_t ucMACAddress[ 6 ];
+    uint32_t ulBatchSize;
+
+    #if ( cmdUSE_BATCHED_RECEIVE == 1 )
+        uint8_t * pucReceivedDatagram;
+    #else
+        static signed char cLocalBuffer[ cmdSOCKET_INPUT_BUFFER_SIZE ];
+    #endif
 
     /* Just to prevent compiler warnings. */
     ( void ) pvParameters;
@@ -98,78 +400,71 @@ void vUDPCommandInterpreterTask( void * pvParameters )
 
     if( xSocket != FREERTOS_INVALID_SOCKET )
     {
+        /* No jobs can be queued before this point, so the workers never see
+         * an invalid socket. */
+        xCommandSocket = xSocket;
+
         for( ; ; )
         {
-            /* Wait for incoming data on the opened socket. */
-            lBytes = FreeRTOS_recvfrom( xSocket, ( void * ) cLocalBuffer, sizeof( cLocalBuffer ), 0, &xClient, &xClientAddressLength );
+            ulBatchSize = 0;
 
-            if( lBytes != FREERTOS_SOCKET_ERROR )
+            #if ( cmdUSE_BATCHED_RECEIVE == 1 )
             {
-                /* Process each received byte in turn. */
-                lByte = 0;
+                /* Wait for incoming data on the opened socket.  The zero copy
+                 * option is used, so pucReceivedDatagram is set to point to the
+                 * network buffer that holds the datagram, which must be returned
+                 * to the stack once its contents have been processed. */
+                pucReceivedDatagram = NULL;
+                lBytes = FreeRTOS_recvfrom( xSocket, ( void * ) &pucReceivedDatagram, 0, FREERTOS_ZERO_COPY, &xClient, &xClientAddressLength );
 
-                while( lByte < lBytes )
+                while( ( lBytes >= 0 ) && ( pucReceivedDatagram != NULL ) )
                 {
-                    /* The next character in the input buffer. */
-                    cInChar = cLocalBuffer[ lByte ];
-                    lByte++;
+                    ulBatchSize++;
 
-                    /* Newline characters are taken as the end of the command
-                     * string. */
-                    if( cInChar == '\n' )
+                    prvProcessReceivedCharacters( xSocket, prvGetSession( &xClient ), ( signed char * ) pucReceivedDatagram, lBytes );
+
+                    /* The buffer *must* be freed once it is no longer
+                     * needed. */
+                    FreeRTOS_ReleaseUDPPayloadBuffer( ( void * ) pucReceivedDatagram );
+
+                    if( ulBatchSize >= cmdMAX_DATAGRAMS_PER_WAKEUP )
                     {
-                        /* Process the input string received prior to the
-                         * newline. */
-                        do
-                        {
-                            /* Pass the string to FreeRTOS+CLI. */
-                            xMoreDataToFollow = FreeRTOS_CLIProcessCommand( cInputString, cOutputString, cmdMAX_OUTPUT_SIZE );
-
-                            /* Send the output generated by the command's
-                             * implementation. */
-                            FreeRTOS_sendto( xSocket, cOutputString, strlen( ( const char * ) cOutputString ), 0, &xClient, xClientAddressLength );
-                        } while( xMoreDataToFollow != pdFALSE ); /* Until the command does not generate any more output. */
-
-                        /* All the strings generated by the command processing
-                         * have been sent.  Clear the input string ready to receive
-                         * the next command. */
-                        cInputIndex = 0;
-                        memset( cInputString, 0x00, cmdMAX_INPUT_SIZE );
-
-                        /* Transmit a spacer, just to make the command console
-                         * easier to read. */
-                        FreeRTOS_sendto( xSocket, "\r\n", strlen( "\r\n" ), 0, &xClient, xClientAddressLength );
+                        break;
                     }
-                    else
+
+                    /* Collect the next datagram if one is already queued on the
+                     * socket, but do not block if the queue is empty. */
+                    pucReceivedDatagram = NULL;
+                    lBytes = FreeRTOS_recvfrom( xSocket, ( void * ) &pucReceivedDatagram, 0, FREERTOS_ZERO_COPY | FREERTOS_MSG_DONTWAIT, &xClient, &xClientAddressLength );
+                }
+            }
+            #else /* if ( cmdUSE_BATCHED_RECEIVE == 1 ) */
+            {
+                /* Wait for incoming data on the opened socket. */
+                lBytes = FreeRTOS_recvfrom( xSocket, ( void * ) cLocalBuffer, sizeof( cLocalBuffer ), 0, &xClient, &xClientAddressLength );
+
+                if( lBytes != FREERTOS_SOCKET_ERROR )
+                {
+                    ulBatchSize++;
+                    prvProcessReceivedCharacters( xSocket, prvGetSession( &xClient ), cLocalBuffer, lBytes );
+                }
+            }
+            #endif /* if ( cmdUSE_BATCHED_RECEIVE == 1 ) */
+
+            if( ulBatchSize > 0 )
+            {
+                taskENTER_CRITICAL();
+                {
+                    xReceiveStats.ulWakeUps++;
+                    xReceiveStats.ulDatagrams += ulBatchSize;
+                    xReceiveStats.ulLastBatch = ulBatchSize;
+
+                    if( ulBatchSize > xReceiveStats.ulMaxBatch )
                     {
-                        if( cInChar == '\r' )
-                        {
-                            /* Ignore the character.  Newlines are used to
-                             * detect the end of the input string. */
-                        }
-                        else if( cInChar == '\b' )
-                        {
-                            /* Backspace was pressed.  Erase the last character
-                             * in the string - if any. */
-                            if( cInputIndex > 0 )
-                            {
-                                cInputIndex--;
-                                cInputString[ cInputIndex ] = '\0';
-                            }
-                        }
-                        else
-                        {
-                            /* A character was entered.  Add it to the string
-                             * entered so far.  When a \n is entered the complete
-                             * string will be passed to the command interpreter. */
-                            if( cInputIndex < cmdMAX_INPUT_SIZE )
-                            {
-                                cInputString[ cInputIndex ] = cInChar;
-                                cInputIndex++;
-                            }
-                        }
+                        xReceiveStats.ulMaxBatch = ulBatchSize;
                     }
                 }
+                taskEXIT_CRITICAL();
             }
         }
     }
@@ -181,6 +476,564 @@ void vUDPCommandInterpreterTask( void * pvParameters )
 }
 /*-----------------------------------------------------------*/
 
+static CLISession_t * prvGetSession( const struct freertos_sockaddr * pxClient )
+{
+    CLISession_t * pxSession, * pxFree = NULL, * pxOldest = NULL;
+    TickType_t xNow = xTaskGetTickCount();
+    const TickType_t xIdleTimeout = pdMS_TO_TICKS( cmdSESSION_IDLE_TIMEOUT_MS );
+    uint32_t ulAddress;
+    UBaseType_t uxSession;
+
+    #if defined( ipconfigIPv4_BACKWARD_COMPATIBLE ) && ( ipconfigIPv4_BACKWARD_COMPATIBLE == 0 )
+        ulAddress = pxClient->sin_address.ulIP_IPv4;
+    #else
+        ulAddress = pxClient->sin_addr;
+    #endif /* defined( ipconfigIPv4_BACKWARD_COMPATIBLE ) && ( ipconfigIPv4_BACKWARD_COMPATIBLE == 0 ) */
+
+    for( uxSession = 0; uxSession < cmdMAX_SESSIONS; uxSession++ )
+    {
+        pxSession = &( xSessions[ uxSession ] );
+
+        if( pxSession->xInUse != pdFALSE )
+        {
+            if( ( pxSession->ulAddress == ulAddress ) && ( pxSession->usPort == pxClient->sin_port ) )
+            {
+                /* This client already has a session. */
+                pxSession->xLastActivity = xNow;
+                return pxSession;
+            }
+
+            if( ( xNow - pxSession->xLastActivity ) >= xIdleTimeout )
+            {
+                /* The client has gone quiet, so release its session.  The
+                 * counters are also read by other tasks. */
+                taskENTER_CRITICAL();
+                {
+                    pxSession->xInUse = pdFALSE;
+                    xReceiveStats.ulSessionsTimedOut++;
+                }
+                taskEXIT_CRITICAL();
+            }
+            else
+            {
+                /* Remember the least recently used session in case every
+                 * session is in use. */
+                if( ( pxOldest == NULL ) || ( ( xNow - pxSession->xLastActivity ) > ( xNow - pxOldest->xLastActivity ) ) )
+                {
+                    pxOldest = pxSession;
+                }
+            }
+        }
+
+        if( ( pxSession->xInUse == pdFALSE ) && ( pxFree == NULL ) )
+        {
+            pxFree = pxSession;
+        }
+    }
+
+    if( pxFree != NULL )
+    {
+        pxSession = pxFree;
+    }
+    else
+    {
+        /* All the sessions are active, so the least recently used one is taken
+         * over.  Its partially entered command is lost. */
+        pxSession = pxOldest;
+
+        taskENTER_CRITICAL();
+        {
+            xReceiveStats.ulSessionsEvicted++;
+        }
+        taskEXIT_CRITICAL();
+    }
+
+    /* Allocate the session to the new client. */
+    taskENTER_CRITICAL();
+    {
+        pxSession->xInUse = pdTRUE;
+    }
+    taskEXIT_CRITICAL();
+
+    pxSession->ulAddress = ulAddress;
+    pxSession->usPort = pxClient->sin_port;
+    pxSession->xClient = *pxClient;
+    pxSession->xLastActivity = xNow;
+    pxSession->cInputIndex = 0;
+    memset( pxSession->cInputString, 0x00, cmdMAX_INPUT_SIZE );
+
+    return pxSession;
+}
+/*-----------------------------------------------------------*/
+
+static void prvProcessReceivedCharacters( Socket_t xSocket,
+                                          CLISession_t * pxSession,
+                                          signed char * pcBytes,
+                                          long lBytes )
+{
+    long lByte, lLineLength, lCommandLength;
+    signed char cInChar;
+
+    /* Process each received byte in turn. */
+    lByte = 0;
+
+    while( lByte < lBytes )
+    {
+        if( pxSession->cInputIndex == 0 )
+        {
+            /* Nothing has been typed into the session's input string, so if
+             * the received data holds a whole command it can be executed from
+             * the received data itself. */
+            lLineLength = prvGetCompleteLine( &( pcBytes[ lByte ] ), lBytes - lByte, &lCommandLength );
+
+            if( lLineLength > 0 )
+            {
+                pcBytes[ lByte + lCommandLength ] = '\0';
+                prvExecuteCommand( xSocket, pxSession, &( pcBytes[ lByte ] ) );
+                lByte += lLineLength;
+                continue;
+            }
+        }
+
+        /* The next character in the input buffer. */
+        cInChar = pcBytes[ lByte ];
+        lByte++;
+
+        /* Newline characters are taken as the end of the command
+         * string. */
+        if( cInChar == '\n' )
+        {
+            /* Process the input string received prior to the
+             * newline. */
+            prvExecuteCommand( xSocket, pxSession, pxSession->cInputString );
+
+            /* All the strings generated by the command processing
+             * have been sent.  Clear the input string ready to receive
+             * the next command. */
+            pxSession->cInputIndex = 0;
+            memset( pxSession->cInputString, 0x00, cmdMAX_INPUT_SIZE );
+        }
+        else
+        {
+            if( cInChar == '\r' )
+            {
+                /* Ignore the character.  Newlines are used to
+                 * detect the end of the input string. */
+            }
+            else if( cInChar == '\b' )
+            {
+                /* Backspace was pressed.  Erase the last character
+                 * in the string - if any. */
+                if( pxSession->cInputIndex > 0 )
+                {
+                    pxSession->cInputIndex--;
+                    pxSession->cInputString[ pxSession->cInputIndex ] = '\0';
+                }
+            }
+            else
+            {
+                /* A character was entered.  Add it to the string
+                 * entered so far.  When a \n is entered the complete
+                 * string will be passed to the command interpreter.  The
+                 * last position is never written so the string always
+                 * remains terminated. */
+                if( pxSession->cInputIndex < ( cmdMAX_INPUT_SIZE - 1 ) )
+                {
+                    pxSession->cInputString[ pxSession->cInputIndex ] = cInChar;
+                    pxSession->cInputIndex++;
+                }
+            }
+        }
+    }
+}
+/*-----------------------------------------------------------*/
+
+static long prvGetCompleteLine( const signed char * pcBytes,
+                                long lBytes,
+                                long * plCommandLength )
+{
+    long lByte;
+
+    for( lByte = 0; ( lByte < lBytes ) && ( lByte < cmdMAX_INPUT_SIZE ); lByte++ )
+    {
+        if( pcBytes[ lByte ] == '\n' )
+        {
+            *plCommandLength = lByte;
+            return lByte + 1;
+        }
+        else if( pcBytes[ lByte ] == '\r' )
+        {
+            /* A carriage return is only expected as part of a "\r\n" line
+             * ending. */
+            if( ( ( lByte + 1 ) < lBytes ) && ( pcBytes[ lByte + 1 ] == '\n' ) )
+            {
+                *plCommandLength = lByte;
+                return lByte + 2;
+            }
+
+            break;
+        }
+        else if( ( pcBytes[ lByte ] == '\b' ) || ( pcBytes[ lByte ] == '\0' ) )
+        {
+            /* The command needs editing, so must go through the session's
+             * input string. */
+            break;
+        }
+    }
+
+    return 0;
+}
+/*-----------------------------------------------------------*/
+
+static void prvCommandWorkerTask( void * pvParameters )
+{
+    CLIJob_t xJob;
+
+    /* Just to prevent compiler warnings. */
+    ( void ) pvParameters;
+
+    for( ; ; )
+    {
+        if( xQueueReceive( xJobQueue, &xJob, portMAX_DELAY ) == pdPASS )
+        {
+            prvRunCommand( xCommandSocket, &( xJob.xClient ), xJob.ulRequestId, xJob.cCommand );
+        }
+    }
+}
+/*-----------------------------------------------------------*/
+
+static void prvExecuteCommand( Socket_t xSocket,
+                               CLISession_t * pxSession,
+                               const signed char * pcCommand )
+{
+    uint32_t ulRequestId = 0, ulDigit;
+    BaseType_t xIdGiven = pdFALSE, xIdValid = pdTRUE;
+    const signed char * pcCursor = pcCommand;
+    CLIJob_t xJob;
+
+    /* Use the ID chosen by the client, if there is one. */
+    if( *pcCursor == '#' )
+    {
+        pcCursor++;
+
+        while( ( *pcCursor >= '0' ) && ( *pcCursor <= '9' ) )
+        {
+            ulDigit = ( uint32_t ) ( *pcCursor - '0' );
+
+            /* Any more digits than fit in the ID prefix, or a value that
+             * does not fit in 32 bits, makes the ID invalid. */
+            if( ( ( pcCursor - &( pcCommand[ 1 ] ) ) >= cmdMAX_ID_DIGITS ) ||
+                ( ulRequestId > ( ( UINT32_MAX - ulDigit ) / 10UL ) ) )
+            {
+                xIdValid = pdFALSE;
+            }
+            else
+            {
+                ulRequestId = ( ulRequestId * 10UL ) + ulDigit;
+            }
+
+            pcCursor++;
+        }
+
+        if( ( pcCursor != &( pcCommand[ 1 ] ) ) && ( *pcCursor == ' ' ) )
+        {
+            while( *pcCursor == ' ' )
+            {
+                pcCursor++;
+            }
+
+            pcCommand = pcCursor;
+            xIdGiven = pdTRUE;
+        }
+    }
+
+    if( ( xIdGiven == pdFALSE ) || ( xIdValid == pdFALSE ) )
+    {
+        /* Not an ID, so the whole line is passed to the interpreter, or an
+         * ID that is out of range, so the reply needs an ID of its own. */
+        ulRequestId = ulNextRequestId;
+        ulNextRequestId++;
+    }
+
+    if( xIdValid == pdFALSE )
+    {
+        prvSendStatus( xSocket, &( pxSession->xClient ), ulRequestId, "invalid request ID\r\n" );
+    }
+    else if( ( xJobQueue != NULL ) && ( xCLIDispatchGetCostClass( ( const int8_t * ) pcCommand ) == cliCOST_HEAVY ) )
+    {
+        xJob.ulRequestId = ulRequestId;
+        xJob.xClient = pxSession->xClient;
+        strncpy( ( char * ) xJob.cCommand, ( const char * ) pcCommand, cmdMAX_INPUT_SIZE - 1 );
+        xJob.cCommand[ cmdMAX_INPUT_SIZE - 1 ] = '\0';
+
+        /* Don't wait for space in the queue, as that would hold up the light
+         * commands the workers exist to protect. */
+        if( xQueueSend( xJobQueue, &xJob, 0 ) == pdPASS )
+        {
+            taskENTER_CRITICAL();
+            {
+                xReceiveStats.ulDeferred++;
+            }
+            taskEXIT_CRITICAL();
+
+            prvSendStatus( xSocket, &( pxSession->xClient ), ulRequestId, "deferred\r\n" );
+        }
+        else
+        {
+            taskENTER_CRITICAL();
+            {
+                xReceiveStats.ulRejected++;
+            }
+            taskEXIT_CRITICAL();
+
+            prvSendStatus( xSocket, &( pxSession->xClient ), ulRequestId, "busy\r\n" );
+        }
+    }
+    else
+    {
+        prvRunCommand( xSocket, &( pxSession->xClient ), ulRequestId, pcCommand );
+    }
+}
+/*-----------------------------------------------------------*/
+
+static void prvRunCommand( Socket_t xSocket,
+                           const struct freertos_sockaddr * pxClient,
+                           uint32_t ulRequestId,
+                           const signed char * pcCommand )
+{
+    portBASE_TYPE xMoreDataToFollow;
+    CLIReply_t xReply;
+    CLIDispatchContext_t xDispatchContext;
+    int8_t * pcOutput;
+    int8_t cDiscard[ 64 ];
+    size_t xLength, xOutputSpace;
+    uint8_t * pucSpacer;
+
+    prvReplyInit( &xReply, xSocket, pxClient, ulRequestId );
+    vCLIDispatchInitContext( &xDispatchContext );
+
+    do
+    {
+        /* The command writes its output straight into the reply buffer, so
+         * the output does not have to be copied before it is sent.  A row that
+         * does not fit in the space left is returned by the next call, which
+         * then writes it into the next datagram. */
+        pcOutput = ( int8_t * ) prvReplyReserve( &xReply, cmdMIN_OUTPUT_SPACE );
+
+        if( pcOutput != NULL )
+        {
+            xOutputSpace = cmdMAX_REPLY_PAYLOAD - xReply.xUsed;
+        }
+        else
+        {
+            /* There is no buffer to send the output in, so the rest of the
+             * reply is dropped.  The command is still called until it
+             * completes, so it releases its lock and resets any state it
+             * keeps between calls, but its output is discarded. */
+            pcOutput = cDiscard;
+            xOutputSpace = sizeof( cDiscard );
+        }
+
+        pcOutput[ 0 ] = 0x00;
+
+        /* Pass the string to FreeRTOS+CLI, via the dispatch index. */
+        xMoreDataToFollow = xCLIDispatchProcessCommand( &xDispatchContext, pcCommand, pcOutput, xOutputSpace );
+
+        if( pcOutput != cDiscard )
+        {
+            xLength = strlen( ( const char * ) pcOutput );
+
+            /* Queue the output generated by the command's implementation for
+             * transmission. */
+            prvReplyCommit( &xReply, xLength );
+
+            if( ( xLength == 0 ) && ( xMoreDataToFollow != pdFALSE ) && ( xReply.xUsed > xReply.xPrefixLength ) )
+            {
+                /* Nothing fitted in the space left, so the rest of the output
+                 * goes in a new datagram. */
+                prvReplyFlush( &xReply );
+            }
+        }
+    } while( xMoreDataToFollow != pdFALSE ); /* Until the command does not generate any more output. */
+
+    /* Add a spacer, just to make the command console easier to read, then
+     * send whatever output has not already been sent. */
+    pucSpacer = prvReplyReserve( &xReply, strlen( "\r\n" ) );
+
+    if( pucSpacer != NULL )
+    {
+        memcpy( pucSpacer, "\r\n", strlen( "\r\n" ) );
+        prvReplyCommit( &xReply, strlen( "\r\n" ) );
+    }
+
+    prvReplyComplete( &xReply );
+}
+/*-----------------------------------------------------------*/
+
+static void prvSendStatus( Socket_t xSocket,
+                           const struct freertos_sockaddr * pxClient,
+                           uint32_t ulRequestId,
+                           const char * pcMessage )
+{
+    CLIReply_t xReply;
+    size_t xLength = strlen( pcMessage );
+    uint8_t * pucMessage;
+
+    prvReplyInit( &xReply, xSocket, pxClient, ulRequestId );
+    pucMessage = prvReplyReserve( &xReply, xLength );
+
+    if( pucMessage != NULL )
+    {
+        memcpy( pucMessage, pcMessage, xLength );
+        prvReplyCommit( &xReply, xLength );
+    }
+
+    prvReplyComplete( &xReply );
+}
+/*-----------------------------------------------------------*/
+
+static void prvReplyInit( CLIReply_t * pxReply,
+                          Socket_t xSocket,
+                          const struct freertos_sockaddr * pxClient,
+                          uint32_t ulRequestId )
+{
+    pxReply->xSocket = xSocket;
+    pxReply->pxClient = pxClient;
+    pxReply->pucBuffer = NULL;
+    pxReply->xUsed = 0;
+    pxReply->ulRequestId = ulRequestId;
+    pxReply->xPrefixLength = 0;
+    pxReply->ulChunks = 0;
+    pxReply->ulDatagrams = 0;
+    pxReply->xDropped = pdFALSE;
+}
+/*-----------------------------------------------------------*/
+
+static void prvReplyComplete( CLIReply_t * pxReply )
+{
+    prvReplyFlush( pxReply );
+
+    /* Replies are sent by the worker tasks as well as the CLI task. */
+    taskENTER_CRITICAL();
+    {
+        xReceiveStats.ulReplyChunks += pxReply->ulChunks;
+        xReceiveStats.ulReplyDatagrams += pxReply->ulDatagrams;
+
+        if( pxReply->xDropped != pdFALSE )
+        {
+            xReceiveStats.ulRepliesDropped++;
+        }
+    }
+    taskEXIT_CRITICAL();
+}
+/*-----------------------------------------------------------*/
+
+static uint8_t * prvReplyReserve( CLIReply_t * pxReply,
+                                  size_t xLength )
+{
+    TimeOut_t xTimeOut;
+    TickType_t xTicksToWait = pdMS_TO_TICKS( cmdBUFFER_MAX_WAIT_MS );
+
+    if( pxReply->xDropped != pdFALSE )
+    {
+        /* Once part of a reply is lost the rest is not sent either. */
+        return NULL;
+    }
+
+    if( ( pxReply->pucBuffer != NULL ) &&
+        ( pxReply->xUsed > pxReply->xPrefixLength ) &&
+        ( ( cmdMAX_REPLY_PAYLOAD - pxReply->xUsed ) < xLength ) )
+    {
+        prvReplyFlush( pxReply );
+    }
+
+    if( pxReply->pucBuffer == NULL )
+    {
+        /* Obtain a buffer from the IP stack into which the output can be
+         * written directly.  The time each attempt blocks is capped to
+         * ipconfigMAX_SEND_BLOCK_TIME_TICKS, hence the loop, which gives up
+         * after cmdBUFFER_MAX_WAIT_MS in total. */
+        vTaskSetTimeOutState( &xTimeOut );
+
+        for( ; ; )
+        {
+            #if defined( ipconfigIPv4_BACKWARD_COMPATIBLE ) && ( ipconfigIPv4_BACKWARD_COMPATIBLE == 0 )
+                pxReply->pucBuffer = ( uint8_t * ) FreeRTOS_GetUDPPayloadBuffer_Multi( cmdMAX_REPLY_PAYLOAD, xTicksToWait, ipTYPE_IPv4 );
+            #else
+                pxReply->pucBuffer = ( uint8_t * ) FreeRTOS_GetUDPPayloadBuffer( cmdMAX_REPLY_PAYLOAD, xTicksToWait );
+            #endif /* defined( ipconfigIPv4_BACKWARD_COMPATIBLE ) && ( ipconfigIPv4_BACKWARD_COMPATIBLE == 0 ) */
+
+            if( pxReply->pucBuffer != NULL )
+            {
+                break;
+            }
+
+            if( xTaskCheckForTimeOut( &xTimeOut, &xTicksToWait ) != pdFALSE )
+            {
+                pxReply->xDropped = pdTRUE;
+                return NULL;
+            }
+
+            vTaskDelay( cmdBUFFER_RETRY_DELAY );
+        }
+
+        /* Tag the datagram with the request it belongs to. */
+        pxReply->xPrefixLength = ( size_t ) sprintf( ( char * ) pxReply->pucBuffer, "[%lu] ", ( unsigned long ) pxReply->ulRequestId );
+        pxReply->xUsed = pxReply->xPrefixLength;
+    }
+
+    return &( pxReply->pucBuffer[ pxReply->xUsed ] );
+}
+/*-----------------------------------------------------------*/
+
+static void prvReplyCommit( CLIReply_t * pxReply,
+                            size_t xLength )
+{
+    pxReply->ulChunks++;
+
+    pxReply->xUsed += xLength;
+    configASSERT( pxReply->xUsed <= cmdMAX_REPLY_PAYLOAD );
+
+    #if ( cmdCOALESCE_REPLIES == 0 )
+    {
+        /* Each chunk of output is sent in its own datagram. */
+        prvReplyFlush( pxReply );
+    }
+    #endif
+}
+/*-----------------------------------------------------------*/
+
+static void prvReplyFlush( CLIReply_t * pxReply )
+{
+    socklen_t xClientAddressLength = 0; /* Not used by sendto(), see the comment in vUDPCommandInterpreterTask(). */
+
+    if( pxReply->pucBuffer != NULL )
+    {
+        if( pxReply->xUsed > pxReply->xPrefixLength )
+        {
+            /* Pass the buffer into the send function.  ulFlags has the
+             * FREERTOS_ZERO_COPY bit set so the IP stack will take control of
+             * the buffer rather than copy data out of the buffer. */
+            if( FreeRTOS_sendto( pxReply->xSocket, ( void * ) pxReply->pucBuffer, pxReply->xUsed, FREERTOS_ZERO_COPY, pxReply->pxClient, xClientAddressLength ) == 0 )
+            {
+                /* The send operation failed, so this task is still
+                 * responsible for the buffer. */
+                FreeRTOS_ReleaseUDPPayloadBuffer( ( void * ) pxReply->pucBuffer );
+            }
+
+            pxReply->ulDatagrams++;
+        }
+        else
+        {
+            FreeRTOS_ReleaseUDPPayloadBuffer( ( void * ) pxReply->pucBuffer );
+        }
+
+        pxReply->pucBuffer = NULL;
+        pxReply->xUsed = 0;
+    }
+}
+/*-----------------------------------------------------------*/
+
 static Socket_t prvOpenUDPServerSocket( uint16_t usPort )
 {
     struct freertos_sockaddr xServer;
@@ -0,0 +1,408 @@
+/*
+ * FreeRTOS V202411.00
+ * Copyright (C) 2020 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * https://www.FreeRTOS.org
+ * https://github.com/FreeRTOS
+ *
+ */
+
+/*
+ * See UDPServer.h.
+ */
+
+/* Standard includes. */
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+/* FreeRTOS includes. */
+#include "FreeRTOS.h"
+#include "task.h"
+#include "queue.h"
+#include "semphr.h"
+
+/* FreeRTOS+UDP includes. */
+#include "FreeRTOS_IP.h"
+#include "FreeRTOS_Sockets.h"
+
+/* Demo app includes. */
+#include "DemoStatic.h"
+#include "UDPServer.h"
+
+/* The ring slots are masked with this. */
+#define srvINDEX_MASK    ( ( uint32_t ) srvQUEUE_LENGTH - 1UL )
+
+/* A datagram waiting for a worker. */
+typedef struct xUDP_SERVER_ITEM
+{
+    uint8_t * pucData; /* The received data. */
+    int32_t lLength;   /* The number of bytes received. */
+} UDPServerItem_t;
+
+struct xUDP_SERVER;
+
+/* A worker task and its ring.  The receive task is the only writer of ulHead
+ * and the worker is the only writer of ulTail. */
+typedef struct xUDP_SERVER_WORKER
+{
+    struct xUDP_SERVER * pxServer;                                     /* The server the worker belongs to. */
+    TaskHandle_t xTask;                                                /* The worker task, notified each time a datagram is added to the ring. */
+    volatile uint32_t ulHead;                                          /* The number of datagrams added to the ring. */
+    volatile uint32_t ulTail;                                          /* The number of datagrams handled. */
+    UDPServerItem_t xItems[ srvQUEUE_LENGTH ];                         /* The ring. */
+    uint8_t ucCopyBuffers[ srvQUEUE_LENGTH ][ srvMAX_COPY_LENGTH + 1 ]; /* The data of each slot, if the server does not use the zero copy interface. */
+    volatile uint32_t ulHandled;                                       /* Only updated by the worker. */
+    volatile uint32_t ulBytes;                                         /* Only updated by the worker. */
+    uint32_t ulHighWater;                                              /* Only updated by the receive task. */
+} UDPServerWorker_t;
+
+typedef struct xUDP_SERVER
+{
+    const char * pcName;
+    uint16_t usPort;
+    BaseType_t xZeroCopy;
+    UDPServerHandler_t pxHandler;
+    UBaseType_t uxNextWorker;                           /* Where the search for a worker with space starts. */
+    volatile uint32_t ulReceived;                       /* Only updated by the receive task. */
+    volatile uint32_t ulDropped;                        /* Only updated by the receive task. */
+    uint8_t ucDiscardBuffer[ srvMAX_COPY_LENGTH ];      /* Receives datagrams that are dropped, if the server does not use the zero copy interface. */
+    UDPServerWorker_t xWorkers[ srvNUMBER_OF_WORKERS ];
+} UDPServer_t;
+
+/*
+ * Receives datagrams from the server's socket and passes them to the workers.
+ */
+static void prvReceiveTask( void * pvParameters );
+
+/*
+ * Handles the datagrams in one worker's ring.
+ */
+static void prvWorkerTask( void * pvParameters );
+
+/*
+ * Return the next worker, in round robin order, that has space in its ring,
+ * or NULL if every worker's ring is full.
+ */
+static UDPServerWorker_t * prvSelectWorker( UDPServer_t * pxServer );
+
+/*
+ * Add a datagram to a worker's ring, which must have space, and notify the
+ * worker.
+ */
+static void prvPostToWorker( UDPServerWorker_t * pxWorker,
+                             uint8_t * pucData,
+                             int32_t lLength );
+
+/*-----------------------------------------------------------*/
+
+static UDPServer_t xServers[ srvMAX_SERVERS ];
+static UBaseType_t uxServers = 0;
+
+/*-----------------------------------------------------------*/
+
+BaseType_t xUDPServerStart( const char * pcName,
+                            uint16_t usPort,
+                            BaseType_t xZeroCopy,
+                            UDPServerHandler_t pxHandler,
+                            uint16_t usStackSize,
+                            UBaseType_t uxPriority )
+{
+    demoTASK_MEMORY( xWorkerMemory, srvMAX_SERVERS * srvNUMBER_OF_WORKERS, demoSTATIC_TASK_STACK_DEPTH );
+    demoTASK_MEMORY( xReceiveMemory, srvMAX_SERVERS, demoSTATIC_TASK_STACK_DEPTH );
+    UDPServer_t * pxServer = NULL;
+    UDPServerWorker_t * pxWorker;
+    TaskHandle_t xReceiveTask = NULL;
+    char cTaskName[ configMAX_TASK_NAME_LEN ];
+    BaseType_t xReturn = pdPASS;
+    UBaseType_t ux;
+
+    configASSERT( pcName );
+    configASSERT( pxHandler );
+
+    taskENTER_CRITICAL();
+    {
+        if( uxServers < srvMAX_SERVERS )
+        {
+            pxServer = &( xServers[ uxServers ] );
+            memset( ( void * ) pxServer, 0x00, sizeof( UDPServer_t ) );
+            pxServer->pcName = pcName;
+            pxServer->usPort = usPort;
+            pxServer->xZeroCopy = xZeroCopy;
+            pxServer->pxHandler = pxHandler;
+            uxServers++;
+        }
+    }
+    taskEXIT_CRITICAL();
+
+    if( pxServer == NULL )
+    {
+        return pdFAIL;
+    }
+
+    /* Create the workers first, so they are waiting before the receive task
+     * starts passing datagrams to them. */
+    for( ux = 0; ( ux < srvNUMBER_OF_WORKERS ) && ( xReturn == pdPASS ); ux++ )
+    {
+        pxWorker = &( pxServer->xWorkers[ ux ] );
+        pxWorker->pxServer = pxServer;
+        snprintf( cTaskName, sizeof( cTaskName ), "%.*s%u", ( int ) ( sizeof( cTaskName ) - 3 ), pcName, ( unsigned ) ux );
+        xReturn = xDemoTaskCreate( prvWorkerTask, cTaskName, usStackSize, ( void * ) pxWorker, uxPriority, &( pxWorker->xTask ), &xWorkerMemory );
+
+        #if defined( configNUMBER_OF_CORES ) && ( configNUMBER_OF_CORES > 1 ) && ( configUSE_CORE_AFFINITY == 1 ) && ( srvPIN_WORKERS == 1 )
+        {
+            if( xReturn == pdPASS )
+            {
+                /* Core 0 is left for the receive task. */
+                vTaskCoreAffinitySet( pxWorker->xTask, ( UBaseType_t ) 1U << ( ( ux + 1 ) % configNUMBER_OF_CORES ) );
+            }
+        }
+        #endif
+    }
+
+    if( xReturn == pdPASS )
+    {
+        xReturn = xDemoTaskCreate( prvReceiveTask, pcName, usStackSize, ( void * ) pxServer, uxPriority, &xReceiveTask, &xReceiveMemory );
+
+        #if defined( configNUMBER_OF_CORES ) && ( configNUMBER_OF_CORES > 1 ) && ( configUSE_CORE_AFFINITY == 1 ) && ( srvPIN_WORKERS == 1 )
+        {
+            if( xReturn == pdPASS )
+            {
+                vTaskCoreAffinitySet( xReceiveTask, ( UBaseType_t ) 1U );
+            }
+        }
+        #endif
+    }
+
+    return xReturn;
+}
+/*-----------------------------------------------------------*/
+
+UBaseType_t uxUDPServerGetCount( void )
+{
+    return uxServers;
+}
+/*-----------------------------------------------------------*/
+
+BaseType_t xUDPServerGetStats( UBaseType_t uxIndex,
+                               UDPServerStats_t * pxStats )
+{
+    UDPServer_t * pxServer;
+    UBaseType_t ux;
+
+    configASSERT( pxStats );
+
+    if( uxIndex >= uxServers )
+    {
+        return pdFALSE;
+    }
+
+    pxServer = &( xServers[ uxIndex ] );
+
+    taskENTER_CRITICAL();
+    {
+        pxStats->pcName = pxServer->pcName;
+        pxStats->usPort = pxServer->usPort;
+        pxStats->xZeroCopy = pxServer->xZeroCopy;
+        pxStats->ulReceived = pxServer->ulReceived;
+        pxStats->ulDropped = pxServer->ulDropped;
+
+        for( ux = 0; ux < srvNUMBER_OF_WORKERS; ux++ )
+        {
+            pxStats->xWorkers[ ux ].ulHandled = pxServer->xWorkers[ ux ].ulHandled;
+            pxStats->xWorkers[ ux ].ulBytes = pxServer->xWorkers[ ux ].ulBytes;
+            pxStats->xWorkers[ ux ].ulHighWater = pxServer->xWorkers[ ux ].ulHighWater;
+        }
+    }
+    taskEXIT_CRITICAL();
+
+    return pdTRUE;
+}
+/*-----------------------------------------------------------*/
+
+static void prvReceiveTask( void * pvParameters )
+{
+    UDPServer_t * pxServer = ( UDPServer_t * ) pvParameters;
+    UDPServerWorker_t * pxWorker;
+    struct freertos_sockaddr xClient, xBindAddress;
+    uint32_t xClientLength = sizeof( xClient );
+    Socket_t xListeningSocket;
+    uint8_t * pucData;
+    int32_t lBytes;
+
+    /* Attempt to open the socket. */
+    xListeningSocket = FreeRTOS_socket( FREERTOS_AF_INET, FREERTOS_SOCK_DGRAM, FREERTOS_IPPROTO_UDP );
+    configASSERT( xListeningSocket != FREERTOS_INVALID_SOCKET );
+
+    /* Bind the socket to the server's port on any address. */
+    memset( ( void * ) &xBindAddress, 0x00, sizeof( xBindAddress ) );
+    xBindAddress.sin_port = FreeRTOS_htons( pxServer->usPort );
+    xBindAddress.sin_family = FREERTOS_AF_INET;
+    FreeRTOS_bind( xListeningSocket, &xBindAddress, sizeof( xBindAddress ) );
+
+    for( ; ; )
+    {
+        if( pxServer->xZeroCopy != pdFALSE )
+        {
+            /* The stack passes out a reference to the received data, which
+             * is passed on to a worker.  By default the block time is
+             * portMAX_DELAY. */
+            lBytes = FreeRTOS_recvfrom( xListeningSocket, ( void * ) &pucData, 0, FREERTOS_ZERO_COPY, &xClient, &xClientLength );
+
+            if( lBytes > 0 )
+            {
+                pxServer->ulReceived++;
+                pxWorker = prvSelectWorker( pxServer );
+
+                if( pxWorker != NULL )
+                {
+                    prvPostToWorker( pxWorker, pucData, lBytes );
+                }
+                else
+                {
+                    /* No worker has space, so the buffer is returned to the
+                     * stack straight away. */
+                    pxServer->ulDropped++;
+                    FreeRTOS_ReleaseUDPPayloadBuffer( ( void * ) pucData );
+                }
+            }
+        }
+        else
+        {
+            /* Receive straight into the next free slot of a worker's ring.
+             * Only this task adds to the rings, so the slot stays free while
+             * the task is blocked in FreeRTOS_recvfrom(). */
+            pxWorker = prvSelectWorker( pxServer );
+
+            if( pxWorker != NULL )
+            {
+                pucData = pxWorker->ucCopyBuffers[ pxWorker->ulHead & srvINDEX_MASK ];
+            }
+            else
+            {
+                pucData = pxServer->ucDiscardBuffer;
+            }
+
+            lBytes = FreeRTOS_recvfrom( xListeningSocket, ( void * ) pucData, srvMAX_COPY_LENGTH, 0, &xClient, &xClientLength );
+
+            if( lBytes > 0 )
+            {
+                pxServer->ulReceived++;
+
+                if( pxWorker != NULL )
+                {
+                    pucData[ lBytes ] = 0x00;
+                    prvPostToWorker( pxWorker, pucData, lBytes );
+                }
+                else
+                {
+                    pxServer->ulDropped++;
+                }
+            }
+        }
+    }
+}
+/*-----------------------------------------------------------*/
+
+static void prvWorkerTask( void * pvParameters )
+{
+    UDPServerWorker_t * pxWorker = ( UDPServerWorker_t * ) pvParameters;
+    UDPServer_t * pxServer = pxWorker->pxServer;
+    UDPServerItem_t xItem;
+    uint32_t ulTail;
+
+    for( ; ; )
+    {
+        /* Wait to be told there is something in the ring, then empty it. */
+        ulTaskNotifyTake( pdTRUE, portMAX_DELAY );
+
+        while( pxWorker->ulTail != pxWorker->ulHead )
+        {
+            ulTail = pxWorker->ulTail;
+
+            /* The head must be read before the slot it covers. */
+            portMEMORY_BARRIER();
+            xItem = pxWorker->xItems[ ulTail & srvINDEX_MASK ];
+
+            pxServer->pxHandler( xItem.pucData, xItem.lLength );
+
+            if( pxServer->xZeroCopy != pdFALSE )
+            {
+                /* The buffer *must* be freed once it is no longer needed. */
+                FreeRTOS_ReleaseUDPPayloadBuffer( ( void * ) xItem.pucData );
+            }
+
+            pxWorker->ulHandled++;
+            pxWorker->ulBytes += ( uint32_t ) xItem.lLength;
+
+            /* Finish with the slot before giving it back to the receive
+             * task. */
+            portMEMORY_BARRIER();
+            pxWorker->ulTail = ulTail + 1UL;
+        }
+    }
+}
+/*-----------------------------------------------------------*/
+
+static UDPServerWorker_t * prvSelectWorker( UDPServer_t * pxServer )
+{
+    UDPServerWorker_t * pxWorker;
+    UBaseType_t ux, uxIndex;
+
+    for( ux = 0; ux < srvNUMBER_OF_WORKERS; ux++ )
+    {
+        uxIndex = ( pxServer->uxNextWorker + ux ) % srvNUMBER_OF_WORKERS;
+        pxWorker = &( pxServer->xWorkers[ uxIndex ] );
+
+        if( ( pxWorker->ulHead - pxWorker->ulTail ) < ( uint32_t ) srvQUEUE_LENGTH )
+        {
+            pxServer->uxNextWorker = ( uxIndex + 1 ) % srvNUMBER_OF_WORKERS;
+            return pxWorker;
+        }
+    }
+
+    return NULL;
+}
+/*-----------------------------------------------------------*/
+
+static void prvPostToWorker( UDPServerWorker_t * pxWorker,
+                             uint8_t * pucData,
+                             int32_t lLength )
+{
+    uint32_t ulHead = pxWorker->ulHead, ulWaiting;
+    UDPServerItem_t * pxItem = &( pxWorker->xItems[ ulHead & srvINDEX_MASK ] );
+
+    pxItem->pucData = pucData;
+    pxItem->lLength = lLength;
+
+    /* The slot must be complete before the worker can see it. */
+    portMEMORY_BARRIER();
+    pxWorker->ulHead = ulHead + 1UL;
+
+    ulWaiting = ( ulHead + 1UL ) - pxWorker->ulTail;
+
+    if( ulWaiting > pxWorker->ulHighWater )
+    {
+        pxWorker->ulHighWater = ulWaiting;
+    }
+
+    xTaskNotifyGive( pxWorker->xTask );
+}
+/*-----------------------------------------------------------*/
@@ -0,0 +1,690 @@
+/*
+ * FreeRTOS V202411.00
+ * Copyright (C) 2020 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * https://www.FreeRTOS.org
+ * https://github.com/FreeRTOS
+ *
+ */
+
+/*
+ * See Workload.h.
+ *
+ * Each worker waits for its next release time by blocking on its task
+ * notification with a timeout, rather than using xTaskDelayUntil(), so starting
+ * or stopping the workload can wake it straight away by notifying it.  A run
+ * number is incremented each time the workload is started, so a worker can
+ * tell that the run it was part of has been replaced by a new one.  Because
+ * the workers time their own releases they use the PeriodicTask start and end
+ * calls, so their release, response time and deadline statistics are kept,
+ * and shown, along with those of every other periodic task.
+ */
+
+/* Standard includes. */
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+/* FreeRTOS includes. */
+#include "FreeRTOS.h"
+#include "task.h"
+#include "queue.h"
+#include "semphr.h"
+
+/* Demo app includes. */
+#include "DemoStatic.h"
+#include "DemoTimestamp.h"
+#include "DemoLock.h"
+#include "PeriodicTask.h"
+#include "TraceRing.h"
+#include "Workload.h"
+
+/* The number of workers used by the largest built in scenario. */
+#define workloadSCENARIO_TASKS    4
+
+#if ( workloadMAX_TASKS < workloadSCENARIO_TASKS )
+    #error workloadMAX_TASKS must be large enough for the built in scenarios
+#endif
+
+#if ( periodicMAX_TASKS < workloadMAX_TASKS )
+    #error periodicMAX_TASKS must be large enough for every worker to be a periodic task
+#endif
+
+#if ( workloadMAX_LOCKS > 32 )
+    #error The locks used by a worker are held in a 32-bit mask
+#endif
+
+/* A worker's parameters, results and task. */
+typedef struct xWORKLOAD_WORKER
+{
+    TaskHandle_t xTask;
+    WorkloadTaskConfig_t xConfig;
+    LogHistogram_t xBlockingTime;
+} WorkloadWorker_t;
+
+/* A built in scenario.  Workers after the last one listed are not used. */
+typedef struct xWORKLOAD_SCENARIO
+{
+    const char * pcName;
+    const char * pcDescription;
+    WorkloadTaskConfig_t xTasks[ workloadSCENARIO_TASKS ];
+} WorkloadScenario_t;
+
+/*
+ * The task run by each worker.  pvParameters points to the worker's
+ * WorkloadWorker_t.
+ */
+static void prvWorkerTask( void * pvParameters );
+
+/*
+ * Wait until xTime.  Returns pdFALSE, possibly before xTime, if run ulRun has
+ * been stopped or replaced by a new run.
+ */
+static BaseType_t prvWaitUntil( TickType_t xTime,
+                                uint32_t ulRun );
+
+/*
+ * Run job ulJob of worker uxTask with the parameters in pxConfig.  Returns the
+ * time taken to obtain the job's locks, in microseconds.
+ */
+static uint32_t prvRunJob( const WorkloadTaskConfig_t * pxConfig,
+                           UBaseType_t uxTask,
+                           uint32_t ulJob );
+
+/*
+ * Write the output of job ulJob of worker uxTask, if it has any.
+ */
+static void prvWriteOutput( const WorkloadTaskConfig_t * pxConfig,
+                            UBaseType_t uxTask,
+                            uint32_t ulJob );
+
+/*
+ * Use xTicks ticks of CPU time.
+ */
+static void prvUseCpu( TickType_t xTicks );
+
+/*
+ * Set the ceiling of each lock to the highest priority of the workers that
+ * use it.
+ */
+static void prvUpdateCeilings( void );
+
+/*
+ * Return pdTRUE if the parameters in pxConfig are in range.
+ */
+static BaseType_t prvConfigIsValid( const WorkloadTaskConfig_t * pxConfig );
+
+/*-----------------------------------------------------------*/
+
+/* The built in scenarios.  The fields are priority, period, offset, burst,
+ * lock mask, hold time and output characters.  L in "inversion" writes to the
+ * slow output while holding the lock, so output-mode shows the effect of
+ * moving the output out of the lock.  "classic" is the timing of the original
+ * L/M/H demo tasks, where L's output keeps the lock for several seconds and M
+ * is busy most of the time. */
+static const WorkloadScenario_t xScenarios[] =
+{
+    {
+        "inversion",
+        "L/M/H priority inversion on lock 0",
+        {
+            { tskIDLE_PRIORITY + 1, 4000, 0,   0,   0x01, 400, 8 },
+            { tskIDLE_PRIORITY + 2, 200,  200, 150, 0x00, 0,   0 },
+            { tskIDLE_PRIORITY + 3, 1500, 150, 0,   0x01, 10,  0 }
+        }
+    },
+    {
+        "classic",
+        "The original L/M/H demo, L writing slowly under lock 0",
+        {
+            { tskIDLE_PRIORITY + 1, 11000, 0,   0,  0x01, 100, 72 },
+            { tskIDLE_PRIORITY + 2, 60,    0,   50, 0x00, 0,   0  },
+            { tskIDLE_PRIORITY + 3, 5000,  150, 0,  0x01, 0,   32 }
+        }
+    },
+    {
+        "rms",
+        "Rate monotonic, harmonic periods, 70% CPU",
+        {
+            { tskIDLE_PRIORITY + 4, 10, 0, 2, 0x00, 0, 0 },
+            { tskIDLE_PRIORITY + 3, 20, 0, 4, 0x00, 0, 0 },
+            { tskIDLE_PRIORITY + 2, 40, 0, 8, 0x00, 0, 0 },
+            { tskIDLE_PRIORITY + 1, 80, 0, 8, 0x00, 0, 0 }
+        }
+    },
+    {
+        "overload",
+        "As rms but 110% CPU, so the lower priorities miss deadlines",
+        {
+            { tskIDLE_PRIORITY + 4, 10, 0, 3,  0x00, 0, 0 },
+            { tskIDLE_PRIORITY + 3, 20, 0, 6,  0x00, 0, 0 },
+            { tskIDLE_PRIORITY + 2, 40, 0, 12, 0x00, 0, 0 },
+            { tskIDLE_PRIORITY + 1, 80, 0, 16, 0x00, 0, 0 }
+        }
+    },
+    {
+        "contention",
+        "Four tasks sharing locks 0 and 1",
+        {
+            { tskIDLE_PRIORITY + 4, 50,  0,  2,  0x01, 3,  0 },
+            { tskIDLE_PRIORITY + 3, 100, 5,  5,  0x03, 5,  0 },
+            { tskIDLE_PRIORITY + 2, 100, 10, 5,  0x02, 10, 0 },
+            { tskIDLE_PRIORITY + 1, 200, 0,  10, 0x03, 20, 0 }
+        }
+    }
+};
+
+/* The formats of the eWorkloadEvent events, in the same order. */
+static const char * const pcTraceFormats[ eWorkloadNumberOfEvents ] =
+{
+    "Took locks 0x%x after %u us",
+    "Gave locks 0x%x",
+    "Wrote %u chars under the locks",
+    "Queued %u chars for output",
+    "Output buffer full, dropped %u chars"
+};
+
+static WorkloadWorker_t xWorkers[ workloadMAX_TASKS ];
+static DemoLockHandle_t xLocks[ workloadMAX_LOCKS ];
+
+static volatile BaseType_t xRunning = pdFALSE;
+static volatile uint32_t ulCurrentRun = 0;
+static TickType_t xRunStart = 0;
+
+/*-----------------------------------------------------------*/
+
+void vStartWorkload( uint16_t usStackSize )
+{
+    demoTASK_MEMORY( xWorkerMemory, workloadMAX_TASKS, demoSTATIC_TASK_STACK_DEPTH );
+    char cName[ configMAX_TASK_NAME_LEN ];
+    UBaseType_t ux;
+
+    for( ux = 0; ux < workloadMAX_LOCKS; ux++ )
+    {
+        if( xLocks[ ux ] == NULL )
+        {
+            sprintf( cName, "WLock%u", ( unsigned ) ux );
+            xLocks[ ux ] = xDemoLockCreate( cName, eDemoLockMutex, 0 );
+            configASSERT( xLocks[ ux ] );
+        }
+    }
+
+    for( ux = 0; ux < workloadMAX_TASKS; ux++ )
+    {
+        configASSERT( xWorkers[ ux ].xTask == NULL );
+        sprintf( cName, "WL%u", ( unsigned ) ux );
+        xDemoTaskCreate( prvWorkerTask, cName, usStackSize, &( xWorkers[ ux ] ), tskIDLE_PRIORITY, &( xWorkers[ ux ].xTask ), &xWorkerMemory );
+    }
+
+    /* In case the workers were configured before the locks existed. */
+    prvUpdateCeilings();
+}
+/*-----------------------------------------------------------*/
+
+BaseType_t xWorkloadSetLock( UBaseType_t uxLock,
+                             DemoLockHandle_t xLock )
+{
+    BaseType_t xReturn = pdFAIL;
+
+    configASSERT( xLock );
+
+    if( uxLock < workloadMAX_LOCKS )
+    {
+        xLocks[ uxLock ] = xLock;
+        xReturn = pdPASS;
+    }
+
+    return xReturn;
+}
+/*-----------------------------------------------------------*/
+
+BaseType_t xWorkloadSetTask( UBaseType_t uxTask,
+                             const WorkloadTaskConfig_t * pxConfig )
+{
+    BaseType_t xReturn = pdFAIL;
+
+    configASSERT( pxConfig );
+
+    if( ( uxTask < workloadMAX_TASKS ) && ( prvConfigIsValid( pxConfig ) != pdFALSE ) )
+    {
+        taskENTER_CRITICAL();
+        {
+            xWorkers[ uxTask ].xConfig = *pxConfig;
+        }
+        taskEXIT_CRITICAL();
+
+        if( ( pxConfig->uxPriority != 0 ) && ( xWorkers[ uxTask ].xTask != NULL ) )
+        {
+            vTaskPrioritySet( xWorkers[ uxTask ].xTask, pxConfig->uxPriority );
+        }
+
+        prvUpdateCeilings();
+        xReturn = pdPASS;
+    }
+
+    return xReturn;
+}
+/*-----------------------------------------------------------*/
+
+BaseType_t xWorkloadLoadScenario( const char * pcName )
+{
+    const WorkloadScenario_t * pxScenario = NULL;
+    WorkloadTaskConfig_t xUnused;
+    UBaseType_t ux;
+
+    configASSERT( pcName );
+
+    for( ux = 0; ux < ( sizeof( xScenarios ) / sizeof( xScenarios[ 0 ] ) ); ux++ )
+    {
+        if( strcmp( xScenarios[ ux ].pcName, pcName ) == 0 )
+        {
+            pxScenario = &( xScenarios[ ux ] );
+            break;
+        }
+    }
+
+    if( pxScenario == NULL )
+    {
+        return pdFAIL;
+    }
+
+    /* The scenarios only use priorities that fit in the smallest sensible
+     * configMAX_PRIORITIES, but check anyway. */
+    for( ux = 0; ux < workloadSCENARIO_TASKS; ux++ )
+    {
+        if( prvConfigIsValid( &( pxScenario->xTasks[ ux ] ) ) == pdFALSE )
+        {
+            return pdFAIL;
+        }
+    }
+
+    memset( &xUnused, 0x00, sizeof( xUnused ) );
+
+    for( ux = 0; ux < workloadMAX_TASKS; ux++ )
+    {
+        ( void ) xWorkloadSetTask( ux, ( ux < workloadSCENARIO_TASKS ) ? &( pxScenario->xTasks[ ux ] ) : &xUnused );
+    }
+
+    return pdPASS;
+}
+/*-----------------------------------------------------------*/
+
+const char * pcWorkloadGetScenario( UBaseType_t uxIndex,
+                                    const char ** ppcDescription )
+{
+    const char * pcReturn = NULL;
+
+    if( uxIndex < ( sizeof( xScenarios ) / sizeof( xScenarios[ 0 ] ) ) )
+    {
+        pcReturn = xScenarios[ uxIndex ].pcName;
+
+        if( ppcDescription != NULL )
+        {
+            *ppcDescription = xScenarios[ uxIndex ].pcDescription;
+        }
+    }
+
+    return pcReturn;
+}
+/*-----------------------------------------------------------*/
+
+void vWorkloadStart( void )
+{
+    UBaseType_t ux;
+
+    taskENTER_CRITICAL();
+    {
+        for( ux = 0; ux < workloadMAX_TASKS; ux++ )
+        {
+            configASSERT( xWorkers[ ux ].xTask );
+            vPeriodicTaskResetTask( xWorkers[ ux ].xTask );
+            vLogHistogramReset( &( xWorkers[ ux ].xBlockingTime ) );
+        }
+
+        xRunStart = xTaskGetTickCount();
+        ulCurrentRun++;
+        xRunning = pdTRUE;
+    }
+    taskEXIT_CRITICAL();
+
+    for( ux = 0; ux < workloadMAX_TASKS; ux++ )
+    {
+        configASSERT( xWorkers[ ux ].xTask );
+        xTaskNotifyGive( xWorkers[ ux ].xTask );
+    }
+}
+/*-----------------------------------------------------------*/
+
+void vWorkloadStop( void )
+{
+    UBaseType_t ux;
+
+    xRunning = pdFALSE;
+
+    for( ux = 0; ux < workloadMAX_TASKS; ux++ )
+    {
+        configASSERT( xWorkers[ ux ].xTask );
+        xTaskNotifyGive( xWorkers[ ux ].xTask );
+    }
+}
+/*-----------------------------------------------------------*/
+
+BaseType_t xWorkloadIsRunning( void )
+{
+    return xRunning;
+}
+/*-----------------------------------------------------------*/
+
+BaseType_t xWorkloadGetTask( UBaseType_t uxTask,
+                             WorkloadTaskConfig_t * pxConfig,
+                             WorkloadTaskStats_t * pxStats )
+{
+    BaseType_t xReturn = pdFALSE;
+
+    configASSERT( pxConfig );
+    configASSERT( pxStats );
+
+    if( uxTask < workloadMAX_TASKS )
+    {
+        taskENTER_CRITICAL();
+        {
+            *pxConfig = xWorkers[ uxTask ].xConfig;
+            pxStats->xBlockingTime = xWorkers[ uxTask ].xBlockingTime;
+
+            /* A worker only becomes a periodic task when it first runs. */
+            if( ( xWorkers[ uxTask ].xTask == NULL ) ||
+                ( xPeriodicTaskGetTaskStats( xWorkers[ uxTask ].xTask, &( pxStats->xPeriodic ) ) == pdFAIL ) )
+            {
+                memset( ( void * ) &( pxStats->xPeriodic ), 0x00, sizeof( pxStats->xPeriodic ) );
+                pxStats->xPeriodic.xTask = xWorkers[ uxTask ].xTask;
+            }
+        }
+        taskEXIT_CRITICAL();
+
+        xReturn = pdTRUE;
+    }
+
+    return xReturn;
+}
+/*-----------------------------------------------------------*/
+
+TaskHandle_t xWorkloadGetTaskHandle( UBaseType_t uxTask )
+{
+    configASSERT( uxTask < workloadMAX_TASKS );
+
+    return xWorkers[ uxTask ].xTask;
+}
+/*-----------------------------------------------------------*/
+
+const char * const * ppcWorkloadGetTraceFormats( UBaseType_t * puxNumberOfFormats )
+{
+    configASSERT( puxNumberOfFormats );
+
+    *puxNumberOfFormats = ( UBaseType_t ) eWorkloadNumberOfEvents;
+
+    return pcTraceFormats;
+}
+/*-----------------------------------------------------------*/
+
+static void prvWorkerTask( void * pvParameters )
+{
+    WorkloadWorker_t * pxWorker = ( WorkloadWorker_t * ) pvParameters;
+    WorkloadTaskConfig_t xConfig;
+    uint32_t ulRun = 0, ulJob = 0, ulBlockingUs;
+    TickType_t xRelease;
+
+    for( ; ; )
+    {
+        /* Wait for a run this worker has not yet taken part in. */
+        while( ( xRunning == pdFALSE ) || ( ulRun == ulCurrentRun ) )
+        {
+            ( void ) ulTaskNotifyTake( pdTRUE, portMAX_DELAY );
+        }
+
+        taskENTER_CRITICAL();
+        {
+            ulRun = ulCurrentRun;
+            xRelease = xRunStart;
+            xConfig = pxWorker->xConfig;
+        }
+        taskEXIT_CRITICAL();
+
+        if( xConfig.uxPriority == 0 )
+        {
+            /* Not used in this run. */
+            continue;
+        }
+
+        xRelease += pdMS_TO_TICKS( xConfig.ulOffsetMs );
+        ulJob = 0;
+
+        while( prvWaitUntil( xRelease, ulRun ) != pdFALSE )
+        {
+            /* The deadline is the end of the period.  Registering again picks
+             * up a period changed by xWorkloadSetTask(). */
+            ( void ) xPeriodicTaskRegister( pdMS_TO_TICKS( xConfig.ulPeriodMs ), 0 );
+
+            vPeriodicTaskStartJob( xRelease );
+            ulBlockingUs = prvRunJob( &xConfig, ( UBaseType_t ) ( pxWorker - xWorkers ), ulJob );
+            ulJob++;
+            vPeriodicTaskEndJob();
+
+            taskENTER_CRITICAL();
+            {
+                if( xConfig.ulLockMask != 0 )
+                {
+                    vLogHistogramRecord( &( pxWorker->xBlockingTime ), ulBlockingUs );
+                }
+
+                /* Pick up any change made while the job was running. */
+                xConfig = pxWorker->xConfig;
+            }
+            taskEXIT_CRITICAL();
+
+            if( xConfig.uxPriority == 0 )
+            {
+                break;
+            }
+
+            /* A job that overran its period is followed straight away by the
+             * next one, which then starts late. */
+            xRelease += pdMS_TO_TICKS( xConfig.ulPeriodMs );
+        }
+    }
+}
+/*-----------------------------------------------------------*/
+
+static BaseType_t prvWaitUntil( TickType_t xTime,
+                                uint32_t ulRun )
+{
+    TickType_t xNow;
+
+    for( ; ; )
+    {
+        if( ( xRunning == pdFALSE ) || ( ulRun != ulCurrentRun ) )
+        {
+            return pdFALSE;
+        }
+
+        xNow = xTaskGetTickCount();
+
+        /* True if xNow is at or after xTime, allowing for the tick count
+         * overflowing. */
+        if( ( TickType_t ) ( xNow - xTime ) < ( portMAX_DELAY >> 1 ) )
+        {
+            return pdTRUE;
+        }
+
+        /* Any notification, including one that is nothing to do with the
+         * workload, just causes the loop to check again. */
+        ( void ) ulTaskNotifyTake( pdTRUE, xTime - xNow );
+    }
+}
+/*-----------------------------------------------------------*/
+
+static uint32_t prvRunJob( const WorkloadTaskConfig_t * pxConfig,
+                           UBaseType_t uxTask,
+                           uint32_t ulJob )
+{
+    UBaseType_t ux;
+    DemoTimestamp_t xWaitStart;
+    uint32_t ulBlockingUs = 0;
+
+    prvUseCpu( pdMS_TO_TICKS( pxConfig->ulBurstMs ) );
+
+    if( pxConfig->ulLockMask != 0 )
+    {
+        xWaitStart = demoGET_TIMESTAMP();
+
+        for( ux = 0; ux < workloadMAX_LOCKS; ux++ )
+        {
+            if( ( pxConfig->ulLockMask & ( 1UL << ux ) ) != 0 )
+            {
+                ( void ) xDemoLockTake( xLocks[ ux ], portMAX_DELAY );
+            }
+        }
+
+        ulBlockingUs = demoTIMESTAMP_TO_US( demoGET_TIMESTAMP() - xWaitStart );
+        vTraceRingRecord( eWorkloadEventLocksTaken, pxConfig->ulLockMask, ulBlockingUs );
+
+        prvUseCpu( pdMS_TO_TICKS( pxConfig->ulHoldMs ) );
+        prvWriteOutput( pxConfig, uxTask, ulJob );
+
+        for( ux = workloadMAX_LOCKS; ux > 0; ux-- )
+        {
+            if( ( pxConfig->ulLockMask & ( 1UL << ( ux - 1 ) ) ) != 0 )
+            {
+                ( void ) xDemoLockGive( xLocks[ ux - 1 ] );
+            }
+        }
+
+        vTraceRingRecord( eWorkloadEventLocksGiven, pxConfig->ulLockMask, 0 );
+    }
+    else
+    {
+        prvWriteOutput( pxConfig, uxTask, ulJob );
+    }
+
+    return ulBlockingUs;
+}
+/*-----------------------------------------------------------*/
+
+static void prvWriteOutput( const WorkloadTaskConfig_t * pxConfig,
+                            UBaseType_t uxTask,
+                            uint32_t ulJob )
+{
+    char cMessage[ deferredMAX_MESSAGE_LENGTH + 1 ];
+    int iLength;
+    eWorkloadEvent eEvent;
+
+    if( ( pxConfig->ulOutputChars == 0 ) || ( xDeferredOutputIsStarted() == pdFALSE ) )
+    {
+        return;
+    }
+
+    /* The job is identified at the start, and the rest is padding to make
+     * the output as long as configured. */
+    iLength = snprintf( cMessage, sizeof( cMessage ), "WL%u job %u ", ( unsigned ) uxTask, ( unsigned ) ulJob );
+
+    if( ( iLength < 0 ) || ( ( uint32_t ) iLength > pxConfig->ulOutputChars ) )
+    {
+        iLength = ( int ) pxConfig->ulOutputChars;
+    }
+
+    memset( &( cMessage[ iLength ] ), '.', pxConfig->ulOutputChars - ( uint32_t ) iLength );
+
+    eEvent = ( xDeferredOutputIsEnabled() != pdFALSE ) ? eWorkloadEventOutputQueued : eWorkloadEventOutputWritten;
+
+    /* Dropped messages are also counted by the DeferredOutput module. */
+    if( xDeferredOutputSend( cMessage, ( size_t ) pxConfig->ulOutputChars ) == pdFAIL )
+    {
+        eEvent = eWorkloadEventOutputDropped;
+    }
+
+    vTraceRingRecord( ( uint16_t ) eEvent, pxConfig->ulOutputChars, 0 );
+}
+/*-----------------------------------------------------------*/
+
+static void prvUseCpu( TickType_t xTicks )
+{
+    TickType_t xLastTick = xTaskGetTickCount(), xTick;
+
+    /* Only count ticks that change while this task is spinning.  A task that
+     * was preempted sees the tick count jump when it runs again, but the jump
+     * is only counted as one tick. */
+    while( xTicks > 0 )
+    {
+        xTick = xTaskGetTickCount();
+
+        if( xTick != xLastTick )
+        {
+            xLastTick = xTick;
+            xTicks--;
+        }
+    }
+}
+/*-----------------------------------------------------------*/
+
+static void prvUpdateCeilings( void )
+{
+    UBaseType_t uxLock, uxTask, uxCeiling;
+
+    for( uxLock = 0; uxLock < workloadMAX_LOCKS; uxLock++ )
+    {
+        if( xLocks[ uxLock ] == NULL )
+        {
+            continue;
+        }
+
+        uxCeiling = 0;
+
+        for( uxTask = 0; uxTask < workloadMAX_TASKS; uxTask++ )
+        {
+            if( ( ( xWorkers[ uxTask ].xConfig.ulLockMask & ( 1UL << uxLock ) ) != 0 ) &&
+                ( xWorkers[ uxTask ].xConfig.uxPriority > uxCeiling ) )
+            {
+                uxCeiling = xWorkers[ uxTask ].xConfig.uxPriority;
+            }
+        }
+
+        vDemoLockSetCeiling( xLocks[ uxLock ], uxCeiling );
+    }
+}
+/*-----------------------------------------------------------*/
+
+static BaseType_t prvConfigIsValid( const WorkloadTaskConfig_t * pxConfig )
+{
+    BaseType_t xReturn = pdTRUE;
+
+    if( pxConfig->uxPriority != 0 )
+    {
+        if( ( pxConfig->uxPriority >= ( UBaseType_t ) configMAX_PRIORITIES ) ||
+            ( pdMS_TO_TICKS( pxConfig->ulPeriodMs ) == 0 ) ||
+            ( pxConfig->ulPeriodMs > ( UINT32_MAX / 1000UL ) ) ||
+            ( pxConfig->ulOutputChars > deferredMAX_MESSAGE_LENGTH ) ||
+            ( ( workloadMAX_LOCKS < 32 ) && ( ( pxConfig->ulLockMask >> ( workloadMAX_LOCKS & 31 ) ) != 0 ) ) )
+        {
+            xReturn = pdFALSE;
+        }
+    }
+
+    return xReturn;
+}
+/*-----------------------------------------------------------*/
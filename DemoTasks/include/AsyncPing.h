@@ -0,0 +1,108 @@
+/*
+ * FreeRTOS V202411.00
+ * Copyright (C) 2020 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * https://www.FreeRTOS.org
+ * https://github.com/FreeRTOS
+ *
+ */
+
+#ifndef ASYNC_PING_H
+#define ASYNC_PING_H
+
+/*
+ * Outgoing pings whose replies are matched back to the request that caused
+ * them.  The send time of each ping is recorded against the identifier
+ * returned by FreeRTOS_SendPingRequest(), and the module's implementation of
+ * vApplicationPingReplyHook() uses the identifier in the reply to calculate
+ * the round trip time.  Only available when ipconfigSUPPORT_OUTGOING_PINGS is
+ * 1, so the application must not define its own vApplicationPingReplyHook().
+ */
+
+/* The number of pings that can be waiting for a reply at any one time. */
+#ifndef pingMAX_OUTSTANDING
+    #define pingMAX_OUTSTANDING    8
+#endif
+
+/* The limits on the number of pings in a run, and the time between them,
+ * accepted by xAsyncPingRun(). */
+#define pingMAX_COUNT          100UL
+#define pingMIN_INTERVAL_MS    10UL
+
+/*
+ * Called when the reply to a ping sent by xAsyncPingSend() is received.
+ * xSuccess is pdFALSE if the reply had a bad checksum or did not contain the
+ * data that was sent.  The callback normally executes in the context of the
+ * IP task, so must be short and must not block.
+ */
+typedef void ( * AsyncPingCallback_t )( uint16_t usIdentifier,
+                                        BaseType_t xSuccess,
+                                        uint32_t ulRoundTripUs,
+                                        void * pvContext );
+
+/* The result of a run of pings sent by xAsyncPingRun().  The round trip times
+ * only include successful replies.  The jitter is the mean difference between
+ * the round trip times of consecutive replies. */
+typedef struct xASYNC_PING_SUMMARY
+{
+    uint32_t ulSent;      /* Pings passed to the IP stack. */
+    uint32_t ulNotSent;   /* Pings that could not be sent. */
+    uint32_t ulReceived;  /* Successful replies. */
+    uint32_t ulFailed;    /* Replies with a bad checksum or bad data. */
+    uint32_t ulLost;      /* Pings that had no reply before the run timed out. */
+    uint32_t ulMinUs;     /* The shortest round trip time. */
+    uint32_t ulAverageUs; /* The mean round trip time. */
+    uint32_t ulMaxUs;     /* The longest round trip time. */
+    uint32_t ulJitterUs;  /* The mean difference between consecutive round trip times. */
+} AsyncPingSummary_t;
+
+/*
+ * Send a ping of xBytes bytes to ulIPAddress, waiting up to xBlockTime for a
+ * network buffer.  pxCallback is called with pvContext when the reply arrives.
+ * Returns the ping's identifier, or 0 if the ping was not sent, for example
+ * because pingMAX_OUTSTANDING pings are already waiting for replies.
+ */
+uint16_t usAsyncPingSend( uint32_t ulIPAddress,
+                          size_t xBytes,
+                          TickType_t xBlockTime,
+                          AsyncPingCallback_t pxCallback,
+                          void * pvContext );
+
+/*
+ * Stop waiting for the replies to all the pings that were sent with
+ * pvContext, returning how many there were.  When the function returns the
+ * callback will not be called again for any of them.
+ */
+UBaseType_t uxAsyncPingCancel( void * pvContext );
+
+/*
+ * Send ulCount pings of xBytes bytes to ulIPAddress, xInterval apart, then
+ * wait up to xTimeout for the outstanding replies.  The calling task is
+ * blocked for the whole run, and its task notification is used to wait for
+ * the replies.  Returns pdFAIL if the parameters are out of range.
+ */
+BaseType_t xAsyncPingRun( uint32_t ulIPAddress,
+                          size_t xBytes,
+                          uint32_t ulCount,
+                          TickType_t xInterval,
+                          TickType_t xTimeout,
+                          AsyncPingSummary_t * pxSummary );
+
+#endif /* ASYNC_PING_H */
@@ -0,0 +1,94 @@
+/*
+ * FreeRTOS V202411.00
+ * Copyright (C) 2020 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * https://www.FreeRTOS.org
+ * https://github.com/FreeRTOS
+ *
+ */
+
+#ifndef CLI_DISPATCH_H
+#define CLI_DISPATCH_H
+
+/* The cost classes a command can be registered with.  A cliCOST_HEAVY command
+ * is one that can take a long time to complete, for example because it blocks
+ * on the network.  Interpreters use the class to decide where a command is
+ * run - see xCLIDispatchGetCostClass(). */
+#define cliCOST_LIGHT    0
+#define cliCOST_HEAVY    1
+
+/*
+ * The state of a command that is being executed through
+ * xCLIDispatchProcessCommand().  A context must be zeroed (or passed to
+ * vCLIDispatchInitContext()) before it is first used.
+ */
+typedef struct xCLI_DISPATCH_CONTEXT
+{
+    const CLI_Command_Definition_t * pxActiveCommand; /* A command that has more output to return, or NULL. */
+    BaseType_t xInFallback;                           /* pdTRUE if FreeRTOS_CLIProcessCommand() has more output to return. */
+    SemaphoreHandle_t xHeldLock;                      /* The lock held for the active command, or NULL. */
+} CLIDispatchContext_t;
+
+/*
+ * Register a command with FreeRTOS+CLI, so it is listed by the "help"
+ * command, and also add it to the dispatch index so it can be found by a
+ * binary search rather than a linear walk of the registered command list.
+ */
+portBASE_TYPE xCLIDispatchRegisterCommand( const CLI_Command_Definition_t * const pxCommandToRegister );
+
+/*
+ * As xCLIDispatchRegisterCommand(), but also sets the command's cost class.
+ * Commands registered with xCLIDispatchRegisterCommand() are cliCOST_LIGHT.
+ * Each cliCOST_HEAVY command is given a mutex that is held while the command
+ * executes, the cliCOST_LIGHT commands share a single mutex, and the commands
+ * left to FreeRTOS+CLI share another, so command implementations that keep
+ * state between calls can be executed from more than one task without
+ * interfering with each other.
+ */
+portBASE_TYPE xCLIDispatchRegisterCommandWithCost( const CLI_Command_Definition_t * const pxCommandToRegister,
+                                                   BaseType_t xCostClass );
+
+/*
+ * Return the cost class of the command at the start of pcCommandInput, or
+ * cliCOST_LIGHT if the command is not in the dispatch index.
+ */
+BaseType_t xCLIDispatchGetCostClass( const int8_t * const pcCommandInput );
+
+/*
+ * Initialise a context before it is used with xCLIDispatchProcessCommand().
+ */
+void vCLIDispatchInitContext( CLIDispatchContext_t * pxContext );
+
+/*
+ * Drop-in replacement for FreeRTOS_CLIProcessCommand().  Commands registered
+ * with xCLIDispatchRegisterCommand() are located using the dispatch index.
+ * Anything else, including the built in "help" command, is passed to
+ * FreeRTOS_CLIProcessCommand().  As with FreeRTOS_CLIProcessCommand() the
+ * function must be called repeatedly, with the same context, until it returns
+ * pdFALSE.  The command's mutex is held from the first call until then, so a
+ * caller should not do anything slow, such as writing to a console, between
+ * the calls.
+ */
+portBASE_TYPE xCLIDispatchProcessCommand( CLIDispatchContext_t * pxContext,
+                                          const int8_t * const pcCommandInput,
+                                          int8_t * pcWriteBuffer,
+                                          size_t xWriteBufferLen );
+
+#endif /* CLI_DISPATCH_H */
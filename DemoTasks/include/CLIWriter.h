@@ -0,0 +1,110 @@
+/*
+ * FreeRTOS V202411.00
+ * Copyright (C) 2020 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * https://www.FreeRTOS.org
+ * https://github.com/FreeRTOS
+ *
+ */
+#ifndef CLI_WRITER_H
+#define CLI_WRITER_H
+
+/*
+ * A cursor over the write buffer passed to a CLI command, so commands can
+ * build their output without overrunning the buffer and without scanning it
+ * with strlen() to find where to append.  Nothing is allocated.
+ *
+ * Every append writes as much as fits, keeps the buffer terminated and
+ * returns pdFAIL if it did not all fit, after which the writer reports that
+ * it is truncated.  A command that returns its output in rows can write as
+ * many rows per call as fit: take a mark before each row and pass it to
+ * xCLIWriterCommitRow() afterwards.  A row that did not fit is removed again,
+ * so the command can return pdTRUE and write the row into the next chunk.
+ */
+
+typedef struct xCLI_WRITER
+{
+    char * pcBuffer;       /* The buffer being written to. */
+    size_t xLength;        /* The size of the buffer, including the terminator. */
+    size_t xUsed;          /* The characters written so far, not including the terminator. */
+    BaseType_t xTruncated; /* pdTRUE if anything written did not fit. */
+} CLIWriter_t;
+
+/*
+ * Start writing to the xLength byte buffer pcBuffer, which is emptied.
+ */
+void vCLIWriterInit( CLIWriter_t * pxWriter,
+                     int8_t * pcBuffer,
+                     size_t xLength );
+
+/*
+ * Append a null terminated string, the first xLength characters of a string,
+ * a number in decimal, or an IP address held in network byte order in dotted
+ * decimal form.
+ */
+BaseType_t xCLIWriterAppendString( CLIWriter_t * pxWriter,
+                                   const char * pcString );
+BaseType_t xCLIWriterAppendStringN( CLIWriter_t * pxWriter,
+                                    const char * pcString,
+                                    size_t xLength );
+BaseType_t xCLIWriterAppendUnsigned( CLIWriter_t * pxWriter,
+                                     uint32_t ulValue );
+BaseType_t xCLIWriterAppendInt( CLIWriter_t * pxWriter,
+                                int32_t lValue );
+BaseType_t xCLIWriterAppendIP( CLIWriter_t * pxWriter,
+                               uint32_t ulIPAddress );
+
+/*
+ * Append formatted output, as snprintf().
+ */
+BaseType_t xCLIWriterPrintf( CLIWriter_t * pxWriter,
+                             const char * pcFormat,
+                             ... );
+
+/*
+ * Return pdTRUE if anything written since the writer was initialised, or last
+ * rewound, did not fit.
+ */
+BaseType_t xCLIWriterIsTruncated( const CLIWriter_t * pxWriter );
+
+/*
+ * Return the number of characters that can still be appended.
+ */
+size_t xCLIWriterGetRemaining( const CLIWriter_t * pxWriter );
+
+/*
+ * Return a mark of the current position, and remove everything appended after
+ * a mark.  Rewinding clears the truncated state.
+ */
+size_t xCLIWriterGetMark( const CLIWriter_t * pxWriter );
+void vCLIWriterRewind( CLIWriter_t * pxWriter,
+                       size_t xMark );
+
+/*
+ * Finish a row that was started at the mark xRowStart.  Returns pdTRUE if the
+ * row fitted.  Also returns pdTRUE, leaving the truncated row in the buffer, if
+ * the row was the first output in the buffer, as it will never fit.
+ * Otherwise the row is removed and pdFALSE is returned, the caller should
+ * return pdTRUE so the row can be written again into the next chunk.
+ */
+BaseType_t xCLIWriterCommitRow( CLIWriter_t * pxWriter,
+                                size_t xRowStart );
+
+#endif /* CLI_WRITER_H */
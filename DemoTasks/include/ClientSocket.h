@@ -0,0 +1,101 @@
+/*
+ * FreeRTOS V202411.00
+ * Copyright (C) 2020 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * https://www.FreeRTOS.org
+ * https://github.com/FreeRTOS
+ *
+ */
+
+#ifndef CLIENT_SOCKET_H
+#define CLIENT_SOCKET_H
+
+/*
+ * Manages the socket used by a UDP client task.  The demo client tasks
+ * originally created a new socket, sent a few messages, then closed the socket
+ * again, so most of their time was spent creating, binding and closing
+ * sockets.  With clientsockPERSISTENT set to 1 the socket is instead kept open
+ * for as long as it keeps working.  The reconnect policy closes the socket
+ * after clientsockMAX_CONSECUTIVE_ERRORS errors in a row, then waits before
+ * opening a new one - the wait doubling from clientsockMIN_RECONNECT_DELAY_MS
+ * up to clientsockMAX_RECONNECT_DELAY_MS for as long as the new sockets
+ * continue to fail.
+ */
+
+/* Set to 0 to create and close a socket for each batch of messages, as the
+ * demo originally did. */
+#ifndef clientsockPERSISTENT
+    #define clientsockPERSISTENT    1
+#endif
+
+/* The number of consecutive send or receive errors after which the socket is
+ * replaced. */
+#ifndef clientsockMAX_CONSECUTIVE_ERRORS
+    #define clientsockMAX_CONSECUTIVE_ERRORS    5
+#endif
+
+/* The range of delays used before opening a replacement socket. */
+#ifndef clientsockMIN_RECONNECT_DELAY_MS
+    #define clientsockMIN_RECONNECT_DELAY_MS    10
+#endif
+
+#ifndef clientsockMAX_RECONNECT_DELAY_MS
+    #define clientsockMAX_RECONNECT_DELAY_MS    5000
+#endif
+
+/* The state of a client task's socket.  Owned by a single task. */
+typedef struct xCLIENT_SOCKET
+{
+    Socket_t xSocket;                 /* The open socket, or FREERTOS_INVALID_SOCKET. */
+    TickType_t xReceiveTimeout;       /* The receive timeout set on each new socket, or 0 to leave the default. */
+    TickType_t xReconnectDelay;       /* The delay before the next replacement socket is opened. */
+    UBaseType_t uxConsecutiveErrors;  /* Errors since the last successful send or receive. */
+    BaseType_t xReplacing;            /* pdTRUE if the socket was closed because of errors. */
+    uint32_t ulOpened;                /* The number of sockets opened. */
+} ClientSocket_t;
+
+/*
+ * Initialise a ClientSocket_t before it is first used.  xReceiveTimeout is
+ * set as the FREERTOS_SO_RCVTIMEO option of each socket opened.
+ */
+void vClientSocketInit( ClientSocket_t * pxClient,
+                        TickType_t xReceiveTimeout );
+
+/*
+ * Return an open socket, opening one if necessary.  If the previous socket
+ * was closed because of errors this first waits for the reconnect delay.  Can
+ * return FREERTOS_INVALID_SOCKET if a socket could not be created.
+ */
+Socket_t xClientSocketOpen( ClientSocket_t * pxClient );
+
+/*
+ * Report whether a send or receive on the socket succeeded.  The socket is
+ * closed if too many consecutive operations have failed.
+ */
+void vClientSocketReport( ClientSocket_t * pxClient,
+                          BaseType_t xSuccess );
+
+/*
+ * Called at the end of each batch of messages.  Closes the socket unless
+ * clientsockPERSISTENT is 1.
+ */
+void vClientSocketEndOfBatch( ClientSocket_t * pxClient );
+
+#endif /* CLIENT_SOCKET_H */
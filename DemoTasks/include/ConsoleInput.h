@@ -0,0 +1,71 @@
+/*
+ * FreeRTOS V202411.00
+ * Copyright (C) 2020 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * https://www.FreeRTOS.org
+ * https://github.com/FreeRTOS
+ *
+ */
+
+#ifndef CONSOLE_INPUT_H
+#define CONSOLE_INPUT_H
+
+/*
+ * Delivers key presses from the Windows console to a FreeRTOS task without the
+ * task having to poll _kbhit().  A Windows thread that is not a FreeRTOS task
+ * blocks in _getch(), then raises a simulated interrupt whose handler writes
+ * the key to a stream buffer, so the task that receives the keys sleeps until
+ * a key is pressed.  Only one task may receive keys.
+ */
+
+/* The number of key presses that can be waiting to be received.  Further key
+ * presses are dropped until the receiving task catches up.  Must be a power of
+ * 2. */
+#ifndef consoleINPUT_BUFFER_BYTES
+    #define consoleINPUT_BUFFER_BYTES    32
+#endif
+
+/* The simulated interrupt used to pass key presses from the Windows thread to
+ * the kernel.  Must not be the same number as any other simulated interrupt,
+ * for example one used by the network driver. */
+#ifndef consoleINPUT_INTERRUPT_NUMBER
+    #define consoleINPUT_INTERRUPT_NUMBER    portINTERRUPT_APPLICATION_DEFINED_START
+#endif
+
+/*
+ * Create the stream buffer, install the simulated interrupt handler and start
+ * the Windows thread that reads the keyboard.  Must be called before the
+ * scheduler is started.
+ */
+void vConsoleInputStart( void );
+
+/*
+ * Wait up to xTicksToWait ticks for a key press.  Returns pdTRUE and writes
+ * the key to *pcKey if a key was pressed, otherwise returns pdFALSE.
+ */
+BaseType_t xConsoleInputReceive( char * pcKey,
+                                 TickType_t xTicksToWait );
+
+/*
+ * Return the number of key presses dropped because the buffer was full.
+ */
+uint32_t ulConsoleInputGetDropped( void );
+
+#endif /* CONSOLE_INPUT_H */
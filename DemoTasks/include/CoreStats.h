@@ -0,0 +1,98 @@
+/*
+ * FreeRTOS V202411.00
+ * Copyright (C) 2020 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * https://www.FreeRTOS.org
+ * https://github.com/FreeRTOS
+ *
+ */
+#ifndef CORE_STATS_H
+#define CORE_STATS_H
+
+/*
+ * A per-core view of where the processing time goes.  The run time stats
+ * kept by the kernel give the total time each task has run, but not which
+ * core it ran on, so vCoreStatsTickHook() records the task that is running on
+ * each core at every tick.  The share of a core's samples that a task has
+ * approximates the share of that core's time the task used.
+ *
+ * Also wraps setting the core affinity of a task, so the same code builds for
+ * single core kernels, such as the Windows port, on which it has no effect.
+ */
+
+#ifdef configNUMBER_OF_CORES
+    #define corestatsNUMBER_OF_CORES    configNUMBER_OF_CORES
+#else
+    #define corestatsNUMBER_OF_CORES    1
+#endif
+
+/* A core affinity mask that allows a task to run on any core. */
+#define corestatsALL_CORES    ( ( UBaseType_t ) ( ( 1UL << corestatsNUMBER_OF_CORES ) - 1UL ) )
+
+/* The most tasks samples are kept for.  Samples of further tasks are only
+ * counted in the total returned by uxCoreStatsGetTasks(). */
+#ifndef corestatsMAX_TASKS
+    #define corestatsMAX_TASKS    24
+#endif
+
+typedef struct xCORE_STATS_TASK
+{
+    TaskHandle_t xTask;                                  /* The sampled task. */
+    char cName[ configMAX_TASK_NAME_LEN ];               /* Its name, copied as the task could be deleted. */
+    uint32_t ulSamples[ corestatsNUMBER_OF_CORES ];      /* The number of ticks at which the task was running on each core. */
+} CoreStatsTask_t;
+
+/*
+ * Record the task running on each core.  Call from vApplicationTickHook(),
+ * which needs configUSE_TICK_HOOK to be 1 in FreeRTOSConfig.h.
+ */
+void vCoreStatsTickHook( void );
+
+/*
+ * Copy the samples of up to uxMaxTasks tasks into pxTasks[] and return the
+ * number copied.  *pulTicks is set to the number of ticks sampled, so the
+ * share of core n used by task t is pxTasks[ t ].ulSamples[ n ] / *pulTicks.
+ */
+UBaseType_t uxCoreStatsGetTasks( CoreStatsTask_t * pxTasks,
+                                 UBaseType_t uxMaxTasks,
+                                 uint32_t * pulTicks );
+
+/*
+ * Forget all the samples, for example after changing the core affinity of
+ * tasks or after tasks have been deleted.
+ */
+void vCoreStatsReset( void );
+
+/*
+ * Allow xTask, or the calling task if xTask is NULL, to run only on the cores
+ * whose bits are set in uxCoreMask.  Returns pdFAIL if uxCoreMask does not
+ * include any core, or if the kernel is not built with configNUMBER_OF_CORES
+ * greater than 1 and configUSE_CORE_AFFINITY set to 1.
+ */
+BaseType_t xCoreStatsSetAffinity( TaskHandle_t xTask,
+                                  UBaseType_t uxCoreMask );
+
+/*
+ * Return the core affinity mask of xTask, which is always corestatsALL_CORES
+ * if the kernel does not support core affinity.
+ */
+UBaseType_t uxCoreStatsGetAffinity( TaskHandle_t xTask );
+
+#endif /* CORE_STATS_H */
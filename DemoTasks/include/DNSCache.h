@@ -0,0 +1,105 @@
+/*
+ * FreeRTOS V202411.00
+ * Copyright (C) 2020 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * https://www.FreeRTOS.org
+ * https://github.com/FreeRTOS
+ *
+ */
+
+#ifndef DNS_CACHE_H
+#define DNS_CACHE_H
+
+/*
+ * A small cache of host names that have been resolved by
+ * FreeRTOS_gethostbyname(), so repeatedly looking up the same name does not
+ * block for a DNS round trip each time.  The cache is a fixed array of
+ * dnscacheNUMBER_OF_ENTRIES entries.  When it is full the least recently used
+ * entry is replaced.  FreeRTOS_gethostbyname() does not report the TTL of
+ * the record it received, so each entry is kept for dnscacheTTL_SECONDS.
+ */
+
+/* The number of names the cache can hold. */
+#ifndef dnscacheNUMBER_OF_ENTRIES
+    #define dnscacheNUMBER_OF_ENTRIES    8
+#endif
+
+/* The longest name that can be cached, including the terminating null.
+ * Longer names are still resolved, but are not cached. */
+#ifndef dnscacheMAX_NAME_LENGTH
+    #define dnscacheMAX_NAME_LENGTH    64
+#endif
+
+/* How long a resolved name is used before it is looked up again. */
+#ifndef dnscacheTTL_SECONDS
+    #define dnscacheTTL_SECONDS    300UL
+#endif
+
+/* A copy of one cache entry, as returned by xDNSCacheGetEntry(). */
+typedef struct xDNS_CACHE_ENTRY_INFO
+{
+    char cName[ dnscacheMAX_NAME_LENGTH ]; /* The host name. */
+    uint32_t ulIPAddress;                  /* The address the name resolved to. */
+    uint32_t ulSecondsToLive;              /* The time left before the entry expires. */
+    uint32_t ulHits;                       /* The number of lookups answered by the entry. */
+} DNSCacheEntryInfo_t;
+
+/* Counters maintained by the cache. */
+typedef struct xDNS_CACHE_STATS
+{
+    uint32_t ulHits;      /* Lookups answered from the cache. */
+    uint32_t ulMisses;    /* Lookups that needed a DNS request. */
+    uint32_t ulExpired;   /* Entries found to be past their TTL. */
+    uint32_t ulEvictions; /* Entries replaced because the cache was full. */
+    uint32_t ulFailures;  /* DNS requests that did not resolve the name. */
+} DNSCacheStats_t;
+
+/*
+ * Return the IP address of the host called pcName, from the cache if
+ * possible, otherwise by calling FreeRTOS_gethostbyname(), which blocks until
+ * the name is resolved or the DNS request times out.  Returns 0 if the name
+ * could not be resolved.
+ */
+uint32_t ulDNSCacheLookup( const char * pcName );
+
+/*
+ * As ulDNSCacheLookup(), but always sends a DNS request, so the cache entry
+ * for pcName is refreshed.
+ */
+uint32_t ulDNSCacheRefresh( const char * pcName );
+
+/*
+ * Remove every entry from the cache.
+ */
+void vDNSCacheFlush( void );
+
+/*
+ * Copy the uxIndex'th valid entry in the cache into pxInfo.  Returns pdFALSE
+ * if there are not that many valid entries.
+ */
+BaseType_t xDNSCacheGetEntry( UBaseType_t uxIndex,
+                              DNSCacheEntryInfo_t * pxInfo );
+
+/*
+ * Obtain a copy of the counters maintained by the cache.
+ */
+void vDNSCacheGetStats( DNSCacheStats_t * pxStats );
+
+#endif /* DNS_CACHE_H */
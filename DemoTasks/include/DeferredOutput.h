@@ -0,0 +1,112 @@
+/*
+ * FreeRTOS V202411.00
+ * Copyright (C) 2020 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * https://www.FreeRTOS.org
+ * https://github.com/FreeRTOS
+ *
+ */
+#ifndef DEFERRED_OUTPUT_H
+#define DEFERRED_OUTPUT_H
+
+/*
+ * Moves slow output out of code that holds a lock.  Instead of writing to a
+ * slow device while holding the lock, a task copies its message into a
+ * message buffer, which takes microseconds, and a dedicated output task later
+ * passes the message to the slow output function without holding anything.
+ *
+ * Any number of tasks can write.  Writes never block: a message that does not
+ * fit is dropped and counted.  Messages are output in the order in which they
+ * were written.
+ */
+
+/* The number of bytes the message buffer can hold.  Each message also takes
+ * sizeof( size_t ) bytes for its length. */
+#ifndef deferredBUFFER_BYTES
+    #define deferredBUFFER_BYTES    512
+#endif
+
+/* The longest message that can be written. */
+#ifndef deferredMAX_MESSAGE_LENGTH
+    #define deferredMAX_MESSAGE_LENGTH    128
+#endif
+
+/* The function the output task passes each message to.  pcMessage is not
+ * terminated. */
+typedef void (* DeferredOutputFunction_t)( const char * pcMessage,
+                                           size_t xLength );
+
+typedef struct xDEFERRED_OUTPUT_STATS
+{
+    uint32_t ulWritten;      /* Messages accepted by xDeferredOutputWrite(). */
+    uint32_t ulDropped;      /* Messages dropped because they did not fit. */
+    uint32_t ulOutput;       /* Messages passed to the output function. */
+    size_t xMaxBytesWaiting; /* The most bytes that were ever waiting in the message buffer. */
+} DeferredOutputStats_t;
+
+/*
+ * Create the message buffer and the output task.  The task runs at uxPriority,
+ * which should be below that of the writers so slow output does not delay
+ * them.
+ */
+void vStartDeferredOutputTask( uint16_t usStackSize,
+                               UBaseType_t uxPriority,
+                               DeferredOutputFunction_t pxOutputFunction );
+
+/*
+ * Copy xLength bytes from pcMessage into the message buffer without blocking.
+ * Returns pdFAIL, and counts the message as dropped, if it is longer than
+ * deferredMAX_MESSAGE_LENGTH or there is not enough space.  Must not be called
+ * from an interrupt.
+ */
+BaseType_t xDeferredOutputWrite( const char * pcMessage,
+                                 size_t xLength );
+
+/*
+ * For writers that do not choose the mode themselves.  If deferring is
+ * enabled, as xDeferredOutputWrite().  Otherwise the message is passed
+ * straight to the output function by the calling task, so the call takes as
+ * long as the output and returns pdPASS.  Returns pdFAIL if the output task
+ * has not been started.
+ */
+BaseType_t xDeferredOutputSend( const char * pcMessage,
+                                size_t xLength );
+
+/*
+ * Set and get whether tasks should defer their output.  The module does not
+ * use the setting itself - it is for writers that can produce their output
+ * either directly or through xDeferredOutputWrite(), so the two can be
+ * compared at run time.  Deferring is off until it is set.
+ */
+void vDeferredOutputSetEnabled( BaseType_t xEnable );
+BaseType_t xDeferredOutputIsEnabled( void );
+
+/*
+ * Return pdTRUE if vStartDeferredOutputTask() has been called, so messages can
+ * be written.
+ */
+BaseType_t xDeferredOutputIsStarted( void );
+
+/*
+ * Copy the statistics into *pxStats.
+ */
+void vDeferredOutputGetStats( DeferredOutputStats_t * pxStats );
+
+#endif /* DEFERRED_OUTPUT_H */
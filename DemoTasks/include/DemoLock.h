@@ -0,0 +1,135 @@
+/*
+ * FreeRTOS V202411.00
+ * Copyright (C) 2020 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * https://www.FreeRTOS.org
+ * https://github.com/FreeRTOS
+ *
+ */
+
+#ifndef DEMO_LOCK_H
+#define DEMO_LOCK_H
+
+/*
+ * A lock whose locking protocol can be changed at run time, so the protocols
+ * can be compared without rebuilding.  Each lock is backed by a mutex, which
+ * uses priority inheritance, and by a binary semaphore, which does not.  The
+ * binary semaphore is used by both the eDemoLockSemaphore mode and the
+ * eDemoLockCeiling mode.  In eDemoLockCeiling mode a task's priority is raised
+ * to the lock's ceiling before it takes the lock and restored when it gives
+ * the lock (the immediate priority ceiling protocol).  The ceiling must be the
+ * highest priority of any task that uses the lock.
+ *
+ * Both handles are registered with the lock profiler, under the lock's name
+ * followed by "/mutex" and "/sem", and are taken and given with
+ * xTracedSemaphoreTake() and xTracedSemaphoreGive().  Locks are taken and
+ * given by the same task.  Ceiling locks must be given in the reverse of the
+ * order in which they were taken.
+ */
+
+/* The maximum number of locks. */
+#ifndef demolockMAX_LOCKS
+    #define demolockMAX_LOCKS    6
+#endif
+
+/* The longest name a lock can be given, not including the terminator. */
+#ifndef demolockMAX_NAME_LENGTH
+    #define demolockMAX_NAME_LENGTH    10
+#endif
+
+/* The locking protocols. */
+typedef enum
+{
+    eDemoLockMutex = 0,     /* A mutex, so the holder inherits the priority of a higher priority waiter. */
+    eDemoLockSemaphore,     /* A binary semaphore, so there is no protection against priority inversion. */
+    eDemoLockCeiling,       /* A binary semaphore taken at the lock's ceiling priority. */
+    eDemoLockNumberOfModes
+} eDemoLockMode;
+
+struct xDEMO_LOCK;
+typedef struct xDEMO_LOCK * DemoLockHandle_t;
+
+/*
+ * Create a lock called pcName that uses the protocol eMode, and register it
+ * with the lock profiler.  pcName is copied.  uxCeiling is only used in
+ * eDemoLockCeiling mode.  Returns NULL if demolockMAX_LOCKS locks already
+ * exist.
+ */
+DemoLockHandle_t xDemoLockCreate( const char * pcName,
+                                  eDemoLockMode eMode,
+                                  UBaseType_t uxCeiling );
+
+/*
+ * Take and give the lock.  The same as xSemaphoreTake() and xSemaphoreGive(),
+ * which take the same parameters and return the same values.  Must not be
+ * called from an interrupt.
+ */
+BaseType_t xDemoLockTake( DemoLockHandle_t xLock,
+                          TickType_t xTicksToWait );
+BaseType_t xDemoLockGive( DemoLockHandle_t xLock );
+
+/*
+ * Change the protocol used by the lock.  Waits up to xTicksToWait ticks for
+ * the lock to be free, returning pdFAIL if it does not become free.  A task
+ * that was waiting for the lock when the protocol changed waits again using
+ * the new protocol.
+ */
+BaseType_t xDemoLockSetMode( DemoLockHandle_t xLock,
+                             eDemoLockMode eMode,
+                             TickType_t xTicksToWait );
+
+/*
+ * Change the protocol used by every lock, returning pdFAIL if any lock did not
+ * become free within xTicksToWait ticks.
+ */
+BaseType_t xDemoLockSetAllModes( eDemoLockMode eMode,
+                                 TickType_t xTicksToWait );
+
+/*
+ * Set the priority the lock is taken at in eDemoLockCeiling mode.  The change
+ * applies from the next time the lock is taken.
+ */
+void vDemoLockSetCeiling( DemoLockHandle_t xLock,
+                          UBaseType_t uxCeiling );
+
+/*
+ * Return the lock's current protocol, ceiling and name.
+ */
+eDemoLockMode eDemoLockGetMode( DemoLockHandle_t xLock );
+UBaseType_t uxDemoLockGetCeiling( DemoLockHandle_t xLock );
+const char * pcDemoLockGetName( DemoLockHandle_t xLock );
+
+/*
+ * Return the number of locks, and the uxIndex'th lock, or NULL if uxIndex is
+ * not less than uxDemoLockGetCount().
+ */
+UBaseType_t uxDemoLockGetCount( void );
+DemoLockHandle_t xDemoLockGetLock( UBaseType_t uxIndex );
+
+/*
+ * Return the name of eMode, as accepted by eDemoLockModeFromName(), which
+ * returns eDemoLockNumberOfModes if the name is not recognised.  The name
+ * passed to eDemoLockModeFromName() is the xLength characters at pcName.
+ */
+const char * pcDemoLockModeName( eDemoLockMode eMode );
+eDemoLockMode eDemoLockModeFromName( const char * pcName,
+                                     size_t xLength );
+
+#endif /* DEMO_LOCK_H */
@@ -0,0 +1,127 @@
+/*
+ * FreeRTOS V202411.00
+ * Copyright (C) 2020 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * https://www.FreeRTOS.org
+ * https://github.com/FreeRTOS
+ *
+ */
+
+#ifndef DEMO_MESSAGE_H
+#define DEMO_MESSAGE_H
+
+/*
+ * Builds and checks the datagrams sent by the echo and simple client tasks
+ * without sprintf(), strlen() or strcmp().  Everything about a message that
+ * does not change from one message to the next is prepared once, in a
+ * template, so encoding a message only copies the template and fills in the
+ * parts that do change.
+ *
+ * Two formats are supported:
+ *
+ * msgFORMAT_BINARY messages are a msgHEADER_LENGTH byte header followed by a
+ * fixed payload.  The header holds, in network byte order, a 32-bit sequence
+ * number, a 32-bit timestamp, the 16-bit length of the whole message and a
+ * 16-bit ones' complement checksum of the whole message.  The checksum of the
+ * payload is calculated when the template is created, so only the header is
+ * summed as each message is encoded.
+ *
+ * msgFORMAT_TEXT messages are the template's text followed by the sequence
+ * number in decimal and "\r\n", optionally followed by a null terminator, so
+ * they can still be printed by whatever receives them.
+ */
+
+#define msgFORMAT_BINARY    0
+#define msgFORMAT_TEXT      1
+
+/* The length of the header at the start of a binary message. */
+#define msgHEADER_LENGTH    12
+
+/* The longest text, or binary payload, a template can hold. */
+#ifndef msgMAX_FIXED_LENGTH
+    #define msgMAX_FIXED_LENGTH    64
+#endif
+
+/* A buffer this long can hold any message.  A text message adds at most ten
+ * digits, "\r\n" and the terminator to the template text, a binary message
+ * adds the header. */
+#define msgMAX_MESSAGE_LENGTH    ( msgMAX_FIXED_LENGTH + 13 )
+
+/* The parts of a message that are the same in every message. */
+typedef struct xDEMO_MESSAGE_TEMPLATE
+{
+    BaseType_t xFormat;                    /* msgFORMAT_BINARY or msgFORMAT_TEXT. */
+    BaseType_t xTerminate;                 /* pdTRUE if text messages include the null terminator. */
+    size_t xFixedLength;                   /* The number of bytes in ucFixed[]. */
+    uint32_t ulFixedSum;                   /* Checksum partial sum of ucFixed[], used by binary messages. */
+    uint8_t ucFixed[ msgMAX_FIXED_LENGTH ]; /* The text, or the binary payload. */
+} DemoMessageTemplate_t;
+
+/*
+ * Prepare a template for binary messages that carry xPayloadLength bytes of
+ * payload after the header.
+ */
+void vDemoMessageInitBinary( DemoMessageTemplate_t * pxTemplate,
+                             size_t xPayloadLength );
+
+/*
+ * Prepare a template for text messages that start with pcText.  If
+ * xTerminate is pdTRUE the null terminator is counted as part of each
+ * message.
+ */
+void vDemoMessageInitText( DemoMessageTemplate_t * pxTemplate,
+                           const char * pcText,
+                           BaseType_t xTerminate );
+
+/*
+ * Return the length of the longest message pxTemplate can encode.
+ */
+size_t xDemoMessageMaxLength( const DemoMessageTemplate_t * pxTemplate );
+
+/*
+ * Encode the message with sequence number ulSequence into pucBuffer.  Returns
+ * the number of bytes to send, or 0 if xBufferLength is too short for the
+ * longest message pxTemplate can encode.  A null terminator is always written
+ * after a text message, whether or not it is counted in the length.
+ */
+size_t xDemoMessageEncode( const DemoMessageTemplate_t * pxTemplate,
+                           uint32_t ulSequence,
+                           uint8_t * pucBuffer,
+                           size_t xBufferLength );
+
+/*
+ * Return pdTRUE if pucMessage is a complete binary message with a correct
+ * checksum, in which case its sequence number is written to pulSequence if
+ * pulSequence is not NULL.
+ */
+BaseType_t xDemoMessageVerify( const uint8_t * pucMessage,
+                               size_t xLength,
+                               uint32_t * pulSequence );
+
+/*
+ * Return pdTRUE if a received message is exactly the same length as, and
+ * identical to, the message that was sent.  Used to check echo replies.
+ */
+BaseType_t xDemoMessageMatches( const uint8_t * pucSent,
+                                size_t xSentLength,
+                                const uint8_t * pucReceived,
+                                int32_t lReceivedLength );
+
+#endif /* DEMO_MESSAGE_H */
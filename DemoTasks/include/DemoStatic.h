@@ -0,0 +1,152 @@
+/*
+ * FreeRTOS V202411.00
+ * Copyright (C) 2020 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * https://www.FreeRTOS.org
+ * https://github.com/FreeRTOS
+ *
+ */
+
+#ifndef DEMO_STATIC_H
+#define DEMO_STATIC_H
+
+/*
+ * Creation functions used for every task, semaphore and queue created by the
+ * demo.  When demoSTATIC_ALLOCATION is 0 they simply call the normal dynamic
+ * allocation API.  When it is 1 the memory for each object is taken from
+ * arrays that are reserved at compile time, so the demo does not use the
+ * FreeRTOS heap and the RAM used is visible in the link map.  Each place that
+ * creates tasks names its own stacks and task control blocks with
+ * demoTASK_MEMORY(), so every task's memory can be found in the link map by
+ * name.  Memory taken from the arrays is never returned, so objects created
+ * this way must not be deleted.  demoSTATIC_ALLOCATION requires
+ * configSUPPORT_STATIC_ALLOCATION, and also provides the idle and timer task
+ * memory the kernel then needs.
+ */
+#ifndef demoSTATIC_ALLOCATION
+    #define demoSTATIC_ALLOCATION    0
+#endif
+
+/* The number of tasks whose stack depth is recorded for
+ * uxDemoTaskGetStackDepth(). */
+#ifndef demoSTATIC_MAX_TASKS
+    #define demoSTATIC_MAX_TASKS    24
+#endif
+
+/* The number of semaphores and queues that can be created when
+ * demoSTATIC_ALLOCATION is 1. */
+#ifndef demoSTATIC_MAX_SEMAPHORES
+    #define demoSTATIC_MAX_SEMAPHORES    24
+#endif
+
+#ifndef demoSTATIC_MAX_QUEUES
+    #define demoSTATIC_MAX_QUEUES    8
+#endif
+
+/* The stack, in words, reserved for each task created by a module that is
+ * given its stack depth at run time, so can not size its stack at compile
+ * time, when demoSTATIC_ALLOCATION is 1.  Such a task asking for more than
+ * this is not created. */
+#ifndef demoSTATIC_TASK_STACK_DEPTH
+    #define demoSTATIC_TASK_STACK_DEPTH    ( configMINIMAL_STACK_SIZE + 512 )
+#endif
+
+/* The total storage, in bytes, shared out between the queues when
+ * demoSTATIC_ALLOCATION is 1. */
+#ifndef demoSTATIC_QUEUE_BYTES
+    #define demoSTATIC_QUEUE_BYTES    4096
+#endif
+
+/* How much of the statically reserved memory has been used. */
+typedef struct xDEMO_STATIC_STATS
+{
+    UBaseType_t uxTasks;      /* Tasks created. */
+    UBaseType_t uxSemaphores; /* Semaphores and mutexes created. */
+    UBaseType_t uxQueues;     /* Queues created. */
+    size_t xStackWords;       /* Stack words given to tasks. */
+    size_t xQueueBytes;       /* Storage bytes given to queues. */
+    uint32_t ulFailures;      /* Objects that could not be created because their memory was exhausted. */
+} DemoStaticStats_t;
+
+/* The memory for the tasks created in one place, see demoTASK_MEMORY(). */
+typedef struct xDEMO_TASK_MEMORY
+{
+    StaticTask_t * pxTaskBuffers;        /* uxTasks task control blocks. */
+    StackType_t * pxStacks;              /* uxTasks stacks of uxStackDepth words, one after another. */
+    configSTACK_DEPTH_TYPE uxStackDepth; /* The largest stack a task can be given. */
+    UBaseType_t uxTasks;                 /* The number of tasks there is memory for. */
+    UBaseType_t uxUsed;                  /* The number of tasks created so far. */
+} DemoTaskMemory_t;
+
+/*
+ * Define the memory, called xName, for uxTasks tasks with stacks of up to
+ * uxStackDepth words, for passing to xDemoTaskCreate().  The stacks and task
+ * control blocks are the arrays xName##Stacks and xName##TaskBuffers.  When
+ * demoSTATIC_ALLOCATION is 0 nothing is reserved.
+ */
+#if ( demoSTATIC_ALLOCATION == 1 )
+    #define demoTASK_MEMORY( xName, uxTasks, uxStackDepth )                     \
+    static StaticTask_t xName##TaskBuffers[ uxTasks ];                          \
+    static StackType_t xName##Stacks[ ( uxTasks ) * ( uxStackDepth ) ];         \
+    static DemoTaskMemory_t xName = { xName##TaskBuffers, xName##Stacks, ( uxStackDepth ), ( uxTasks ), 0 }
+#else
+    #define demoTASK_MEMORY( xName, uxTasks, uxStackDepth ) \
+    static DemoTaskMemory_t xName = { NULL, NULL, ( uxStackDepth ), ( uxTasks ), 0 }
+#endif
+
+/*
+ * As xTaskCreate().  When demoSTATIC_ALLOCATION is 1 the task's stack and
+ * task control block are the next unused ones in pxMemory, and the task is
+ * not created if they have all been used or uxStackDepth is more than their
+ * stack depth.
+ */
+BaseType_t xDemoTaskCreate( TaskFunction_t pxTaskCode,
+                            const char * const pcName,
+                            configSTACK_DEPTH_TYPE uxStackDepth,
+                            void * const pvParameters,
+                            UBaseType_t uxPriority,
+                            TaskHandle_t * const pxCreatedTask,
+                            DemoTaskMemory_t * pxMemory );
+
+/*
+ * Return the stack depth, in words, that xTask was created with by
+ * xDemoTaskCreate(), or 0 if the task was not created by xDemoTaskCreate().
+ */
+configSTACK_DEPTH_TYPE uxDemoTaskGetStackDepth( TaskHandle_t xTask );
+
+/*
+ * As xSemaphoreCreateMutex() and xSemaphoreCreateBinary().
+ */
+SemaphoreHandle_t xDemoSemaphoreCreateMutex( void );
+SemaphoreHandle_t xDemoSemaphoreCreateBinary( void );
+
+/*
+ * As xQueueCreate().
+ */
+QueueHandle_t xDemoQueueCreate( UBaseType_t uxQueueLength,
+                                UBaseType_t uxItemSize );
+
+/*
+ * Obtain a copy of the memory usage counters.  They are only updated when
+ * demoSTATIC_ALLOCATION is 1.
+ */
+void vDemoStaticGetStats( DemoStaticStats_t * pxStats );
+
+#endif /* DEMO_STATIC_H */
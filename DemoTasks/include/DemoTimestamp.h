@@ -0,0 +1,54 @@
+/*
+ * FreeRTOS V202411.00
+ * Copyright (C) 2020 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * https://www.FreeRTOS.org
+ * https://github.com/FreeRTOS
+ *
+ */
+
+#ifndef DEMO_TIMESTAMP_H
+#define DEMO_TIMESTAMP_H
+
+/*
+ * Timestamps used by the demo to measure intervals that are too short to be
+ * measured in ticks, such as how long a lock is held.  When run time stats are
+ * being generated the run time stats counter is used, which on the Windows
+ * port counts (simulated) 1/100ths of a millisecond - see
+ * Run-time-stats-utils.c.  Otherwise the tick count is used.
+ */
+#if ( configGENERATE_RUN_TIME_STATS == 1 )
+    typedef configRUN_TIME_COUNTER_TYPE DemoTimestamp_t;
+    #define demoGET_TIMESTAMP()    ( ( DemoTimestamp_t ) portGET_RUN_TIME_COUNTER_VALUE() )
+
+    #ifndef demoTIMESTAMP_COUNTS_PER_SECOND
+        #define demoTIMESTAMP_COUNTS_PER_SECOND    100000UL
+    #endif
+#else
+    typedef TickType_t DemoTimestamp_t;
+    #define demoGET_TIMESTAMP()                xTaskGetTickCount()
+    #define demoTIMESTAMP_COUNTS_PER_SECOND    ( ( uint32_t ) configTICK_RATE_HZ )
+#endif
+
+/* Convert a difference between two timestamps to microseconds. */
+#define demoTIMESTAMP_TO_US( xTimestampDifference ) \
+    ( ( uint32_t ) ( ( ( uint64_t ) ( xTimestampDifference ) * 1000000ULL ) / ( uint64_t ) demoTIMESTAMP_COUNTS_PER_SECOND ) )
+
+#endif /* DEMO_TIMESTAMP_H */
@@ -0,0 +1,102 @@
+/*
+ * FreeRTOS V202411.00
+ * Copyright (C) 2020 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * https://www.FreeRTOS.org
+ * https://github.com/FreeRTOS
+ *
+ */
+
+#ifndef LOCK_PROFILER_H
+#define LOCK_PROFILER_H
+
+#include "LogHistogram.h"
+
+/*
+ * Instrumentation for semaphores and mutexes.  A lock is registered once,
+ * after it is created, then taken and given using xTracedSemaphoreTake() and
+ * xTracedSemaphoreGive() in place of xSemaphoreTake() and xSemaphoreGive().
+ * The traced versions record how often the lock was obtained, how long each
+ * task waited for it, how long it was held, and how often a task had to wait
+ * for a lower priority task - which is where priority inversion comes from.
+ * Locks that have not been registered are passed straight through to the
+ * untraced API.  Recursive mutexes are not supported.
+ */
+
+/* The maximum number of locks that can be registered.  Each DemoLock
+ * registers two. */
+#ifndef lockprofMAX_LOCKS
+    #define lockprofMAX_LOCKS    12
+#endif
+
+/* The statistics gathered for one lock.  All times are in microseconds. */
+typedef struct xLOCK_STATS
+{
+    const char * pcName;          /* The name given when the lock was registered. */
+    SemaphoreHandle_t xLock;      /* The lock itself. */
+    BaseType_t xIsMutex;          /* pdTRUE if the lock is a mutex, so uses priority inheritance. */
+    TaskHandle_t xHolder;         /* The task holding the lock, or NULL if the lock is free. */
+    uint32_t ulAcquisitions;      /* The number of times the lock was obtained. */
+    uint32_t ulContended;         /* The number of times the lock was obtained after having to wait for it. */
+    uint32_t ulTimeouts;          /* The number of times the lock could not be obtained within the block time. */
+    uint32_t ulInversions;        /* The number of times a task had to wait for a lower priority holder. */
+    uint32_t ulInheritances;      /* The number of times the holder's priority was raised while it held the lock. */
+    LogHistogram_t xWaitTime;     /* The time taken to obtain the lock. */
+    LogHistogram_t xHoldTime;     /* The time the lock was held. */
+} LockStats_t;
+
+/*
+ * Start gathering statistics for xLock.  pcName is not copied, so must remain
+ * valid.  Set xIsMutex to pdTRUE if xLock was created as a mutex.  Returns
+ * pdFAIL if lockprofMAX_LOCKS locks are already registered.
+ */
+BaseType_t xLockProfilerRegister( SemaphoreHandle_t xLock,
+                                  const char * pcName,
+                                  BaseType_t xIsMutex );
+
+/*
+ * Traced versions of xSemaphoreTake() and xSemaphoreGive(), which take the
+ * same parameters and return the same values.  Must not be called from an
+ * interrupt.
+ */
+BaseType_t xTracedSemaphoreTake( SemaphoreHandle_t xLock,
+                                 TickType_t xTicksToWait );
+BaseType_t xTracedSemaphoreGive( SemaphoreHandle_t xLock );
+
+/*
+ * Return the number of registered locks.
+ */
+UBaseType_t uxLockProfilerGetCount( void );
+
+/*
+ * Copy the statistics of the uxIndex'th registered lock into pxStats.  The
+ * copy is taken in a critical section so is consistent.  Returns pdFAIL if
+ * uxIndex is not less than uxLockProfilerGetCount().
+ */
+BaseType_t xLockProfilerGetStats( UBaseType_t uxIndex,
+                                  LockStats_t * pxStats );
+
+/*
+ * Clear the statistics of every registered lock.  The locks remain
+ * registered.
+ */
+void vLockProfilerReset( void );
+
+#endif /* LOCK_PROFILER_H */
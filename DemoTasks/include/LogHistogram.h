@@ -0,0 +1,78 @@
+/*
+ * FreeRTOS V202411.00
+ * Copyright (C) 2020 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * https://www.FreeRTOS.org
+ * https://github.com/FreeRTOS
+ *
+ */
+
+#ifndef LOG_HISTOGRAM_H
+#define LOG_HISTOGRAM_H
+
+/*
+ * A histogram with one bucket per power of two, used to record latencies
+ * without using the heap.  Bucket 0 counts values of 0 and bucket n (n > 0)
+ * counts values from 2^(n-1) to (2^n)-1 inclusive, so any 32-bit value can be
+ * recorded in constant time and memory.
+ */
+#define histNUM_BUCKETS    33
+
+typedef struct xLOG_HISTOGRAM
+{
+    uint32_t ulBuckets[ histNUM_BUCKETS ];
+    uint32_t ulCount; /* The number of values recorded. */
+    uint32_t ulMin;   /* The smallest value recorded, only valid if ulCount > 0. */
+    uint32_t ulMax;   /* The largest value recorded. */
+    uint64_t ullSum;  /* The sum of all the values recorded. */
+} LogHistogram_t;
+
+/*
+ * Remove all the values from the histogram.
+ */
+void vLogHistogramReset( LogHistogram_t * pxHistogram );
+
+/*
+ * Add ulValue to the histogram.
+ */
+void vLogHistogramRecord( LogHistogram_t * pxHistogram,
+                          uint32_t ulValue );
+
+/*
+ * Estimate the value below which ulPerMille thousandths of the recorded values
+ * fall - for example 500 for the median or 999 for the 99.9th percentile.  The
+ * estimate interpolates within the bucket that contains the percentile and is
+ * clamped to the recorded minimum and maximum.  Returns 0 if the histogram is
+ * empty.
+ */
+uint32_t ulLogHistogramPercentile( const LogHistogram_t * pxHistogram,
+                                   uint32_t ulPerMille );
+
+/*
+ * Return the mean of the recorded values, or 0 if the histogram is empty.
+ */
+uint32_t ulLogHistogramMean( const LogHistogram_t * pxHistogram );
+
+/*
+ * Return the largest value that is counted in bucket uxBucket.
+ */
+uint32_t ulLogHistogramBucketLimit( UBaseType_t uxBucket );
+
+#endif /* LOG_HISTOGRAM_H */
@@ -0,0 +1,105 @@
+/*
+ * FreeRTOS V202411.00
+ * Copyright (C) 2020 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * https://www.FreeRTOS.org
+ * https://github.com/FreeRTOS
+ *
+ */
+#ifndef METRICS_SERVER_H
+#define METRICS_SERVER_H
+
+/*
+ * Serves the demo's statistics in a compact, machine readable form on a UDP
+ * port of its own, so a collector can poll many devices without scraping the
+ * tables generated by the CLI commands.  Each reply is a single datagram of
+ * text lines, one record per line.  Every line starts with a record type,
+ * followed by a name where the record has one, followed by key=value pairs:
+ *
+ *   m1 seq=<n> up=<ms> rt=<run time> polls=<n> pushes=<n>    header, always first
+ *   t <task> rt=<run time> pri=<priority> hw=<free stack>     task CPU and stack
+ *   tover tasks=<n> max=<n>                                  sent instead of the t records
+ *                                                            when there are more than
+ *                                                            metricsMAX_TASKS tasks
+ *   s <task> min=<words> depth=<words> rec=<words>            stack audit history
+ *   l <lock> acq= cont= to= inv= inh= w99= wmax= h99= hmax=   lock stats, times in us
+ *   n <counter> <value>                                      IP stack debug counters
+ *   e <copy|zcopy> bytes= sent= recv= lost= late= err= p50= p99= max=
+ *                                                            echo benchmark, times in us
+ *   end lines=<n> dropped=<n>                                always last
+ *
+ * Run time values are the raw counters; a collector calculates CPU use from
+ * the change between two polls.  The header's polls and pushes count the
+ * replies sent to poll requests and to push subscriptions respectively.  Spaces in names are replaced with '_'.
+ * Lines that do not fit in the datagram are dropped and counted on the "end"
+ * line.
+ *
+ * Requests are single datagrams:
+ *
+ *   poll [sections]             reply once
+ *   push <ms> [sections]        send a reply to the sender every <ms> ms, 0 to stop
+ *
+ * where sections is any of the letters "tslne", which select the record types
+ * above.  All sections are sent if none are given.  A push subscription lapses
+ * after metricsPUSH_LEASE_MS unless the collector renews it by sending the
+ * push request again, so a collector that goes away is not sent to forever.
+ */
+
+/* The largest reply, which must fit in a single frame - 20 bytes are needed
+ * for the IPv4 header and 8 bytes for the UDP header. */
+#ifndef metricsMAX_PAYLOAD
+    #define metricsMAX_PAYLOAD    ( ipconfigNETWORK_MTU - 28 )
+#endif
+
+/* The most collectors that can have a push subscription at once. */
+#ifndef metricsMAX_SUBSCRIBERS
+    #define metricsMAX_SUBSCRIBERS    4
+#endif
+
+/* How long a push subscription lasts unless it is renewed. */
+#ifndef metricsPUSH_LEASE_MS
+    #define metricsPUSH_LEASE_MS    60000UL
+#endif
+
+/* The shortest push interval accepted. */
+#ifndef metricsMIN_PUSH_INTERVAL_MS
+    #define metricsMIN_PUSH_INTERVAL_MS    100UL
+#endif
+
+/* How long to wait before trying again if the UDP port can not be opened, for
+ * example because it is already in use. */
+#ifndef metricsOPEN_RETRY_DELAY_MS
+    #define metricsOPEN_RETRY_DELAY_MS    10000UL
+#endif
+
+/* The most tasks there can be for the "t" records to be sent.  With more tasks
+ * than this a "tover" record is sent in their place. */
+#ifndef metricsMAX_TASKS
+    #define metricsMAX_TASKS    64
+#endif
+
+/*
+ * Create the task that serves the metrics on port ulPort.
+ */
+void vStartMetricsServerTask( uint16_t usStackSize,
+                              uint32_t ulPort,
+                              UBaseType_t uxPriority );
+
+#endif /* METRICS_SERVER_H */
@@ -0,0 +1,137 @@
+/*
+ * FreeRTOS V202411.00
+ * Copyright (C) 2020 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * https://www.FreeRTOS.org
+ * https://github.com/FreeRTOS
+ *
+ */
+
+#ifndef PERIODIC_TASK_H
+#define PERIODIC_TASK_H
+
+#include "LogHistogram.h"
+
+/*
+ * Instrumentation for tasks that run at a fixed rate.  A task calls
+ * xPeriodicTaskInit() once, which releases its first job straight away, then
+ * calls vPeriodicTaskWaitForRelease() at the end of each job in place of
+ * vTaskDelay().  The releases are spaced with xTaskDelayUntil(), so they do
+ * not drift however long each job takes.  For every job the time from its
+ * release to the task starting it, the time from its release to it completing,
+ * and whether it completed after its deadline are recorded.  The start latency
+ * is measured to tick resolution, as that is the resolution of the release
+ * time, and the time taken by the job itself to DemoTimestamp_t resolution.
+ *
+ * A task that decides its own release times, for example one that must also
+ * wake for other reasons, instead calls xPeriodicTaskRegister() once and then
+ * brackets each job with vPeriodicTaskStartJob() and vPeriodicTaskEndJob().
+ */
+
+/* The maximum number of periodic tasks. */
+#ifndef periodicMAX_TASKS
+    #define periodicMAX_TASKS    16
+#endif
+
+/* The statistics gathered for one periodic task.  All times are in
+ * microseconds. */
+typedef struct xPERIODIC_TASK_STATS
+{
+    TaskHandle_t xTask;             /* The task. */
+    TickType_t xPeriod;             /* The time between releases, in ticks. */
+    TickType_t xDeadline;           /* The time from each release to its deadline, in ticks. */
+    uint32_t ulReleases;            /* The number of jobs released. */
+    uint32_t ulMisses;              /* The number of jobs that completed after their deadline. */
+    uint32_t ulLateReleases;        /* The number of jobs whose release time had passed before the previous job completed. */
+    LogHistogram_t xStartLatency;   /* The time from each release to the job starting. */
+    LogHistogram_t xResponseTime;   /* The time from each release to the job completing. */
+} PeriodicTaskStats_t;
+
+/*
+ * Make the calling task a periodic task with a period of xPeriod ticks, whose
+ * jobs must complete within xDeadline ticks of their release.  Pass 0 as the
+ * deadline to use the period.  The first job is released immediately.
+ * Returns pdFAIL if periodicMAX_TASKS tasks are already periodic tasks.
+ */
+BaseType_t xPeriodicTaskInit( TickType_t xPeriod,
+                              TickType_t xDeadline );
+
+/*
+ * Mark the calling task's current job as complete, then wait for the next job
+ * to be released.  Does nothing if the calling task is not a periodic task.
+ */
+void vPeriodicTaskWaitForRelease( void );
+
+/*
+ * Make the calling task a periodic task, as xPeriodicTaskInit(), but without
+ * releasing a job.  If the calling task is already a periodic task its period
+ * and deadline are updated and its statistics are kept.  Returns pdFAIL if
+ * periodicMAX_TASKS other tasks are already periodic tasks.
+ */
+BaseType_t xPeriodicTaskRegister( TickType_t xPeriod,
+                                  TickType_t xDeadline );
+
+/*
+ * Start a job of the calling task that was released at tick xRelease, which
+ * must not be in the future.  The job is counted as a late release if the
+ * calling task's previous job completed at or after xRelease.  Does nothing
+ * if the calling task is not a periodic task.
+ */
+void vPeriodicTaskStartJob( TickType_t xRelease );
+
+/*
+ * Mark the calling task's current job as complete.  Does nothing if the
+ * calling task is not a periodic task or has no job running.
+ */
+void vPeriodicTaskEndJob( void );
+
+/*
+ * Return the number of periodic tasks.
+ */
+UBaseType_t uxPeriodicTaskGetCount( void );
+
+/*
+ * Copy the statistics of the uxIndex'th periodic task into pxStats.  The copy
+ * is taken in a critical section so is consistent.  Returns pdFAIL if uxIndex
+ * is not less than uxPeriodicTaskGetCount().
+ */
+BaseType_t xPeriodicTaskGetStats( UBaseType_t uxIndex,
+                                  PeriodicTaskStats_t * pxStats );
+
+/*
+ * Copy the statistics of periodic task xTask into pxStats, as
+ * xPeriodicTaskGetStats().  Returns pdFAIL if xTask is not a periodic task.
+ */
+BaseType_t xPeriodicTaskGetTaskStats( TaskHandle_t xTask,
+                                      PeriodicTaskStats_t * pxStats );
+
+/*
+ * Clear the statistics of every periodic task.  The tasks remain periodic
+ * tasks.
+ */
+void vPeriodicTaskReset( void );
+
+/*
+ * Clear the statistics of periodic task xTask only.  Does nothing if xTask is
+ * not a periodic task.
+ */
+void vPeriodicTaskResetTask( TaskHandle_t xTask );
+
+#endif /* PERIODIC_TASK_H */
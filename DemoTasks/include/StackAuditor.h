@@ -0,0 +1,96 @@
+/*
+ * FreeRTOS V202411.00
+ * Copyright (C) 2020 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * https://www.FreeRTOS.org
+ * https://github.com/FreeRTOS
+ *
+ */
+
+#ifndef STACK_AUDITOR_H
+#define STACK_AUDITOR_H
+
+/*
+ * Periodically reads the stack high water mark of every task and keeps the
+ * lowest value seen for each, so the stack each task actually needs can be
+ * seen without catching it at the moment its stack use peaks.  Where the stack
+ * depth a task was created with is known, a stack depth that leaves a safety
+ * margin over the deepest use seen is recommended.  The depth is only known for
+ * tasks created by xDemoTaskCreate().  Requires configUSE_TRACE_FACILITY.
+ *
+ * Note the Windows port runs each task in its own Windows thread using the
+ * thread's stack, so on that port the high water marks only show the stack
+ * used before the task first ran.
+ */
+
+/* The most tasks whose history can be kept.  The history of a task that has
+ * been deleted is discarded if the space is needed for a new task. */
+#ifndef stackauditMAX_TASKS
+    #define stackauditMAX_TASKS    32
+#endif
+
+/* The time between samples. */
+#ifndef stackauditPERIOD_MS
+    #define stackauditPERIOD_MS    1000UL
+#endif
+
+/* The recommended stack depth is the deepest use seen plus this percentage,
+ * but with at least stackauditMIN_MARGIN_WORDS words to spare. */
+#ifndef stackauditMARGIN_PERCENT
+    #define stackauditMARGIN_PERCENT    25UL
+#endif
+
+#ifndef stackauditMIN_MARGIN_WORDS
+    #define stackauditMIN_MARGIN_WORDS    64UL
+#endif
+
+/* The history kept for one task. */
+typedef struct xSTACK_AUDIT_ENTRY
+{
+    TaskHandle_t xTask;                       /* The task. */
+    char cName[ configMAX_TASK_NAME_LEN ];    /* The task's name. */
+    configSTACK_DEPTH_TYPE uxStackDepth;      /* The depth the task was created with, or 0 if not known. */
+    configSTACK_DEPTH_TYPE uxMinHighWater;    /* The least free stack seen, in words. */
+    configSTACK_DEPTH_TYPE uxRecommended;     /* The recommended depth, or 0 if the depth is not known. */
+    uint32_t ulSamples;                       /* The number of samples that included the task. */
+    BaseType_t xDeleted;                      /* pdTRUE if the task was missing from the latest sample. */
+} StackAuditEntry_t;
+
+/*
+ * Create the task that takes the samples.  The task runs at uxPriority, which
+ * would normally be low so the sampling does not disturb the tasks being
+ * audited.
+ */
+void vStartStackAuditorTask( uint16_t usStackSize,
+                             UBaseType_t uxPriority );
+
+/*
+ * Copy the history of the uxIndex'th task into pxEntry, returning pdFALSE if
+ * there are not that many tasks in the history.
+ */
+BaseType_t xStackAuditorGetEntry( UBaseType_t uxIndex,
+                                  StackAuditEntry_t * pxEntry );
+
+/*
+ * Return the number of samples taken so far.
+ */
+uint32_t ulStackAuditorGetSamples( void );
+
+#endif /* STACK_AUDITOR_H */
@@ -0,0 +1,132 @@
+/*
+ * FreeRTOS V202411.00
+ * Copyright (C) 2020 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * https://www.FreeRTOS.org
+ * https://github.com/FreeRTOS
+ *
+ */
+
+#ifndef STATE_RECORDER_H
+#define STATE_RECORDER_H
+
+/*
+ * Records a timeline of the scheduler state of a set of tasks.  A high
+ * priority task samples the state of every registered task once per period,
+ * which can be as short as one tick, and stores each state in two bits of a
+ * statically allocated circular buffer.  When the buffer is full the oldest
+ * samples are overwritten, so the buffer always holds the most recent part of
+ * the timeline and the recorder can be left running.
+ *
+ * The sampling task preempts whichever task was running when it woke, so that
+ * task is always found in the Ready state.  The registered task that is Ready
+ * and has the highest (possibly inherited) priority is therefore recorded as
+ * Running - which is correct unless an unregistered task was running.
+ */
+
+/* The maximum number of tasks whose states can be recorded. */
+#ifndef staterecMAX_TASKS
+    #define staterecMAX_TASKS    16
+#endif
+
+/* The size of the buffer holding the timeline.  The number of samples it can
+ * hold is ( staterecBUFFER_BYTES * 4 ) divided by the number of registered
+ * tasks. */
+#ifndef staterecBUFFER_BYTES
+    #define staterecBUFFER_BYTES    4096
+#endif
+
+/* The tick count is recorded along with every staterecSAMPLES_PER_STAMP'th
+ * sample, starting with sample 0, so the time of a sample is still known
+ * after samples have been taken late. */
+#ifndef staterecSAMPLES_PER_STAMP
+    #define staterecSAMPLES_PER_STAMP    64
+#endif
+
+/* The states stored in the timeline. */
+#define staterecSTATE_BLOCKED      0U
+#define staterecSTATE_READY        1U
+#define staterecSTATE_RUNNING      2U
+#define staterecSTATE_SUSPENDED    3U /* Also used for deleted tasks. */
+
+/* Information about the timeline held by the recorder. */
+typedef struct xSTATE_RECORDER_INFO
+{
+    UBaseType_t uxTasks;    /* The number of registered tasks. */
+    uint32_t ulCapacity;    /* The number of samples the buffer can hold. */
+    uint32_t ulFirstSample; /* The number of the oldest sample still in the buffer. */
+    uint32_t ulSamples;     /* The number of samples taken since the recorder was started. */
+    uint32_t ulLateSamples; /* The number of samples taken later than their period. */
+    TickType_t xPeriod;     /* The time between samples. */
+    TickType_t xStartTime;  /* The tick count when sample 0 was taken. */
+    BaseType_t xRecording;  /* pdTRUE if the recorder is running. */
+} StateRecorderInfo_t;
+
+/*
+ * Create the task that takes the samples.  The priority should be higher than
+ * the priority of any task being recorded.  The recorder does not start until
+ * vStateRecorderStart() is called.
+ */
+void vStartStateRecorderTask( uint16_t usStackSize,
+                              UBaseType_t uxPriority );
+
+/*
+ * Add xTask to the tasks whose states are recorded.  Tasks can only be
+ * registered while the recorder is stopped, and registering a task discards
+ * the current timeline.  Returns pdFAIL if staterecMAX_TASKS tasks are already
+ * registered or the recorder is running.
+ */
+BaseType_t xStateRecorderRegisterTask( TaskHandle_t xTask );
+
+/*
+ * Discard the current timeline and start sampling every xPeriod ticks, or
+ * stop sampling.  The timeline is kept when the recorder is stopped.
+ */
+void vStateRecorderStart( TickType_t xPeriod );
+void vStateRecorderStop( void );
+
+/*
+ * Obtain information about the timeline.
+ */
+void vStateRecorderGetInfo( StateRecorderInfo_t * pxInfo );
+
+/*
+ * Return the uxTask'th registered task.
+ */
+TaskHandle_t xStateRecorderGetTask( UBaseType_t uxTask );
+
+/*
+ * Return the state of the uxTask'th registered task in sample ulSample, where
+ * ulSample is between StateRecorderInfo_t's ulFirstSample and ulSamples - 1.
+ * If the recorder is running the oldest samples may have been overwritten by
+ * the time they are read.
+ */
+UBaseType_t uxStateRecorderGetState( uint32_t ulSample,
+                                     UBaseType_t uxTask );
+
+/*
+ * Return the tick count at which sample ulSample was taken, where ulSample is
+ * in the same range as for uxStateRecorderGetState().  The time is exact for
+ * samples whose number is a multiple of staterecSAMPLES_PER_STAMP, and is
+ * calculated from the period for the samples in between.
+ */
+TickType_t xStateRecorderGetSampleTime( uint32_t ulSample );
+
+#endif /* STATE_RECORDER_H */
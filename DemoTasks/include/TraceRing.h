@@ -0,0 +1,112 @@
+/*
+ * FreeRTOS V202411.00
+ * Copyright (C) 2020 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * https://www.FreeRTOS.org
+ * https://github.com/FreeRTOS
+ *
+ */
+
+#ifndef TRACE_RING_H
+#define TRACE_RING_H
+
+/*
+ * A low overhead alternative to printf() for tasks that must not be slowed
+ * down by console I/O, for example while holding a lock.  Each registered
+ * task has its own ring of fixed size binary records.  Recording an event only
+ * writes a timestamp, a sequence number, an event ID and two arguments into
+ * the calling task's ring - it does not block, does not enter a critical
+ * section and does not format anything.  The records are formatted later,
+ * when they are read, using a table of printf() style format strings indexed
+ * by the event ID.
+ *
+ * Each ring has a single writer (the task that owns it) and a single reader,
+ * so needs no lock.  Readers are serialised by a mutex, so records can be read
+ * by both the drain task and the trace-dump CLI command.  Records from all the
+ * rings are merged by sequence number, so they are returned in the order in
+ * which they were recorded, except that a record can come out ahead of one
+ * recorded just before it by another task that had not yet finished writing
+ * it.
+ */
+
+/* The maximum number of tasks that can have a ring. */
+#ifndef ringMAX_RINGS
+    #define ringMAX_RINGS    8
+#endif
+
+/* The number of records in each ring, which must be a power of two.  An event
+ * is dropped, and counted, if it is recorded when its ring is full. */
+#ifndef ringRECORDS_PER_RING
+    #define ringRECORDS_PER_RING    64
+#endif
+
+/* The longest line generated by xTraceRingFormatNext(). */
+#define ringMAX_LINE_LENGTH    120
+
+/*
+ * Set the format strings used to format the records.  ppcFormats[ n ] is used
+ * for event ID n and is passed the two event arguments as unsigned values, so
+ * can contain up to two %u (or %c, %x, etc.) conversions.  The table is not
+ * copied, so must remain valid.
+ */
+void vTraceRingSetFormats( const char * const * ppcFormats,
+                           UBaseType_t uxNumberOfFormats );
+
+/*
+ * Give xTask a ring, so the events it records are kept.  Pass NULL to give
+ * the calling task a ring.  Returns pdFAIL if ringMAX_RINGS tasks already have
+ * a ring.  Must be called before the scheduler is started or from a single
+ * task.
+ */
+BaseType_t xTraceRingRegisterTask( TaskHandle_t xTask );
+
+/*
+ * Record event usEventId in the calling task's ring.  The event is discarded if
+ * the calling task does not have a ring.  Must not be called from an
+ * interrupt.
+ */
+void vTraceRingRecord( uint16_t usEventId,
+                       uint32_t ulArgument1,
+                       uint32_t ulArgument2 );
+
+/*
+ * Remove the oldest record from the rings and format it into pcBuffer as a
+ * single line of text terminated with "\r\n".  Returns pdFALSE, and leaves
+ * pcBuffer unchanged, if there are no records.
+ */
+BaseType_t xTraceRingFormatNext( char * pcBuffer,
+                                 size_t xBufferLength );
+
+/*
+ * Return the number of records that are waiting to be read, and the total
+ * number of events dropped because a ring was full.
+ */
+UBaseType_t uxTraceRingGetPending( void );
+uint32_t ulTraceRingGetDropped( void );
+
+/*
+ * Create a task that periodically reads the records and prints them to the
+ * console.  The task should have a low priority so printing does not delay
+ * the tasks being traced.
+ */
+void vStartTraceRingDrainTask( uint16_t usStackSize,
+                               UBaseType_t uxPriority );
+
+#endif /* TRACE_RING_H */
@@ -27,6 +27,29 @@
 #ifndef TWO_ECHO_CLIENTS_H
 #define TWO_ECHO_CLIENTS_H
 
+#include "LogHistogram.h"
+
+/* The range of payload sizes and run times accepted by xEchoBenchStart().
+ * Each request starts with a 32-bit sequence number. */
+#define echoBENCH_MIN_PAYLOAD        ( sizeof( uint32_t ) )
+#define echoBENCH_MAX_PAYLOAD        ( ipconfigNETWORK_MTU - 28 )
+#define echoBENCH_MAX_RUN_TIME_MS    600000UL
+#define echoBENCH_MAX_WINDOW         32
+
+/* The results of one echo benchmark run. */
+typedef struct xECHO_BENCH_RESULT
+{
+    uint32_t ulPayloadBytes;   /* The size of each echo request. */
+    uint32_t ulWindow;         /* The maximum number of requests in flight. */
+    uint32_t ulDurationMs;     /* How long the run actually took. */
+    uint32_t ulSent;           /* The number of requests sent. */
+    uint32_t ulReceived;       /* The number of correct replies received. */
+    uint32_t ulErroneous;      /* The number of replies that did not match the request. */
+    uint32_t ulLost;           /* The number of requests not answered within the receive timeout. */
+    uint32_t ulLate;           /* The number of replies that arrived after their request timed out. */
+    LogHistogram_t xRoundTrip; /* The round trip time of each correct reply, in microseconds. */
+} EchoBenchResult_t;
+
 /*
  * Create the two UDP echo client tasks.  One task uses the standard interface
  * to send to and receive from an echo server.  The other task uses the zero
@@ -35,4 +58,24 @@
 void vStartEchoClientTasks( uint16_t usTaskStackSize,
                             unsigned portBASE_TYPE uxTaskPriority );
 
+/*
+ * Replace the normal echo traffic with a benchmark.  The task that uses the
+ * standard interface sends xPayloadBytes byte requests for ulRunTimeMs
+ * milliseconds, keeping up to uxWindow requests in flight, then the task that
+ * uses the zero copy interface does the same, after which both tasks return to
+ * their normal behaviour.  A window of 1 is the stop-and-wait behaviour of the
+ * normal echo clients.  Returns pdFAIL if a benchmark is already running or
+ * the parameters are out of range.
+ */
+BaseType_t xEchoBenchStart( size_t xPayloadBytes,
+                            uint32_t ulRunTimeMs,
+                            UBaseType_t uxWindow );
+
+/*
+ * Obtain the results of the most recent benchmark run by each task.  Returns
+ * pdTRUE if a benchmark is still running.
+ */
+BaseType_t xEchoBenchGetResults( EchoBenchResult_t * pxCopyResult,
+                                 EchoBenchResult_t * pxZeroCopyResult );
+
 #endif /* TWO_ECHO_CLIENTS_H */
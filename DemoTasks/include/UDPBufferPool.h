@@ -0,0 +1,85 @@
+/*
+ * FreeRTOS V202411.00
+ * Copyright (C) 2020 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * https://www.FreeRTOS.org
+ * https://github.com/FreeRTOS
+ *
+ */
+
+#ifndef UDP_BUFFER_POOL_H
+#define UDP_BUFFER_POOL_H
+
+/*
+ * A pool of zero copy UDP payload buffers that have already been obtained
+ * from the IP stack.  A background task keeps the pool topped up, so a task
+ * sending with the zero copy interface can take a buffer from the pool without
+ * waiting in FreeRTOS_GetUDPPayloadBuffer() for the stack to allocate one.
+ * Every buffer in the pool is large enough for a maximum size UDP payload, so
+ * can be sent with any length up to udppoolBUFFER_SIZE.
+ */
+
+/* The number of buffers in the pool. */
+#ifndef udppoolNUMBER_OF_BUFFERS
+    #define udppoolNUMBER_OF_BUFFERS    8
+#endif
+
+/* The size of each buffer in the pool. */
+#define udppoolBUFFER_SIZE    ( ipconfigNETWORK_MTU - 28 )
+
+/* Counters maintained by the pool. */
+typedef struct xUDP_BUFFER_POOL_STATS
+{
+    uint32_t ulTaken;     /* The number of buffers taken from the pool. */
+    uint32_t ulReturned;  /* The number of unused buffers given back to the pool. */
+    uint32_t ulEmpty;     /* The number of times a buffer was wanted but the pool was empty. */
+    uint32_t ulAllocated; /* The number of buffers obtained from the IP stack by the refill task. */
+    uint32_t ulAvailable; /* The number of buffers currently in the pool. */
+} UDPBufferPoolStats_t;
+
+/*
+ * Create the pool and the task that refills it.  Can be called more than
+ * once, only the first call has any effect.  The refill task should have a
+ * lower priority than the tasks taking buffers from the pool.
+ */
+void vUDPBufferPoolStart( uint16_t usStackSize,
+                          UBaseType_t uxRefillPriority );
+
+/*
+ * Take a buffer from the pool, waiting up to xTicksToWait for one to be
+ * available if the pool is empty.  The buffer is then owned by the caller, so
+ * must either be passed to FreeRTOS_sendto() using the zero copy interface, be
+ * released with FreeRTOS_ReleaseUDPPayloadBuffer(), or be given back with
+ * vUDPBufferPoolReturn().  Returns NULL if no buffer was obtained.
+ */
+uint8_t * pucUDPBufferPoolTake( TickType_t xTicksToWait );
+
+/*
+ * Give back a buffer that was taken from the pool but not sent, for example
+ * because FreeRTOS_sendto() failed.
+ */
+void vUDPBufferPoolReturn( uint8_t * pucBuffer );
+
+/*
+ * Obtain a copy of the counters maintained by the pool.
+ */
+void vUDPBufferPoolGetStats( UDPBufferPoolStats_t * pxStats );
+
+#endif /* UDP_BUFFER_POOL_H */
@@ -27,8 +27,32 @@
 #ifndef UDP_COMMAND_INTERPRETER_H
 #define UDP_COMMAND_INTERPRETER_H
 
+/* Counters maintained by the UDP command interpreter task. */
+typedef struct xUDP_COMMAND_INTERPRETER_STATS
+{
+    uint32_t ulWakeUps;          /* The number of times the task woke to receive datagrams. */
+    uint32_t ulDatagrams;        /* The total number of datagrams received. */
+    uint32_t ulLastBatch;        /* The number of datagrams handled by the most recent wake-up. */
+    uint32_t ulMaxBatch;         /* The most datagrams handled by any single wake-up. */
+    uint32_t ulActiveSessions;   /* The number of clients that currently have a session. */
+    uint32_t ulMaxSessions;      /* The size of the session pool. */
+    uint32_t ulSessionsTimedOut; /* Sessions released because their client went idle. */
+    uint32_t ulSessionsEvicted;  /* Sessions taken over because the pool was full. */
+    uint32_t ulReplyChunks;      /* The number of output chunks generated by commands. */
+    uint32_t ulReplyDatagrams;   /* The number of datagrams used to send those chunks. */
+    uint32_t ulDeferred;         /* Heavy commands passed to a worker task. */
+    uint32_t ulRejected;         /* Heavy commands refused because the job queue was full. */
+    uint32_t ulRepliesDropped;   /* Replies cut short because no network buffer became available. */
+} UDPCommandInterpreterStats_t;
+
 void vStartUDPCommandInterpreterTask( uint16_t usStackSize,
                                       uint32_t ulPort,
                                       unsigned portBASE_TYPE uxPriority );
 
+/*
+ * Obtain a copy of the counters maintained by the UDP command interpreter
+ * task.
+ */
+void vUDPCommandInterpreterGetStats( UDPCommandInterpreterStats_t * pxStats );
+
 #endif /* UDP_COMMAND_INTERPRETER_H */
@@ -0,0 +1,127 @@
+/*
+ * FreeRTOS V202411.00
+ * Copyright (C) 2020 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * https://www.FreeRTOS.org
+ * https://github.com/FreeRTOS
+ *
+ */
+
+#ifndef UDP_SERVER_H
+#define UDP_SERVER_H
+
+/*
+ * A UDP server made up of one receive task and srvNUMBER_OF_WORKERS worker
+ * tasks.  The receive task does nothing but receive datagrams from the bound
+ * socket and pass them, round robin, to the workers.  Each worker has its own
+ * single producer single consumer ring, so passing a datagram to a worker does
+ * not need a lock.  The workers call the server's handler for each datagram,
+ * so anything slow, such as printing, is kept off the receive path and can run
+ * on another core.
+ *
+ * A zero copy server passes the buffers received from the IP stack straight
+ * to the workers.  A server that does not use the zero copy interface
+ * receives each datagram directly into a slot of a worker's ring, so the data
+ * is still only copied once, by FreeRTOS_recvfrom().
+ */
+
+/* The number of worker tasks created by each server. */
+#ifndef srvNUMBER_OF_WORKERS
+    #define srvNUMBER_OF_WORKERS    2
+#endif
+
+/* The number of datagrams each worker can have waiting.  Must be a power of
+ * two.  Datagrams that arrive while every worker's ring is full are dropped. */
+#ifndef srvQUEUE_LENGTH
+    #define srvQUEUE_LENGTH    8
+#endif
+
+/* The longest datagram a server that does not use the zero copy interface
+ * can receive.  Longer datagrams are truncated. */
+#ifndef srvMAX_COPY_LENGTH
+    #define srvMAX_COPY_LENGTH    128
+#endif
+
+/* The maximum number of servers that can be started. */
+#ifndef srvMAX_SERVERS
+    #define srvMAX_SERVERS    2
+#endif
+
+/* Set to 1 to spread the workers over the cores of an SMP build, leaving the
+ * receive task on core 0.  Has no effect on single core builds. */
+#ifndef srvPIN_WORKERS
+    #define srvPIN_WORKERS    1
+#endif
+
+/*
+ * Called by a worker for each datagram.  Data received by a server that does
+ * not use the zero copy interface is always followed by a null byte, which is
+ * not counted in lLength.  The data must not be used after the handler
+ * returns.
+ */
+typedef void ( * UDPServerHandler_t )( const uint8_t * pucData,
+                                       int32_t lLength );
+
+/* The counters of one worker. */
+typedef struct xUDP_SERVER_WORKER_STATS
+{
+    uint32_t ulHandled;   /* The number of datagrams handled. */
+    uint32_t ulBytes;     /* The number of bytes handled. */
+    uint32_t ulHighWater; /* The most datagrams that have been waiting at once. */
+} UDPServerWorkerStats_t;
+
+/* The counters of a server. */
+typedef struct xUDP_SERVER_STATS
+{
+    const char * pcName;                                     /* The name given to xUDPServerStart(). */
+    uint16_t usPort;                                         /* The port the server is bound to. */
+    BaseType_t xZeroCopy;                                    /* pdTRUE if the server uses the zero copy interface. */
+    uint32_t ulReceived;                                     /* The number of datagrams received. */
+    uint32_t ulDropped;                                      /* The number of datagrams dropped because every worker was busy. */
+    UDPServerWorkerStats_t xWorkers[ srvNUMBER_OF_WORKERS ]; /* The counters of each worker. */
+} UDPServerStats_t;
+
+/*
+ * Create a server bound to usPort.  pcName is used to name the server's tasks
+ * and must remain valid.  The receive task and workers are created at
+ * uxPriority.  Returns pdFAIL if srvMAX_SERVERS servers have already been
+ * started or the tasks could not be created.
+ */
+BaseType_t xUDPServerStart( const char * pcName,
+                            uint16_t usPort,
+                            BaseType_t xZeroCopy,
+                            UDPServerHandler_t pxHandler,
+                            uint16_t usStackSize,
+                            UBaseType_t uxPriority );
+
+/*
+ * Return the number of servers that have been started.
+ */
+UBaseType_t uxUDPServerGetCount( void );
+
+/*
+ * Obtain a copy of the counters of the server with index uxIndex, where
+ * uxIndex is less than uxUDPServerGetCount().  Returns pdFALSE if there is no
+ * such server.
+ */
+BaseType_t xUDPServerGetStats( UBaseType_t uxIndex,
+                               UDPServerStats_t * pxStats );
+
+#endif /* UDP_SERVER_H */
@@ -0,0 +1,176 @@
+/*
+ * FreeRTOS V202411.00
+ * Copyright (C) 2020 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * https://www.FreeRTOS.org
+ * https://github.com/FreeRTOS
+ *
+ */
+
+#ifndef WORKLOAD_H
+#define WORKLOAD_H
+
+#include "LogHistogram.h"
+#include "DemoLock.h"
+#include "PeriodicTask.h"
+#include "DeferredOutput.h"
+
+/*
+ * A workload generator for measuring scheduling latency and lock contention.
+ * A fixed pool of worker tasks is created once.  Each worker is given a
+ * priority, a period, an amount of CPU time to use each period, a set of
+ * locks and an amount of CPU time to use while holding them, and optionally
+ * an amount of slow output to write while holding them, either one task at a
+ * time or by loading one of the built in scenarios.  While the workload
+ * is running each worker is a periodic task, see PeriodicTask.h, so the
+ * start latency and response time of every job, measured from the tick at
+ * which the job was released, are recorded along with the number of jobs that
+ * missed their deadline, which is the end of their period.
+ *
+ * The CPU time is used by spinning, counting the tick interrupts seen while
+ * spinning, so time spent preempted by higher priority tasks is not counted.
+ * The locks are DemoLocks, so their protocol can be changed while the workload
+ * runs, and are taken in ascending order, so scenarios can not deadlock.  The
+ * ceiling of each lock is kept at the highest priority of the workers that
+ * use it.
+ *
+ * The output is written with xDeferredOutputSend(), so output-mode chooses
+ * whether it is written while the locks are held or only queued for the
+ * output task.  It is not written if the output task has not been started.
+ *
+ * Each worker also records when it takes and gives its locks and writes its
+ * output in its trace ring, if xTraceRingRegisterTask() has given it one.  The
+ * events are formatted with the table returned by ppcWorkloadGetTraceFormats().
+ */
+
+/* The number of worker tasks, each created at start up. */
+#ifndef workloadMAX_TASKS
+    #define workloadMAX_TASKS    8
+#endif
+
+/* The number of locks the workers can take. */
+#ifndef workloadMAX_LOCKS
+    #define workloadMAX_LOCKS    4
+#endif
+
+/* The events recorded in the workers' trace rings. */
+typedef enum
+{
+    eWorkloadEventLocksTaken = 0, /* The job took its locks.  The arguments are the lock mask and the blocking time in microseconds. */
+    eWorkloadEventLocksGiven,     /* The job gave its locks.  The argument is the lock mask. */
+    eWorkloadEventOutputWritten,  /* The job wrote its output to the slow output function.  The argument is the length. */
+    eWorkloadEventOutputQueued,   /* The job queued its output for the output task.  The argument is the length. */
+    eWorkloadEventOutputDropped,  /* The job's output did not fit in the message buffer.  The argument is the length. */
+    eWorkloadNumberOfEvents
+} eWorkloadEvent;
+
+/* The parameters of one worker.  All times are in milliseconds. */
+typedef struct xWORKLOAD_TASK_CONFIG
+{
+    UBaseType_t uxPriority; /* The task's priority, or 0 if the worker is not used. */
+    uint32_t ulPeriodMs;    /* The time between releases, which is also the deadline. */
+    uint32_t ulOffsetMs;    /* The time from the start of the workload to the first release. */
+    uint32_t ulBurstMs;     /* The CPU time used by each job before taking any locks. */
+    uint32_t ulLockMask;    /* Bit n is set if each job takes lock n. */
+    uint32_t ulHoldMs;      /* The CPU time used by each job while holding the locks. */
+    uint32_t ulOutputChars; /* The characters of output each job writes while holding the locks, at most deferredMAX_MESSAGE_LENGTH. */
+} WorkloadTaskConfig_t;
+
+/* The results gathered for one worker since the workload was last started. */
+typedef struct xWORKLOAD_TASK_STATS
+{
+    PeriodicTaskStats_t xPeriodic; /* The worker's periodic task statistics.  The number of jobs completed is xPeriodic.xResponseTime.ulCount. */
+    LogHistogram_t xBlockingTime;  /* The time each job that uses locks took to obtain them, in microseconds. */
+} WorkloadTaskStats_t;
+
+/*
+ * Create the worker tasks with stacks of usStackSize words, and any locks that
+ * have not been provided by xWorkloadSetLock(), which start as mutexes.  The
+ * workers wait until a workload is started.
+ */
+void vStartWorkload( uint16_t usStackSize );
+
+/*
+ * Use xLock, which must not be taken by anything other than the workers, as
+ * lock uxLock rather than having vStartWorkload() create a lock for it.  Must
+ * be called before vStartWorkload().
+ */
+BaseType_t xWorkloadSetLock( UBaseType_t uxLock,
+                             DemoLockHandle_t xLock );
+
+/*
+ * Set the parameters of worker uxTask.  A priority change takes effect
+ * immediately and any other change from the worker's next job.  A worker that
+ * was not used when the workload was started does not run until the workload
+ * is next started.  Returns pdFAIL if any parameter is out of range.
+ */
+BaseType_t xWorkloadSetTask( UBaseType_t uxTask,
+                             const WorkloadTaskConfig_t * pxConfig );
+
+/*
+ * Replace the parameters of every worker with those of the built in scenario
+ * called pcName.  Returns pdFAIL if there is no such scenario.
+ */
+BaseType_t xWorkloadLoadScenario( const char * pcName );
+
+/*
+ * Return the name and description of the uxIndex'th built in scenario, or NULL
+ * if there are not that many scenarios.
+ */
+const char * pcWorkloadGetScenario( UBaseType_t uxIndex,
+                                    const char ** ppcDescription );
+
+/*
+ * Clear the results and release every used worker, each at its offset from
+ * now.  If the workload is already running it is restarted.
+ */
+void vWorkloadStart( void );
+
+/*
+ * Stop the workload.  Each worker stops at the end of its current job.
+ */
+void vWorkloadStop( void );
+
+/*
+ * Return pdTRUE if the workload is running.
+ */
+BaseType_t xWorkloadIsRunning( void );
+
+/*
+ * Copy the parameters and results of worker uxTask into pxConfig and pxStats.
+ * Returns pdFALSE if uxTask is not less than workloadMAX_TASKS.
+ */
+BaseType_t xWorkloadGetTask( UBaseType_t uxTask,
+                             WorkloadTaskConfig_t * pxConfig,
+                             WorkloadTaskStats_t * pxStats );
+
+/*
+ * Return the handle of worker uxTask, or NULL if the workers have not been
+ * created.
+ */
+TaskHandle_t xWorkloadGetTaskHandle( UBaseType_t uxTask );
+
+/*
+ * Return the format strings for the eWorkloadEvent events, to pass to
+ * vTraceRingSetFormats(), and set *puxNumberOfFormats to the number of them.
+ */
+const char * const * ppcWorkloadGetTraceFormats( UBaseType_t * puxNumberOfFormats );
+
+#endif /* WORKLOAD_H */
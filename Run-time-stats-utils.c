@@ -32,22 +32,51 @@
  * real time, therefore the run time counter values have no real meaningful
  * units.
  *
- * Also note that it is assumed this demo is going to be used for short periods
- * of time only, and therefore timer overflows are not handled.
+ * ulGetRunTimeCounterValue() returns a 32-bit count that, at 1/100th of a
+ * millisecond per count, wraps after about 12 hours.  For longer runs use the
+ * 64-bit ullGetRunTimeCounterValue() instead by adding the following to
+ * FreeRTOSConfig.h:
+ *
+ * #define configRUN_TIME_COUNTER_TYPE         uint64_t
+ * #define portGET_RUN_TIME_COUNTER_VALUE()    ullGetRunTimeCounterValue()
+ *
+ * The kernel reads the run time counter on every context switch, so the
+ * performance counter is converted to 1/100ths of a millisecond using a
+ * multiply and a shift that are calculated once, rather than a 64-bit division
+ * on each read.
  */
 
+/* Standard includes. */
+#include <stdint.h>
+
 /* FreeRTOS includes. */
 #include <FreeRTOS.h>
 
+/*
+ * Return the number of (simulated) 1/100ths of a millisecond since
+ * vConfigureTimerForRunTimeStats() was called.
+ */
+uint64_t ullGetRunTimeCounterValue( void );
+
+/* The largest shift for which 100000 can be shifted by that amount without
+ * overflowing 64 bits. */
+#define runtimeMAX_COUNTER_SHIFT    47UL
+
 /* Variables used in the creation of the run time stats time base.  Run time
- * stats record how much time each task spends in the Running state. */
-static long long llInitialRunTimeCounterValue = 0LL, llTicksPerHundredthMillisecond = 0LL;
+ * stats record how much time each task spends in the Running state.  A count
+ * of elapsed performance counter ticks is converted to 1/100ths of a
+ * millisecond by multiplying it by ulCounterMultiplier then shifting the
+ * result right by ulCounterShift bits. */
+static long long llInitialRunTimeCounterValue = 0LL;
+static uint32_t ulCounterMultiplier = 1UL, ulCounterShift = 0UL;
 
 /*-----------------------------------------------------------*/
 
 void vConfigureTimerForRunTimeStats( void )
 {
     LARGE_INTEGER liPerformanceCounterFrequency, liInitialRunTimeValue;
+    uint64_t ullMultiplier;
+    uint32_t ulShift;
 
     /* Initialise the variables used to create the run time stats time base.
      * Run time stats record how much time each task spends in the Running
@@ -55,13 +84,35 @@ void vConfigureTimerForRunTimeStats( void )
 
     if( QueryPerformanceFrequency( &liPerformanceCounterFrequency ) == 0 )
     {
-        llTicksPerHundredthMillisecond = 1;
+        /* Use the raw performance counter value. */
+        ulCounterMultiplier = 1UL;
+        ulCounterShift = 0UL;
     }
     else
     {
-        /* How many times does the performance counter increment in 1/100th
-         * millisecond. */
-        llTicksPerHundredthMillisecond = liPerformanceCounterFrequency.QuadPart / 100000LL;
+        /* The multiplier is 100000 / frequency scaled up by 2^shift, which
+         * converts performance counter increments to 1/100ths of a
+         * millisecond.  Use the largest shift, and therefore the most
+         * accurate multiplier, for which the multiplier still fits in 32
+         * bits, as ullGetRunTimeCounterValue() relies on that to avoid
+         * overflowing its 64-bit intermediate results. */
+        for( ulShift = runtimeMAX_COUNTER_SHIFT; ulShift > 0UL; ulShift-- )
+        {
+            ullMultiplier = ( 100000ULL << ulShift ) / ( uint64_t ) liPerformanceCounterFrequency.QuadPart;
+
+            if( ullMultiplier <= 0xffffffffULL )
+            {
+                break;
+            }
+        }
+
+        if( ulShift == 0UL )
+        {
+            ullMultiplier = 100000ULL / ( uint64_t ) liPerformanceCounterFrequency.QuadPart;
+        }
+
+        ulCounterMultiplier = ( uint32_t ) ullMultiplier;
+        ulCounterShift = ulShift;
 
         /* What is the performance counter value now, this will be subtracted
          * from readings taken at run time. */
@@ -71,19 +122,42 @@ void vConfigureTimerForRunTimeStats( void )
 }
 /*-----------------------------------------------------------*/
 
-unsigned long ulGetRunTimeCounterValue( void )
+uint64_t ullGetRunTimeCounterValue( void )
 {
     LARGE_INTEGER liCurrentCount;
-    unsigned long ulReturn;
+    uint64_t ullElapsed, ullHigh, ullLow;
 
     /* What is the performance counter value now? */
     QueryPerformanceCounter( &liCurrentCount );
 
     /* Subtract the performance counter value reading taken when the
-     * application started to get a count from that reference point, then
-     * scale to (simulated) 1/100ths of a millisecond. */
-    ulReturn = ( unsigned long ) ( ( liCurrentCount.QuadPart - llInitialRunTimeCounterValue ) / llTicksPerHundredthMillisecond );
+     * application started to get a count from that reference point. */
+    ullElapsed = ( uint64_t ) ( liCurrentCount.QuadPart - llInitialRunTimeCounterValue );
+
+    /* Scale to (simulated) 1/100ths of a millisecond, which is
+     * ( ullElapsed * ulCounterMultiplier ) >> ulCounterShift.  The product can
+     * exceed 64 bits, so the upper and lower 32 bits of the elapsed count are
+     * multiplied separately - neither of those products can overflow as the
+     * multiplier fits in 32 bits. */
+    ullHigh = ( ullElapsed >> 32 ) * ulCounterMultiplier;
+    ullLow = ( ullElapsed & 0xffffffffULL ) * ulCounterMultiplier;
 
-    return ulReturn;
+    if( ulCounterShift <= 32UL )
+    {
+        ullHigh <<= ( 32UL - ulCounterShift );
+    }
+    else
+    {
+        ullHigh >>= ( ulCounterShift - 32UL );
+    }
+
+    return ullHigh + ( ullLow >> ulCounterShift );
+}
+/*-----------------------------------------------------------*/
+
+unsigned long ulGetRunTimeCounterValue( void )
+{
+    /* The 32-bit version of the count, which wraps. */
+    return ( unsigned long ) ullGetRunTimeCounterValue();
 }
 /*-----------------------------------------------------------*/
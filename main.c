@@ -1,65 +1,132 @@
 #include <stdio.h>
 #include <string.h>
-#include <conio.h>
 
 #include <FreeRTOS.h>
 #include <task.h>
 #include <semphr.h>
 #include <stdarg.h>
+#include <FreeRTOS_CLI.h>
 
+#include "CLIDispatch.h"
+#include "ConsoleInput.h"
+#include "DemoStatic.h"
+#include "DemoLock.h"
+#include "TraceRing.h"
+#include "StateRecorder.h"
+#include "StackAuditor.h"
+#include "Workload.h"
+#include "PeriodicTask.h"
+#include "DeferredOutput.h"
+#include "CoreStats.h"
 
+/* Defined in CLI-commands.c. */
+extern void vRegisterCLICommands(void);
+
+
+/* The starting mode of xResLock: 1 = mutex, 0 = binary semaphore.  Can be changed at run time,
+   see the lock-mode and lock-compare commands */
 #define USE_MUTEX 1
 
+/* 1 = the workload workers L/M/H record binary events (lock taken/given, output written/queued)
+   that a low priority task prints later, 0 = the events are discarded */
+#define USE_TRACE_RING 1
+
+/* The starting output mode of the workload workers that write output: 1 = only copy the message
+   into a message buffer while holding the lock, the Output task does the slow printing after the lock is
+   released, 0 = the slow printing happens while the lock is held.  Switch at run time with 'o' or output-mode */
+#define USE_DEFERRED_OUTPUT 0
+
+/* Where L/M/H run on an SMP build (configNUMBER_OF_CORES > 1, configUSE_CORE_AFFINITY 1).  Ignored on a
+   single core build, such as the Windows port.  Change at run time with core-affinity.
+   0 = any core
+   1 = all on core 0, so the inversion is the same as on a single core
+   2 = M on core 1, away from L/H, so M cannot starve L even without inheritance
+   3 = H on core 1, L/M on core 0: H has a core to itself, but still waits for L, which M starves
+   Note that with configRUN_MULTIPLE_PRIORITIES 0 (the kernel default) tasks of different priorities never
+   run at the same time, so 2 and 3 only differ from 1 when it is set to 1 */
+#define SMP_PLACEMENT 1
+
+/* The workload scenario started at boot.  L/M/H are workers 0-2, so the scenario can be changed
+   at run time with the workload command, "workload load classic" for the timing of the original
+   L/M/H tasks.  The workers record trace ring events, write L's output through DeferredOutput
+   (see 'o') and appear in periodic-stats */
+#define START_SCENARIO "inversion"
+
 /* ---------- Task priorities ---------- */
-#define PRIO_LOW        (tskIDLE_PRIORITY + 1)   /* L */
-#define PRIO_MEDIUM     (tskIDLE_PRIORITY + 2)   /* M */
-#define PRIO_HIGH       (tskIDLE_PRIORITY + 3)   /* H */
+#define PRIO_MEDIUM     (tskIDLE_PRIORITY + 2)   /* Ctl, level with M */
+#define PRIO_HIGH       (tskIDLE_PRIORITY + 3)   /* H, so the ceiling of xResLock */
+
+/* ---------- Task stack sizes (words) ----------
+   Fixed at compile time, so with demoSTATIC_ALLOCATION=1 the whole footprint is in the link map */
+#define STACK_CTL           (configMINIMAL_STACK_SIZE + 256)
+#define STACK_STATE_REC     (configMINIMAL_STACK_SIZE + 256)
+#define STACK_TRACE_DRAIN   (configMINIMAL_STACK_SIZE + 256)
+#define STACK_AUDITOR       (configMINIMAL_STACK_SIZE + 256)
+#define STACK_WORKLOAD      (configMINIMAL_STACK_SIZE + 256)
+#define STACK_OUTPUT        (configMINIMAL_STACK_SIZE + 256)
 
 /* ---------- Timing knobs (tune if needed) ---------- */
-#define L_REPEAT_PERIOD_MS      3000   /* How often L does a long resource use */
-#define H_START_DELAY_MS         150   /* H tries a bit after L starts */
-#define M_BURST_SLICE_ITER     20000   /* Busy work iterations per slice */
-#define M_BURST_CYCLES            50   /* How many slices per burst before yielding */
-#define HOLD_DELAY_PER_CHAR_MS     10  /* Makes L hold lock longer per printed char */
+#define HOLD_DELAY_PER_CHAR_MS     10  /* Makes the slow output take longer per printed char */
+#define STATE_SAMPLE_TICKS          1  /* Task state timeline sample period used by 'r' (1 = every tick) */
 
-#if USE_MUTEX
-static SemaphoreHandle_t xResLock;     /* actually a mutex */
-#else
-static SemaphoreHandle_t xResLock;     /* binary semaphore */
-#endif
+/* Mutex, binary semaphore or priority ceiling, switchable with the lock-mode command */
+static DemoLockHandle_t xResLock;
 
 static TaskHandle_t hL, hM, hH;
 
-static char stateChar(eTaskState s, TaskHandle_t h) {
-    if (xTaskGetCurrentTaskHandle() == h) return 'R';
-    switch (s) {
-    case eReady:     return 'r';
-    case eBlocked:   return 'B';
-    case eSuspended: return 'S';
-    default:         return '?';
-    }
+/* The stacks and TCBs of the tasks created here, named arrays in the link map with
+   demoSTATIC_ALLOCATION=1 (xCtlMemoryStacks and so on).  The modules' tasks have their own */
+demoTASK_MEMORY(xCtlMemory, 1, STACK_CTL);
+
+#if (configUSE_TICK_HOOK == 1)
+/* Samples the task running on each core, see "run-time-stats cores" */
+void vApplicationTickHook(void)
+{
+    vCoreStatsTickHook();
 }
+#endif
 
-static void vStateProbe(void* pv) {
-    (void)pv;
-    for (;;) {
-        eTaskState sL = eTaskGetState(hL);
-        eTaskState sM = eTaskGetState(hM);
-        eTaskState sH = eTaskGetState(hH);
-        //printf("[t=%ums] L:%c M:%c H:%c\n",
-            //(unsigned)pdTICKS_TO_MS(xTaskGetTickCount()),
-            //stateChar(sL, hL), stateChar(sM, hM), stateChar(sH, hH));
-        vTaskDelay(pdMS_TO_TICKS(50));
-    }
+/* Run a CLI command and print its output to the console.  The command holds its dispatch
+   lock until it completes, so the output is collected first and only printed once the
+   lock is released, unless it is longer than the buffer.  That way a slow console does
+   not hold up the same commands sent over UDP */
+#define CLI_OUT_SIZE      4096
+#define CLI_CHUNK_SIZE    512
+static void run_cli_command(const char* cmd)
+{
+    static int8_t out[CLI_OUT_SIZE];
+    CLIDispatchContext_t ctx;
+    portBASE_TYPE more;
+    size_t used = 0;
+
+    vCLIDispatchInitContext(&ctx);
+    do {
+        if (sizeof(out) - used < CLI_CHUNK_SIZE) {
+            /* Full, so print what there is while the lock is still held */
+            fputs((const char*)out, stdout);
+            used = 0;
+        }
+        out[used] = 0x00;
+        more = xCLIDispatchProcessCommand(&ctx, (const int8_t*)cmd, &out[used], sizeof(out) - used);
+        used += strlen((const char*)&out[used]);
+    } while (more != pdFALSE);
+    fputs((const char*)out, stdout);
+    fflush(stdout);
 }
 
 static void vConsoleCtl(void* pv) {
     (void)pv;
     printf("Keys: m= suspend M, n= resume M, s= suspend L, d= resume L, "
-        "a= suspend H, f= resume H, e= trigger event, q= SuspendAll, w= ResumeAll\n");
+        "a= suspend H, f= resume H, e= trigger event, q= SuspendAll, w= ResumeAll, "
+        "l= lock stats, k= clear lock stats, t= dump timeline, r= start/stop timeline\n");
+    printf("o= switch between direct and deferred output (shows the lock and H stats, then clears them)\n");
+    StateRecorderInfo_t rec;
+    char c;
     for (;;) {
-        if (_kbhit()) {
-            int c = _getch();
+        /* Sleep until a key is pressed.  Blocking is not allowed while the
+           scheduler is suspended ('q'), so until 'w' just check for keys */
+        TickType_t wait = (xTaskGetSchedulerState() == taskSCHEDULER_SUSPENDED) ? 0 : portMAX_DELAY;
+        if (xConsoleInputReceive(&c, wait) != pdFALSE) {
             switch (c) {
             case 'm': vTaskSuspend(hM); puts("[ctl] Suspended M"); break;
             case 'n': vTaskResume(hM); puts("[ctl] Resumed M"); break;
@@ -70,10 +137,28 @@ static void vConsoleCtl(void* pv) {
             case 'q': vTaskSuspendAll(); puts("[ctl] SuspendAll"); break;
             case 'w': xTaskResumeAll();  puts("[ctl] ResumeAll"); break;
             case 'e': xTaskNotifyGive(hH); puts("[ctl] Event -> notified H"); break;
+            case 'l': run_cli_command("lock-stats"); break;
+            case 'k': run_cli_command("lock-stats reset"); break;
+            case 't': run_cli_command("task-timeline"); break;
+            case 'o':
+                /* The stats so far are "before", clear them so the next 'l' shows "after" */
+                run_cli_command("lock-stats");
+                run_cli_command("periodic-stats");
+                vDeferredOutputSetEnabled(!xDeferredOutputIsEnabled());
+                run_cli_command("lock-stats reset");
+                run_cli_command("periodic-stats reset");
+                puts(xDeferredOutputIsEnabled() ? "[ctl] Output deferred to the Output task" : "[ctl] Output direct, under the lock");
+                break;
+            case 'r':
+                /* May have been started or stopped with task-timeline since */
+                vStateRecorderGetInfo(&rec);
+                if (!rec.xRecording) vStateRecorderStart(STATE_SAMPLE_TICKS);
+                else vStateRecorderStop();
+                puts(!rec.xRecording ? "[ctl] Timeline started" : "[ctl] Timeline stopped");
+                break;
                
             }
         }
-        vTaskDelay(pdMS_TO_TICKS(10));
     }
 }
 
@@ -90,108 +175,48 @@ static void logf(const char* tag, const char* fmt, ...)
     fflush(stdout);
 }
 
-
-/* Simulated resource: print a string char-by-char WHILE holding the lock */
-static void use_shared_resource(const char* who, const char* msg)
+/* The slow device: print a string char-by-char.  Called by the Output task in deferred mode, otherwise by the writer */
+static void write_slowly(const char* msg, size_t len)
 {
-    /* Expect lock is already taken by caller */
-    for (const char* p = msg; *p; ++p)
+    for (size_t i = 0; i < len; ++i)
     {
-        putchar(*p);
+        putchar(msg[i]);
         fflush(stdout);
         vTaskDelay(pdMS_TO_TICKS(HOLD_DELAY_PER_CHAR_MS+100));
     }
-    putchar('\n'); 
+    putchar('\n');
     fflush(stdout);
 }
 
-/* ------------------ Task L (Low) ------------------ */
-static void vTaskL(void* pv)
-{
-    (void)pv;
-    const char* bigMsg = "L: Using the resource very SLOWLY (simulating long critical section) ...";
-    for (;;)
-    {
-        //logf("L", "Attempting to take lock...");
-        if (xSemaphoreTake(xResLock, portMAX_DELAY) == pdPASS)
-        {
-            logf("L", "Got lock, starting long use.");
-            vTaskDelay(pdMS_TO_TICKS(100));
-            /* Keep the lock WHILE doing slow prints (this is bad on purpose) */
-            use_shared_resource("L", bigMsg);
-            logf("L", "Releasing lock.");
-            xSemaphoreGive(xResLock);
-        }
-        /* Do it again later */
-        vTaskDelay(pdMS_TO_TICKS(L_REPEAT_PERIOD_MS));
-    }
-}
-
-/* ------------------ Task H (High) ------------------ */
-static void vTaskH(void* pv)
-{
-    (void)pv;
-    /* Start slightly later than L so L likely holds the resource */
-    vTaskDelay(pdMS_TO_TICKS(H_START_DELAY_MS));
-    for (;;)
-    {
-        //logf("H", "Needs resource; trying to take lock...");
-        TickType_t t0 = xTaskGetTickCount();
-        if (xSemaphoreTake(xResLock, portMAX_DELAY) == pdPASS)
-        {
-            TickType_t t1 = xTaskGetTickCount();
-            logf("H", "Acquired lock after %u ms wait.",
-                (unsigned)pdTICKS_TO_MS(t1 - t0));
-
-            /* Quick use, then release */
-            use_shared_resource("H", "H: quick critical section done.");
-            xSemaphoreGive(xResLock);
-            logf("H", "Released lock, work complete.");
-
-            /* Wait a while so we see repeated cycles */
-            vTaskDelay(pdMS_TO_TICKS(1500));
-        }
-    }
-}
-
-/* ------------------ Task M (Medium) ------------------ */
-/* Does bursts of CPU work (not using the resource), to preempt L while H is blocked */
-static void vTaskM(void* pv)
+/* Pin L/M/H as selected by SMP_PLACEMENT.  The UDP server pins its own tasks, see srvPIN_WORKERS */
+static void place_tasks(void)
 {
-    (void)pv;
-    unsigned burst = 0;
-    volatile unsigned sink = 0;
+    static const UBaseType_t masks[][3] = {
+        /*   L                   M                   H        */
+        { corestatsALL_CORES, corestatsALL_CORES, corestatsALL_CORES },
+        { 0x1,                0x1,                0x1                },
+        { 0x1,                0x2,                0x1                },
+        { 0x1,                0x1,                0x2                },
+    };
+    const UBaseType_t* m = masks[SMP_PLACEMENT];
 
-    for (;;)
-    {
-        /* Busy for a while, then yield briefly */
-        for (unsigned c = 0; c < M_BURST_CYCLES; ++c)
-        {
-            for (unsigned i = 0; i < M_BURST_SLICE_ITER; ++i)
-            {
-                sink ^= (i ^ sink); /* useless math to burn CPU */
-            }
-            /* keep runnable; a tiny delay still keeps M dominant over L */
-            vTaskDelay(pdMS_TO_TICKS(1));
-        }
-        //logf("M", "Finished a CPU burst #%u (not using resource).", ++burst);
-
-        /* Tiny pause between bursts */
-        vTaskDelay(pdMS_TO_TICKS(10));
-    }
+    /* Fails on a single core build, where there is nothing to place */
+    if (xCoreStatsSetAffinity(hL, m[0]) == pdPASS &&
+        xCoreStatsSetAffinity(hM, m[1]) == pdPASS &&
+        xCoreStatsSetAffinity(hH, m[2]) == pdPASS)
+        logf("SYS", "SMP placement %d on %d cores (L 0x%x, M 0x%x, H 0x%x)", SMP_PLACEMENT, corestatsNUMBER_OF_CORES,
+            (unsigned)m[0], (unsigned)m[1], (unsigned)m[2]);
 }
 
 static void create_lock(void)
 {
-#if USE_MUTEX
-    xResLock = xSemaphoreCreateMutex();
+    /* USE_MUTEX only picks the starting mode; H is the highest priority user, so is the ceiling.
+       Both underlying locks are profiled, so "lock-stats" shows the waits and holds */
+    xResLock = xDemoLockCreate("xResLock", USE_MUTEX ? eDemoLockMutex : eDemoLockSemaphore, PRIO_HIGH);
     configASSERT(xResLock != NULL);
+#if USE_MUTEX
     logf("SYS", "Using MUTEX (priority inheritance ENABLED).");
 #else
-    xResLock = xSemaphoreCreateBinary();
-    configASSERT(xResLock != NULL);
-    /* Binary semaphores start empty; give once so it behaves like unlocked. */
-    xSemaphoreGive(xResLock);
     logf("SYS", "Using BINARY SEMAPHORE (NO priority inheritance).");
 #endif
 }
@@ -201,15 +226,66 @@ int main(void)
     printf("\n=== FreeRTOS Priority Inversion Demo (USE_MUTEX=%d) ===\n", USE_MUTEX);
 
     create_lock();
+    vRegisterCLICommands();
 
     /* Create tasks: L lowest, M middle, H highest */
     BaseType_t ok = pdPASS;
-    ok &= xTaskCreate(vTaskL, "L", configMINIMAL_STACK_SIZE + 512, NULL, PRIO_LOW, &hL);
-    ok &= xTaskCreate(vTaskM, "M", configMINIMAL_STACK_SIZE + 512, NULL, PRIO_MEDIUM, &hM);
-    ok &= xTaskCreate(vTaskH, "H", configMINIMAL_STACK_SIZE + 512, NULL, PRIO_HIGH, &hH);
-    ok &= xTaskCreate(vStateProbe, "Probe", configMINIMAL_STACK_SIZE + 256, NULL, tskIDLE_PRIORITY, NULL);
-    ok &= xTaskCreate(vConsoleCtl, "Ctl", configMINIMAL_STACK_SIZE + 256, NULL, PRIO_MEDIUM, NULL);
+    /* The scenario's lock 0 is xResLock, so USE_MUTEX and lock-mode apply to it */
+    ok &= xWorkloadSetLock(0, xResLock);
+    vStartWorkload(STACK_WORKLOAD);
+    ok &= xWorkloadLoadScenario(START_SCENARIO);
+    hL = xWorkloadGetTaskHandle(0);
+    hM = xWorkloadGetTaskHandle(1);
+    hH = xWorkloadGetTaskHandle(2);
+
+    /* Below L, so the slow printing never delays L/M/H */
+    vStartDeferredOutputTask(STACK_OUTPUT, tskIDLE_PRIORITY, write_slowly);
+    vDeferredOutputSetEnabled(USE_DEFERRED_OUTPUT);
+    ok &= xDemoTaskCreate(vConsoleCtl, "Ctl", STACK_CTL, NULL, PRIO_MEDIUM, NULL, &xCtlMemory);
+    configASSERT(ok == pdPASS);
+    place_tasks();
+
+    /* Key presses for Ctl come from a Windows thread, so Ctl only wakes when a key is pressed */
+    vConsoleInputStart();
+
+    /* Scheduler state timeline of L/M/H, sampled from above all of them.  Sampling every tick
+       from the top priority costs a wake-up per tick, so it only starts on request */
+    vStartStateRecorderTask(STACK_STATE_REC, configMAX_PRIORITIES - 1);
+    ok &= xStateRecorderRegisterTask(hL);
+    ok &= xStateRecorderRegisterTask(hM);
+    ok &= xStateRecorderRegisterTask(hH);
     configASSERT(ok == pdPASS);
+    logf("SYS", "Timeline not recording, start it with 'r' or task-timeline start");
+
+    /* Stack high water marks of every task, see the stack-stats command */
+    vStartStackAuditorTask(STACK_AUDITOR, tskIDLE_PRIORITY);
+
+    vWorkloadStart();
+
+#if USE_TRACE_RING
+    /* One ring per demo task; printed from below M so printing never delays L/M/H */
+    {
+        UBaseType_t formats;
+        const char* const* table = ppcWorkloadGetTraceFormats(&formats);
+        vTraceRingSetFormats(table, formats);
+    }
+    ok &= xTraceRingRegisterTask(hL);
+    ok &= xTraceRingRegisterTask(hM);
+    ok &= xTraceRingRegisterTask(hH);
+    configASSERT(ok == pdPASS);
+    vStartTraceRingDrainTask(STACK_TRACE_DRAIN, tskIDLE_PRIORITY);
+#endif
+
+#if demoSTATIC_ALLOCATION
+    {
+        DemoStaticStats_t st;
+        vDemoStaticGetStats(&st);
+        printf("Static allocation: %u tasks, %u stack words, %u semaphores, %u queue bytes\n",
+            (unsigned)st.uxTasks, (unsigned)st.xStackWords,
+            (unsigned)st.uxSemaphores, (unsigned)st.xQueueBytes);
+        configASSERT(st.ulFailures == 0);
+    }
+#endif
 
 
     vTaskStartScheduler();